@@ -84,6 +84,7 @@ declare -a testScripts=(
     'p2p_txexpiry_dos.py'
     'p2p_txexpiringsoon.py'
     'p2p_node_bloom.py'
+    'p2p_compactblocks.py'
     'regtest_signrawtransaction.py'
     'finalsaplingroot.py'
 )
@@ -111,6 +112,7 @@ declare -a testScriptsMN1=(
     'mn_payment.py'
     'mn_bugs.py'
     'mn_expiration.py'
+    'mn_list_sync.py'
 )
 
 declare -a testScriptsMN2=(
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The Pastel Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or https://www.opensource.org/licenses/mit-license.php.
+import os
+import re
+import time
+from decimal import getcontext
+
+from test_framework.util import (
+    assert_equal,
+    assert_true,
+    initialize_chain_clean,
+    start_node,
+    stop_node,
+    connect_nodes_bi
+)
+from mn_common import MasterNodeCommon
+
+getcontext().prec = 16
+
+DSEGC_SENT_PATTERN = re.compile(r"DSEGC -- Sent (\d+) of (\d+) Masternode invs")
+
+class MasterNodeListSyncTest(MasterNodeCommon):
+    """ Compact masternode list sync (dsegc) between two nodes.
+        Sync node is connected only to the list source node:
+        - with empty masternode cache it receives all masternode entries;
+        - with the same list the digests match and no entries are sent.
+    """
+
+    def __init__(self):
+        super().__init__()
+
+        self.number_of_master_nodes = 3
+        self.number_of_simple_nodes = 3
+        self.number_of_cold_nodes = self.number_of_master_nodes
+
+        self.mining_node_num = self.number_of_master_nodes      # list source node
+        self.hot_node_num = self.number_of_master_nodes + 1
+        self.sync_node_num = self.number_of_master_nodes + 2    # node that syncs the list
+        self.setup_clean_chain = True
+        self.is_network_split = False
+
+
+    def setup_chain(self):
+        print("Initializing test directory " + self.options.tmpdir)
+        initialize_chain_clean(self.options.tmpdir, self.total_number_of_nodes)
+
+
+    def setup_network(self, split=False):
+        self.nodes = []
+        self.is_network_split = False
+        self.setup_masternodes_network("masternode")
+
+
+    def get_log_path(self, node_num: int) -> str:
+        return os.path.join(self.options.tmpdir, f"node{node_num}", "regtest", "debug.log")
+
+
+    def get_dsegc_replies(self, node_num: int, log_offset: int) -> list:
+        """ Get (sent, total) pairs of the dsegc replies logged by the node after the given offset.
+        """
+        with open(self.get_log_path(node_num), "r", encoding="utf8") as f:
+            f.seek(log_offset)
+            return [(int(m.group(1)), int(m.group(2))) for m in DSEGC_SENT_PATTERN.finditer(f.read())]
+
+
+    def restart_sync_node(self, clear_cache: bool):
+        print(f"Restarting sync node {self.sync_node_num}, clear masternode cache: {clear_cache}")
+        stop_node(self.nodes[self.sync_node_num])
+        if clear_cache:
+            cache_path = os.path.join(self.options.tmpdir, f"node{self.sync_node_num}", "regtest", "mncache.dat")
+            if os.path.exists(cache_path):
+                os.remove(cache_path)
+        self.nodes[self.sync_node_num] = start_node(self.sync_node_num, self.options.tmpdir, ["-debug=masternode"])
+        # two-node sync: sync node is connected only to the list source node
+        connect_nodes_bi(self.nodes, self.sync_node_num, self.mining_node_num)
+
+
+    def wait_for_dsegc_reply(self, log_offset: int, wait_secs: int = 120) -> list:
+        replies = []
+        while wait_secs > 0 and not replies:
+            time.sleep(5)
+            wait_secs -= 5
+            replies = self.get_dsegc_replies(self.mining_node_num, log_offset)
+        assert_true(replies, "Timeout period elapsed waiting for the dsegc reply")
+        return replies
+
+
+    def wait_for_same_list(self, wait_secs: int = 120):
+        source_list = self.nodes[self.mining_node_num].masternodelist()
+        while wait_secs > 0:
+            if self.nodes[self.sync_node_num].masternodelist().keys() == source_list.keys():
+                return
+            time.sleep(5)
+            wait_secs -= 5
+        assert_equal(sorted(source_list.keys()), sorted(self.nodes[self.sync_node_num].masternodelist().keys()))
+
+
+    def run_test(self):
+        source_list = self.nodes[self.mining_node_num].masternodelist()
+        assert_equal(len(source_list), self.number_of_master_nodes)
+
+        print("=== Compact list sync with empty masternode cache ===")
+        log_offset = os.path.getsize(self.get_log_path(self.mining_node_num))
+        self.restart_sync_node(True)
+        replies = self.wait_for_dsegc_reply(log_offset)
+        print(f"dsegc replies (sent, total): {replies}")
+        # all entries are sent to the node with empty list
+        assert_true((len(source_list), len(source_list)) in replies, "Not all masternode entries were sent")
+        self.wait_for_same_list()
+
+        print("=== Compact list sync with the same masternode list ===")
+        # entries are not sent if the digests match,
+        # retry in case masternode ping was updated in between
+        for _ in range(3):
+            log_offset = os.path.getsize(self.get_log_path(self.mining_node_num))
+            assert_equal(self.nodes[self.sync_node_num].mnsync("reset"), "success")
+            replies = self.wait_for_dsegc_reply(log_offset)
+            print(f"dsegc replies (sent, total): {replies}")
+            if (0, len(source_list)) in replies:
+                break
+            self.wait_for_same_list()
+        assert_true((0, len(source_list)) in replies, "Masternode entries were sent for the same list")
+
+
+if __name__ == '__main__':
+    MasterNodeListSyncTest().main()
@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+# Copyright (c) 2024 The Pastel Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or https://www.opensource.org/licenses/mit-license.php .
+
+#
+# Test compact block relay and compare block propagation time
+# between two nodes with and without compact blocks (-compactblocks).
+#
+
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_greater_than, \
+    start_nodes, stop_nodes, wait_pastelds, connect_nodes_bi, sync_blocks, sync_mempools
+
+import time
+
+class CompactBlocksTest(BitcoinTestFramework):
+
+    TX_PER_BLOCK = 40
+    BLOCK_COUNT = 5
+
+    def __init__(self):
+        super().__init__()
+        self.num_nodes = 2
+        self.setup_clean_chain = False
+
+    def setup_network(self):
+        self.start_network(True)
+
+    def start_network(self, compact_blocks):
+        args = ["-debug=net", f"-compactblocks={1 if compact_blocks else 0}"]
+        self.nodes = start_nodes(self.num_nodes, self.options.tmpdir, [args] * self.num_nodes)
+        connect_nodes_bi(self.nodes, 0, 1)
+        self.is_network_split = False
+        self.sync_all()
+
+    def restart_network(self, compact_blocks):
+        stop_nodes(self.nodes)
+        wait_pastelds()
+        self.start_network(compact_blocks)
+
+    def get_peer_stats(self, node):
+        peers = node.getpeerinfo()
+        return sum(peer["cmpctblocks"] for peer in peers), sum(peer["cmpctblocktxnreqs"] for peer in peers)
+
+    def disconnect_nodes(self):
+        for peer in self.nodes[0].getpeerinfo():
+            self.nodes[0].disconnectnode(peer["addr"])
+        while any(len(node.getpeerinfo()) for node in self.nodes):
+            time.sleep(0.1)
+
+    def wait_for_block(self, node, blockhash, timeout = 60):
+        start = time.time()
+        while node.getbestblockhash() != blockhash:
+            if time.time() - start > timeout:
+                raise AssertionError(f"block {blockhash} was not received in {timeout} secs")
+            time.sleep(0.01)
+        return time.time() - start
+
+    def measure_propagation(self, mode):
+        """Mine blocks with mempool transactions on node0 and measure the time until node1 has them."""
+        # first block makes the chain tip recent, so the next blocks are requested directly
+        self.nodes[0].generate(1)
+        sync_blocks(self.nodes)
+
+        address = self.nodes[1].getnewaddress()
+        total_time = 0
+        for _ in range(self.BLOCK_COUNT):
+            for _ in range(self.TX_PER_BLOCK):
+                self.nodes[0].sendtoaddress(address, 1)
+            sync_mempools(self.nodes)
+            blockhash = self.nodes[0].generate(1)[0]
+            total_time += self.wait_for_block(self.nodes[1], blockhash)
+        assert_equal(self.nodes[1].getmempoolinfo()['size'], 0)
+        print(f"{mode}: {self.BLOCK_COUNT} blocks with {self.TX_PER_BLOCK} txs, "
+              f"average propagation time {1000 * total_time / self.BLOCK_COUNT:.1f} ms")
+        return total_time
+
+    def run_test(self):
+        print("Block propagation with compact blocks")
+        compact_time = self.measure_propagation("compact blocks")
+        cmpctblocks, txnreqs = self.get_peer_stats(self.nodes[1])
+        # all transactions are in the receiver mempool, no round-trips
+        assert_greater_than(cmpctblocks, self.BLOCK_COUNT - 1)
+        assert_equal(txnreqs, 0)
+
+        print("Compact block with transactions missing in the receiver mempool")
+        address = self.nodes[1].getnewaddress()
+        self.nodes[0].sendtoaddress(address, 1)
+        sync_mempools(self.nodes)
+        # the second transaction is not relayed to node1
+        self.disconnect_nodes()
+        self.nodes[0].sendtoaddress(address, 1)
+        connect_nodes_bi(self.nodes, 0, 1)
+        blockhash = self.nodes[0].generate(1)[0]
+        self.wait_for_block(self.nodes[1], blockhash)
+        cmpctblocks, txnreqs = self.get_peer_stats(self.nodes[1])
+        assert_equal(cmpctblocks, 1)
+        assert_equal(txnreqs, 1)
+        assert_equal(self.nodes[1].getmempoolinfo()['size'], 0)
+
+        print("Block propagation without compact blocks")
+        self.restart_network(False)
+        full_time = self.measure_propagation("full blocks")
+        cmpctblocks, txnreqs = self.get_peer_stats(self.nodes[1])
+        assert_equal(cmpctblocks, 0)
+        assert_equal(txnreqs, 0)
+
+        print(f"Propagation time: compact blocks {1000 * compact_time:.1f} ms, full blocks {1000 * full_time:.1f} ms")
+
+if __name__ == '__main__':
+    CompactBlocksTest().main()
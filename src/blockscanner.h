@@ -4,7 +4,7 @@
 #pragma once
 #include <memory>
 #include <functional>
-#include <unordered_map>
+#include <map>
 
 #include <utils/vector_types.h>
 #include <consensus/params.h>
@@ -42,6 +42,6 @@ private:
     static constexpr size_t BLOCK_SCANNER_MAX_OFFSETS_PER_THREAD = 10000U;
 
     std::vector<std::unique_ptr<BlockScannerTask>> m_vTasks;
-    std::unordered_map<int, v_uint32> m_mapBlockFiles;
+    std::map<int, v_uint32> m_mapBlockFiles; // block file number -> block offsets, files are scanned in ascending order
 };
 
@@ -104,10 +104,7 @@ typedef u_int SOCKET;
 size_t strnlen( const char *start, size_t max_len);
 #endif // HAVE_DECL_STRNLEN
 
+// sockets are polled with epoll/poll on POSIX systems and are not limited by FD_SETSIZE
 bool static inline IsSelectableSocket(SOCKET s) {
-#ifdef WIN32
     return true;
-#else
-    return (s < FD_SETSIZE);
-#endif
 }
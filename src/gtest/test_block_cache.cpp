@@ -0,0 +1,182 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <gtest/gtest.h>
+
+#include <utils/fs.h>
+#include <main.h>
+#include <netmsg/block-cache.h>
+
+#include <pastel_gtest_main.h>
+
+using namespace std;
+using namespace testing;
+
+class CTestBlockCache : public CBlockCache
+{
+public:
+    bool is_waiting(const uint256& hash) const
+    {
+        unique_lock lck(m_CacheMapLock);
+        return m_BlockCacheMap.at(hash).bWaiting;
+    }
+
+    bool is_ready(const uint256& hash) const
+    {
+        unique_lock lck(m_CacheMapLock);
+        return m_BlockCacheMap.at(hash).bReady;
+    }
+
+    bool is_spilled(const uint256& hash) const
+    {
+        unique_lock lck(m_CacheMapLock);
+        return m_BlockCacheMap.at(hash).bSpilled;
+    }
+
+    size_t ready_count() const
+    {
+        unique_lock lck(m_CacheMapLock);
+        return m_nReadyCount;
+    }
+
+    fs::path spill_file_path(const uint256& hash) const
+    {
+        return GetSpillFilePath(hash);
+    }
+
+    bool load_spilled_block(const uint256& hash, CBlock &block)
+    {
+        unique_lock lck(m_CacheMapLock);
+        auto& item = m_BlockCacheMap.at(hash);
+        if (!LoadSpilledBlock(hash, item))
+            return false;
+        block = item.block;
+        return true;
+    }
+
+    void delete_block(const uint256& hash)
+    {
+        unique_lock lck(m_CacheMapLock);
+        DeleteCacheItems(__func__, { hash });
+    }
+};
+
+class TestBlockCache : public Test
+{
+public:
+    static void SetUpTestSuite()
+    {
+        gl_pPastelTestEnv->InitializeRegTest();
+    }
+
+    static void TearDownTestSuite()
+    {
+        gl_pPastelTestEnv->FinalizeRegTest();
+    }
+
+protected:
+    static CBlock CreateBlock(const uint256& hashPrevBlock, const uint32_t nTime, const size_t nDataSize = 100)
+    {
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout.SetNull();
+        mtx.vin[0].scriptSig = CScript() << v_uint8(nDataSize, 0x01);
+        mtx.vout.resize(1);
+        mtx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+        mtx.vout[0].nValue = 0;
+
+        CBlock block;
+        block.hashPrevBlock = hashPrevBlock;
+        block.nTime = nTime;
+        block.vtx.emplace_back(mtx);
+        block.hashMerkleRoot = block.BuildMerkleTree();
+        return block;
+    }
+};
+
+TEST_F(TestBlockCache, waiting_blocks)
+{
+    CTestBlockCache cache;
+    const uint256 hashPrev = GetRandHash();
+    CBlock block1 = CreateBlock(hashPrev, 1);
+    const uint256 hash1 = block1.GetHash();
+    CBlock block2 = CreateBlock(hash1, 2);
+    const uint256 hash2 = block2.GetHash();
+
+    cache.add_block(hash1, 1, TxOrigin::MSG_BLOCK, std::move(block1));
+    cache.add_block(hash2, 1, TxOrigin::MSG_BLOCK, std::move(block2));
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_TRUE(cache.is_waiting(hash1));
+    EXPECT_TRUE(cache.is_waiting(hash2));
+
+    // unrelated block does not wake up any cached blocks
+    cache.block_connected(GetRandHash());
+    EXPECT_EQ(cache.ready_count(), 0u);
+
+    // only direct dependents are woken up
+    cache.block_connected(hashPrev);
+    EXPECT_EQ(cache.ready_count(), 1u);
+    EXPECT_TRUE(cache.is_ready(hash1));
+    EXPECT_FALSE(cache.is_waiting(hash1));
+    EXPECT_TRUE(cache.is_waiting(hash2));
+    EXPECT_FALSE(cache.is_ready(hash2));
+
+    // removing the block from the cache wakes up its dependents
+    cache.delete_block(hash1);
+    EXPECT_FALSE(cache.exists(hash1));
+    EXPECT_EQ(cache.ready_count(), 1u);
+    EXPECT_TRUE(cache.is_ready(hash2));
+
+    cache.delete_block(hash2);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.ready_count(), 0u);
+    EXPECT_EQ(cache.mem_usage(), 0u);
+}
+
+TEST_F(TestBlockCache, spill_to_disk)
+{
+    constexpr size_t TEST_BLOCK_DATA_SIZE = 10'000;
+    constexpr size_t TEST_BLOCK_COUNT = 5;
+
+    const fs::path spillDir = fs::temp_directory_path() / fs::unique_path();
+    CTestBlockCache cache;
+    // keep only two blocks in memory
+    cache.set_max_mem_usage(2 * TEST_BLOCK_DATA_SIZE + TEST_BLOCK_DATA_SIZE / 2, spillDir);
+
+    v_uint256 vHashes;
+    uint256 hashPrev = GetRandHash();
+    for (uint32_t i = 0; i < TEST_BLOCK_COUNT; ++i)
+    {
+        CBlock block = CreateBlock(hashPrev, i + 1, TEST_BLOCK_DATA_SIZE);
+        hashPrev = block.GetHash();
+        vHashes.push_back(hashPrev);
+        cache.add_block(hashPrev, 1, TxOrigin::MSG_BLOCK, std::move(block));
+        EXPECT_LE(cache.mem_usage(), 2 * TEST_BLOCK_DATA_SIZE + TEST_BLOCK_DATA_SIZE / 2);
+    }
+    EXPECT_EQ(cache.size(), TEST_BLOCK_COUNT);
+
+    size_t nSpilled = 0;
+    for (const auto& hash : vHashes)
+    {
+        if (!cache.is_spilled(hash))
+            continue;
+        ++nSpilled;
+        EXPECT_TRUE(fs::exists(cache.spill_file_path(hash)));
+    }
+    EXPECT_EQ(nSpilled, TEST_BLOCK_COUNT - 2);
+
+    // spilled block is loaded back from disk
+    const auto it = find_if(vHashes.cbegin(), vHashes.cend(), [&](const auto& hash) { return cache.is_spilled(hash); });
+    ASSERT_NE(it, vHashes.cend());
+    CBlock block;
+    EXPECT_TRUE(cache.load_spilled_block(*it, block));
+    EXPECT_EQ(block.GetHash(), *it);
+    EXPECT_FALSE(fs::exists(cache.spill_file_path(*it)));
+
+    // spill files are removed with the cached blocks
+    for (const auto& hash : vHashes)
+        cache.delete_block(hash);
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_TRUE(fs::is_empty(spillDir));
+    fs::remove_all(spillDir);
+}
@@ -64,6 +64,33 @@ TEST(CheckBlock, BlockSproutRejectsBadVersion)
 }
 
 
+// Context-free checks do not look up the mnid registration ticket,
+// block with unknown Pastel ID is rejected by the transaction checks.
+TEST(CheckBlock, ContextFreeSkipsMnidTicket)
+{
+    SelectParams(ChainNetwork::MAIN);
+    auto verifier = libzcash::ProofVerifier::Strict();
+
+    CMutableTransaction mtx;
+    mtx.vin.resize(1);
+    mtx.vin[0].prevout.SetNull();
+    mtx.vin[0].scriptSig = CScript() << 1 << OP_0;
+    mtx.vout.resize(1);
+    mtx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+    mtx.vout[0].nValue = 0;
+
+    CBlock block;
+    block.vtx.emplace_back(mtx);
+    block.vtx.emplace_back(mtx);
+    block.sPastelID = "unknown-mnid";
+
+    MockCValidationState state(TxOrigin::MSG_BLOCK);
+    EXPECT_CALL(state, DoS(100, false, REJECT_INVALID, "bad-cb-multiple", false, Ne(""))).Times(1);
+    uint256 hashBlock;
+    EXPECT_FALSE(CheckBlockContextFree(block, hashBlock, state, Params(), verifier, BlockPoWCheck::NONE, false));
+    EXPECT_EQ(hashBlock, block.GetHash());
+}
+
 class ContextualCheckBlockTest : public ::testing::Test
 {
 protected:
@@ -0,0 +1,208 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <gtest/gtest.h>
+
+#include <utils/streams.h>
+#include <version.h>
+#include <txmempool.h>
+#include <netmsg/compact-block.h>
+
+#include <pastel_gtest_main.h>
+#include <test_mempool_entryhelper.h>
+
+using namespace std;
+using namespace testing;
+
+class TestCompactBlock : public Test
+{
+public:
+    static void SetUpTestSuite()
+    {
+        gl_pPastelTestEnv->InitializeRegTest();
+    }
+
+    static void TearDownTestSuite()
+    {
+        gl_pPastelTestEnv->FinalizeRegTest();
+    }
+
+protected:
+    static CMutableTransaction CreateTransaction(const uint32_t n)
+    {
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].prevout.hash = GetRandHash();
+        mtx.vin[0].prevout.n = n;
+        mtx.vin[0].scriptSig = CScript() << OP_11;
+        mtx.vout.resize(1);
+        mtx.vout[0].scriptPubKey = CScript() << OP_11 << OP_EQUAL;
+        mtx.vout[0].nValue = 1000 + n;
+        return mtx;
+    }
+
+    // create block with coinbase and nTxCount transactions
+    static CBlock CreateBlock(const size_t nTxCount)
+    {
+        CMutableTransaction coinbase;
+        coinbase.vin.resize(1);
+        coinbase.vin[0].prevout.SetNull();
+        coinbase.vin[0].scriptSig = CScript() << OP_1 << OP_1;
+        coinbase.vout.resize(1);
+        coinbase.vout[0].scriptPubKey = CScript() << OP_TRUE;
+        coinbase.vout[0].nValue = 0;
+
+        CBlock block;
+        block.hashPrevBlock = GetRandHash();
+        block.nTime = 1;
+        block.vtx.emplace_back(coinbase);
+        for (uint32_t i = 0; i < nTxCount; ++i)
+            block.vtx.emplace_back(CreateTransaction(i));
+        block.hashMerkleRoot = block.BuildMerkleTree();
+        return block;
+    }
+
+    template <typename T>
+    static T SerializeRoundTrip(const T& obj)
+    {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << obj;
+        T result;
+        ss >> result;
+        EXPECT_TRUE(ss.empty());
+        return result;
+    }
+};
+
+TEST_F(TestCompactBlock, serialization)
+{
+    const CBlock block = CreateBlock(5);
+    const CBlockHeaderAndShortTxIDs cmpctblock(block);
+    EXPECT_EQ(cmpctblock.BlockTxCount(), block.vtx.size());
+    ASSERT_EQ(cmpctblock.prefilledtxn.size(), 1u);
+    EXPECT_EQ(cmpctblock.prefilledtxn[0].index, 0u);
+
+    const auto cmpctblock2 = SerializeRoundTrip(cmpctblock);
+    EXPECT_EQ(cmpctblock2.header.GetHash(), block.GetHash());
+    EXPECT_EQ(cmpctblock2.nonce, cmpctblock.nonce);
+    EXPECT_EQ(cmpctblock2.shorttxids, cmpctblock.shorttxids);
+    ASSERT_EQ(cmpctblock2.prefilledtxn.size(), 1u);
+    EXPECT_EQ(cmpctblock2.prefilledtxn[0].index, 0u);
+    EXPECT_EQ(cmpctblock2.prefilledtxn[0].tx.GetHash(), block.vtx[0].GetHash());
+    // short id key is restored from the header and nonce
+    for (size_t i = 1; i < block.vtx.size(); ++i)
+        EXPECT_EQ(cmpctblock2.GetShortID(block.vtx[i].GetHash()), cmpctblock.shorttxids[i - 1]);
+
+    // indexes are differentially encoded
+    CBlockTransactionsRequest req;
+    req.blockhash = block.GetHash();
+    req.indexes = { 1, 2, 5, 300 };
+    const auto req2 = SerializeRoundTrip(req);
+    EXPECT_EQ(req2.blockhash, req.blockhash);
+    EXPECT_EQ(req2.indexes, req.indexes);
+}
+
+TEST_F(TestCompactBlock, prefilled_indexes)
+{
+    const CBlock block = CreateBlock(5);
+    CBlockHeaderAndShortTxIDs cmpctblock(block);
+    // prefill coinbase and transactions #3 and #5
+    cmpctblock.prefilledtxn.push_back({ 3, block.vtx[3] });
+    cmpctblock.prefilledtxn.push_back({ 5, block.vtx[5] });
+
+    // differential encoding does not modify the serialized object
+    const auto cmpctblock2 = SerializeRoundTrip(cmpctblock);
+    ASSERT_EQ(cmpctblock.prefilledtxn.size(), 3u);
+    EXPECT_EQ(cmpctblock.prefilledtxn[1].index, 3u);
+    EXPECT_EQ(cmpctblock.prefilledtxn[2].index, 5u);
+    ASSERT_EQ(cmpctblock2.prefilledtxn.size(), 3u);
+    for (size_t i = 0; i < cmpctblock.prefilledtxn.size(); ++i)
+    {
+        EXPECT_EQ(cmpctblock2.prefilledtxn[i].index, cmpctblock.prefilledtxn[i].index);
+        EXPECT_EQ(cmpctblock2.prefilledtxn[i].tx.GetHash(), cmpctblock.prefilledtxn[i].tx.GetHash());
+    }
+
+    // prefilled transaction indexes should be in ascending order
+    swap(cmpctblock.prefilledtxn[1], cmpctblock.prefilledtxn[2]);
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    EXPECT_THROW(ss << cmpctblock, ios_base::failure);
+}
+
+TEST_F(TestCompactBlock, reconstruct_from_mempool)
+{
+    const CBlock block = CreateBlock(5);
+    const CBlockHeaderAndShortTxIDs cmpctblock(block);
+
+    CTxMemPool pool(CFeeRate(0));
+    TestMemPoolEntryHelper entry;
+    for (size_t i = 1; i < block.vtx.size(); ++i)
+        pool.addUnchecked(block.vtx[i].GetHash(), entry.FromTx(CMutableTransaction(block.vtx[i])));
+    // transaction not in the block
+    const CTransaction txOther = CreateTransaction(100);
+    pool.addUnchecked(txOther.GetHash(), entry.FromTx(CMutableTransaction(txOther)));
+
+    CPartialCompactBlock partialBlock;
+    ASSERT_EQ(partialBlock.InitData(cmpctblock, pool), CompactBlockStatus::OK);
+    EXPECT_EQ(partialBlock.GetPrefilledCount(), 1u);
+    EXPECT_EQ(partialBlock.GetMempoolCount(), block.vtx.size() - 1);
+    EXPECT_TRUE(partialBlock.GetMissingTxIndexes().empty());
+
+    CBlock block2;
+    ASSERT_EQ(partialBlock.FillBlock(block2, {}), CompactBlockStatus::OK);
+    EXPECT_EQ(block2.GetHash(), block.GetHash());
+    ASSERT_EQ(block2.vtx.size(), block.vtx.size());
+    for (size_t i = 0; i < block.vtx.size(); ++i)
+        EXPECT_EQ(block2.vtx[i].GetHash(), block.vtx[i].GetHash());
+}
+
+TEST_F(TestCompactBlock, missing_transactions)
+{
+    const CBlock block = CreateBlock(5);
+    const auto cmpctblock = SerializeRoundTrip(CBlockHeaderAndShortTxIDs(block));
+
+    // transactions 2 and 4 are not in the mempool
+    CTxMemPool pool(CFeeRate(0));
+    TestMemPoolEntryHelper entry;
+    for (const size_t i : { 1, 3, 5 })
+        pool.addUnchecked(block.vtx[i].GetHash(), entry.FromTx(CMutableTransaction(block.vtx[i])));
+
+    CPartialCompactBlock partialBlock;
+    ASSERT_EQ(partialBlock.InitData(cmpctblock, pool), CompactBlockStatus::OK);
+    EXPECT_EQ(partialBlock.GetMempoolCount(), 3u);
+    const auto vMissing = partialBlock.GetMissingTxIndexes();
+    ASSERT_EQ(vMissing, vector<uint16_t>({ 2, 4 }));
+
+    CBlockTransactionsRequest req;
+    req.blockhash = block.GetHash();
+    req.indexes = vMissing;
+    CBlockTransactions resp(req);
+    for (size_t i = 0; i < req.indexes.size(); ++i)
+        resp.txn[i] = block.vtx[req.indexes[i]];
+    resp = SerializeRoundTrip(resp);
+
+    CBlock block2;
+    // wrong number of the missing transactions
+    EXPECT_EQ(partialBlock.FillBlock(block2, { resp.txn[0] }), CompactBlockStatus::INVALID);
+    // wrong transactions - merkle root mismatch
+    EXPECT_EQ(partialBlock.FillBlock(block2, { resp.txn[1], resp.txn[0] }), CompactBlockStatus::FAILED);
+    ASSERT_EQ(partialBlock.FillBlock(block2, resp.txn), CompactBlockStatus::OK);
+    EXPECT_EQ(block2.GetHash(), block.GetHash());
+    EXPECT_EQ(block2.BuildMerkleTree(), block.hashMerkleRoot);
+}
+
+TEST_F(TestCompactBlock, invalid)
+{
+    const CBlock block = CreateBlock(2);
+    CTxMemPool pool(CFeeRate(0));
+
+    // prefilled transaction index out of range
+    CBlockHeaderAndShortTxIDs cmpctblock(block);
+    cmpctblock.prefilledtxn[0].index = static_cast<uint16_t>(cmpctblock.BlockTxCount());
+    CPartialCompactBlock partialBlock;
+    EXPECT_EQ(partialBlock.InitData(cmpctblock, pool), CompactBlockStatus::INVALID);
+
+    // duplicate short ids can't be resolved
+    CBlockHeaderAndShortTxIDs cmpctblock2(block);
+    cmpctblock2.shorttxids[1] = cmpctblock2.shorttxids[0];
+    EXPECT_EQ(partialBlock.InitData(cmpctblock2, pool), CompactBlockStatus::FAILED);
+}
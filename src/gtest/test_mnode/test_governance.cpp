@@ -11,8 +11,11 @@
 #include <key_io.h>
 #include <chain.h>
 #include <chainparams.h>
+#include <clientversion.h>
 #include <mnode/mnode-governance.h>
 
+#include <pastel_gtest_utils.h>
+
 #ifdef GOVERNANCE_TICKETS
 TEST(mnode_governance, CalculateLastPaymentBlock)
 {
@@ -143,4 +146,80 @@ TEST(mnode_governance, TicketProcessing)
     EXPECT_EQ(false, res);
 }
 
+TEST(mnode_governance, VoteTally)
+{
+    CGovernanceTicket ticket(CScript(), 1250000000, "ticket", 1001);
+    ticket.ticketId = ticket.GetHash();
+
+    std::string error;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        CGovernanceVote vote(COutPoint(generateRandomUint256(), i), ticket.ticketId, 1000, i != 1);
+        // signed votes are not re-signed by AddVote
+        vote.vchSig = { static_cast<uint8_t>(i + 1) };
+        EXPECT_TRUE(ticket.AddVote(vote, error));
+        EXPECT_TRUE(ticket.HasVoted(vote.vinMasternode.prevout));
+        // masternode can vote only once
+        EXPECT_FALSE(ticket.AddVote(vote, error));
+    }
+    EXPECT_EQ(ticket.GetVoteCount(), 3u);
+    EXPECT_EQ(ticket.nYesVotes, 2);
+    EXPECT_EQ(ticket.nNoVotes, 1);
+
+    // tallies are persisted on disk
+    CDataStream ssDisk(SER_DISK, CLIENT_VERSION);
+    ssDisk << ticket;
+    CGovernanceTicket ticketLoaded;
+    ssDisk >> ticketLoaded;
+    EXPECT_EQ(ticketLoaded.GetVoteCount(), 3u);
+    EXPECT_EQ(ticketLoaded.nYesVotes, 2);
+    EXPECT_EQ(ticketLoaded.nNoVotes, 1);
+
+    // and recalculated for the ticket received from the network
+    ticket.nYesVotes = 100;
+    CDataStream ssNet(SER_NETWORK, PROTOCOL_VERSION);
+    ssNet << ticket;
+    CGovernanceTicket ticketReceived;
+    ssNet >> ticketReceived;
+    EXPECT_EQ(ticketReceived.GetVoteCount(), 3u);
+    EXPECT_EQ(ticketReceived.nYesVotes, 2);
+    EXPECT_EQ(ticketReceived.nNoVotes, 1);
+}
+
+TEST(mnode_governance, CacheVersion)
+{
+    CGovernanceTicket ticket(CScript(), 1250000000, "ticket", 1001);
+    ticket.ticketId = ticket.GetHash();
+    std::string error;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        CGovernanceVote vote(COutPoint(generateRandomUint256(), i), ticket.ticketId, 1000, i != 1);
+        vote.vchSig = { static_cast<uint8_t>(i + 1) };
+        EXPECT_TRUE(ticket.AddVote(vote, error));
+    }
+
+    CMasternodeGovernance governance;
+    governance.mapTickets.emplace(ticket.ticketId, ticket);
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << governance;
+    CMasternodeGovernance governanceLoaded;
+    ss >> governanceLoaded;
+    EXPECT_TRUE(ss.empty());
+    ASSERT_EQ(governanceLoaded.mapTickets.size(), 1u);
+    EXPECT_EQ(governanceLoaded.mapTickets[ticket.ticketId].nYesVotes, 2);
+    EXPECT_EQ(governanceLoaded.mapTickets[ticket.ticketId].nNoVotes, 1);
+
+    // governance.dat without version string and persisted tallies
+    CDataStream ssTickets(SER_NETWORK, CLIENT_VERSION);
+    ssTickets << governance.mapTickets << governance.mapPayments << governance.mapVotes;
+    CDataStream ssLegacy(ssTickets.begin(), ssTickets.end(), SER_DISK, CLIENT_VERSION);
+    CMasternodeGovernance governanceLegacy;
+    ssLegacy >> governanceLegacy;
+    EXPECT_TRUE(ssLegacy.empty());
+    ASSERT_EQ(governanceLegacy.mapTickets.size(), 1u);
+    EXPECT_EQ(governanceLegacy.mapTickets[ticket.ticketId].GetVoteCount(), 3u);
+    EXPECT_EQ(governanceLegacy.mapTickets[ticket.ticketId].nYesVotes, 2);
+    EXPECT_EQ(governanceLegacy.mapTickets[ticket.ticketId].nNoVotes, 1);
+}
+
 #endif // GOVERNANCE_TICKETS
@@ -1,13 +1,19 @@
 // Copyright (c) 2023-2024 The Pastel Core developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <cstdio>
+#include <iostream>
 #include <gtest/gtest.h>
 
 #include <extlibs/scope_guard.hpp>
+#include <utils/timer.h>
 #include <mnode/mnode-db.h>
 #include <mnode/mnode-consts.h>
 #include <mnode/mnode-payments.h>
 #include <mnode/mnode-manager.h>
+#include <mnode/mnode-validation.h>
+#include <mnode/mnode-messageproc.h>
+#include <mnode/mnode-controller.h>
 
 #include <pastel_gtest_main.h>
 #include <pastel_gtest_utils.h>
@@ -15,6 +21,25 @@
 using namespace std;
 using namespace testing;
 
+static masternode_info_t generateTestMasternodeInfo(const int i, const time_t nNow)
+{
+    v_uint8 v1, v2;
+    generateRandomData(v1, CPubKey::PUBLIC_KEY_SIZE);
+    generateRandomData(v2, CPubKey::PUBLIC_KEY_SIZE);
+    CPubKey pkCollAddr(v1);
+    CPubKey pkMN(v2);
+
+    MASTERNODE_STATE state = static_cast<MASTERNODE_STATE>(i % to_integral_type(MASTERNODE_STATE::COUNT));
+    return masternode_info_t(
+        state, PROTOCOL_VERSION,
+        nNow - i * 60,
+        COutPoint(generateRandomUint256(), i),
+        CService("127.0.0.1", i * 60 + 1),
+        pkCollAddr, pkMN,
+        "extAddress" + to_string(i), "extP2P" + to_string(i), "extCfg" + to_string(i),
+        nNow + i * 60, i % 2 == 0);
+}
+
 class TestMNodeCache : public Test
 {
 public:
@@ -54,12 +79,154 @@ TEST_F(TestMNodeCache, payments)
     CMasternodePayments mnPaymentsLoaded;
     EXPECT_TRUE(flatDB.Load(mnPaymentsLoaded));
     EXPECT_EQ(mnPaymentsLoaded.mapMasternodePaymentVotes.size(), 2);
+    // votes are bucketed by block height on load
+    EXPECT_EQ(mnPaymentsLoaded.GetVoteHeightCount(), 2u);
     EXPECT_EQ(mnPaymentsLoaded.mapMasternodeBlockPayees.size(), 1);
     EXPECT_EQ(mnPaymentsLoaded.mapMasternodeBlockPayees[10].vecPayees.size(), 2);
     EXPECT_EQ(mnPaymentsLoaded.mapMasternodeBlockPayees[10].vecPayees[0].GetVoteCount(), 1);
     EXPECT_EQ(mnPaymentsLoaded.mapMasternodeBlockPayees[10].vecPayees[1].GetVoteCount(), 1);
 }
 
+class TestMasternodePayments : public CMasternodePayments
+{
+public:
+    void SetCachedBlockHeight(const int nHeight) noexcept { nCachedBlockHeight = nHeight; }
+    using CMasternodePayments::RebuildVoteHeightIndex;
+};
+
+TEST_F(TestMNodeCache, payments_check_and_remove)
+{
+    TestMasternodePayments mnPayments;
+    const int nStorageLimit = mnPayments.GetStorageLimit();
+    constexpr int TEST_CACHED_HEIGHT = 10'000;
+    const int nMinBlockHeight = TEST_CACHED_HEIGHT - nStorageLimit;
+    ASSERT_GT(nMinBlockHeight, 2);
+
+    // two votes per height: expired heights are below nMinBlockHeight
+    const vector<int> vHeights = { 1, nMinBlockHeight - 1, nMinBlockHeight, TEST_CACHED_HEIGHT };
+    for (const int nHeight : vHeights)
+    {
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            CMasternodePaymentVote vote(COutPoint(generateRandomUint256(), i), nHeight, CScript());
+            mnPayments.mapMasternodePaymentVotes[vote.GetHash()] = vote;
+        }
+        mnPayments.mapMasternodeBlockPayees.emplace(nHeight, CMasternodeBlockPayees(nHeight));
+    }
+    mnPayments.RebuildVoteHeightIndex();
+    EXPECT_EQ(mnPayments.GetVoteCount(), 8u);
+    EXPECT_EQ(mnPayments.GetVoteHeightCount(), 4u);
+
+    const COutPoint outOld(generateRandomUint256(), 0);
+    const COutPoint outNew(generateRandomUint256(), 1);
+    EXPECT_TRUE(mnPayments.CanVote(outOld, nMinBlockHeight - 1));
+    EXPECT_TRUE(mnPayments.CanVote(outNew, nMinBlockHeight));
+
+    // blockchain should be synced to clean up the cache
+    auto& mnSync = masterNodeCtrl.masternodeSync;
+    auto guard = sg::make_scope_guard([&]() noexcept { mnSync.Reset(); });
+    mnSync.Reset();
+    mnSync.SwitchToNextAsset();
+    mnSync.SwitchToNextAsset();
+    ASSERT_TRUE(mnSync.IsBlockchainSynced());
+
+    mnPayments.SetCachedBlockHeight(TEST_CACHED_HEIGHT);
+    mnPayments.CheckAndRemove();
+    EXPECT_EQ(mnPayments.GetVoteCount(), 4u);
+    EXPECT_EQ(mnPayments.GetVoteHeightCount(), 2u);
+    for (const auto& [hash, vote] : mnPayments.mapMasternodePaymentVotes)
+        EXPECT_GE(vote.nBlockHeight, nMinBlockHeight);
+    EXPECT_EQ(mnPayments.GetBlockCount(), 2u);
+    EXPECT_EQ(mnPayments.mapMasternodeBlockPayees.cbegin()->first, nMinBlockHeight);
+    EXPECT_EQ(mnPayments.mapMasternodesLastVote.size(), 1u);
+    EXPECT_EQ(mnPayments.mapMasternodesLastVote.count(outNew), 1u);
+    // expired last vote does not block the new vote
+    EXPECT_TRUE(mnPayments.CanVote(outOld, nMinBlockHeight - 1));
+}
+
+TEST_F(TestMNodeCache, collateral_cache)
+{
+    CMasternodeCollateralCache cache;
+    cache.SetCollateralAmount(5'000'000 * COIN);
+    const COutPoint outpoint1(generateRandomUint256(), 1);
+    const COutPoint outpoint2(generateRandomUint256(), 0);
+    const COutPoint outpoint3(generateRandomUint256(), 2);
+    cache.Add(outpoint1, 5'000'000 * COIN, 100);
+    cache.Add(outpoint2, 5'000'000 * COIN, 110);
+    cache.Add(outpoint3, 5'000'000 * COIN, 120);
+    EXPECT_EQ(cache.size(), 3u);
+
+    CAmount nValue = 0;
+    int nHeight = 0;
+    EXPECT_TRUE(cache.GetCoin(outpoint2, nValue, nHeight));
+    EXPECT_EQ(nValue, 5'000'000 * COIN);
+    EXPECT_EQ(nHeight, 110);
+
+    // connected block spends outpoint1
+    CMutableTransaction mtxSpend;
+    mtxSpend.vin.emplace_back(outpoint1);
+    CBlock block;
+    block.vtx.emplace_back(mtxSpend);
+    cache.ChainTip(&block, true);
+    EXPECT_FALSE(cache.IsCached(outpoint1));
+    EXPECT_EQ(cache.size(), 2u);
+
+    // disconnected block created outpoint3
+    CMutableTransaction mtxCreate;
+    mtxCreate.vout.resize(3);
+    const CTransaction txCreate(mtxCreate);
+    cache.Add(COutPoint(txCreate.GetHash(), 0), 5'000'000 * COIN, 130);
+    cache.Add(COutPoint(txCreate.GetHash(), 2), 5'000'000 * COIN, 130);
+    EXPECT_EQ(cache.size(), 4u);
+    CBlock blockDisconnected;
+    blockDisconnected.vtx.push_back(txCreate);
+    cache.ChainTip(&blockDisconnected, false);
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_TRUE(cache.IsCached(outpoint2));
+    EXPECT_TRUE(cache.IsCached(outpoint3));
+}
+
+TEST_F(TestMNodeCache, collateral_cache_limits)
+{
+    constexpr size_t TEST_MAX_CACHE_SIZE = 3;
+    constexpr CAmount TEST_COLLATERAL = 1000 * COIN;
+    CMasternodeCollateralCache cache(TEST_MAX_CACHE_SIZE);
+    cache.SetCollateralAmount(TEST_COLLATERAL);
+
+    // only coins with the collateral amount are cached
+    const COutPoint outpointOther(generateRandomUint256(), 0);
+    EXPECT_FALSE(cache.Add(outpointOther, TEST_COLLATERAL + 1, 100));
+    EXPECT_FALSE(cache.IsCached(outpointOther));
+
+    // cache size is limited
+    vector<COutPoint> vOutpoints;
+    for (uint32_t i = 0; i < TEST_MAX_CACHE_SIZE; ++i)
+    {
+        vOutpoints.emplace_back(generateRandomUint256(), i);
+        EXPECT_TRUE(cache.Add(vOutpoints.back(), TEST_COLLATERAL, 100 + i));
+    }
+    const COutPoint outpointExtra(generateRandomUint256(), 0);
+    EXPECT_FALSE(cache.Add(outpointExtra, TEST_COLLATERAL, 200));
+    EXPECT_EQ(cache.size(), TEST_MAX_CACHE_SIZE);
+    // cached entry can be updated in the full cache
+    EXPECT_TRUE(cache.Add(vOutpoints[0], TEST_COLLATERAL, 150));
+
+    // collaterals not used by the masternodes are removed
+    sort(vOutpoints.begin(), vOutpoints.end());
+    const COutPoint outpointRemoved = vOutpoints[1];
+    vOutpoints.erase(vOutpoints.begin() + 1);
+    cache.Retain(vOutpoints);
+    EXPECT_EQ(cache.size(), TEST_MAX_CACHE_SIZE - 1);
+    EXPECT_FALSE(cache.IsCached(outpointRemoved));
+    for (const auto& outpoint : vOutpoints)
+        EXPECT_TRUE(cache.IsCached(outpoint));
+    EXPECT_TRUE(cache.Add(outpointExtra, TEST_COLLATERAL, 200));
+
+    // collateral amount change invalidates the cache
+    cache.SetCollateralAmount(TEST_COLLATERAL * 2);
+    EXPECT_EQ(cache.size(), 0u);
+}
+
 TEST_F(TestMNodeCache, mnode_manager)
 {
     CMasternodeMan mnMgr;
@@ -70,24 +237,9 @@ TEST_F(TestMNodeCache, mnode_manager)
     size_t nEnabledCount = 0;
     for (int i = 0; i < 100; ++i)
     {
-        v_uint8 v1, v2;
-        generateRandomData(v1, CPubKey::PUBLIC_KEY_SIZE);
-        generateRandomData(v2, CPubKey::PUBLIC_KEY_SIZE);
-        CPubKey pkCollAddr(v1);
-        CPubKey pkMN(v2);
-
-        MASTERNODE_STATE state = static_cast<MASTERNODE_STATE>(i % to_integral_type(MASTERNODE_STATE::COUNT));
-        if (state == MASTERNODE_STATE::ENABLED)
+        masternode_info_t mnInfo = generateTestMasternodeInfo(i, nNow);
+        if (mnInfo.GetActiveState() == MASTERNODE_STATE::ENABLED)
             ++nEnabledCount;
-        masternode_info_t mnInfo(
-            state, PROTOCOL_VERSION,
-            nNow - i * 60,
-            COutPoint(generateRandomUint256(), i),
-            CService("127.0.0.1", i * 60 + 1),
-            pkCollAddr, pkMN,
-            "extAddress" + to_string(i), "extP2P" + to_string(i), "extCfg" + to_string(i),
-            nNow + i * 60, i % 2 == 0);
-
         vTestMN.push_back(mnInfo);
         masternode_t pmn = make_shared<CMasternode>();
         pmn->SetMasternodeInfo(mnInfo);
@@ -117,4 +269,410 @@ TEST_F(TestMNodeCache, mnode_manager)
         EXPECT_EQ(pmn->nTimeLastWatchdogVote, mnInfo.nTimeLastWatchdogVote);
         EXPECT_EQ(pmn->IsEligibleForMining(), mnInfo.IsEligibleForMining());
     }
-}
\ No newline at end of file
+}
+TEST_F(TestMNodeCache, mnode_manager_snapshot)
+{
+    CMasternodeMan mnMgr;
+    const time_t nNow = time(nullptr);
+
+    masternode_t pmn1 = make_shared<CMasternode>();
+    pmn1->SetMasternodeInfo(generateTestMasternodeInfo(1, nNow));
+    EXPECT_TRUE(mnMgr.Add(pmn1));
+    const auto pSnapshot1 = mnMgr.GetMasternodeSnapshot();
+    ASSERT_TRUE(pSnapshot1);
+    EXPECT_EQ(pSnapshot1->size(), 1u);
+    // snapshot is shared by the readers until the list is changed
+    EXPECT_EQ(mnMgr.GetMasternodeSnapshot(), pSnapshot1);
+    EXPECT_TRUE(mnMgr.Has(pmn1->getOutPoint()));
+    EXPECT_EQ(mnMgr.Get(USE_LOCK, pmn1->getOutPoint()), pmn1);
+
+    masternode_t pmn2 = make_shared<CMasternode>();
+    pmn2->SetMasternodeInfo(generateTestMasternodeInfo(2, nNow));
+    EXPECT_TRUE(mnMgr.Add(pmn2));
+    EXPECT_FALSE(mnMgr.Add(pmn2));
+    const auto pSnapshot2 = mnMgr.GetMasternodeSnapshot();
+    EXPECT_NE(pSnapshot2, pSnapshot1);
+    EXPECT_EQ(pSnapshot2->size(), 2u);
+    // old snapshot is not changed
+    EXPECT_EQ(pSnapshot1->size(), 1u);
+
+    masternode_info_t mnInfo;
+    EXPECT_TRUE(mnMgr.GetMasternodeInfo(USE_LOCK, pmn2->getOutPoint(), mnInfo));
+    EXPECT_EQ(mnInfo.getOutPoint(), pmn2->getOutPoint());
+    size_t nCount = 0;
+    mnMgr.ForEachMasternode<size_t>(nCount, [](size_t& nCount, const masternode_info_t&) { ++nCount; });
+    EXPECT_EQ(nCount, 2u);
+
+    mnMgr.Clear();
+    EXPECT_FALSE(mnMgr.Has(pmn1->getOutPoint()));
+    EXPECT_TRUE(mnMgr.GetMasternodeSnapshot()->empty());
+    EXPECT_EQ(pSnapshot2->size(), 2u);
+}
+
+TEST_F(TestMNodeCache, mnode_list_digest)
+{
+    CMasternodeMan mnMgr, mnMgrPeer;
+    const time_t nNow = time(nullptr);
+    size_t nSendableCount = 0;
+    masternode_t pmnUpdateRequired;
+    for (int i = 0; i < 10; ++i)
+    {
+        const masternode_info_t mnInfo = generateTestMasternodeInfo(i, nNow);
+        masternode_t pmn = make_shared<CMasternode>();
+        pmn->SetMasternodeInfo(mnInfo);
+        EXPECT_TRUE(mnMgr.Add(pmn));
+        masternode_t pmnPeer = make_shared<CMasternode>();
+        pmnPeer->SetMasternodeInfo(mnInfo);
+        EXPECT_TRUE(mnMgrPeer.Add(pmnPeer));
+        if (pmn->IsUpdateRequired())
+            pmnUpdateRequired = pmn;
+        else
+            ++nSendableCount;
+    }
+    ASSERT_TRUE(pmnUpdateRequired);
+    // same lists have the same digest,
+    // entries that are not sent on the list request (outdated masternodes) are not included
+    const auto digest = mnMgr.GetListDigest();
+    EXPECT_EQ(digest.vShortIds.size(), nSendableCount * 2);
+    EXPECT_FALSE(digest.Contains(CMasternodeListDigest::GetShortId(CMasternodeBroadcast(*pmnUpdateRequired).GetHash())));
+    EXPECT_TRUE(is_sorted(digest.vShortIds.cbegin(), digest.vShortIds.cend()));
+    EXPECT_EQ(digest.hashList, mnMgrPeer.GetListDigest().hashList);
+
+    // digest survives serialization
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << digest;
+    CMasternodeListDigest digestLoaded;
+    ss >> digestLoaded;
+    EXPECT_EQ(digestLoaded.hashList, digest.hashList);
+    EXPECT_EQ(digestLoaded.vShortIds, digest.vShortIds);
+
+    // new masternode is detected by its short ids
+    masternode_t pmnNew = make_shared<CMasternode>();
+    pmnNew->SetMasternodeInfo(generateTestMasternodeInfo(10, nNow));
+    EXPECT_TRUE(mnMgrPeer.Add(pmnNew));
+    const auto digestPeer = mnMgrPeer.GetListDigest();
+    EXPECT_NE(digestPeer.hashList, digest.hashList);
+    EXPECT_FALSE(digest.Contains(CMasternodeListDigest::GetShortId(CMasternodeBroadcast(*pmnNew).GetHash())));
+    EXPECT_TRUE(digestPeer.Contains(CMasternodeListDigest::GetShortId(CMasternodeBroadcast(*pmnNew).GetHash())));
+}
+
+TEST_F(TestMNodeCache, messages)
+{
+    CMasternodeMessageProcessor msgProc(5, 3);
+    const int64_t nNow = GetTime();
+    const COutPoint outpointFrom(generateRandomUint256(), 0);
+    const COutPoint outpointTo1(generateRandomUint256(), 1);
+    const COutPoint outpointTo2(generateRandomUint256(), 2);
+
+    v_uint256 vMessageIds;
+    for (int i = 0; i < 8; ++i)
+    {
+        CMasternodeMessage message(outpointFrom, (i % 2) ? outpointTo2 : outpointTo1, CMasternodeMessageType::PLAINTEXT, strprintf("message %d", i));
+        message.sigTime = nNow + i;
+        vMessageIds.push_back(message.GetHash());
+        msgProc.AddSeenMessage(vMessageIds.back(), message);
+        if (i == 4)
+        {
+            // recently used message is not evicted
+            CMasternodeMessage msg;
+            EXPECT_TRUE(msgProc.GetSeenMessage(vMessageIds[0], msg));
+        }
+        if (i < 4)
+            msgProc.AddOurMessage(vMessageIds.back(), message);
+    }
+    // least recently used messages are evicted
+    EXPECT_EQ(msgProc.Size(), 5u);
+    EXPECT_FALSE(msgProc.HasSeenMessage(vMessageIds[1]));
+    EXPECT_FALSE(msgProc.HasSeenMessage(vMessageIds[2]));
+    EXPECT_FALSE(msgProc.HasSeenMessage(vMessageIds[3]));
+    EXPECT_TRUE(msgProc.HasSeenMessage(vMessageIds[7]));
+    EXPECT_EQ(msgProc.SizeOur(), 3u);
+
+    // messages by recipient are ordered by message time
+    v_uint256 vMessagesTo;
+    const auto fnCollect = [&](const uint256& messageId, const CMasternodeMessage&) { vMessagesTo.push_back(messageId); };
+    EXPECT_EQ(msgProc.ForEachMessageTo(outpointTo1, 0, 0, fnCollect), 3u);
+    EXPECT_EQ(vMessagesTo, v_uint256({ vMessageIds[0], vMessageIds[4], vMessageIds[6] }));
+    vMessagesTo.clear();
+    EXPECT_EQ(msgProc.ForEachMessageTo(outpointTo2, 1, 1, fnCollect), 2u);
+    EXPECT_EQ(vMessagesTo, v_uint256({ vMessageIds[7] }));
+    vMessagesTo.clear();
+    EXPECT_EQ(msgProc.ForEachOurMessage(0, 0, fnCollect), 3u);
+    EXPECT_EQ(vMessagesTo, v_uint256({ vMessageIds[1], vMessageIds[2], vMessageIds[3] }));
+
+    // indexes are rebuilt on load
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << msgProc;
+    CMasternodeMessageProcessor msgProcLoaded;
+    ss >> msgProcLoaded;
+    EXPECT_EQ(msgProcLoaded.Size(), 5u);
+    EXPECT_EQ(msgProcLoaded.ForEachMessageTo(outpointTo1, 0, 0, [](const uint256&, const CMasternodeMessage&) {}), 3u);
+
+    // expired messages are removed
+    msgProc.EnforceLimits(nNow + MN_MESSAGES_SEEN_EXPIRATION_SECS + 100);
+    EXPECT_EQ(msgProc.Size(), 0u);
+    EXPECT_EQ(msgProc.ForEachMessageTo(outpointTo1, 0, 0, fnCollect), 0u);
+    EXPECT_EQ(msgProc.SizeOur(), 3u);
+    msgProc.EnforceLimits(nNow + MN_MESSAGES_OUR_EXPIRATION_SECS + 100);
+    EXPECT_EQ(msgProc.SizeOur(), 0u);
+}
+
+TEST_F(TestMNodeCache, messages_replay)
+{
+    CMasternodeMessageProcessor msgProc;
+    const int64_t nNow = GetTime();
+    CMasternodeMessage message(COutPoint(generateRandomUint256(), 0), COutPoint(generateRandomUint256(), 1),
+        CMasternodeMessageType::PLAINTEXT, "message");
+    message.sigTime = nNow;
+    const uint256 messageId = message.GetHash();
+    EXPECT_TRUE(CMasternodeMessageProcessor::IsMessageTimeValid(message.sigTime, nNow));
+    msgProc.AddSeenMessage(messageId, message);
+
+    // message is removed from the seen messages after expiration time...
+    const int64_t nExpiredTime = nNow + MN_MESSAGES_SEEN_EXPIRATION_SECS + 100;
+    msgProc.EnforceLimits(nExpiredTime);
+    EXPECT_FALSE(msgProc.HasSeenMessage(messageId));
+    // ... and can't be replayed
+    EXPECT_FALSE(CMasternodeMessageProcessor::IsMessageTimeValid(message.sigTime, nExpiredTime));
+
+    // messages from the future are not accepted
+    EXPECT_TRUE(CMasternodeMessageProcessor::IsMessageTimeValid(nNow + MN_MESSAGES_MAX_FUTURE_SECS, nNow));
+    EXPECT_FALSE(CMasternodeMessageProcessor::IsMessageTimeValid(nNow + MN_MESSAGES_MAX_FUTURE_SECS + 1, nNow));
+}
+
+TEST_F(TestMNodeCache, journal_payments)
+{
+    constexpr auto TEST_CACHE_FILENAME = "mnpayments-journal.dat";
+    CMasternodePayments mnPayments;
+    for (int i = 0; i < 10; ++i)
+    {
+        CMasternodePaymentVote vote(COutPoint(generateRandomUint256(), i), 100 + i, CScript());
+        mnPayments.mapMasternodePaymentVotes[vote.GetHash()] = vote;
+    }
+
+    CJournaledFlatDB<CMasternodePayments> flatDB(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+    // no journal yet - full snapshot is written
+    EXPECT_TRUE(flatDB.Dump(mnPayments));
+    const auto nSnapshotSize = flatDB.getSnapshotSize();
+    const auto nJournalHeaderSize = flatDB.getJournalSize();
+    EXPECT_GT(nSnapshotSize, 0u);
+    EXPECT_EQ(nJournalHeaderSize, fs::file_size(flatDB.getJournalPath()));
+
+    // no changes - nothing is appended
+    EXPECT_TRUE(flatDB.Dump(mnPayments));
+    EXPECT_EQ(flatDB.getJournalSize(), nJournalHeaderSize);
+
+    // erase one vote, add new vote and block payees
+    mnPayments.mapMasternodePaymentVotes.erase(mnPayments.mapMasternodePaymentVotes.begin());
+    CMasternodePaymentVote vote(COutPoint(generateRandomUint256(), 20), 120, CScript());
+    mnPayments.mapMasternodePaymentVotes[vote.GetHash()] = vote;
+    CMasternodeBlockPayees mnBlockPayees(10);
+    mnBlockPayees.vecPayees.emplace_back(CScript(), generateRandomUint256());
+    mnPayments.mapMasternodeBlockPayees[10] = mnBlockPayees;
+    EXPECT_TRUE(flatDB.Dump(mnPayments));
+    EXPECT_EQ(flatDB.getSnapshotSize(), nSnapshotSize);
+    EXPECT_GT(flatDB.getJournalSize(), nJournalHeaderSize);
+
+    auto checkLoaded = [&](const CMasternodePayments& mnPaymentsLoaded)
+    {
+        EXPECT_EQ(mnPaymentsLoaded.mapMasternodePaymentVotes.size(), mnPayments.mapMasternodePaymentVotes.size());
+        for (const auto& [hash, v] : mnPayments.mapMasternodePaymentVotes)
+            EXPECT_EQ(mnPaymentsLoaded.mapMasternodePaymentVotes.count(hash), 1u);
+        ASSERT_EQ(mnPaymentsLoaded.mapMasternodeBlockPayees.size(), 1u);
+        EXPECT_EQ(mnPaymentsLoaded.mapMasternodeBlockPayees.at(10).vecPayees.size(), 1u);
+    };
+
+    // snapshot + journal replay
+    {
+        CMasternodePayments mnPaymentsLoaded;
+        CJournaledFlatDB<CMasternodePayments> flatDBLoad(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+        EXPECT_TRUE(flatDBLoad.Load(mnPaymentsLoaded));
+        checkLoaded(mnPaymentsLoaded);
+        EXPECT_EQ(flatDBLoad.getJournalSize(), flatDB.getJournalSize());
+    }
+
+    // simulate append interrupted by crash - incomplete frame is discarded
+    {
+        FILE* file = fopen(flatDB.getJournalPath().c_str(), "ab");
+        ASSERT_NE(file, nullptr);
+        const uint32_t nFrameSize = 1000;
+        fwrite(&nFrameSize, sizeof(nFrameSize), 1, file);
+        fwrite("abc", 1, 3, file);
+        fclose(file);
+
+        CMasternodePayments mnPaymentsLoaded;
+        CJournaledFlatDB<CMasternodePayments> flatDBLoad(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+        EXPECT_TRUE(flatDBLoad.Load(mnPaymentsLoaded));
+        checkLoaded(mnPaymentsLoaded);
+        EXPECT_EQ(flatDBLoad.getJournalSize(), flatDB.getJournalSize());
+        EXPECT_EQ(fs::file_size(flatDB.getJournalPath()), flatDB.getJournalSize());
+    }
+
+    // fully consumed journal is not truncated on load - reload twice
+    for (int i = 0; i < 2; ++i)
+    {
+        CMasternodePayments mnPaymentsLoaded;
+        CJournaledFlatDB<CMasternodePayments> flatDBLoad(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+        EXPECT_TRUE(flatDBLoad.Load(mnPaymentsLoaded));
+        checkLoaded(mnPaymentsLoaded);
+        EXPECT_EQ(flatDBLoad.getJournalSize(), flatDB.getJournalSize());
+        EXPECT_EQ(fs::file_size(flatDB.getJournalPath()), flatDB.getJournalSize());
+    }
+
+    // changes are appended to the replayed journal
+    {
+        CJournaledFlatDB<CMasternodePayments> flatDBLoad(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+        CMasternodePayments mnPaymentsLoaded;
+        EXPECT_TRUE(flatDBLoad.Load(mnPaymentsLoaded));
+        CMasternodePaymentVote vote2(COutPoint(generateRandomUint256(), 21), 121, CScript());
+        mnPayments.mapMasternodePaymentVotes[vote2.GetHash()] = vote2;
+        mnPaymentsLoaded.mapMasternodePaymentVotes[vote2.GetHash()] = vote2;
+        EXPECT_TRUE(flatDBLoad.Dump(mnPaymentsLoaded));
+        EXPECT_GT(flatDBLoad.getJournalSize(), flatDB.getJournalSize());
+    }
+    {
+        CMasternodePayments mnPaymentsLoaded;
+        CJournaledFlatDB<CMasternodePayments> flatDBLoad(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+        EXPECT_TRUE(flatDBLoad.Load(mnPaymentsLoaded));
+        checkLoaded(mnPaymentsLoaded);
+    }
+}
+
+TEST_F(TestMNodeCache, journal_legacy_format)
+{
+    constexpr auto TEST_CACHE_FILENAME = "mnpayments-legacy.dat";
+    CMasternodePayments mnPayments;
+    CMasternodePaymentVote vote(COutPoint(generateRandomUint256(), 1), 10, CScript());
+    mnPayments.mapMasternodePaymentVotes[vote.GetHash()] = vote;
+
+    // cache file in the full format is loaded and rewritten as a snapshot
+    CFlatDB<CMasternodePayments> flatDBLegacy(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+    EXPECT_TRUE(flatDBLegacy.Dump(mnPayments, false));
+
+    CMasternodePayments mnPaymentsLoaded;
+    CJournaledFlatDB<CMasternodePayments> flatDB(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+    EXPECT_TRUE(flatDB.Load(mnPaymentsLoaded));
+    EXPECT_EQ(mnPaymentsLoaded.mapMasternodePaymentVotes.size(), 1u);
+    EXPECT_EQ(flatDB.getSnapshotSize(), 0u);
+    EXPECT_TRUE(flatDB.Dump(mnPaymentsLoaded));
+    EXPECT_GT(flatDB.getSnapshotSize(), 0u);
+
+    CMasternodePayments mnPaymentsLoaded2;
+    CJournaledFlatDB<CMasternodePayments> flatDB2(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+    EXPECT_TRUE(flatDB2.Load(mnPaymentsLoaded2));
+    EXPECT_EQ(mnPaymentsLoaded2.mapMasternodePaymentVotes.count(vote.GetHash()), 1u);
+}
+
+class CTestJournaledFlatDB : public CJournaledFlatDB<CMasternodePayments>
+{
+public:
+    CTestJournaledFlatDB(const string &strFilenameIn, const string &strMagicMessageIn) :
+        CJournaledFlatDB<CMasternodePayments>(strFilenameIn, strMagicMessageIn)
+    {}
+
+    bool WriteSnapshot(const CFlatDBSnapshot &snapshot)
+    {
+        return WriteFile(strSnapshotMagicMessage, snapshot) && CommitFile();
+    }
+};
+
+TEST_F(TestMNodeCache, journal_format_version)
+{
+    constexpr auto TEST_CACHE_FILENAME = "mnpayments-version.dat";
+    CMasternodePayments mnPayments;
+    CMasternodePaymentVote vote(COutPoint(generateRandomUint256(), 1), 10, CScript());
+    mnPayments.mapMasternodePaymentVotes[vote.GetHash()] = vote;
+
+    CTestJournaledFlatDB flatDB(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+    EXPECT_TRUE(flatDB.Dump(mnPayments));
+    // snapshot with another format version
+    CFlatDBSnapshot snapshot;
+    mnPayments.GetFlatDBRecords(snapshot.records);
+    snapshot.nVersion = FLATDB_JOURNAL_FORMAT_VERSION + 1;
+    ASSERT_TRUE(flatDB.WriteSnapshot(snapshot));
+    EXPECT_TRUE(fs::exists(flatDB.getJournalPath()));
+
+    // snapshot and journal are discarded, object is not loaded
+    CMasternodePayments mnPaymentsLoaded;
+    CJournaledFlatDB<CMasternodePayments> flatDBLoad(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+    EXPECT_TRUE(flatDBLoad.Load(mnPaymentsLoaded));
+    EXPECT_TRUE(mnPaymentsLoaded.mapMasternodePaymentVotes.empty());
+    EXPECT_FALSE(fs::exists(flatDBLoad.getJournalPath()));
+
+    // full snapshot is written on the next dump
+    EXPECT_TRUE(flatDBLoad.Dump(mnPayments));
+    EXPECT_GT(flatDBLoad.getSnapshotSize(), 0u);
+    CMasternodePayments mnPaymentsLoaded2;
+    CJournaledFlatDB<CMasternodePayments> flatDBLoad2(TEST_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+    EXPECT_TRUE(flatDBLoad2.Load(mnPaymentsLoaded2));
+    EXPECT_EQ(mnPaymentsLoaded2.mapMasternodePaymentVotes.count(vote.GetHash()), 1u);
+}
+
+/**
+ * Compare full cache dump/load with the journaled one.
+ * Run with --gtest_also_run_disabled_tests.
+ */
+TEST_F(TestMNodeCache, DISABLED_journal_benchmark)
+{
+    const time_t nNow = time(nullptr);
+    for (const size_t nCount : { 5'000, 50'000 })
+    {
+        CMasternodeMan mnMgr;
+        vector<COutPoint> vOutpoints;
+        vOutpoints.reserve(nCount);
+        for (size_t i = 0; i < nCount; ++i)
+        {
+            masternode_t pmn = make_shared<CMasternode>();
+            pmn->SetMasternodeInfo(generateTestMasternodeInfo(static_cast<int>(i), nNow));
+            vOutpoints.push_back(pmn->getOutPoint());
+            mnMgr.Add(pmn);
+        }
+        const string sFullFilename = strprintf("mncache-full-%zu.dat", nCount);
+        const string sJournalFilename = strprintf("mncache-journal-%zu.dat", nCount);
+
+        CTimer timer;
+        CFlatDB<CMasternodeMan> flatDBFull(sFullFilename, MNCACHE_CACHE_MAGIC_STR);
+        timer.start();
+        EXPECT_TRUE(flatDBFull.Dump(mnMgr, false));
+        timer.stop();
+        const auto nFullDumpMs = timer.elapsedMilliseconds();
+        {
+            CMasternodeMan mnMgrLoaded;
+            timer.start();
+            EXPECT_TRUE(flatDBFull.Load(mnMgrLoaded));
+            timer.stop();
+        }
+        const auto nFullLoadMs = timer.elapsedMilliseconds();
+
+        CJournaledFlatDB<CMasternodeMan> flatDBJournal(sJournalFilename, MNCACHE_CACHE_MAGIC_STR);
+        timer.start();
+        EXPECT_TRUE(flatDBJournal.Dump(mnMgr));
+        timer.stop();
+        const auto nSnapshotDumpMs = timer.elapsedMilliseconds();
+
+        // change 1% of masternodes
+        for (size_t i = 0; i < nCount; i += 100)
+        {
+            masternode_t pmn = mnMgr.Get(false, vOutpoints[i]);
+            if (pmn)
+                pmn->nTimeLastWatchdogVote = nNow + 1;
+        }
+        timer.start();
+        EXPECT_TRUE(flatDBJournal.Dump(mnMgr));
+        timer.stop();
+        const auto nJournalDumpMs = timer.elapsedMilliseconds();
+        {
+            CMasternodeMan mnMgrLoaded;
+            CJournaledFlatDB<CMasternodeMan> flatDBLoad(sJournalFilename, MNCACHE_CACHE_MAGIC_STR);
+            timer.start();
+            EXPECT_TRUE(flatDBLoad.Load(mnMgrLoaded));
+            timer.stop();
+            EXPECT_EQ(mnMgrLoaded.size(), mnMgr.size());
+        }
+        const auto nJournalLoadMs = timer.elapsedMilliseconds();
+
+        cout << "[          ] " << nCount << " masternodes: full dump " << nFullDumpMs << "ms, load " << nFullLoadMs <<
+            "ms; snapshot dump " << nSnapshotDumpMs << "ms, journal dump (1% changed) " << nJournalDumpMs <<
+            "ms, load " << nJournalLoadMs << "ms" << endl;
+    }
+}
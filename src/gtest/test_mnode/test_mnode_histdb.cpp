@@ -0,0 +1,128 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <gtest/gtest.h>
+
+#include <utils/streams.h>
+#include <mnode/mnode-consts.h>
+#include <mnode/mnode-histdb.h>
+
+#include <pastel_gtest_main.h>
+#include <pastel_gtest_utils.h>
+
+using namespace std;
+using namespace testing;
+
+class TestMNodeHistoryDB : public Test
+{
+public:
+    static void SetUpTestCase()
+    {
+        SelectParams(ChainNetwork::REGTEST);
+        gl_pPastelTestEnv->GenerateTempDataDir();
+    }
+
+    static void TearDownTestCase()
+    {
+        gl_pPastelTestEnv->ClearTempDataDir();
+    }
+
+protected:
+    static masternode_vector_t createTopMNs(const size_t nCount)
+    {
+        masternode_vector_t vTopMNs;
+        for (size_t i = 0; i < nCount; ++i)
+        {
+            auto pmn = make_shared<CMasternode>();
+            static_cast<masternode_info_t &>(*pmn) = masternode_info_t(MASTERNODE_STATE::ENABLED,
+                PROTOCOL_VERSION, 0, COutPoint(generateRandomUint256(), static_cast<uint32_t>(i)),
+                CService(), CPubKey(), CPubKey(), "", "", "");
+            vTopMNs.push_back(pmn);
+        }
+        return vTopMNs;
+    }
+};
+
+TEST_F(TestMNodeHistoryDB, height_key_order)
+{
+    CDataStream ss1(SER_DISK, CLIENT_VERSION), ss2(SER_DISK, CLIENT_VERSION);
+    ss1 << mn_history_height_key_t(0xFF);
+    ss2 << mn_history_height_key_t(0x100);
+    // big-endian keys are ordered by block height
+    EXPECT_LT(ss1.str(), ss2.str());
+
+    mn_history_height_key_t key;
+    ss2 >> key;
+    EXPECT_EQ(key.nHeight, 0x100u);
+}
+
+TEST_F(TestMNodeHistoryDB, write_read_prune)
+{
+    CMasternodeHistoryDB db;
+    ASSERT_TRUE(db.Init(GetDataDir() / MN_HISTORY_DB_SUBFOLDER, MN_HISTORY_DB_CACHE_SIZE, true, 5));
+
+    const auto vTopMNs = createTopMNs(10);
+    for (uint32_t nHeight = 1; nHeight <= 10; ++nHeight)
+        EXPECT_TRUE(db.WriteTopMNs(nHeight, vTopMNs));
+
+    v_outpoints vOutpoints;
+    ASSERT_TRUE(db.ReadTopMNs(3, vOutpoints));
+    ASSERT_EQ(vOutpoints.size(), vTopMNs.size());
+    for (size_t i = 0; i < vTopMNs.size(); ++i)
+        EXPECT_EQ(vOutpoints[i], vTopMNs[i]->getOutPoint());
+    EXPECT_FALSE(db.ReadTopMNs(11, vOutpoints));
+
+    // blocks below 10 - 5 are pruned
+    EXPECT_EQ(db.Prune(10), 4u);
+    EXPECT_FALSE(db.HasTopMNs(4));
+    EXPECT_TRUE(db.HasTopMNs(5));
+    EXPECT_EQ(db.Prune(10), 0u);
+
+    db.Clear();
+    EXPECT_FALSE(db.HasTopMNs(10));
+    EXPECT_FALSE(db.ReadMasternode(vTopMNs[0]->getOutPoint()));
+}
+
+TEST_F(TestMNodeHistoryDB, lazy_load)
+{
+    const auto vTopMNs = createTopMNs(3);
+    const auto dbPath = GetDataDir() / MN_HISTORY_DB_SUBFOLDER;
+    {
+        CMasternodeHistoryDB db;
+        ASSERT_TRUE(db.Init(dbPath, MN_HISTORY_DB_CACHE_SIZE, true, DEFAULT_MN_HISTORY_DEPTH));
+        EXPECT_TRUE(db.WriteTopMNs(100, vTopMNs));
+    }
+    // masternode snapshots are loaded from the reopened DB on demand
+    CMasternodeHistoryDB db;
+    ASSERT_TRUE(db.Init(dbPath, MN_HISTORY_DB_CACHE_SIZE, false, DEFAULT_MN_HISTORY_DEPTH));
+    v_outpoints vOutpoints;
+    ASSERT_TRUE(db.ReadTopMNs(100, vOutpoints));
+    ASSERT_EQ(vOutpoints.size(), vTopMNs.size());
+    for (const auto& outpoint : vOutpoints)
+    {
+        const auto pmn = db.ReadMasternode(outpoint);
+        ASSERT_TRUE(pmn);
+        EXPECT_EQ(pmn->getOutPoint(), outpoint);
+    }
+    EXPECT_FALSE(db.ReadMasternode(COutPoint(generateRandomUint256(), 0)));
+}
+
+TEST_F(TestMNodeHistoryDB, snapshot_update)
+{
+    const auto vTopMNs = createTopMNs(2);
+    const auto dbPath = GetDataDir() / MN_HISTORY_DB_SUBFOLDER;
+    const auto outpoint = vTopMNs[0]->getOutPoint();
+    {
+        CMasternodeHistoryDB db;
+        ASSERT_TRUE(db.Init(dbPath, MN_HISTORY_DB_CACHE_SIZE, true, DEFAULT_MN_HISTORY_DEPTH));
+        EXPECT_TRUE(db.WriteTopMNs(100, vTopMNs));
+        // masternode data changed - snapshot is overwritten
+        vTopMNs[0]->nProtocolVersion = PROTOCOL_VERSION + 1;
+        EXPECT_TRUE(db.WriteTopMNs(101, vTopMNs));
+    }
+    CMasternodeHistoryDB db;
+    ASSERT_TRUE(db.Init(dbPath, MN_HISTORY_DB_CACHE_SIZE, false, DEFAULT_MN_HISTORY_DEPTH));
+    const auto pmn = db.ReadMasternode(outpoint);
+    ASSERT_TRUE(pmn);
+    EXPECT_EQ(pmn->nProtocolVersion, PROTOCOL_VERSION + 1);
+}
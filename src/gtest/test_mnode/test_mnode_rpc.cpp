@@ -13,6 +13,7 @@
 #include <mnode/rpc/mnode-rpc.h>
 #include <mnode/rpc/ingest.h>
 #include <mnode/rpc/mnode-rpc-utils.h>
+#include <mnode/tickets/username-change.h>
 
 using namespace testing;
 using namespace std;
@@ -93,3 +94,39 @@ INSTANTIATE_TEST_SUITE_P(mnode_rpc_ani2psl, PTest_ani2psl_secret,
             return Base58Encode_TestKey(s);
         }, true, true)
 	));
+
+TEST(mnode_rpc, raw_json_value)
+{
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("tickets", GetRawJSONValue(R"([{"a": 1}, {"b": "x"}])"));
+    EXPECT_TRUE(obj["tickets"].isRaw());
+    EXPECT_FALSE(obj["tickets"].isNum());
+    EXPECT_EQ(obj.write(), R"({"tickets":[{"a": 1}, {"b": "x"}]})");
+
+    // written raw json can be parsed back
+    UniValue parsed;
+    ASSERT_TRUE(parsed.read(obj.write()));
+    const auto &arr = parsed["tickets"];
+    ASSERT_TRUE(arr.isArray());
+    ASSERT_EQ(arr.size(), 2u);
+    EXPECT_EQ(arr[1]["b"].get_str(), "x");
+}
+
+TEST(mnode_rpc, getJSONforTickets)
+{
+    EXPECT_TRUE(getJSONforTickets<CChangeUsernameTicket>({}).isNull());
+
+    vector<CChangeUsernameTicket> vTickets;
+    vTickets.emplace_back("PastelID-1", "user1");
+    vTickets.emplace_back("PastelID-2", "user2");
+    UniValue arr;
+    ASSERT_TRUE(arr.read(getJSONforTickets(vTickets).write()));
+    ASSERT_TRUE(arr.isArray());
+    ASSERT_EQ(arr.size(), vTickets.size());
+    for (size_t i = 0; i < vTickets.size(); ++i)
+    {
+        UniValue ticket;
+        ASSERT_TRUE(ticket.read(vTickets[i].ToJSON()));
+        EXPECT_EQ(arr[i].write(), ticket.write());
+    }
+}
@@ -0,0 +1,104 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <gtest/gtest.h>
+
+#include <mnode/mnode-score.h>
+
+#include <pastel_gtest_main.h>
+#include <pastel_gtest_utils.h>
+
+using namespace std;
+using namespace testing;
+
+class TestMNodeScore : public Test
+{
+public:
+    static void SetUpTestCase()
+    {
+        SelectParams(ChainNetwork::REGTEST);
+    }
+
+    void SetUp() override
+    {
+        for (uint32_t i = 0; i < 50; ++i)
+        {
+            auto pmn = make_shared<CMasternode>();
+            static_cast<masternode_info_t &>(*pmn) = masternode_info_t(MASTERNODE_STATE::ENABLED,
+                (i % 5 == 0) ? 1 : 2, 0, COutPoint(generateRandomUint256(), i), CService(), CPubKey(), CPubKey(), "", "", "");
+            pmn->SetCollateralMinConfBlockHash(generateRandomUint256());
+            m_mapMasternodes.emplace(pmn->getOutPoint(), pmn);
+        }
+    }
+
+protected:
+    CMasternodeScoreEngine::masternode_map_t m_mapMasternodes;
+
+    // calculate scores without the score engine
+    CMasternodeScoreEngine::score_pair_vec_t getSortedScores(const uint256 &blockHash, const int nMinProtocol)
+    {
+        CMasternodeScoreEngine::score_pair_vec_t vScores;
+        for (auto& [outpoint, pmn] : m_mapMasternodes)
+        {
+            if (pmn->nProtocolVersion < nMinProtocol)
+                continue;
+            CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+            ss << outpoint << pmn->GetCollateralMinConfBlockHash() << blockHash;
+            vScores.emplace_back(UintToArith256(ss.GetHash()), pmn);
+        }
+        sort(vScores.begin(), vScores.end(), [](const auto &s1, const auto &s2)
+        {
+            return (s1.first != s2.first) ? (s1.first > s2.first) : (s2.second->get_vin() < s1.second->get_vin());
+        });
+        return vScores;
+    }
+};
+
+TEST_F(TestMNodeScore, top_scores)
+{
+    CMasternodeScoreEngine engine;
+    const uint256 blockHash = generateRandomUint256();
+    for (const int nMinProtocol : { 0, 2 })
+    {
+        const auto vExpected = getSortedScores(blockHash, nMinProtocol);
+        for (const size_t nCount : { 1, 5, 10, 0 })
+        {
+            CMasternodeScoreEngine::score_pair_vec_t vScores;
+            EXPECT_EQ(engine.GetTopScores(m_mapMasternodes, blockHash, nMinProtocol, nCount, vScores), vExpected.size());
+            ASSERT_EQ(vScores.size(), nCount ? nCount : vExpected.size());
+            for (size_t i = 0; i < vScores.size(); ++i)
+            {
+                EXPECT_EQ(vScores[i].first, vExpected[i].first);
+                EXPECT_EQ(vScores[i].second, vExpected[i].second);
+            }
+        }
+        // rank is a position in the sorted list
+        for (size_t i = 0; i < vExpected.size(); ++i)
+            EXPECT_EQ(engine.GetRank(m_mapMasternodes, blockHash, vExpected[i].second->getOutPoint(), nMinProtocol), static_cast<int>(i + 1));
+    }
+    // masternode with lower protocol version has no rank
+    EXPECT_EQ(engine.GetRank(m_mapMasternodes, blockHash, m_mapMasternodes.cbegin()->first, 3), 0);
+    EXPECT_EQ(engine.GetCachedBlockCount(), 1u);
+}
+
+TEST_F(TestMNodeScore, cache)
+{
+    CMasternodeScoreEngine engine(2);
+    const uint256 blockHash1 = generateRandomUint256();
+    CMasternodeScoreEngine::score_pair_vec_t vScores;
+    engine.GetTopScores(m_mapMasternodes, blockHash1, 0, 1, vScores);
+    engine.GetTopScores(m_mapMasternodes, generateRandomUint256(), 0, 1, vScores);
+    engine.GetTopScores(m_mapMasternodes, generateRandomUint256(), 0, 1, vScores);
+    EXPECT_EQ(engine.GetCachedBlockCount(), 2u);
+
+    // collateral hash change is detected
+    m_mapMasternodes.cbegin()->second->SetCollateralMinConfBlockHash(generateRandomUint256());
+    engine.GetTopScores(m_mapMasternodes, blockHash1, 0, 0, vScores);
+    const auto vExpected = getSortedScores(blockHash1, 0);
+    ASSERT_EQ(vScores.size(), vExpected.size());
+    for (size_t i = 0; i < vScores.size(); ++i)
+        EXPECT_EQ(vScores[i].first, vExpected[i].first);
+
+    engine.Invalidate();
+    EXPECT_EQ(engine.GetCachedBlockCount(), 0u);
+}
@@ -0,0 +1,163 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include <key.h>
+#include <utils/svc_thread.h>
+#include <mnode/mnode-msgsigner.h>
+#include <mnode/mnode-sigverify.h>
+
+#include <pastel_gtest_utils.h>
+
+using namespace std;
+using namespace testing;
+
+TEST(mnode_sigverify, recovery_cache)
+{
+    gl_SigRecoveryCache.clear();
+
+    CKey key, otherKey;
+    key.MakeNewKey(true);
+    otherKey.MakeNewKey(true);
+    const string strMessage = "mnp-message";
+    v_uint8 vchSig;
+    ASSERT_TRUE(CMessageSigner::SignMessage(strMessage, vchSig, key));
+
+    // recovered public key is cached and used for signature verification
+    CMessageSigner::PrecomputeMessage(strMessage, vchSig);
+    EXPECT_EQ(gl_SigRecoveryCache.size(), 1u);
+    CMessageSigner::PrecomputeMessage(strMessage, vchSig);
+    EXPECT_EQ(gl_SigRecoveryCache.size(), 1u);
+    string strError;
+    EXPECT_TRUE(CMessageSigner::VerifyMessage(key.GetPubKey(), vchSig, strMessage, strError));
+    EXPECT_FALSE(CMessageSigner::VerifyMessage(otherKey.GetPubKey(), vchSig, strMessage, strError));
+
+    // failed recovery is cached too
+    v_uint8 vchBadSig(vchSig.size(), 0);
+    CMessageSigner::PrecomputeMessage(strMessage, vchBadSig);
+    EXPECT_EQ(gl_SigRecoveryCache.size(), 2u);
+    EXPECT_FALSE(CMessageSigner::VerifyMessage(key.GetPubKey(), vchBadSig, strMessage, strError));
+
+    // oldest entries are evicted first
+    CSigRecoveryCache cache(2);
+    const uint256 hash1 = generateRandomUint256(), hash2 = generateRandomUint256(), hash3 = generateRandomUint256();
+    cache.Add(hash1, vchSig, true, key.GetPubKey().GetID());
+    cache.Add(hash2, vchSig, true, key.GetPubKey().GetID());
+    cache.Add(hash3, vchSig, false, CKeyID());
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_FALSE(cache.Contains(hash1, vchSig));
+    bool bRecovered = true;
+    CKeyID keyID;
+    EXPECT_TRUE(cache.Get(hash3, vchSig, bRecovered, keyID));
+    EXPECT_FALSE(bRecovered);
+    gl_SigRecoveryCache.clear();
+}
+
+TEST(mnode_sigverify, queue_inline)
+{
+    CMasternodeSigVerifyQueue queue;
+    vector<int> vApplied;
+    bool bVerified = false;
+    queue.Submit([&]() { bVerified = true; }, [&]() { EXPECT_TRUE(bVerified); vApplied.push_back(1); });
+    EXPECT_EQ(vApplied.size(), 1u);
+    EXPECT_EQ(queue.size(), 0u);
+}
+
+TEST(mnode_sigverify, queue_apply_in_order)
+{
+    constexpr size_t TEST_JOB_COUNT = 2000;
+    CMasternodeSigVerifyQueue queue(100);
+    queue.SetThreadCount(4);
+    EXPECT_EQ(queue.GetThreadCount(), 4u);
+
+    CServiceThreadGroup threadGroup;
+    queue.create_workers(threadGroup);
+    // wait for workers to start, otherwise messages are processed inline
+    for (size_t i = 0; (i < 1000) && (queue.GetWorkerCount() < queue.GetThreadCount()); ++i)
+        this_thread::sleep_for(chrono::milliseconds(1));
+    ASSERT_EQ(queue.GetWorkerCount(), queue.GetThreadCount());
+
+    vector<size_t> vApplied;
+    vApplied.reserve(TEST_JOB_COUNT);
+    atomic_size_t nVerified(0);
+    for (size_t i = 0; i < TEST_JOB_COUNT; ++i)
+    {
+        // queue is smaller than the number of jobs - retry rejected submissions
+        while (!queue.Submit(
+            [&nVerified, i]()
+            {
+                // later jobs are verified faster than earlier ones
+                if (i % 7 == 0)
+                    this_thread::sleep_for(chrono::microseconds(200));
+                ++nVerified;
+            },
+            [&vApplied, i]() { vApplied.push_back(i); }))
+            this_thread::yield();
+    }
+    queue.WaitForEmpty();
+    threadGroup.stop_all();
+    threadGroup.join_all();
+
+    EXPECT_EQ(nVerified.load(), TEST_JOB_COUNT);
+    ASSERT_EQ(vApplied.size(), TEST_JOB_COUNT);
+    for (size_t i = 0; i < TEST_JOB_COUNT; ++i)
+        EXPECT_EQ(vApplied[i], i);
+}
+
+TEST(mnode_sigverify, queue_full)
+{
+    constexpr size_t TEST_MAX_QUEUE_SIZE = 4;
+    CMasternodeSigVerifyQueue queue(TEST_MAX_QUEUE_SIZE);
+    queue.SetThreadCount(1);
+    atomic_uint32_t nResumed(0);
+    queue.SetResumeHandler([&]() { ++nResumed; });
+
+    CServiceThreadGroup threadGroup;
+    queue.create_workers(threadGroup);
+    for (size_t i = 0; (i < 1000) && (queue.GetWorkerCount() < queue.GetThreadCount()); ++i)
+        this_thread::sleep_for(chrono::milliseconds(1));
+    ASSERT_EQ(queue.GetWorkerCount(), queue.GetThreadCount());
+
+    // block the worker on the first message
+    atomic_bool bRelease(false);
+    atomic_uint32_t nApplied(0);
+    const auto fnVerify = [&]()
+        {
+            while (!bRelease)
+                this_thread::sleep_for(chrono::milliseconds(1));
+        };
+    const auto fnApply = [&]() { ++nApplied; };
+
+    // reserved space is available to the reservation owner only
+    EXPECT_TRUE(queue.TryReserve());
+    for (size_t i = 0; i < TEST_MAX_QUEUE_SIZE - 1; ++i)
+    {
+        EXPECT_TRUE(queue.TryReserve());
+        EXPECT_TRUE(queue.Submit(fnVerify, fnApply));
+        queue.ReleaseReservation();
+    }
+    EXPECT_FALSE(queue.TryReserve());
+    EXPECT_TRUE(queue.Submit(fnVerify, fnApply));
+    queue.ReleaseReservation();
+    EXPECT_EQ(queue.size(), TEST_MAX_QUEUE_SIZE);
+
+    // Submit does not block on the full queue
+    EXPECT_FALSE(queue.Submit(fnVerify, fnApply));
+    EXPECT_FALSE(queue.TryReserve());
+    EXPECT_EQ(nResumed.load(), 0u);
+
+    // resume handler is called once the queue has free space
+    bRelease = true;
+    queue.WaitForEmpty();
+    EXPECT_EQ(nApplied.load(), TEST_MAX_QUEUE_SIZE);
+    EXPECT_EQ(nResumed.load(), 1u);
+    EXPECT_TRUE(queue.TryReserve());
+    queue.ReleaseReservation();
+
+    threadGroup.stop_all();
+    threadGroup.join_all();
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2024 The Pastel developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <gtest/gtest.h>
+
+#include <utils/streams.h>
+#include <utils/utilstrencodings.h>
+#include <mnode/mnode-consts.h>
+#include <mnode/tickets/nft-reg.h>
+#include <mnode/nft-search.h>
+
+using namespace std;
+using namespace testing;
+using json = nlohmann::json;
+
+static const json TEST_APP_TICKET = {
+    { "creator_name", "Alice Smith" },
+    { "nft_title", "Sunset Over Lake" },
+    { "nft_keyword_set", "sunset,lake" },
+    { "creator_written_statement", true },
+    { "nft_series_name", 42 },
+    { "rareness_score", 750 },
+    { "nsfw_score", 10 },
+    { "thumbnail_hash", "abcdef" },
+    { "preview_hash", "123456" }
+};
+
+TEST(nft_search, build_attributes)
+{
+    nft_search_attr_t attr;
+    string error;
+    ASSERT_TRUE(BuildNFTSearchAttributes(5, TEST_APP_TICKET, attr, error)) << error;
+    EXPECT_EQ(attr.nTotalCopies, 5u);
+    EXPECT_TRUE(attr.bHasRarenessScore);
+    EXPECT_EQ(attr.nRarenessScore, 750u);
+    EXPECT_TRUE(attr.bHasNsfwScore);
+    EXPECT_EQ(attr.nNsfwScore, 10u);
+    EXPECT_TRUE(attr.bHasThumbnailHash);
+    EXPECT_EQ(attr.sThumbnailHash, "abcdef");
+    // only search properties are stored
+    EXPECT_EQ(attr.mapProps.size(), 5u);
+    EXPECT_EQ(attr.mapProps.count("preview_hash"), 0u);
+    EXPECT_EQ(attr.mapProps["creator_name"].sValue, "alice smith");
+
+    // NFT without app ticket
+    ASSERT_TRUE(BuildNFTSearchAttributes(1, json(), attr, error));
+    EXPECT_EQ(attr.nTotalCopies, 1u);
+    EXPECT_FALSE(attr.bHasRarenessScore);
+    EXPECT_TRUE(attr.mapProps.empty());
+}
+
+TEST(nft_search, fuzzy_filter)
+{
+    nft_search_attr_t attr;
+    string error;
+    ASSERT_TRUE(BuildNFTSearchAttributes(1, TEST_APP_TICKET, attr, error)) << error;
+    EXPECT_TRUE(IsNFTSearchPropPassFuzzyFilter(attr.mapProps["nft_title"], "over lake"));
+    EXPECT_FALSE(IsNFTSearchPropPassFuzzyFilter(attr.mapProps["nft_title"], "sunrise"));
+    EXPECT_TRUE(IsNFTSearchPropPassFuzzyFilter(attr.mapProps["creator_written_statement"], "true"));
+    EXPECT_FALSE(IsNFTSearchPropPassFuzzyFilter(attr.mapProps["creator_written_statement"], "0"));
+    EXPECT_FALSE(IsNFTSearchPropPassFuzzyFilter(attr.mapProps["creator_written_statement"], "maybe"));
+    EXPECT_TRUE(IsNFTSearchPropPassFuzzyFilter(attr.mapProps["nft_series_name"], "42"));
+    EXPECT_FALSE(IsNFTSearchPropPassFuzzyFilter(attr.mapProps["nft_series_name"], "4"));
+    EXPECT_FALSE(IsNFTSearchPropPassFuzzyFilter(nft_search_prop_t(), ""));
+}
+
+TEST(nft_search, parse_app_ticket)
+{
+    json jTicket = {
+        { "nft_ticket_version", 2 },
+        { NFT_TICKET_APP_OBJ, EncodeAscii85(TEST_APP_TICKET.dump()) }
+    };
+    json jApp;
+    string error;
+    ASSERT_TRUE(ParseNFTAppTicket(EncodeBase64(jTicket.dump()), jApp, error)) << error;
+    EXPECT_EQ(jApp, TEST_APP_TICKET);
+
+    // no app ticket
+    jTicket.erase(NFT_TICKET_APP_OBJ);
+    ASSERT_TRUE(ParseNFTAppTicket(EncodeBase64(jTicket.dump()), jApp, error));
+    EXPECT_TRUE(jApp.empty());
+
+    EXPECT_FALSE(ParseNFTAppTicket(EncodeBase64("not a json"), jApp, error));
+    EXPECT_FALSE(error.empty());
+}
+
+TEST(nft_search, serialization)
+{
+    nft_search_attr_t attr;
+    string error;
+    ASSERT_TRUE(BuildNFTSearchAttributes(3, TEST_APP_TICKET, attr, error)) << error;
+    CDataStream ss(SER_DISK, DATASTREAM_VERSION);
+    ss << attr;
+    nft_search_attr_t attr2;
+    ss >> attr2;
+    EXPECT_EQ(attr2.nVersion, nft_search_attr_t::CURRENT_VERSION);
+    EXPECT_EQ(attr2.nTotalCopies, 3u);
+    EXPECT_EQ(attr2.nRarenessScore, attr.nRarenessScore);
+    EXPECT_EQ(attr2.sThumbnailHash, attr.sThumbnailHash);
+    ASSERT_EQ(attr2.mapProps.size(), attr.mapProps.size());
+    for (const auto& [sName, prop] : attr.mapProps)
+    {
+        EXPECT_EQ(attr2.mapProps[sName].type, prop.type);
+        EXPECT_EQ(attr2.mapProps[sName].sValue, prop.sValue);
+    }
+}
+
+TEST(nft_search, keyword_ngrams)
+{
+    EXPECT_TRUE(GetNFTKeywordNGramTokens("ab").empty());
+    const s_strings expected = { "sabc", "sbca", "scab" };
+    EXPECT_EQ(GetNFTKeywordNGramTokens("abcabc"), expected);
+    // every n-gram of the substring is an n-gram of the whole value
+    const auto valueTokens = GetNFTKeywordNGramTokens("sunset over lake");
+    for (const auto& sToken : GetNFTKeywordNGramTokens("over la"))
+        EXPECT_EQ(valueTokens.count(sToken), 1u) << sToken;
+}
+
+TEST(nft_search, keyword_index_tokens)
+{
+    json jApp = TEST_APP_TICKET;
+    jApp.erase("nft_keyword_set");
+    jApp["nft_title"] = json::array({ "sunset" });
+    nft_search_attr_t attr;
+    string error;
+    ASSERT_TRUE(BuildNFTSearchAttributes(1, jApp, attr, error)) << error;
+    map<string, s_strings> mapTokens;
+    GetNFTKeywordIndexTokens(attr, mapTokens);
+    EXPECT_EQ(mapTokens["creator_name"], GetNFTKeywordNGramTokens("alice smith"));
+    EXPECT_EQ(mapTokens["creator_written_statement"], s_strings({ "b1" }));
+    EXPECT_EQ(mapTokens["nft_series_name"], s_strings({ "n42" }));
+    // missing property
+    EXPECT_EQ(mapTokens["nft_keyword_set"], s_strings({ "m" }));
+    // unsupported property type is not indexed
+    EXPECT_EQ(mapTokens.count("nft_title"), 0u);
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2024 The Pastel developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <gtest/gtest.h>
+
+#include <mnode/ticket-cache.h>
+#include <mnode/tickets/username-change.h>
+#include <mnode/tickets/pastelid-reg.h>
+
+using namespace std;
+using namespace testing;
+
+class TestTicketCache : public Test
+{
+public:
+    void SetUp() override
+    {
+        m_cache.SetMaxSize(3);
+    }
+
+protected:
+    CTicketCache m_cache;
+
+    static CChangeUsernameTicket createTicket(const string &sUserName, const uint32_t nHeight)
+    {
+        CChangeUsernameTicket ticket(strprintf("PastelID-%s", sUserName), string(sUserName));
+        ticket.SetBlock(nHeight);
+        return ticket;
+    }
+
+    void putTicket(const string &sUserName, const uint32_t nHeight)
+    {
+        m_cache.PutTicket(createTicket(sUserName, nHeight), m_cache.GetGeneration());
+    }
+};
+
+TEST_F(TestTicketCache, get_put)
+{
+    CChangeUsernameTicket ticket;
+    EXPECT_FALSE(m_cache.GetTicket(TicketID::Username, "user1", ticket));
+    putTicket("user1", 10);
+    ASSERT_TRUE(m_cache.GetTicket(TicketID::Username, "user1", ticket));
+    EXPECT_EQ(ticket.getUserName(), "user1");
+    EXPECT_EQ(ticket.getPastelID(), "PastelID-user1");
+    EXPECT_EQ(ticket.GetBlock(), 10u);
+
+    // ticket of the other type should not be found
+    CPastelIDRegTicket idTicket;
+    EXPECT_FALSE(m_cache.GetTicket(TicketID::PastelID, "user1", idTicket));
+
+    const auto stats = m_cache.GetStats(TicketID::Username);
+    EXPECT_EQ(stats.nHits, 1u);
+    EXPECT_EQ(stats.nMisses, 1u);
+    EXPECT_EQ(stats.nEntries, 1u);
+}
+
+TEST_F(TestTicketCache, lru_eviction)
+{
+    putTicket("user1", 1);
+    putTicket("user2", 2);
+    putTicket("user3", 3);
+    CChangeUsernameTicket ticket;
+    // make user1 most recently used
+    EXPECT_TRUE(m_cache.GetTicket(TicketID::Username, "user1", ticket));
+    putTicket("user4", 4);
+    // user2 is evicted as least recently used
+    EXPECT_FALSE(m_cache.GetTicket(TicketID::Username, "user2", ticket));
+    EXPECT_TRUE(m_cache.GetTicket(TicketID::Username, "user1", ticket));
+    EXPECT_TRUE(m_cache.GetTicket(TicketID::Username, "user3", ticket));
+    EXPECT_TRUE(m_cache.GetTicket(TicketID::Username, "user4", ticket));
+    const auto stats = m_cache.GetStats(TicketID::Username);
+    EXPECT_EQ(stats.nEvictions, 1u);
+    EXPECT_EQ(stats.nEntries, 3u);
+}
+
+TEST_F(TestTicketCache, invalidation)
+{
+    const v_strings vKeys = { "user1", "user2" };
+    m_cache.PutKeys(TicketID::Username, "@M@key", vKeys, m_cache.GetGeneration());
+    putTicket("user1", 10);
+    putTicket("user2", 20);
+
+    v_strings vCachedKeys;
+    ASSERT_TRUE(m_cache.GetKeys(TicketID::Username, "@M@key", vCachedKeys));
+    EXPECT_EQ(vCachedKeys, vKeys);
+
+    m_cache.Invalidate(TicketID::Username, "@M@key");
+    EXPECT_FALSE(m_cache.GetKeys(TicketID::Username, "@M@key", vCachedKeys));
+
+    // tickets from height 15 and above are invalidated
+    EXPECT_EQ(m_cache.InvalidateFromHeight(15), 1u);
+    CChangeUsernameTicket ticket;
+    EXPECT_TRUE(m_cache.GetTicket(TicketID::Username, "user1", ticket));
+    EXPECT_FALSE(m_cache.GetTicket(TicketID::Username, "user2", ticket));
+}
+
+TEST_F(TestTicketCache, stale_generation)
+{
+    // ticket read from DB before invalidation should not be cached
+    const uint64_t nGeneration = m_cache.GetGeneration();
+    m_cache.Invalidate(TicketID::Username, "user1");
+    m_cache.PutTicket(createTicket("user1", 1), nGeneration);
+    CChangeUsernameTicket ticket;
+    EXPECT_FALSE(m_cache.GetTicket(TicketID::Username, "user1", ticket));
+}
+
+TEST_F(TestTicketCache, disabled)
+{
+    m_cache.SetMaxSize(0);
+    putTicket("user1", 1);
+    CChangeUsernameTicket ticket;
+    EXPECT_FALSE(m_cache.GetTicket(TicketID::Username, "user1", ticket));
+}
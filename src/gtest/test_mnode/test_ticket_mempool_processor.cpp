@@ -7,25 +7,13 @@
 #include <mnode/ticket-mempool-processor.h>
 #include <mnode/tickets/username-change.h>
 
+#include <test_mempool_entryhelper.h>
 #include <test_mnode/mock_p2fms_txbuilder.h>
 #include "test_mnode/test_ticket_mempool.h"
 
 using namespace testing;
 using namespace std;
 
-class MockTxMemPool : public CTxMemPool
-{
-public:
-    MockTxMemPool(const CFeeRate& _minRelayFee) : 
-        CTxMemPool(_minRelayFee)
-    {}
-    
-    // Lookup for the transaction with the specific hash (txid).
-    MOCK_METHOD(bool, lookup, (const uint256& txid, CTransaction& tx, uint32_t* nBlockHeight), (const, override));
-    // Get a list of transactions by txids
-    MOCK_METHOD(void, batch_lookup, (const v_uint256& vTxid, std::vector<CMutableTransaction>& vTx, v_uints& vBlockHeight), (const, override));
-};
-
 class TestTktMemPoolProcessor : 
     public CPastelTicketMemPoolProcessor,
     public MockP2FMS_TxBuilder,
@@ -47,14 +35,12 @@ TEST_F(TestTktMemPoolProcessor, ticket_search)
 	EXPECT_CALL(*this, CreateP2FMSScripts())
 		.WillRepeatedly(Invoke(this, &MockP2FMS_TxBuilder::Call_CreateP2FMSScripts));
 
-    MockTxMemPool txMemPool(CFeeRate(0));
-
     auto pMemPoolTracker = make_shared<MockTicketTxMemPoolTracker>();
     ASSERT_NE(pMemPoolTracker, nullptr);
 
-    v_uint256 vTxid_username, vTxid_pastelid;
-    vector<CMutableTransaction> vTx;
-    v_uints vBlockHeight;
+    TestMemPoolEntryHelper entry;
+    entry.hadNoDependencies = true;
+    v_uint256 vTxid_username;
     for (uint32_t i = 0; i < 10; ++i)
     {
         CMutableTransaction tx = CreateTicketTransaction(TicketID::Username, [&](CPastelTicket& tkt)
@@ -63,28 +49,14 @@ TEST_F(TestTktMemPoolProcessor, ticket_search)
             userNameTicket.setUserName(to_string(i));
             userNameTicket.setPastelID(strprintf("Pastel-ID-%u", i));
         });
-        vTx.push_back(tx);
-        vBlockHeight.emplace_back(100 + i);
+        // tickets are parsed and indexed by the mempool tracker
+        pMemPoolTracker->processTransaction(entry.Height(100 + i).FromTx(tx), false);
         vTxid_username.emplace_back(tx.GetHash());
     }
-    pMemPoolTracker->Mock_AddTestData(TicketID::PastelID, 20, vTxid_pastelid);
-    pMemPoolTracker->Mock_AddTestTxids(TicketID::Username, vTxid_username);
+    EXPECT_EQ(pMemPoolTracker->size_mapTxId(), 10u);
 
-    Sequence s1;
     m_TicketID = TicketID::Username;
-    EXPECT_CALL(*pMemPoolTracker, getTicketTransactions(TicketID::Username, _))
-        .WillOnce(DoAll(
-            SetArgReferee<1>(vTxid_username),
-            Return()));
-    EXPECT_CALL(txMemPool, batch_lookup)
-        .WillOnce(DoAll(
-                SetArgReferee<1>(vTx),
-                SetArgReferee<2>(vBlockHeight),
-                Return()
-            ));
-
-    EXPECT_NO_THROW(Initialize(txMemPool, pMemPoolTracker));
-    EXPECT_EQ(m_vTicket.size(), 10u);
+    EXPECT_NO_THROW(Initialize(pMemPoolTracker));
 
     // FindTicket
     auto pTkt = CPastelTicketProcessor::CreateTicket(TicketID::Username);
@@ -93,6 +65,8 @@ TEST_F(TestTktMemPoolProcessor, ticket_search)
     userNameTkt.setUserName("5");
     EXPECT_TRUE(FindTicket(userNameTkt));
     EXPECT_EQ(userNameTkt.getPastelID(), "Pastel-ID-5");
+    EXPECT_EQ(userNameTkt.GetBlock(), 105u);
+    EXPECT_EQ(userNameTkt.GetTxId(), vTxid_username[5].ToString());
     
     userNameTkt.Clear();
     userNameTkt.setUserName("not_existing");
@@ -115,5 +89,22 @@ TEST_F(TestTktMemPoolProcessor, ticket_search)
     userNameTkt.Clear();
     userNameTkt.setPastelID("not_existing");
     EXPECT_FALSE(FindTicketBySecondaryKey(userNameTkt));
+
+    // ListTickets
+    PastelTickets_t vTicket;
+    EXPECT_TRUE(ListTickets(vTicket, "3"));
+    ASSERT_EQ(vTicket.size(), 1u);
+    EXPECT_EQ(vTicket[0]->KeyTwo(), "Pastel-ID-3");
+
+    // ticket of the other type is not found
+    m_TicketID = TicketID::PastelID;
+    EXPECT_FALSE(TicketExists("2"));
+    m_TicketID = TicketID::Username;
+
+    // removed transaction is removed from the ticket indexes
+    pMemPoolTracker->removeTx(vTxid_username[2]);
+    EXPECT_FALSE(TicketExists("2"));
+    EXPECT_FALSE(TicketExistsBySecondaryKey("Pastel-ID-2"));
+    EXPECT_TRUE(TicketExists("3"));
 }
 
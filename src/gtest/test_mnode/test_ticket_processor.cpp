@@ -4,7 +4,9 @@
 #include <gtest/gtest.h>
 #include <extlibs/json.hpp>
 
+#include <utils/str_utils.h>
 #include <mnode/ticket-processor.h>
+#include <mnode/tickets/nft-royalty.h>
 #include <pastel_gtest_main.h>
 #include <test_mnode/mock_ticket.h>
 
@@ -94,6 +96,289 @@ TEST_F(TestTicketProcessor, ticket_compression)
 #endif // ENABLE_WALLET
 #endif // ENABLE_MINING
 
+class TestTicketDB :
+    public CPastelTicketProcessor,
+    public Test
+{
+public:
+    static void SetUpTestSuite()
+    {
+        gl_pPastelTestEnv->InitializeRegTest();
+    }
+
+    static void TearDownTestSuite()
+    {
+        gl_pPastelTestEnv->FinalizeRegTest();
+    }
+
+protected:
+    static parsed_ticket_t CreateUsernameTicket(string &&sUserName, const uint256 &hashTx)
+    {
+        parsed_ticket_t parsedTicket;
+        parsedTicket.ticket = make_unique<CChangeUsernameTicket>(string("pastelid-") + sUserName, std::move(sUserName));
+        parsedTicket.ticket->SetSerializedSize(100);
+        parsedTicket.hashTx = hashTx;
+        parsedTicket.nMultiSigOutputsCount = 2;
+        parsedTicket.nMultiSigTxTotalFee = 1000;
+        return parsedTicket;
+    }
+};
+
+TEST_F(TestTicketDB, txid_index_lookup)
+{
+    InitTicketDB();
+    const uint256 hashBlock = GetRandHash();
+    const uint256 hashTx1 = GetRandHash();
+    auto parsedTicket = CreateUsernameTicket("user1", hashTx1);
+    ASSERT_TRUE(addTicketToDB(parsedTicket, 10, hashBlock, nullptr));
+
+    PastelTicketPtr ticket;
+    ticket_txid_index_t txIndex;
+    ASSERT_TRUE(readTicketByTxId(hashTx1, ticket, txIndex));
+    ASSERT_NE(ticket.get(), nullptr);
+    EXPECT_EQ(ticket->ID(), TicketID::Username);
+    EXPECT_EQ(ticket->KeyOne(), "user1");
+    EXPECT_EQ(ticket->GetTxId(), hashTx1.GetHex());
+    EXPECT_EQ(ticket->GetSerializedSize(), 100u);
+    EXPECT_EQ(txIndex.nHeight, 10u);
+    EXPECT_EQ(txIndex.hashBlock, hashBlock);
+    EXPECT_EQ(txIndex.nMultiSigOutputsCount, 2u);
+    EXPECT_EQ(txIndex.nMultiSigTxTotalFee, 1000);
+
+    // unknown txid
+    EXPECT_FALSE(readTicketByTxId(GetRandHash(), ticket, txIndex));
+
+    // primary key reused by another ticket - old txid is not resolved to the new ticket
+    const uint256 hashTx2 = GetRandHash();
+    auto parsedTicket2 = CreateUsernameTicket("user1", hashTx2);
+    ASSERT_TRUE(addTicketToDB(parsedTicket2, 11, hashBlock, nullptr));
+    EXPECT_FALSE(readTicketByTxId(hashTx1, ticket, txIndex));
+    ASSERT_TRUE(readTicketByTxId(hashTx2, ticket, txIndex));
+    EXPECT_EQ(ticket->GetTxId(), hashTx2.GetHex());
+}
+
+TEST_F(TestTicketDB, txid_index_build_marker)
+{
+    InitTicketDB();
+    // txid index DB was just created - index should be built
+    EXPECT_FALSE(isIndexBuilt(TICKET_TXIDX_DB_SUBFOLDER));
+    {
+        LOCK(cs_main);
+        BuildTicketTxIdIndex();
+    }
+    EXPECT_TRUE(isIndexBuilt(TICKET_TXIDX_DB_SUBFOLDER));
+    // interrupted build - marker is erased, index is rebuilt on the next call
+    setIndexBuilt(TICKET_TXIDX_DB_SUBFOLDER, false);
+    EXPECT_FALSE(isIndexBuilt(TICKET_TXIDX_DB_SUBFOLDER));
+    {
+        LOCK(cs_main);
+        BuildTicketTxIdIndex();
+    }
+    EXPECT_TRUE(isIndexBuilt(TICKET_TXIDX_DB_SUBFOLDER));
+}
+
+TEST_F(TestTicketDB, mvkey_height_order)
+{
+    InitTicketDB();
+    const uint32_t nSavedChainHeight = gl_nChainHeight;
+    gl_nChainHeight = 100;
+    const string sPastelID = "royalty-pastelid-" + GetRandHash().GetHex();
+    // tickets are added in the block height order, primary keys are not sorted
+    for (const auto& [sKeyOne, nHeight] : vector<pair<string, uint32_t>>{ { "z", 10 }, { "m", 15 }, { "a", 20 } })
+    {
+        parsed_ticket_t parsedTicket;
+        parsedTicket.ticket = make_unique<CNFTRoyaltyTicket>(string(sPastelID), "new-pastelid");
+        parsedTicket.ticket->SetKeyOne(sKeyOne + sPastelID);
+        parsedTicket.hashTx = GetRandHash();
+        ASSERT_TRUE(addTicketToDB(parsedTicket, nHeight, GetRandHash(), nullptr));
+    }
+    v_strings vKeys;
+    ProcessTicketsByMVKey<CNFTRoyaltyTicket>(sPastelID, nullptr, [&](const CNFTRoyaltyTicket& ticket) -> bool
+    {
+        vKeys.push_back(ticket.KeyOne().substr(0, 1));
+        return true;
+    });
+    EXPECT_EQ(vKeys, v_strings({ "z", "m", "a" }));
+    gl_nChainHeight = nSavedChainHeight;
+}
+
+TEST_F(TestTicketDB, mvkey_block_tx_order)
+{
+    InitTicketDB();
+    const uint32_t nSavedChainHeight = gl_nChainHeight;
+    gl_nChainHeight = 100;
+    const string sPastelID = "royalty-pastelid-" + GetRandHash().GetHex();
+    const uint256 hashBlock = GetRandHash();
+    // tickets with the same mv key in one block are read in the transaction order
+    const vector<pair<string, uint32_t>> vTickets = { { "z", 1 }, { "a", 2 }, { "m", 5 } };
+    for (const auto& [sKeyOne, nTxIndex] : vTickets)
+    {
+        parsed_ticket_t parsedTicket;
+        parsedTicket.ticket = make_unique<CNFTRoyaltyTicket>(string(sPastelID), "new-pastelid");
+        parsedTicket.ticket->SetKeyOne(sKeyOne + sPastelID);
+        parsedTicket.hashTx = GetRandHash();
+        parsedTicket.nTxIndex = nTxIndex;
+        ASSERT_TRUE(addTicketToDB(parsedTicket, 10, hashBlock, nullptr));
+    }
+    auto fnReadKeys = [&]() -> v_strings
+    {
+        v_strings vKeys;
+        ProcessTicketsByMVKey<CNFTRoyaltyTicket>(sPastelID, nullptr, [&](const CNFTRoyaltyTicket& ticket) -> bool
+        {
+            vKeys.push_back(ticket.KeyOne().substr(0, 1));
+            return true;
+        });
+        return vKeys;
+    };
+    EXPECT_EQ(fnReadKeys(), v_strings({ "z", "a", "m" }));
+
+    // ticket added again at the same height with another tx index replaces its mv key record
+    parsed_ticket_t parsedTicket;
+    parsedTicket.ticket = make_unique<CNFTRoyaltyTicket>(string(sPastelID), "new-pastelid");
+    parsedTicket.ticket->SetKeyOne("z" + sPastelID);
+    parsedTicket.hashTx = GetRandHash();
+    parsedTicket.nTxIndex = 3;
+    ASSERT_TRUE(addTicketToDB(parsedTicket, 10, GetRandHash(), nullptr));
+    EXPECT_EQ(fnReadKeys(), v_strings({ "a", "z", "m" }));
+    gl_nChainHeight = nSavedChainHeight;
+}
+
+TEST_F(TestTicketDB, repair_pending)
+{
+    InitTicketDB();
+    writeRepairCheckpoint(nullptr);
+    EXPECT_FALSE(IsRepairPending());
+    // checkpoint with null block hash is written on the ticket DB write failure
+    ticket_db_repair_checkpoint_t checkpoint;
+    writeRepairCheckpoint(&checkpoint);
+    EXPECT_TRUE(IsRepairPending());
+    writeRepairCheckpoint(nullptr);
+    EXPECT_FALSE(IsRepairPending());
+}
+
+TEST_F(TestTicketDB, repair_resume_from_checkpoint)
+{
+    InitTicketDB();
+    // fake active chain with 10 blocks
+    constexpr uint32_t nTipHeight = 9;
+    v_uint256 vHashes(nTipHeight + 1);
+    vector<CBlockIndex> vBlocks(nTipHeight + 1);
+    for (uint32_t i = 0; i <= nTipHeight; ++i)
+    {
+        vHashes[i] = GetRandHash();
+        vBlocks[i].nHeight = i;
+        vBlocks[i].pprev = i ? &vBlocks[i - 1] : nullptr;
+        vBlocks[i].phashBlock = &vHashes[i];
+    }
+    LOCK(cs_main);
+    const auto pindexSavedTip = chainActive.Tip();
+    chainActive.SetTip(&vBlocks.back());
+
+    ticket_db_repair_checkpoint_t checkpoint;
+    writeRepairCheckpoint(nullptr);
+    EXPECT_EQ(getRepairStartHeight(nTipHeight), 1u);
+    // resume from the block next to the checkpoint
+    checkpoint.nHeight = 5;
+    checkpoint.hashBlock = vHashes[5];
+    writeRepairCheckpoint(&checkpoint);
+    EXPECT_EQ(getRepairStartHeight(nTipHeight), 6u);
+    // checkpoint block is not in the active chain
+    checkpoint.hashBlock = GetRandHash();
+    writeRepairCheckpoint(&checkpoint);
+    EXPECT_EQ(getRepairStartHeight(nTipHeight), 1u);
+    // full repair scheduled
+    checkpoint.hashBlock.SetNull();
+    writeRepairCheckpoint(&checkpoint);
+    EXPECT_EQ(getRepairStartHeight(nTipHeight), 1u);
+    // checkpoint at the tip
+    checkpoint.nHeight = nTipHeight;
+    checkpoint.hashBlock = vHashes[nTipHeight];
+    writeRepairCheckpoint(&checkpoint);
+    EXPECT_EQ(getRepairStartHeight(nTipHeight), 1u);
+
+    writeRepairCheckpoint(nullptr);
+    chainActive.SetTip(pindexSavedTip);
+}
+
+TEST_F(TestTicketDB, height_index_build_marker)
+{
+    InitTicketDB();
+    // height index is built on ticket DB initialization
+    EXPECT_TRUE(isIndexBuilt(TICKET_HEIGHTIDX_DB_SUBFOLDER));
+}
+
+TEST_F(TestTicketDB, list_tickets_height_order)
+{
+    InitTicketDB();
+    const uint32_t nSavedChainHeight = gl_nChainHeight;
+    gl_nChainHeight = 100;
+    const string sPrefix = "list-" + GetRandHash().GetHex().substr(0, 8) + "-";
+    // primary keys are not sorted by block height
+    for (const auto& [sKeyOne, nHeight] : vector<pair<string, uint32_t>>{ { "z", 10 }, { "a", 15 }, { "m", 15 }, { "b", 20 } })
+    {
+        auto parsedTicket = CreateUsernameTicket(sPrefix + sKeyOne, GetRandHash());
+        ASSERT_TRUE(addTicketToDB(parsedTicket, nHeight, GetRandHash(), nullptr));
+    }
+    const auto fnList = [&](const uint32_t nMinHeight) -> v_strings
+    {
+        v_strings vKeys;
+        const json jTickets = json::parse(ListTickets<CChangeUsernameTicket>(nMinHeight));
+        for (const auto& jTicket : jTickets)
+        {
+            const string sUserName = jTicket["ticket"]["username"];
+            if (str_starts_with(sUserName, sPrefix.c_str()))
+                vKeys.push_back(sUserName.substr(sPrefix.size()));
+        }
+        return vKeys;
+    };
+    // the same order with and without minimal height
+    EXPECT_EQ(fnList(0), v_strings({ "z", "a", "m", "b" }));
+    EXPECT_EQ(fnList(1), v_strings({ "z", "a", "m", "b" }));
+    EXPECT_EQ(fnList(15), v_strings({ "a", "m", "b" }));
+    gl_nChainHeight = nSavedChainHeight;
+}
+
+TEST_F(TestTicketDB, nft_keyword_index_build_marker)
+{
+    InitTicketDB();
+    // NFT keyword index is built on ticket DB initialization
+    EXPECT_TRUE(isIndexBuilt(TICKET_NFTKEYWORD_DB_SUBFOLDER));
+}
+
+TEST_F(TestTicketDB, nft_keyword_index_read)
+{
+    InitTicketDB();
+    const v_strings vNames = { "alice", "alina", "bob" };
+    v_strings vTxIds;
+    for (const auto &sName : vNames)
+    {
+        nft_search_attr_t attr;
+        attr.mapProps["creator_name"] = { NFT_SEARCH_PROP_TYPE::String, sName };
+        vTxIds.push_back(GetRandHash().GetHex());
+        updateNFTKeywordIndex(vTxIds.back(), attr, false);
+    }
+    const string sToken = string(1, NFT_KEYWORD_TOKEN_NGRAM) + "ali";
+    const string sUnknownTxId = GetRandHash().GetHex();
+
+    // only txids from the filter set are returned
+    su_strings result;
+    readNFTKeywordIndex("creator_name", sToken, { vTxIds[0], vTxIds[2], sUnknownTxId }, result);
+    EXPECT_EQ(result, su_strings({ vTxIds[0] }));
+    result.clear();
+    readNFTKeywordIndex("creator_name", sToken, { vTxIds[0], vTxIds[1], vTxIds[2] }, result);
+    EXPECT_EQ(result, su_strings({ vTxIds[0], vTxIds[1] }));
+    result.clear();
+    readNFTKeywordIndex("creator_name", sToken, {}, result);
+    EXPECT_TRUE(result.empty());
+
+    for (size_t i = 0; i < vNames.size(); ++i)
+    {
+        nft_search_attr_t attr;
+        attr.mapProps["creator_name"] = { NFT_SEARCH_PROP_TYPE::String, vNames[i] };
+        updateNFTKeywordIndex(vTxIds[i], attr, true);
+    }
+}
+
 class PTest_fuzzy_filter : public TestWithParam<
     tuple<
         string, // json value
@@ -123,3 +408,132 @@ INSTANTIATE_TEST_SUITE_P(ticket_processor, PTest_fuzzy_filter, Values(
     make_tuple(R"(-42)", "-43", false),
     make_tuple(R"(2.3)", "2.4", false)
 ));
+
+static nft_fuzzy_filter_t makeFuzzyFilter(const string &sPropName, const string &sFilterValue)
+{
+    nft_fuzzy_filter_t filter;
+    filter.sPropName = sPropName;
+    filter.sFilterValue = sFilterValue;
+    filter.sLowercasedFilterValue = lowercase(sFilterValue);
+    return filter;
+}
+
+TEST(ticket_processor, nft_fuzzy_filters)
+{
+    const json jApp = json::parse(R"({"creator_name": "Alice", "green": true, "total_copies": 5})");
+    const nft_search_attr_t attr;
+
+    // no filters
+    EXPECT_TRUE(isNFTPassFuzzyFilters({}, attr, jApp));
+    // all filters pass
+    EXPECT_TRUE(isNFTPassFuzzyFilters({ makeFuzzyFilter("creator_name", "ali"), makeFuzzyFilter("green", "yes") }, attr, jApp));
+    // filters for the properties not defined in the NFT are skipped
+    EXPECT_TRUE(isNFTPassFuzzyFilters({ makeFuzzyFilter("creator_name", "ali"), makeFuzzyFilter("unknown", "x") }, attr, jApp));
+    // all filters should pass - the order of the filters does not matter
+    EXPECT_FALSE(isNFTPassFuzzyFilters({ makeFuzzyFilter("creator_name", "bob"), makeFuzzyFilter("green", "yes") }, attr, jApp));
+    EXPECT_FALSE(isNFTPassFuzzyFilters({ makeFuzzyFilter("green", "yes"), makeFuzzyFilter("creator_name", "bob") }, attr, jApp));
+}
+
+static string serializeHeightIndexKey(const TicketID id, const uint32_t nHeight, const string &sKeyOne)
+{
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << ticket_height_index_key_t(id, nHeight, sKeyOne);
+    return ss.str();
+}
+
+TEST(ticket_processor, height_index_key)
+{
+    // index keys of the same ticket type are ordered by block height
+    EXPECT_LT(serializeHeightIndexKey(TicketID::NFT, 255, "zzz"), serializeHeightIndexKey(TicketID::NFT, 256, "aaa"));
+    EXPECT_LT(serializeHeightIndexKey(TicketID::NFT, 70'000, "b"), serializeHeightIndexKey(TicketID::NFT, 70'000, "c"));
+    // ticket type is the most significant part of the key
+    EXPECT_LT(serializeHeightIndexKey(TicketID::PastelID, 1'000'000, "key"), serializeHeightIndexKey(TicketID::NFT, 1, "key"));
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << ticket_height_index_key_t(TicketID::Username, 12345, "user");
+    ticket_height_index_key_t key;
+    ss >> key;
+    EXPECT_EQ(key.ticket_id, TicketID::Username);
+    EXPECT_EQ(key.nHeight, 12345u);
+    EXPECT_EQ(key.sKeyOne, "user");
+}
+
+static string serializeMVKey(const string &sRealMVKey, const uint32_t nHeight, const string &sKeyOne,
+    const uint32_t nTxIndex = 0)
+{
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << ticket_mvkey_t(sRealMVKey, nHeight, nTxIndex, sKeyOne);
+    return ss.str();
+}
+
+TEST(ticket_processor, mvkey_record_key)
+{
+    const string sRealMVKey = CPastelTicketProcessor::RealMVKey("PastelID");
+    CDataStream ssPrefix(SER_DISK, CLIENT_VERSION);
+    ssPrefix << sRealMVKey;
+    const string sPrefix = ssPrefix.str();
+    // all records for the mv key share the serialized mv key prefix
+    const v_strings vKeys = { "a", "key1", string(300, 'k') };
+    for (const auto& sKeyOne : vKeys)
+    {
+        const string sKey = serializeMVKey(sRealMVKey, 10, sKeyOne);
+        EXPECT_EQ(sKey.compare(0, sPrefix.size(), sPrefix), 0);
+        // seek key is ordered before all records for the mv key
+        EXPECT_LT(serializeMVKey(sRealMVKey, 0, ""), sKey);
+    }
+    // records are ordered by block height first, then by tx index in the block, then by primary key
+    EXPECT_LT(serializeMVKey(sRealMVKey, 255, "z"), serializeMVKey(sRealMVKey, 256, "a"));
+    EXPECT_LT(serializeMVKey(sRealMVKey, 10, "a"), serializeMVKey(sRealMVKey, 1'000'000, "a"));
+    EXPECT_LT(serializeMVKey(sRealMVKey, 10, "z", 255), serializeMVKey(sRealMVKey, 10, "a", 256));
+    EXPECT_LT(serializeMVKey(sRealMVKey, 10, "z", 1'000), serializeMVKey(sRealMVKey, 11, "a", 0));
+    EXPECT_LT(serializeMVKey(sRealMVKey, 10, "a"), serializeMVKey(sRealMVKey, 10, "b"));
+    // mv key that is a string prefix of another mv key does not share records
+    const string sOtherKey = serializeMVKey(CPastelTicketProcessor::RealMVKey("PastelID2"), 0, "a");
+    EXPECT_NE(sOtherKey.compare(0, sPrefix.size(), sPrefix), 0);
+
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << ticket_mvkey_t(sRealMVKey, 12345, 7, "key1");
+    ticket_mvkey_t key;
+    ss >> key;
+    EXPECT_EQ(key.sRealMVKey, sRealMVKey);
+    EXPECT_EQ(key.nHeight, 12345u);
+    EXPECT_EQ(key.nTxIndex, 7u);
+    EXPECT_EQ(key.sKeyOne, "key1");
+}
+
+TEST(ticket_processor, repair_checkpoint)
+{
+    // repair checkpoint key is an auxiliary key skipped by ticket DB readers
+    EXPECT_EQ(TICKET_DB_REPAIR_KEY[0], '@');
+
+    ticket_db_repair_checkpoint_t checkpoint;
+    checkpoint.nHeight = 123456;
+    checkpoint.hashBlock = uint256S("0000000000000000000000000000000000000000000000000000000000abcdef");
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << checkpoint;
+    ticket_db_repair_checkpoint_t checkpointRead;
+    ss >> checkpointRead;
+    EXPECT_EQ(checkpointRead.nHeight, checkpoint.nHeight);
+    EXPECT_EQ(checkpointRead.hashBlock, checkpoint.hashBlock);
+}
+
+TEST(ticket_processor, db_batch)
+{
+    CDBWrapper db1(fs::temp_directory_path() / fs::unique_path(), 1 << 20, true, false);
+    CDBWrapper db2(fs::temp_directory_path() / fs::unique_path(), 1 << 20, true, false);
+    CTicketDBBatch batch;
+    EXPECT_TRUE(batch.IsEmpty());
+    // one batch per DB
+    auto &batch1 = batch.Get(db1);
+    EXPECT_EQ(&batch1, &batch.Get(db1));
+    EXPECT_NE(&batch1, &batch.Get(db2));
+    EXPECT_FALSE(batch.IsEmpty());
+
+    batch1.Write(string("key1"), uint8_t(1));
+    batch1.Write(ticket_mvkey_t("@M@mvkey", 1, 0, "key1"), uint8_t(0));
+    // changes are not visible until the batch is written
+    EXPECT_FALSE(db1.Exists(string("key1")));
+    ASSERT_TRUE(db1.WriteBatch(batch1));
+    EXPECT_TRUE(db1.Exists(string("key1")));
+    EXPECT_TRUE(db1.Exists(ticket_mvkey_t("@M@mvkey", 1, 0, "key1")));
+}
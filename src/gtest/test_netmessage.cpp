@@ -0,0 +1,130 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <gtest/gtest.h>
+
+#include <version.h>
+#include <netmsg/netmessage.h>
+
+using namespace std;
+using namespace testing;
+
+static const CMessageHeader::MessageStartChars TEST_MESSAGE_START = { 0x01, 0x02, 0x03, 0x04 };
+
+TEST(netmessage, buffer_pool)
+{
+    CNetMessageBufferPool pool(128 * 1024);
+    bool bReused = true;
+
+    // buffer capacity is rounded up to the size class
+    auto vch = pool.Acquire(100, bReused);
+    EXPECT_FALSE(bReused);
+    EXPECT_TRUE(vch.empty());
+    EXPECT_EQ(vch.capacity(), NET_MSG_BUFFER_SIZE_CLASSES[0]);
+    vch.resize(100);
+    pool.Release(std::move(vch));
+    EXPECT_EQ(pool.size(), 1u);
+
+    // free buffer is reused for the same size class
+    vch = pool.Acquire(NET_MSG_BUFFER_SIZE_CLASSES[0], bReused);
+    EXPECT_TRUE(bReused);
+    EXPECT_TRUE(vch.empty());
+    EXPECT_EQ(pool.size(), 0u);
+    pool.Release(std::move(vch));
+
+    // but not for the larger one
+    vch = pool.Acquire(NET_MSG_BUFFER_SIZE_CLASSES[0] + 1, bReused);
+    EXPECT_FALSE(bReused);
+    EXPECT_EQ(vch.capacity(), NET_MSG_BUFFER_SIZE_CLASSES[1]);
+    pool.Release(std::move(vch));
+    EXPECT_EQ(pool.size(), 2u);
+
+    // size class does not fit into the pool
+    vch = pool.Acquire(NET_MSG_BUFFER_SIZE_CLASSES[2], bReused);
+    EXPECT_FALSE(bReused);
+    pool.Release(std::move(vch));
+    EXPECT_EQ(pool.size(), 2u);
+
+    // buffers without size class are not pooled
+    vch = pool.Acquire(MAX_PROTOCOL_MESSAGE_LENGTH + 1, bReused);
+    EXPECT_FALSE(bReused);
+    EXPECT_GE(vch.capacity(), MAX_PROTOCOL_MESSAGE_LENGTH + 1);
+    pool.Release(std::move(vch));
+    CSerializeData vchSmall;
+    vchSmall.reserve(100);
+    pool.Release(std::move(vchSmall));
+    EXPECT_EQ(pool.size(), 2u);
+
+    pool.clear();
+    EXPECT_EQ(pool.size(), 0u);
+}
+
+TEST(netmessage, preallocated_buffer)
+{
+    gl_NetMsgBufferPool.clear();
+
+    constexpr unsigned int TEST_MESSAGE_SIZE = 100'000;
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << CMessageHeader(TEST_MESSAGE_START, "block", TEST_MESSAGE_SIZE);
+    const string sData(TEST_MESSAGE_SIZE, 'x');
+    ss.write(sData.data(), sData.size());
+    const string sMsg = ss.str();
+
+    for (int i = 0; i < 2; ++i)
+    {
+        CNetMessage msg(TEST_MESSAGE_START, SER_NETWORK, PROTOCOL_VERSION);
+        EXPECT_EQ(msg.readHeader(sMsg.data(), static_cast<unsigned int>(sMsg.size())), 24);
+        ASSERT_TRUE(msg.in_data);
+        EXPECT_EQ(msg.bBufferReused, i > 0);
+        EXPECT_GE(msg.vRecv.capacity(), TEST_MESSAGE_SIZE);
+
+        // feed message data in small chunks - no reallocations
+        size_t nPos = 24;
+        while (!msg.complete())
+        {
+            const int nHandled = msg.readData(sMsg.data() + nPos, min<unsigned int>(1000, static_cast<unsigned int>(sMsg.size() - nPos)));
+            ASSERT_GT(nHandled, 0);
+            nPos += nHandled;
+        }
+        EXPECT_EQ(nPos, sMsg.size());
+        EXPECT_EQ(msg.nBufferGrows, 0u);
+        EXPECT_EQ(msg.vRecv.size(), TEST_MESSAGE_SIZE);
+        EXPECT_EQ(msg.vRecv.str(), sData);
+    }
+    // receive buffer is returned to the pool when the message is destroyed
+    EXPECT_EQ(gl_NetMsgBufferPool.size(), 1u);
+    gl_NetMsgBufferPool.clear();
+}
+
+TEST(netmessage, prealloc_limit)
+{
+    gl_NetMsgBufferPool.clear();
+
+    // header announces the max size message
+    const unsigned int nMessageSize = static_cast<unsigned int>(MAX_PROTOCOL_MESSAGE_LENGTH);
+    CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+    ss << CMessageHeader(TEST_MESSAGE_START, "block", nMessageSize);
+    const string sData(nMessageSize, 'x');
+    ss.write(sData.data(), sData.size());
+    const string sMsg = ss.str();
+
+    {
+        CNetMessage msg(TEST_MESSAGE_START, SER_NETWORK, PROTOCOL_VERSION);
+        EXPECT_EQ(msg.readHeader(sMsg.data(), 24), 24);
+        ASSERT_TRUE(msg.in_data);
+        // only limited buffer is allocated before the data is received
+        EXPECT_LE(msg.vRecv.capacity(), NET_MSG_MAX_PREALLOC_SIZE);
+
+        size_t nPos = 24;
+        while (!msg.complete())
+        {
+            const int nHandled = msg.readData(sMsg.data() + nPos, min<unsigned int>(64 * 1024, static_cast<unsigned int>(sMsg.size() - nPos)));
+            ASSERT_GT(nHandled, 0);
+            nPos += nHandled;
+        }
+        EXPECT_GT(msg.nBufferGrows, 0u);
+        EXPECT_EQ(msg.vRecv.size(), nMessageSize);
+        EXPECT_EQ(msg.vRecv.str(), sData);
+    }
+    gl_NetMsgBufferPool.clear();
+}
@@ -0,0 +1,257 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include <chainparams.h>
+#include <version.h>
+#include <netmsg/peer-msg-queue.h>
+
+#include <pastel_gtest_main.h>
+
+using namespace std;
+using namespace testing;
+
+class TestPeerMessageQueue : public Test
+{
+public:
+    static void SetUpTestSuite()
+    {
+        gl_pPastelTestEnv->InitializeRegTest();
+    }
+
+    static void TearDownTestSuite()
+    {
+        gl_pPastelTestEnv->FinalizeRegTest();
+    }
+
+    void TearDown() override
+    {
+        m_threadGroup.stop_all();
+        m_threadGroup.join_all();
+    }
+
+protected:
+    CServiceThreadGroup m_threadGroup;
+
+    static node_t CreateNode(const uint32_t nIP)
+    {
+        struct in_addr s;
+        s.s_addr = nIP;
+        auto pnode = make_shared<CNode>(INVALID_SOCKET, CAddress(CService(CNetAddr(s), Params().GetDefaultPort())), "", true);
+        pnode->nVersion = PROTOCOL_VERSION;
+        return pnode;
+    }
+
+    static CDataStream CreateMessage(const uint32_t nSeq)
+    {
+        CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
+        ss << nSeq;
+        return ss;
+    }
+
+    void StartWorkers(CPeerMessageQueue &queue, const size_t nThreadCount)
+    {
+        queue.SetThreadCount(nThreadCount, nThreadCount);
+        queue.create_workers(m_threadGroup);
+        // wait for workers to start
+        for (size_t i = 0; (i < 1000) && (queue.GetWorkerCount() < nThreadCount); ++i)
+            this_thread::sleep_for(chrono::milliseconds(1));
+        ASSERT_EQ(queue.GetWorkerCount(), nThreadCount);
+    }
+};
+
+TEST_F(TestPeerMessageQueue, disabled)
+{
+    CPeerMessageQueue queue("test");
+    queue.SetHandler([](node_t&, string&, CDataStream&) {});
+    EXPECT_FALSE(queue.IsEnabled());
+
+    // no workers - message is not accepted and stays with the caller
+    auto pnode = CreateNode(0x0a000001);
+    CDataStream ss = CreateMessage(1);
+    EXPECT_FALSE(queue.Submit(pnode, "test", ss));
+    EXPECT_EQ(ss.size(), sizeof(uint32_t));
+    EXPECT_EQ(queue.size(), 0u);
+}
+
+TEST_F(TestPeerMessageQueue, per_peer_order)
+{
+    constexpr uint32_t TEST_PEER_COUNT = 4;
+    constexpr uint32_t TEST_MESSAGE_COUNT = 500;
+
+    CPeerMessageQueue queue("test", TEST_MESSAGE_COUNT);
+    mutex mtx;
+    map<NodeId, vector<uint32_t>> mapProcessed;
+    queue.SetHandler([&](node_t& pfrom, string& strCommand, CDataStream& vRecv)
+        {
+            uint32_t nSeq = 0;
+            vRecv >> nSeq;
+            // slow down the first peer, others should not wait for it
+            if ((nSeq % 50 == 0) && (pfrom->id % TEST_PEER_COUNT == 0))
+                this_thread::sleep_for(chrono::microseconds(500));
+            unique_lock lock(mtx);
+            mapProcessed[pfrom->id].push_back(nSeq);
+        });
+    StartWorkers(queue, 3);
+    EXPECT_TRUE(queue.IsEnabled());
+
+    vector<node_t> vNodes;
+    for (uint32_t i = 0; i < TEST_PEER_COUNT; ++i)
+        vNodes.push_back(CreateNode(0x0a000001 + i));
+    for (uint32_t nSeq = 0; nSeq < TEST_MESSAGE_COUNT; ++nSeq)
+    {
+        for (auto& pnode : vNodes)
+        {
+            CDataStream ss = CreateMessage(nSeq);
+            ASSERT_TRUE(queue.Submit(pnode, "test", ss));
+        }
+    }
+    queue.WaitForEmpty();
+    EXPECT_EQ(queue.size(), 0u);
+
+    unique_lock lock(mtx);
+    ASSERT_EQ(mapProcessed.size(), TEST_PEER_COUNT);
+    for (const auto& [id, vProcessed] : mapProcessed)
+    {
+        ASSERT_EQ(vProcessed.size(), TEST_MESSAGE_COUNT);
+        for (uint32_t i = 0; i < TEST_MESSAGE_COUNT; ++i)
+            EXPECT_EQ(vProcessed[i], i);
+    }
+}
+
+TEST_F(TestPeerMessageQueue, peer_queue_full)
+{
+    constexpr size_t TEST_MAX_PEER_QUEUE_SIZE = 2;
+
+    CPeerMessageQueue queue("test", TEST_MAX_PEER_QUEUE_SIZE);
+    atomic_bool bStarted(false);
+    atomic_bool bRelease(false);
+    atomic_uint32_t nProcessed(0);
+    queue.SetHandler([&](node_t& pfrom, string& strCommand, CDataStream& vRecv)
+        {
+            bStarted = true;
+            while (!bRelease)
+                this_thread::sleep_for(chrono::milliseconds(1));
+            ++nProcessed;
+        });
+    StartWorkers(queue, 1);
+
+    auto pnode1 = CreateNode(0x0a000001);
+    auto pnode2 = CreateNode(0x0a000002);
+    CDataStream ss = CreateMessage(0);
+    ASSERT_TRUE(queue.Submit(pnode1, "test", ss));
+    for (size_t i = 0; (i < 1000) && !bStarted; ++i)
+        this_thread::sleep_for(chrono::milliseconds(1));
+    ASSERT_TRUE(bStarted);
+
+    // the first message is being processed, the peer queue can hold 2 more
+    for (uint32_t i = 1; i <= TEST_MAX_PEER_QUEUE_SIZE; ++i)
+    {
+        ss = CreateMessage(i);
+        EXPECT_TRUE(queue.Submit(pnode1, "test", ss));
+    }
+    EXPECT_EQ(queue.GetPeerQueueSize(pnode1->id), TEST_MAX_PEER_QUEUE_SIZE);
+    ss = CreateMessage(3);
+    EXPECT_FALSE(queue.Submit(pnode1, "test", ss));
+    EXPECT_FALSE(ss.empty());
+    // other peers are not affected
+    EXPECT_TRUE(queue.Submit(pnode2, "test", ss));
+
+    bRelease = true;
+    queue.WaitForEmpty();
+    EXPECT_EQ(nProcessed.load(), TEST_MAX_PEER_QUEUE_SIZE + 2);
+    EXPECT_EQ(queue.GetPeerQueueSize(pnode1->id), 0u);
+}
+
+TEST_F(TestPeerMessageQueue, peer_queue_bytes_limit)
+{
+    // each test message is 4 bytes
+    constexpr size_t TEST_MAX_PEER_QUEUE_BYTES = 10;
+
+    CPeerMessageQueue queue("test");
+    queue.SetMaxPeerQueueBytes(TEST_MAX_PEER_QUEUE_BYTES);
+    atomic_bool bStarted(false);
+    atomic_bool bRelease(false);
+    atomic_uint32_t nProcessed(0);
+    queue.SetHandler([&](node_t& pfrom, string& strCommand, CDataStream& vRecv)
+        {
+            bStarted = true;
+            while (!bRelease)
+                this_thread::sleep_for(chrono::milliseconds(1));
+            ++nProcessed;
+        });
+    StartWorkers(queue, 1);
+
+    auto pnode = CreateNode(0x0a000001);
+    CDataStream ss = CreateMessage(0);
+    ASSERT_TRUE(queue.Submit(pnode, "test", ss));
+    for (size_t i = 0; (i < 1000) && !bStarted; ++i)
+        this_thread::sleep_for(chrono::milliseconds(1));
+    ASSERT_TRUE(bStarted);
+
+    // message is always accepted to the empty peer queue
+    ss = CreateMessage(1);
+    EXPECT_TRUE(queue.Submit(pnode, "test", ss, 100));
+    ss = CreateMessage(2);
+    EXPECT_TRUE(queue.Submit(pnode, "test", ss, 4));
+    EXPECT_EQ(queue.GetPeerQueueBytes(pnode->id), 8u);
+    // queued messages together with the receive buffer exceed the limit
+    ss = CreateMessage(3);
+    EXPECT_FALSE(queue.Submit(pnode, "test", ss, 4));
+    EXPECT_FALSE(ss.empty());
+    EXPECT_EQ(queue.GetPeerQueueSize(pnode->id), 2u);
+
+    bRelease = true;
+    queue.WaitForEmpty();
+    EXPECT_EQ(nProcessed.load(), 3u);
+    EXPECT_EQ(queue.GetPeerQueueBytes(pnode->id), 0u);
+}
+
+TEST_F(TestPeerMessageQueue, gate)
+{
+    CPeerMessageQueue queue("test");
+    atomic_uint32_t nProcessed(0);
+    queue.SetHandler([&](node_t& pfrom, string& strCommand, CDataStream& vRecv) { ++nProcessed; });
+    // next stage has capacity for one message only
+    atomic_uint32_t nAvailable(1);
+    atomic_uint32_t nReleased(0);
+    queue.SetGate(
+        [&]()
+        {
+            if (!nAvailable)
+                return false;
+            --nAvailable;
+            return true;
+        },
+        [&]() { ++nReleased; });
+    StartWorkers(queue, 2);
+
+    auto pnode1 = CreateNode(0x0a000001);
+    auto pnode2 = CreateNode(0x0a000002);
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        CDataStream ss = CreateMessage(i);
+        ASSERT_TRUE(queue.Submit(pnode1, "test", ss));
+        ss = CreateMessage(i);
+        ASSERT_TRUE(queue.Submit(pnode2, "test", ss));
+    }
+    for (size_t i = 0; (i < 1000) && !nReleased; ++i)
+        this_thread::sleep_for(chrono::milliseconds(1));
+    this_thread::sleep_for(chrono::milliseconds(20));
+    // gate is closed - other messages stay in the peer queues
+    EXPECT_EQ(nProcessed.load(), 1u);
+    EXPECT_EQ(nReleased.load(), 1u);
+    EXPECT_EQ(queue.size(), 3u);
+
+    nAvailable = 10;
+    queue.Resume();
+    queue.WaitForEmpty();
+    EXPECT_EQ(nProcessed.load(), 4u);
+    EXPECT_EQ(nReleased.load(), 4u);
+    EXPECT_EQ(queue.size(), 0u);
+}
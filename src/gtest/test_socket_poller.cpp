@@ -0,0 +1,226 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#ifndef WIN32
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include <netbase.h>
+#include <netmsg/socket-poller.h>
+
+using namespace std;
+using namespace testing;
+
+// test parameter: true - prefer epoll backend (if available), false - poll()
+class PTest_SocketPoller : public TestWithParam<bool>
+{
+public:
+    void SetUp() override
+    {
+        m_pPoller = CSocketPoller::Create(GetParam());
+        ASSERT_NE(m_pPoller, nullptr);
+    }
+
+    void TearDown() override
+    {
+        for (auto& [hSocket1, hSocket2] : m_vPairs)
+        {
+            CloseSocket(hSocket1);
+            CloseSocket(hSocket2);
+        }
+    }
+
+    pair<SOCKET, SOCKET> CreateSocketPair()
+    {
+        int fds[2] = { -1, -1 };
+        EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+        m_vPairs.emplace_back(fds[0], fds[1]);
+        return m_vPairs.back();
+    }
+
+    void ClosePair(const pair<SOCKET, SOCKET>& socketPair)
+    {
+        for (auto it = m_vPairs.begin(); it != m_vPairs.end(); ++it)
+        {
+            if (*it != socketPair)
+                continue;
+            CloseSocket(it->first);
+            CloseSocket(it->second);
+            m_vPairs.erase(it);
+            break;
+        }
+    }
+
+protected:
+    unique_ptr<CSocketPoller> m_pPoller;
+    vector<pair<SOCKET, SOCKET>> m_vPairs;
+};
+
+TEST_P(PTest_SocketPoller, readiness)
+{
+    const auto [hSocket, hPeer] = CreateSocketPair();
+    EXPECT_TRUE(m_pPoller->SetInterest(hSocket, 1, SOCKET_EVENT_RECV));
+    EXPECT_EQ(m_pPoller->size(), 1u);
+
+    // no data yet
+    EXPECT_EQ(m_pPoller->Wait(0), 0);
+    EXPECT_EQ(m_pPoller->GetEvents(hSocket), SOCKET_EVENT_NONE);
+
+    ASSERT_EQ(send(hPeer, "x", 1, 0), 1);
+    EXPECT_EQ(m_pPoller->Wait(100), 1);
+    EXPECT_TRUE(m_pPoller->GetEvents(hSocket) & SOCKET_EVENT_RECV);
+
+    // level-triggered - reported again until data is read
+    EXPECT_EQ(m_pPoller->Wait(0), 1);
+    char ch;
+    ASSERT_EQ(recv(hSocket, &ch, 1, 0), 1);
+    EXPECT_EQ(m_pPoller->Wait(0), 0);
+}
+
+TEST_P(PTest_SocketPoller, interest_change)
+{
+    auto [hSocket, hPeer] = CreateSocketPair();
+    ASSERT_EQ(send(hPeer, "x", 1, 0), 1);
+
+    // socket is writable and has data to read, but we are interested only in sending
+    EXPECT_TRUE(m_pPoller->SetInterest(hSocket, 1, SOCKET_EVENT_SEND));
+    EXPECT_EQ(m_pPoller->Wait(100), 1);
+    EXPECT_EQ(m_pPoller->GetEvents(hSocket), SOCKET_EVENT_SEND);
+
+    // send buffer is drained - wait for receiving data
+    EXPECT_TRUE(m_pPoller->SetInterest(hSocket, 1, SOCKET_EVENT_RECV));
+    EXPECT_EQ(m_pPoller->Wait(100), 1);
+    EXPECT_EQ(m_pPoller->GetEvents(hSocket), SOCKET_EVENT_RECV);
+
+    // receive buffer is full - nothing to watch for
+    EXPECT_TRUE(m_pPoller->SetInterest(hSocket, 1, SOCKET_EVENT_NONE));
+    EXPECT_EQ(m_pPoller->Wait(0), 0);
+    EXPECT_EQ(m_pPoller->size(), 1u);
+
+    // errors are always reported
+    CloseSocket(hPeer);
+    m_vPairs.back().second = INVALID_SOCKET;
+    EXPECT_EQ(m_pPoller->Wait(100), 1);
+    EXPECT_TRUE(m_pPoller->GetEvents(hSocket) & SOCKET_EVENT_ERROR);
+}
+
+TEST_P(PTest_SocketPoller, remove_stale)
+{
+    const auto pair1 = CreateSocketPair();
+    const auto pair2 = CreateSocketPair();
+    EXPECT_TRUE(m_pPoller->SetInterest(pair1.first, 1, SOCKET_EVENT_RECV));
+    EXPECT_TRUE(m_pPoller->SetInterest(pair2.first, 2, SOCKET_EVENT_RECV));
+    EXPECT_EQ(m_pPoller->size(), 2u);
+
+    ClosePair(pair1);
+    m_pPoller->RemoveStale({ pair2.first });
+    EXPECT_EQ(m_pPoller->size(), 1u);
+
+    // socket descriptor is reused by the new connection
+    const auto pair3 = CreateSocketPair();
+    EXPECT_TRUE(m_pPoller->SetInterest(pair3.first, 3, SOCKET_EVENT_RECV));
+    // the same descriptor registered again for another owner
+    ClosePair(pair3);
+    const auto pair4 = CreateSocketPair();
+    EXPECT_TRUE(m_pPoller->SetInterest(pair4.first, 4, SOCKET_EVENT_RECV));
+    m_pPoller->RemoveStale({ pair2.first, pair4.first });
+    EXPECT_EQ(m_pPoller->size(), 2u);
+
+    ASSERT_EQ(send(pair4.second, "x", 1, 0), 1);
+    EXPECT_EQ(m_pPoller->Wait(100), 1);
+    EXPECT_TRUE(m_pPoller->GetEvents(pair4.first) & SOCKET_EVENT_RECV);
+    EXPECT_EQ(m_pPoller->GetEvents(pair2.first), SOCKET_EVENT_NONE);
+
+    m_pPoller->Remove(pair4.first);
+    EXPECT_EQ(m_pPoller->size(), 1u);
+    EXPECT_EQ(m_pPoller->GetEvents(pair4.first), SOCKET_EVENT_NONE);
+}
+
+TEST_P(PTest_SocketPoller, ready_sockets)
+{
+    const auto pair1 = CreateSocketPair();
+    const auto pair2 = CreateSocketPair();
+    const auto pair3 = CreateSocketPair();
+    EXPECT_TRUE(m_pPoller->SetInterest(pair1.first, 1, SOCKET_EVENT_RECV));
+    EXPECT_TRUE(m_pPoller->SetInterest(pair2.first, 2, SOCKET_EVENT_RECV));
+    EXPECT_TRUE(m_pPoller->SetInterest(pair3.first, 3, SOCKET_EVENT_SEND));
+
+    vector<CSocketPoller::socket_event_t> vReady;
+    ASSERT_EQ(send(pair2.second, "x", 1, 0), 1);
+    EXPECT_EQ(m_pPoller->Wait(100), 2);
+    m_pPoller->GetReadySockets(vReady);
+    ASSERT_EQ(vReady.size(), 2u);
+    sort(vReady.begin(), vReady.end(), [](const auto& a, const auto& b) { return a.nOwnerId < b.nOwnerId; });
+    EXPECT_EQ(vReady[0].hSocket, pair2.first);
+    EXPECT_EQ(vReady[0].nOwnerId, 2);
+    EXPECT_TRUE(vReady[0].nEvents & SOCKET_EVENT_RECV);
+    EXPECT_EQ(vReady[1].hSocket, pair3.first);
+    EXPECT_EQ(vReady[1].nOwnerId, 3);
+    EXPECT_EQ(vReady[1].nEvents, SOCKET_EVENT_SEND);
+
+    // socket is not removed if it is registered by another owner
+    m_pPoller->Remove(pair2.first, 1);
+    EXPECT_EQ(m_pPoller->size(), 3u);
+    m_pPoller->Remove(pair2.first, 2);
+    EXPECT_EQ(m_pPoller->size(), 2u);
+    m_pPoller->GetReadySockets(vReady);
+    ASSERT_EQ(vReady.size(), 1u);
+    EXPECT_EQ(vReady[0].nOwnerId, 3);
+
+    EXPECT_TRUE(m_pPoller->SetInterest(pair3.first, 3, SOCKET_EVENT_NONE));
+    EXPECT_EQ(m_pPoller->Wait(0), 0);
+    m_pPoller->GetReadySockets(vReady);
+    EXPECT_TRUE(vReady.empty());
+}
+
+/**
+ * Socket poller stress benchmark - hundreds of fake peers,
+ * only some of them are sending messages on each iteration.
+ * Run with --gtest_also_run_disabled_tests.
+ */
+TEST_P(PTest_SocketPoller, DISABLED_stress_benchmark)
+{
+    constexpr size_t TEST_PEER_COUNT = 400;
+    constexpr size_t TEST_ITERATIONS = 20'000;
+    constexpr size_t TEST_ACTIVE_PEER_STEP = 50;
+
+    vector<pair<SOCKET, SOCKET>> vPeers;
+    vPeers.reserve(TEST_PEER_COUNT);
+    for (size_t i = 0; i < TEST_PEER_COUNT; ++i)
+        vPeers.push_back(CreateSocketPair());
+
+    size_t nReceived = 0;
+    char buf[64];
+    vector<CSocketPoller::socket_event_t> vReady;
+    // interest is registered once, like in the socket handler thread
+    for (size_t i = 0; i < vPeers.size(); ++i)
+        m_pPoller->SetInterest(vPeers[i].first, static_cast<int64_t>(i), SOCKET_EVENT_RECV);
+    const auto start = chrono::steady_clock::now();
+    for (size_t nIter = 0; nIter < TEST_ITERATIONS; ++nIter)
+    {
+        for (size_t i = nIter % TEST_ACTIVE_PEER_STEP; i < vPeers.size(); i += TEST_ACTIVE_PEER_STEP)
+            send(vPeers[i].second, "ping", 4, 0);
+        if (m_pPoller->Wait(50) <= 0)
+            continue;
+        // only ready sockets are serviced
+        m_pPoller->GetReadySockets(vReady);
+        for (const auto& socketEvent : vReady)
+        {
+            if (socketEvent.nEvents & SOCKET_EVENT_RECV)
+                nReceived += recv(socketEvent.hSocket, buf, sizeof(buf), 0) > 0 ? 1 : 0;
+        }
+    }
+    const auto elapsed = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+    EXPECT_GT(nReceived, 0u);
+    cout << m_pPoller->GetName() << ": " << TEST_PEER_COUNT << " peers, " << TEST_ITERATIONS
+         << " iterations, " << nReceived << " messages received in " << elapsed.count() << "ms" << endl;
+}
+
+INSTANTIATE_TEST_SUITE_P(socket_poller, PTest_SocketPoller, Values(true, false));
+
+#endif // !WIN32
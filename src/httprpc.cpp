@@ -64,6 +64,8 @@ private:
 static string strRPCUserColonPass;
 /* Stored RPC timer interface (for unregistration) */
 static HTTPRPCTimerInterface* httpRPCTimerInterface = 0;
+/* Chunk size for the chunked RPC replies, 0 - chunked replies disabled */
+static size_t nRPCReplyChunkSize = DEFAULT_HTTP_REPLY_CHUNK_SIZE;
 
 static void JSONErrorReply(HTTPRequest* req, const UniValue& objError, const UniValue& id)
 {
@@ -151,7 +153,10 @@ static bool HTTPReq_JSONRPC(HTTPRequest* req, const string &)
             throw JSONRPCError(RPC_PARSE_ERROR, "Top-level object parse error");
 
         req->WriteHeader("Content-Type", "application/json");
-        req->WriteReply(to_integral_type(HTTPStatusCode::OK), strReply);
+        if (nRPCReplyChunkSize)
+            req->WriteReplyChunked(to_integral_type(HTTPStatusCode::OK), std::move(strReply), nRPCReplyChunkSize);
+        else
+            req->WriteReply(to_integral_type(HTTPStatusCode::OK), strReply);
     } catch (const UniValue& objError)
     {
         JSONErrorReply(req, objError, jreq.id());
@@ -186,6 +191,8 @@ bool StartHTTPRPC()
     if (!InitRPCAuthentication())
         return false;
 
+    const int64_t nChunkSize = GetArg("-rpcchunksize", DEFAULT_HTTP_REPLY_CHUNK_SIZE);
+    nRPCReplyChunkSize = nChunkSize > 0 ? static_cast<size_t>(nChunkSize) : 0;
     RegisterHTTPHandler("/", true, HTTPReq_JSONRPC);
 
     assert(EventBase());
@@ -11,6 +11,7 @@
 #include <deque>
 #include <thread>
 #include <functional>
+#include <memory>
 
 #include <compat.h>
 
@@ -655,6 +656,45 @@ void HTTPRequest::WriteReply(int nStatus, const string& strReply)
     req = 0; // transferred back to main thread
 } //-V773 : ev will be release by the callback function httpevent_callback_fn later, so this PVS warning is a false warning
 
+/** Cleanup callback for the reply data referenced by the evbuffer chunk. */
+static void http_reply_chunk_cleanup_cb(const void*, size_t, void* arg)
+{
+    delete static_cast<shared_ptr<const string>*>(arg);
+}
+
+void HTTPRequest::WriteReplyChunked(int nStatus, string &&strReply, const size_t nChunkSize)
+{
+    assert(!replySent && req);
+    if (!nChunkSize || strReply.size() <= nChunkSize)
+    {
+        WriteReply(nStatus, strReply);
+        return;
+    }
+    const auto pReply = make_shared<const string>(std::move(strReply));
+    struct evhttp_request* pReq = req;
+    // Send event to main http thread to send reply chunks
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [pReq, pReply, nStatus, nChunkSize]()
+    {
+        evhttp_send_reply_start(pReq, nStatus, nullptr);
+        struct evbuffer* evb = evbuffer_new();
+        for (size_t nOffset = 0; evb && (nOffset < pReply->size()); nOffset += nChunkSize)
+        {
+            const size_t nSize = min(nChunkSize, pReply->size() - nOffset);
+            // reply data is not copied, chunk references the reply string until it is written to the socket
+            evbuffer_add_reference(evb, pReply->data() + nOffset, nSize,
+                http_reply_chunk_cleanup_cb, new shared_ptr<const string>(pReply));
+            evhttp_send_reply_chunk(pReq, evb);
+            evbuffer_drain(evb, evbuffer_get_length(evb));
+        }
+        if (evb)
+            evbuffer_free(evb);
+        evhttp_send_reply_end(pReq);
+    });
+    ev->trigger(0);
+    replySent = true;
+    req = 0; // transferred back to main thread
+} //-V773 : ev will be release by the callback function httpevent_callback_fn later
+
 CService HTTPRequest::GetPeer()
 {
     evhttp_connection* con = evhttp_request_get_connection(req);
@@ -10,6 +10,8 @@
 constexpr int DEFAULT_HTTP_THREADS = 4;
 constexpr int DEFAULT_HTTP_WORKQUEUE = 512;
 constexpr int DEFAULT_HTTP_SERVER_TIMEOUT = 30;
+// size of the chunk for the chunked replies in bytes, 0 - chunked transfer encoding is disabled
+constexpr size_t DEFAULT_HTTP_REPLY_CHUNK_SIZE = 0;
 
 struct evhttp_request;
 struct event_base;
@@ -112,6 +114,19 @@ public:
      * main thread, do not call any other HTTPRequest methods after calling this.
      */
     virtual void WriteReply(int nStatus, const std::string& strReply = "");
+
+    /**
+     * Write HTTP reply using chunked transfer encoding.
+     * nStatus is the HTTP status code to send.
+     * strReply is the body of the reply, sent in chunks of nChunkSize bytes.
+     * All chunks are queued to the connection output buffer at once, chunks
+     * reference the reply string instead of copying it, so the reply is not
+     * duplicated in memory. There is no backpressure - libevent writes the
+     * chunks to the socket as it becomes writable.
+     *
+     * @note Same restrictions as for WriteReply apply.
+     */
+    virtual void WriteReplyChunked(int nStatus, std::string &&strReply, const size_t nChunkSize);
 };
 
 /** Event handler closure.
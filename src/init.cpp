@@ -69,6 +69,8 @@
 #include <orphan-tx.h>
 #include <netmsg/netconsts.h>
 #include <netmsg/nodemanager.h>
+#include <netmsg/block-cache.h>
+#include <netmsg/compact-block.h>
 
 using namespace std;
 
@@ -424,6 +426,7 @@ string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-exportdir=<dir>", translate("Specify directory to be used when exporting data"));
     strUsage += HelpMessageOpt("-dbcache=<n>", strprintf(translate("Set database cache size in megabytes (%d to %d, default: %d)"), nMinDbCache, nMaxDbCache, nDefaultDbCache));
     strUsage += HelpMessageOpt("-loadblock=<file>", translate("Imports blocks from external blk000??.dat file") + " " + translate("on startup"));
+    strUsage += HelpMessageOpt("-blockcachemaxmem=<n>", strprintf(translate("Keep at most <n> MiB of blocks waiting for revalidation in memory, the rest is stored on disk (0 = no limit, default: %zu)"), DEFAULT_BLOCK_CACHE_MAX_MEM_MB));
     strUsage += HelpMessageOpt("-maxorphantx=<n>", strprintf(translate("Keep at most <n> unconnectable transactions in memory (default: %zu)"), DEFAULT_MAX_ORPHAN_TRANSACTIONS));
     strUsage += HelpMessageOpt("-par=<n>", strprintf(translate("Set the number of script verification threads (-%u to %zu, 0 = auto, <0 = leave that many cores free, default: %zu)"),
         GetNumCores(), MAX_SCRIPTCHECK_THREADS, DEFAULT_SCRIPTCHECK_THREADS));
@@ -440,12 +443,19 @@ string HelpMessage(HelpMessageMode mode)
     strUsage += HelpMessageOpt("-txindex", strprintf(translate("Maintain a full transaction index, used by the getrawtransaction rpc call (default: %u)"), 0));
     strUsage += HelpMessageOpt("-rewindchain=<block_hash>", translate("Rewind chain to specified block hash"));
     strUsage += HelpMessageOpt("-repairticketdb", translate("Repair ticket database from the blockchain"));
+    strUsage += HelpMessageOpt("-mnsigthreads=<n>", strprintf(translate("Set the number of masternode messages signature verification threads (0 = auto, up to %zu, default: %zu)"),
+        MAX_MN_SIGVERIFY_THREADS, DEFAULT_MN_SIGVERIFY_THREADS));
+    strUsage += HelpMessageOpt("-mnmsgthreads=<n>", strprintf(translate("Set the number of masternode messages processing threads (0 = process in the message handler thread, up to %zu, default: %zu)"),
+        MAX_MN_MSG_THREADS, DEFAULT_MN_MSG_THREADS));
+    strUsage += HelpMessageOpt("-mnhistorydepth=<n>", strprintf(translate("Number of blocks to keep historical top masternodes for, 0 to keep all (default: %u)"), DEFAULT_MN_HISTORY_DEPTH));
+    strUsage += HelpMessageOpt("-ticketcachesize=<n>", strprintf(translate("Max number of decoded tickets cached per ticket type, 0 to disable ticket cache (default: %u)"), DEFAULT_TICKET_CACHE_SIZE));
 
     strUsage += HelpMessageGroup(translate("Connection options:"));
     strUsage += HelpMessageOpt("-addnode=<ip>", translate("Add a node to connect to and attempt to keep the connection open"));
     strUsage += HelpMessageOpt("-banscore=<n>", strprintf(translate("Threshold for disconnecting misbehaving peers (default: %u)"), 100));
     strUsage += HelpMessageOpt("-bantime=<n>", strprintf(translate("Number of seconds to keep misbehaving peers from reconnecting (default: %u)"), 86400));
     strUsage += HelpMessageOpt("-bind=<addr>", translate("Bind to given address and always listen on it. Use [host]:port notation for IPv6"));
+    strUsage += HelpMessageOpt("-compactblocks", strprintf(translate("Use compact block relay, blocks are reconstructed from the mempool transactions (default: %u)"), DEFAULT_COMPACT_BLOCKS));
     strUsage += HelpMessageOpt("-connect=<ip>", translate("Connect only to the specified node(s)"));
     strUsage += HelpMessageOpt("-discover", translate("Discover own IP addresses (default: 1 when listening and no -externalip or -proxy)"));
     strUsage += HelpMessageOpt("-dns", translate("Allow DNS lookups for -addnode, -seednode and -connect") + " " + translate("(default: 1)"));
@@ -598,6 +608,7 @@ string HelpMessage(HelpMessageMode mode)
     if (showDebug) {
         strUsage += HelpMessageOpt("-rpcworkqueue=<n>", strprintf("Set the depth of the work queue to service RPC calls (default: %d)", DEFAULT_HTTP_WORKQUEUE));
         strUsage += HelpMessageOpt("-rpcservertimeout=<n>", strprintf("Timeout during HTTP requests (default: %d)", DEFAULT_HTTP_SERVER_TIMEOUT));
+        strUsage += HelpMessageOpt("-rpcchunksize=<n>", strprintf("Send RPC replies larger than <n> bytes using chunked transfer encoding with <n> bytes per chunk, 0 to disable (default: %u)", DEFAULT_HTTP_REPLY_CHUNK_SIZE));
     }
 
     // Disabled until we can lock notes and also tune performance of libsnark which by default uses multiple threads
@@ -1019,10 +1030,13 @@ bool AppInit2(CServiceThreadGroup& threadGroup, CScheduler& scheduler)
     }
 
     // Make sure enough file descriptors are available
-    int nBind = max((int)mapArgs.count("-bind") + (int)mapArgs.count("-whitebind"), 1);
     uint32_t nFdSoftLimit = static_cast<uint32_t>(GetArg("-fdsoftlimit", DEFAULT_FD_SOFT_LIMIT));
     gl_nMaxConnections = static_cast<uint32_t>(GetArg("-maxconnections", DEFAULT_MAX_PEER_CONNECTIONS));
+#ifdef WIN32
+    // select() is used to poll sockets on Windows
+    int nBind = max((int)mapArgs.count("-bind") + (int)mapArgs.count("-whitebind"), 1);
     gl_nMaxConnections = min(gl_nMaxConnections, static_cast<uint32_t>(FD_SETSIZE - nBind - MIN_CORE_FILEDESCRIPTORS));
+#endif
     const uint32_t nFdLimit = RaiseFileDescriptorLimit(max(nFdSoftLimit, gl_nMaxConnections + MIN_CORE_FILEDESCRIPTORS));
     LogPrintf("File descriptor limit: %u\n", nFdLimit);
     if (nFdLimit < MIN_CORE_FILEDESCRIPTORS)
@@ -1191,6 +1205,8 @@ bool AppInit2(CServiceThreadGroup& threadGroup, CScheduler& scheduler)
 
     if (GetBoolArg("-peerbloomfilters", true))
         nLocalServices |= NODE_BLOOM;
+    if (GetBoolArg("-compactblocks", DEFAULT_COMPACT_BLOCKS))
+        nLocalServices |= NODE_COMPACT_BLOCKS;
 
     nMaxTipAge = GetArg("-maxtipage", DEFAULT_MAX_TIP_AGE);
     if (nMaxTipAge != DEFAULT_MAX_TIP_AGE)
@@ -1617,6 +1633,10 @@ bool AppInit2(CServiceThreadGroup& threadGroup, CScheduler& scheduler)
     LogPrintf("* Using %.1fMiB for block index database\n", nBlockTreeDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for chain state database\n", nCoinDBCache * (1.0 / 1024 / 1024));
     LogPrintf("* Using %.1fMiB for in-memory UTXO set\n", nCoinCacheUsage * (1.0 / 1024 / 1024));
+    const size_t nBlockCacheMaxMem = static_cast<size_t>(max<int64_t>(0, GetArg("-blockcachemaxmem", DEFAULT_BLOCK_CACHE_MAX_MEM_MB))) << 20;
+    gl_BlockCache.set_max_mem_usage(nBlockCacheMaxMem, GetDataDir() / "blockcache");
+    if (nBlockCacheMaxMem)
+        LogPrintf("* Using %.1fMiB for blocks in revalidation cache\n", nBlockCacheMaxMem * (1.0 / 1024 / 1024));
 
     // connect Pastel Ticket txmempool tracker
     mempool.AddTxMemPoolTracker(CPastelTicketProcessor::GetTxMemPoolTracker());
@@ -2025,11 +2045,13 @@ bool AppInit2(CServiceThreadGroup& threadGroup, CScheduler& scheduler)
         if (!RewindChainToBlock(sErrorMsg, chainparams, sRewindChainBlockHash))
             return InitError(sErrorMsg);
 	}
-    if (mapArgs.count("-repairticketdb"))
     {
+        // build ticket indexes missing in the ticket DB created by the previous versions
         LOCK(cs_main);
-        masterNodeCtrl.masternodeTickets.RepairTicketDB(true);
+        masterNodeCtrl.masternodeTickets.BuildTicketTxIdIndex();
     }
+    if (mapArgs.count("-repairticketdb") || masterNodeCtrl.masternodeTickets.IsRepairPending())
+        masterNodeCtrl.masternodeTickets.RepairTicketDB(true);
 		
     // ********************************************************* Step 13: finished
 
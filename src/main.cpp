@@ -42,6 +42,7 @@
 #include <wallet/asyncrpcoperation_sendmany.h>
 #include <wallet/asyncrpcoperation_shieldcoinbase.h>
 #include <netmsg/block-cache.h>
+#include <netmsg/compact-block.h>
 #include <orphan-tx.h>
 #include <netmsg/nodestate.h>
 #include <netmsg/node.h>
@@ -2067,6 +2068,8 @@ static bool ConnectTip(CValidationState& state, const CChainParams& chainparams,
 
     // Update chainActive & related variables.
     UpdateTip(chainparams, pindexNew);
+    // wake up cached blocks waiting for this block to be connected
+    gl_BlockCache.block_connected(pindexNew->GetBlockHash());
     // Tell wallet about transactions that went from mempool
     // to conflicted:
     for (const auto &tx : txConflicted)
@@ -2818,12 +2821,50 @@ bool FindUndoPos(CValidationState &state, int nFile, CDiskBlockPos &pos, unsigne
     return true;
 }
 
+/**
+ * Get proof-of-work checks required for the block header.
+ * Proof of work is not checked for the ingested blocks (up to TOP_INGEST_BLOCK),
+ * only Equihash solution is checked in regtest mode.
+ * Reads chainActive and mapBlockIndex - cs_main should be locked.
+ * 
+ * \param chainparams - chain parameters
+ * \param hashBlock - block hash
+ * \return proof-of-work checks to run for the block header
+ */
+BlockPoWCheck GetBlockPoWCheck(const CChainParams& chainparams, const uint256& hashBlock)
+{
+    //INGEST->!!!
+    if (chainparams.IsRegTest())
+        return BlockPoWCheck::EQUIHASH;
+    if (chainActive.Tip() && chainActive.Tip()->nHeight >= TOP_INGEST_BLOCK) //if current is TOP_INGEST_BLOCK, no more skips
+    {
+        const auto it = mapBlockIndex.find(hashBlock);
+        if (it != mapBlockIndex.cend() && it->second->nHeight > TOP_INGEST_BLOCK) //if new block is TOP_INGEST_BLOCK+1, no more skips
+            return BlockPoWCheck::FULL;
+    }
+    //<-INGEST!!!
+    return BlockPoWCheck::NONE;
+}
+
 bool CheckBlockHeader(
     const CBlockHeader& block,
     uint256& hashBlock,
     CValidationState& state,
     const CChainParams& chainparams,
     bool fCheckPOW)
+{
+    if (hashBlock.IsNull())
+        hashBlock = block.GetHash();
+    return CheckBlockHeader(block, hashBlock, state, chainparams,
+        fCheckPOW ? GetBlockPoWCheck(chainparams, hashBlock) : BlockPoWCheck::NONE);
+}
+
+bool CheckBlockHeader(
+    const CBlockHeader& block,
+    uint256& hashBlock,
+    CValidationState& state,
+    const CChainParams& chainparams,
+    const BlockPoWCheck powCheck)
 {
     string strRejectReasonDetails;
     if (hashBlock.IsNull())
@@ -2837,43 +2878,21 @@ bool CheckBlockHeader(
     }
     
     const auto &consensusParams = chainparams.GetConsensus();
-    //INGEST->!!!
-    if (chainparams.IsRegTest())
+    // Check Equihash solution is valid
+    if ((powCheck != BlockPoWCheck::NONE) && !CheckEquihashSolution(&block, consensusParams))
     {
-        // Check Equihash solution is valid
-        if (fCheckPOW && !CheckEquihashSolution(&block, consensusParams))
-        {
-            strRejectReasonDetails = strprintf("Equihash solution invalid for block %s", hashBlock.ToString());
-            return state.DoS(100, error("%s: %s", __func__, strRejectReasonDetails),
-                REJECT_INVALID, "invalid-solution", false, strRejectReasonDetails);
-        }
+        strRejectReasonDetails = strprintf("Equihash solution invalid for block %s", hashBlock.ToString());
+        return state.DoS(100, error("%s: %s", __func__, strRejectReasonDetails),
+            REJECT_INVALID, "invalid-solution", false, strRejectReasonDetails);
     }
-    else if (chainActive.Tip() && chainActive.Tip()->nHeight >= TOP_INGEST_BLOCK) { //if current is TOP_INGEST_BLOCK, no more skips
 
-        const auto it = mapBlockIndex.find(hashBlock);
-        if (it != mapBlockIndex.cend() && it->second->nHeight > TOP_INGEST_BLOCK) { //if new block is TOP_INGEST_BLOCK+1, no more skips
-    //<-INGEST!!!
-         
-            // Check Equihash solution is valid
-            if (fCheckPOW && !CheckEquihashSolution(&block, consensusParams))
-            {
-                strRejectReasonDetails = strprintf("Equihash solution invalid for block %s", hashBlock.ToString());
-                return state.DoS(100, error("%s: %s", __func__, strRejectReasonDetails),
-                    REJECT_INVALID, "invalid-solution", false, strRejectReasonDetails);
-            }
-    
-            // Check proof of work matches claimed amount
-            if (fCheckPOW && !CheckProofOfWork(hashBlock, block.nBits, consensusParams))
-            {
-                strRejectReasonDetails = strprintf("proof of work failed for block %s", hashBlock.ToString());
-                return state.DoS(50, error("%s: %s", __func__, strRejectReasonDetails),
-								 REJECT_INVALID, "high-hash", false, strRejectReasonDetails);
-            }
-            //INGEST->!!!
-        }
+    // Check proof of work matches claimed amount
+    if ((powCheck == BlockPoWCheck::FULL) && !CheckProofOfWork(hashBlock, block.nBits, consensusParams))
+    {
+        strRejectReasonDetails = strprintf("proof of work failed for block %s", hashBlock.ToString());
+        return state.DoS(50, error("%s: %s", __func__, strRejectReasonDetails),
+                         REJECT_INVALID, "high-hash", false, strRejectReasonDetails);
     }
-    //<-INGEST!!!
-    
 
     // Check timestamp
     const int64_t blockTime = block.GetBlockTime();
@@ -2889,22 +2908,32 @@ bool CheckBlockHeader(
     return true;
 }
 
-bool CheckBlock(
+/**
+ * Context-free block checks: header (version, proof of work, timestamp), merkle root,
+ * size limits and transactions.
+ * These checks do not access chain state and tickets and can be executed in parallel without cs_main.
+ * 
+ * \param block - block to check
+ * \param hashBlock - block hash, calculated if null
+ * \param state - validation state
+ * \param chainparams - chain parameters
+ * \param verifier - proof verifier
+ * \param powCheck - proof-of-work checks to run (see GetBlockPoWCheck)
+ * \param fCheckMerkleRoot - check merkle root of the block
+ * \return true if block passed all context-free checks
+ */
+bool CheckBlockContextFree(
     const CBlock& block,
     uint256& hashBlock,
     CValidationState& state,
     const CChainParams& chainparams,
     libzcash::ProofVerifier& verifier,
-    const bool fCheckPOW,
-    const bool fCheckMerkleRoot,
-    const bool fSkipSnEligibilityChecks,
-    const CBlockIndex* pindexPrev)
+    const BlockPoWCheck powCheck,
+    const bool fCheckMerkleRoot)
 {
-    // These are checks that are independent of context.
-
     // Check that the header is valid (particularly PoW).  This is mostly
     // redundant with the call in AcceptBlockHeader.
-    if (!CheckBlockHeader(block, hashBlock, state, chainparams, fCheckPOW))
+    if (!CheckBlockHeader(block, hashBlock, state, chainparams, powCheck))
         return false;
 
     string strRejectReasonDetails;
@@ -2980,32 +3009,9 @@ bool CheckBlock(
             REJECT_INVALID, "bad-cb-missing", false, strRejectReasonDetails);
     }
 
-    // checks for the block mined by MasterNode with signature of the previous block's merkle root
-    CPastelIDRegTicket mnidTicket;
-    if (!block.sPastelID.empty())
-    {
-        string sPastelID = block.sPastelID;
-        mnidTicket.SetKeyOne(std::move(sPastelID));
-
-        // check that this Pastel ID is registered by MasterNode (mnid)
-        if (!masterNodeCtrl.masternodeTickets.FindTicket(mnidTicket))
-        {
-            strRejectReasonDetails = strprintf("registration ticket with mnid='%s' not found", block.sPastelID);
-            return state.DoS(0, error("%s: %s", __func__, strRejectReasonDetails),
-                REJECT_MISSING_INPUTS, "mnid-not-registered", false, strRejectReasonDetails);
-        }
-        if (mnidTicket.isPersonal())
-        {
-            strRejectReasonDetails = strprintf("[%s] refers to personal Pastel ID registration ticket", block.sPastelID);
-            return state.DoS(100, error("%s: %s", __func__, strRejectReasonDetails),
-                REJECT_INVALID, "personal-pastel-id", false, strRejectReasonDetails);
-        }
-    }
-
     // Check transactions
     size_t nCoinBaseTransactions = 0;
     unsigned int nSigOps = 0;
-    const bool bSnEligibilityCheckAllowed = masterNodeCtrl.SnEligibilityCheckAllowed();
     for (const auto& tx : block.vtx)
     {
         if (tx.IsCoinBase())
@@ -3029,6 +3035,70 @@ bool CheckBlock(
             REJECT_INVALID, "bad-blk-sigops", true, strRejectReasonDetails);
     }
 
+    return true;
+}
+
+/**
+ * Check that the block is mined by MasterNode with registered Pastel ID (mnid).
+ * Block that refers to the unknown Pastel ID is rejected with REJECT_MISSING_INPUTS,
+ * mnid registration ticket can be accepted later.
+ * Reads masternode tickets - should not be called in parallel with the block processing.
+ * 
+ * \param block - block to check
+ * \param state - validation state
+ * \param mnidTicket - returns mnid registration ticket if block has Pastel ID
+ * \return true if block has no Pastel ID or mnid registration ticket is valid
+ */
+bool CheckBlockMnidTicket(const CBlock& block, CValidationState& state, CPastelIDRegTicket &mnidTicket)
+{
+    string strRejectReasonDetails;
+    if (!block.sPastelID.empty())
+    {
+        string sPastelID = block.sPastelID;
+        mnidTicket.SetKeyOne(std::move(sPastelID));
+
+        // check that this Pastel ID is registered by MasterNode (mnid)
+        if (!masterNodeCtrl.masternodeTickets.FindTicket(mnidTicket))
+        {
+            strRejectReasonDetails = strprintf("registration ticket with mnid='%s' not found", block.sPastelID);
+            return state.DoS(0, error("%s: %s", __func__, strRejectReasonDetails),
+                REJECT_MISSING_INPUTS, "mnid-not-registered", false, strRejectReasonDetails);
+        }
+        if (mnidTicket.isPersonal())
+        {
+            strRejectReasonDetails = strprintf("[%s] refers to personal Pastel ID registration ticket", block.sPastelID);
+            return state.DoS(100, error("%s: %s", __func__, strRejectReasonDetails),
+                REJECT_INVALID, "personal-pastel-id", false, strRejectReasonDetails);
+        }
+    }
+    return true;
+}
+
+bool CheckBlock(
+    const CBlock& block,
+    uint256& hashBlock,
+    CValidationState& state,
+    const CChainParams& chainparams,
+    libzcash::ProofVerifier& verifier,
+    const bool fCheckPOW,
+    const bool fCheckMerkleRoot,
+    const bool fSkipSnEligibilityChecks,
+    const CBlockIndex* pindexPrev)
+{
+    if (hashBlock.IsNull())
+        hashBlock = block.GetHash();
+    const BlockPoWCheck powCheck = fCheckPOW ? GetBlockPoWCheck(chainparams, hashBlock) : BlockPoWCheck::NONE;
+    // These are checks that are independent of context.
+    if (!CheckBlockContextFree(block, hashBlock, state, chainparams, verifier, powCheck, fCheckMerkleRoot))
+        return false;
+
+    // checks for the block mined by MasterNode with signature of the previous block's merkle root
+    CPastelIDRegTicket mnidTicket;
+    if (!CheckBlockMnidTicket(block, state, mnidTicket))
+        return false;
+
+    string strRejectReasonDetails;
+    const bool bSnEligibilityCheckAllowed = masterNodeCtrl.SnEligibilityCheckAllowed();
     // check only blocks that were mined/generated recently within last 30 mins
     if (bSnEligibilityCheckAllowed && block.HasPrevBlockSignature() && !fSkipSnEligibilityChecks &&
         (block.GetBlockTime() > (GetTime() - BLOCK_AGE_TO_VALIDATE_SIGNATURE_SECS)) &&
@@ -3389,6 +3459,8 @@ bool MarkBlockAsReceived(const uint256& hash)
             nodeState->nBlocksInFlight--;
             nodeState->nStallingSince = 0;
             mapBlocksInFlight.erase(itInFlight);
+            // block is not reconstructed from the compact block anymore
+            nodeState->mapPartialBlocks.erase(hash);
         }
         return true;
     }
@@ -3413,21 +3485,61 @@ bool ProcessNewBlock(CValidationState &state, const CChainParams& chainparams,
 {
     // Preliminary checks
     auto verifier = libzcash::ProofVerifier::Disabled();
-    uint256 hashBlock;
-    const bool bBlockChecked = CheckBlock(*pblock, hashBlock, state, chainparams, verifier, true, true, true);
+    uint256 hashBlock = pblock->GetHash();
+    BlockPoWCheck powCheck;
+    {
+        LOCK(cs_main);
+        powCheck = GetBlockPoWCheck(chainparams, hashBlock);
+    }
+    // mnid registration ticket is checked by ProcessCheckedBlock
+    if (!CheckBlockContextFree(*pblock, hashBlock, state, chainparams, verifier, powCheck, true))
+    {
+        {
+            LOCK(cs_main);
+            MarkBlockAsReceived(hashBlock);
+        }
+        if (!state.GetRejectReason().empty())
+            return error("%s: CheckBlock %s FAILED, reject reason: %s", 
+                __func__, hashBlock.ToString(), state.GetRejectReason());
 
+        return error("%s: CheckBlock FAILED", __func__);
+    }
+    return ProcessCheckedBlock(state, chainparams, pfrom, pblock, hashBlock, fForceProcessing, dbp);
+}
+
+/**
+ * Process new block that passed context-free checks (CheckBlockContextFree).
+ * Checks mnid registration ticket, stores the block to disk and activates the best chain.
+ * 
+ * \param state - chain validation state
+ * \param chainparams - chain parameters
+ * \param pfrom - node that sent us the block
+ * \param pblock - block to process
+ * \param hashBlock - block hash
+ * \param fForceProcessing - whether to force processing of the block
+ * \param dbp - block position on disk
+ * 
+ * \return a bool indicating whether the block was processed successfully
+ */
+bool ProcessCheckedBlock(CValidationState &state, const CChainParams& chainparams,
+    const node_t &pfrom, const CBlock* pblock, const uint256 &hashBlock, 
+    const bool fForceProcessing, CDiskBlockPos *dbp)
+{
     const auto &consensusParams = chainparams.GetConsensus();
     {
         LOCK(cs_main);
         bool fRequested = MarkBlockAsReceived(hashBlock);
         fRequested |= fForceProcessing;
-        if (!bBlockChecked)
-        {
-            if (!state.GetRejectReason().empty())
-                return error("%s: CheckBlock %s FAILED, reject reason: %s", 
-                    __func__, hashBlock.ToString(), state.GetRejectReason());
 
-            return error("%s: CheckBlock FAILED", __func__);
+        // mnid registration ticket can be accepted with the previous block,
+        // so it is checked here in block processing order
+        CPastelIDRegTicket mnidTicket;
+        if (!CheckBlockMnidTicket(*pblock, state, mnidTicket))
+        {
+            if (state.IsRejectCode(REJECT_MISSING_INPUTS))
+                return false;
+            return error("%s: CheckBlock %s FAILED, reject reason: %s", 
+                __func__, hashBlock.ToString(), state.GetRejectReason());
         }
 
         // Store to disk
@@ -4258,10 +4370,17 @@ bool RewindBlockIndexToValidFork(const CChainParams& chainparams)
 
     bool bSwitchedToForkedChain = false;
     bool bRevalidationMode = false;
+    bool bRepairTicketDB = false;
     do
     {
         try
         {
+            if (bRepairTicketDB)
+            {
+                // ticket DB repair releases cs_main between batches, so it can't be called under the lock
+                bRepairTicketDB = false;
+                masterNodeCtrl.masternodeTickets.RepairTicketDB(true);
+            }
             CValidationState state(TxOrigin::UNKNOWN);
             int nCurrentChainHeight = static_cast<int>(gl_nChainHeight);
             uint256 hashInvalidBlock;
@@ -4375,8 +4494,8 @@ bool RewindBlockIndexToValidFork(const CChainParams& chainparams)
                             forkSwitchTracker.Reset();
                         else
                         {
-                            masterNodeCtrl.masternodeTickets.RepairTicketDB(true);
-                            LogFnPrintf("Revalidation mode: activating best chain");
+                            bRepairTicketDB = true;
+                            LogFnPrintf("Revalidation mode: repairing ticket DB, activating best chain");
                             bRevalidationMode = true;
                             continue;
                         }
@@ -4972,7 +5091,7 @@ void static ProcessGetData(node_t &pfrom, const Consensus::Params& consensusPara
                 func_thread_interrupt_point();
                 it++;
 
-                if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK)
+                if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK || inv.type == MSG_CMPCT_BLOCK)
                 {
                     bool bSend = false;
                     const auto mi = mapBlockIndex.find(inv.hash);
@@ -5004,8 +5123,13 @@ void static ProcessGetData(node_t &pfrom, const Consensus::Params& consensusPara
                         CBlock block;
                         if (!ReadBlockFromDisk(block, pBlockIndex, consensusParams))
                             assert(!"cannot load block from disk");
+                        // compact blocks are sent only for the recent blocks, peer may not have
+                        // transactions of the older blocks in its mempool
+                        int nInvType = inv.type;
+                        if ((nInvType == MSG_CMPCT_BLOCK) && (chainActive.Height() - pBlockIndex->nHeight >= MAX_CMPCTBLOCK_DEPTH))
+                            nInvType = MSG_BLOCK;
                         // add to vBlockMsgs to send later
-                        vBlockMsgs.emplace_back(inv.type, make_unique<CBlock>(std::move(block)));
+                        vBlockMsgs.emplace_back(nInvType, make_unique<CBlock>(std::move(block)));
 
                         // Trigger the peer node to send a getblocks request for the next batch of inventory
                         if (inv.hash == pfrom->hashContinue)
@@ -5062,7 +5186,7 @@ void static ProcessGetData(node_t &pfrom, const Consensus::Params& consensusPara
                 // Track requests for our stuff.
                 GetMainSignals().Inventory(inv.hash);
 
-                if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK)
+                if (inv.type == MSG_BLOCK || inv.type == MSG_FILTERED_BLOCK || inv.type == MSG_CMPCT_BLOCK)
                     break;
             }
         }
@@ -5074,6 +5198,8 @@ void static ProcessGetData(node_t &pfrom, const Consensus::Params& consensusPara
     {
         if (invType == MSG_BLOCK)
             pfrom->PushMessage("block", *block);
+        else if (invType == MSG_CMPCT_BLOCK)
+            pfrom->PushMessage("cmpctblock", CBlockHeaderAndShortTxIDs(*block));
         else // MSG_FILTERED_BLOCK)
         {
             LOCK2(pfrom->cs_filter, pfrom->cs_inventory);
@@ -5128,6 +5254,69 @@ void static ProcessGetData(node_t &pfrom, const Consensus::Params& consensusPara
     }
 }
 
+/**
+ * Check whether compact block relay can be used with the peer.
+ * Both sides should advertise NODE_COMPACT_BLOCKS service.
+ *
+ * \param pnode - peer node
+ * \return true if compact blocks can be requested from the peer
+ */
+static bool CanUseCompactBlocks(const node_t& pnode) noexcept
+{
+    return (nLocalServices & NODE_COMPACT_BLOCKS) && (pnode->nServices & NODE_COMPACT_BLOCKS) &&
+        (pnode->nVersion >= COMPACT_BLOCKS_VERSION);
+}
+
+/**
+ * Request full block from the peer (compact block can't be used).
+ *
+ * \param pfrom - peer node
+ * \param hashBlock - block hash
+ */
+static void RequestFullBlock(node_t& pfrom, const uint256& hashBlock)
+{
+    LogFnPrint("net", "requesting full block %s from peer=%d", hashBlock.ToString(), pfrom->id);
+    pfrom->PushMessage("getdata", vector<CInv>{ CInv(MSG_BLOCK, hashBlock) });
+}
+
+/**
+ * Process block received from the peer as a full block or reconstructed from the compact block.
+ *
+ * \param chainparams - chain parameters
+ * \param pfrom - peer node that sent the block
+ * \param strCommand - message command ("block", "cmpctblock" or "blocktxn")
+ * \param block - block to process
+ * \param bIsInitialBlockDownload - true if the node is in initial block download
+ */
+static void ProcessReceivedBlock(const CChainParams& chainparams, node_t& pfrom, const string& strCommand,
+    CBlock&& block, const bool bIsInitialBlockDownload)
+{
+    const uint256 hashBlock = block.GetHash();
+    CValidationState state(TxOrigin::MSG_BLOCK);
+    // Process all blocks from whitelisted peers, even if not requested,
+    // unless we're still syncing with the network.
+    // Such an unrequested block may still be processed, subject to the
+    // conditions in AcceptBlock().
+    const bool bForceProcessing = pfrom->fWhitelisted && !bIsInitialBlockDownload;
+    ProcessNewBlock(state, chainparams, pfrom, &block, bForceProcessing);
+    // some input transactions may be missing for this block, in this case ProcessNewBlock 
+    // will set rejection code REJECT_MISSING_INPUTS.
+    if (state.IsRejectCode(REJECT_MISSING_INPUTS))
+        // add block to cache to revalidate later on periodically
+        gl_BlockCache.add_block(hashBlock, pfrom->id, state.getTxOrigin(), std::move(block));
+    else
+    {
+        int nDoS = 0; // denial-of-service code
+        if (state.IsInvalid(nDoS))
+        {
+            pfrom->PushMessage("reject", strCommand, state.GetRejectCode(),
+                               state.GetRejectReason().substr(0, MAX_REJECT_MESSAGE_LENGTH), hashBlock);
+            if (nDoS > 0)
+                Misbehaving(pfrom->GetId(), nDoS);
+        }
+    }
+}
+
 static bool ProcessMessage(const CChainParams& chainparams, node_t pfrom, string strCommand, CDataStream& vRecv, int64_t nTimeReceived)
 {
     LogFnPrint("net", "received: %s (%u bytes) peer=%d", SanitizeString(strCommand), vRecv.size(), pfrom->id);
@@ -5426,7 +5615,11 @@ static bool ProcessMessage(const CChainParams& chainparams, node_t pfrom, string
                         if (chainActive.Tip()->GetBlockTime() > GetAdjustedTime() - consensusParams.nPowTargetSpacing * 20 &&
                             pNodeState->nBlocksInFlight < MAX_BLOCKS_IN_TRANSIT_PER_PEER)
                         {
-                            vToFetch.push_back(inv);
+                            // request compact block if the peer supports it
+                            if (CanUseCompactBlocks(pfrom))
+                                vToFetch.emplace_back(MSG_CMPCT_BLOCK, invHash);
+                            else
+                                vToFetch.push_back(inv);
                             // Mark block as in flight already, even though the actual "getdata" message only goes out
                             // later (within the same cs_main lock, though).
                             pNodeState->MarkBlockAsInFlight(invHash, consensusParams, mapBlocksInFlight, gl_nQueuedValidatedHeaders);
@@ -5588,7 +5781,7 @@ static bool ProcessMessage(const CChainParams& chainparams, node_t pfrom, string
 
                 bool fMissingInputs = false;
 
-                pfrom->setAskFor.erase(inv.hash);
+                pfrom->RemoveAskFor(inv.hash);
                 mapAlreadyAskedFor.erase(inv);
 
                 if (!AlreadyHave(inv) && AcceptToMemoryPool(chainparams, mempool, state, tx, true, &fMissingInputs))
@@ -5744,29 +5937,153 @@ static bool ProcessMessage(const CChainParams& chainparams, node_t pfrom, string
 
         pfrom->AddInventoryKnown(inv);
 
-        CValidationState state(TxOrigin::MSG_BLOCK);
-        // Process all blocks from whitelisted peers, even if not requested,
-        // unless we're still syncing with the network.
-        // Such an unrequested block may still be processed, subject to the
-        // conditions in AcceptBlock().
-        const bool bForceProcessing = pfrom->fWhitelisted && !bIsInitialBlockDownload;
-        ProcessNewBlock(state, chainparams, pfrom, &block, bForceProcessing);
-        // some input transactions may be missing for this block, in this case ProcessNewBlock 
-        // will set rejection code REJECT_MISSING_INPUTS.
-        if (state.IsRejectCode(REJECT_MISSING_INPUTS))
-            // add block to cache to revalidate later on periodically
-            gl_BlockCache.add_block(inv.hash, pfrom->id, state.getTxOrigin(), std::move(block));
-        else
+        ProcessReceivedBlock(chainparams, pfrom, strCommand, std::move(block), bIsInitialBlockDownload);
+    }
+
+    else if (strCommand == "cmpctblock" && !fImporting && !fReindex) // Ignore compact blocks received while importing
+    {
+        CBlockHeaderAndShortTxIDs cmpctblock;
+        vRecv >> cmpctblock;
+
+        const uint256 hashBlock = cmpctblock.header.GetHash();
+        CInv inv(MSG_BLOCK, hashBlock);
+        LogFnPrint("net", "received compact block %s (%zu txs, %zu prefilled), peer=%d", hashBlock.ToString(),
+            cmpctblock.BlockTxCount(), cmpctblock.prefilledtxn.size(), pfrom->id);
+
+        pfrom->AddInventoryKnown(inv);
+        ++pfrom->nCmpctBlocksReceived;
         {
-            int nDoS = 0; // denial-of-service code
-            if (state.IsInvalid(nDoS))
+            LOCK(cs_main);
+            // compact blocks are accepted only if requested from this peer
+            const auto it = mapBlocksInFlight.find(hashBlock);
+            if (it == mapBlocksInFlight.cend() || it->second.first != pfrom->GetId())
             {
-                pfrom->PushMessage("reject", strCommand, state.GetRejectCode(),
-                                   state.GetRejectReason().substr(0, MAX_REJECT_MESSAGE_LENGTH), inv.hash);
-                if (nDoS > 0)
-                    Misbehaving(pfrom->GetId(), nDoS);
+                LogFnPrint("net", "ignoring unrequested compact block %s, peer=%d", hashBlock.ToString(), pfrom->id);
+                return true;
+            }
+            const auto pindex = FindBlockIndex(hashBlock);
+            if (pindex && (pindex->nStatus & BLOCK_HAVE_DATA))
+                return true;
+        }
+
+        auto pPartialBlock = make_shared<CPartialCompactBlock>();
+        CompactBlockStatus status = pPartialBlock->InitData(cmpctblock, mempool);
+        if (status == CompactBlockStatus::INVALID)
+        {
+            Misbehaving(pfrom->GetId(), 100);
+            return error("peer %d sent invalid compact block %s", pfrom->id, hashBlock.ToString());
+        }
+        if (status == CompactBlockStatus::FAILED)
+        {
+            RequestFullBlock(pfrom, hashBlock);
+            return true;
+        }
+        auto vMissingTxIndexes = pPartialBlock->GetMissingTxIndexes();
+        LogFnPrint("net", "compact block %s: %zu txs from mempool, %zu txs missing, peer=%d", hashBlock.ToString(),
+            pPartialBlock->GetMempoolCount(), vMissingTxIndexes.size(), pfrom->id);
+        if (vMissingTxIndexes.empty())
+        {
+            CBlock block;
+            status = pPartialBlock->FillBlock(block, {});
+            if (status == CompactBlockStatus::OK)
+                ProcessReceivedBlock(chainparams, pfrom, strCommand, std::move(block), bIsInitialBlockDownload);
+            else
+                RequestFullBlock(pfrom, hashBlock);
+            return true;
+        }
+
+        // request missing transactions from the peer, block is reconstructed when "blocktxn" is received
+        {
+            LOCK(cs_main);
+            node_state_t pNodeState = State(pfrom->GetId());
+            if (pNodeState)
+                pNodeState->mapPartialBlocks[hashBlock] = std::move(pPartialBlock);
+        }
+        CBlockTransactionsRequest req;
+        req.blockhash = hashBlock;
+        req.indexes = std::move(vMissingTxIndexes);
+        ++pfrom->nCmpctBlockTxRequests;
+        pfrom->PushMessage("getblocktxn", req);
+    }
+
+    else if (strCommand == "getblocktxn")
+    {
+        CBlockTransactionsRequest req;
+        vRecv >> req;
+
+        CBlock block;
+        bool bSendFullBlock = false;
+        {
+            LOCK(cs_main);
+            const auto pindex = FindBlockIndex(req.blockhash);
+            if (!pindex || !(pindex->nStatus & BLOCK_HAVE_DATA) || !chainActive.Contains(pindex))
+            {
+                LogFnPrint("net", "peer %d requested transactions of unknown block %s", pfrom->id, req.blockhash.ToString());
+                return true;
             }
+            // peer should not request transactions of the old blocks, send full block instead
+            bSendFullBlock = chainActive.Height() - pindex->nHeight >= MAX_BLOCKTXN_DEPTH;
+            if (!ReadBlockFromDisk(block, pindex, consensusParams))
+                return error("cannot load block %s from disk", req.blockhash.ToString());
+        }
+        if (bSendFullBlock)
+        {
+            pfrom->PushMessage("block", block);
+            return true;
         }
+
+        CBlockTransactions resp(req);
+        for (size_t i = 0; i < req.indexes.size(); ++i)
+        {
+            if (req.indexes[i] >= block.vtx.size())
+            {
+                Misbehaving(pfrom->GetId(), 100);
+                return error("peer %d sent getblocktxn with out-of-bounds tx index %u", pfrom->id, req.indexes[i]);
+            }
+            resp.txn[i] = block.vtx[req.indexes[i]];
+        }
+        pfrom->PushMessage("blocktxn", resp);
+    }
+
+    else if (strCommand == "blocktxn" && !fImporting && !fReindex) // Ignore block transactions received while importing
+    {
+        CBlockTransactions resp;
+        vRecv >> resp;
+
+        shared_ptr<CPartialCompactBlock> pPartialBlock;
+        {
+            LOCK(cs_main);
+            node_state_t pNodeState = State(pfrom->GetId());
+            if (pNodeState)
+            {
+                const auto it = pNodeState->mapPartialBlocks.find(resp.blockhash);
+                if (it != pNodeState->mapPartialBlocks.end())
+                {
+                    pPartialBlock = std::move(it->second);
+                    pNodeState->mapPartialBlocks.erase(it);
+                }
+            }
+        }
+        if (!pPartialBlock)
+        {
+            LogFnPrint("net", "ignoring unexpected blocktxn for block %s, peer=%d", resp.blockhash.ToString(), pfrom->id);
+            return true;
+        }
+
+        CBlock block;
+        const CompactBlockStatus status = pPartialBlock->FillBlock(block, resp.txn);
+        if (status == CompactBlockStatus::INVALID)
+        {
+            Misbehaving(pfrom->GetId(), 100);
+            return error("peer %d sent invalid blocktxn for block %s", pfrom->id, resp.blockhash.ToString());
+        }
+        if (status == CompactBlockStatus::FAILED)
+        {
+            RequestFullBlock(pfrom, resp.blockhash);
+            return true;
+        }
+        LogFnPrint("net", "reconstructed block %s from compact block, peer=%d", resp.blockhash.ToString(), pfrom->id);
+        ProcessReceivedBlock(chainparams, pfrom, strCommand, std::move(block), bIsInitialBlockDownload);
     }
 
     // This asymmetric behavior for inbound and outbound connections was introduced
@@ -6123,6 +6440,35 @@ bool ProcessMessages(const CChainParams& chainparams, node_t &pfrom)
             continue;
         }
 
+        // masternode messages are processed by the masternode message lane,
+        // so they are not queued behind block & tx processing.
+        // Messages of the peer are processed in order of arrival within each lane,
+        // version handshake is always completed by the message handler thread first.
+        bool bSigVerifyReserved = false;
+        if (pfrom->nVersion && IsMasternodeMessageType(strCommand))
+        {
+            if (masterNodeCtrl.messageQueue.IsEnabled())
+            {
+                if (masterNodeCtrl.messageQueue.Submit(pfrom, strCommand, vRecv, pfrom->GetTotalRecvSize()))
+                {
+                    pfrom->fPeerMsgQueueFull = false;
+                    continue;
+                }
+                // peer message queue is full - keep the message in the receive buffer
+                pfrom->fPeerMsgQueueFull = true;
+                --it;
+                break;
+            }
+            // message is processed inline - reserve signature verification queue space the same way
+            // the message lane does, keep the message in the receive buffer if the queue is full
+            if (!masterNodeCtrl.sigVerifyQueue.TryReserve())
+            {
+                --it;
+                break;
+            }
+            bSigVerifyReserved = true;
+        }
+
         // Process message
         bool fRet = false;
         try
@@ -6148,6 +6494,8 @@ bool ProcessMessages(const CChainParams& chainparams, node_t &pfrom)
                 PrintExceptionContinue(&e, "ProcessMessages()");
             }
         } catch (const func_thread_interrupted&) {
+            if (bSigVerifyReserved)
+                masterNodeCtrl.sigVerifyQueue.ReleaseReservation();
             throw;
         }
         catch (const exception& e) {
@@ -6155,6 +6503,8 @@ bool ProcessMessages(const CChainParams& chainparams, node_t &pfrom)
         } catch (...) {
             PrintExceptionContinue(nullptr, "ProcessMessages()");
         }
+        if (bSigVerifyReserved)
+            masterNodeCtrl.sigVerifyQueue.ReleaseReservation();
 
         if (!fRet)
             LogPrintf("%s: (%s, %u bytes) FAILED peer=%d\n", __func__, SanitizeString(strCommand), nMessageSize, pfrom->id);
@@ -6434,9 +6784,17 @@ void NodeSendGetData(node_t& pto, node_state_t& pNodeState, const Consensus::Par
     //
     // Message: getdata (non-blocks)
     //
-    while (!pto->fDisconnect && !pto->mapAskFor.empty() && (*pto->mapAskFor.begin()).first <= nNow)
+    vector<CInv> vAskFor;
+    {
+        LOCK(pto->cs_askFor);
+        while (!pto->fDisconnect && !pto->mapAskFor.empty() && (*pto->mapAskFor.begin()).first <= nNow)
+        {
+            vAskFor.push_back((*pto->mapAskFor.begin()).second);
+            pto->mapAskFor.erase(pto->mapAskFor.begin());
+        }
+    }
+    for (const auto& inv : vAskFor)
     {
-        const CInv& inv = (*pto->mapAskFor.begin()).second;
         if (!AlreadyHave(inv))
         {
             if (fDebug)
@@ -6449,9 +6807,8 @@ void NodeSendGetData(node_t& pto, node_state_t& pNodeState, const Consensus::Par
             }
         } else {
             //If we're not going to ask, don't expect a response.
-            pto->setAskFor.erase(inv.hash);
+            pto->RemoveAskFor(inv.hash);
         }
-        pto->mapAskFor.erase(pto->mapAskFor.begin());
     }
     if (!vGetData.empty())
         pto->PushMessage("getdata", vGetData);
@@ -42,6 +42,7 @@
 class CBlockIndex;
 class CBloomFilter;
 class CInv;
+class CPastelIDRegTicket;
 class CValidationInterface;
 class CValidationState;
 struct PrecomputedTransactionData;
@@ -175,6 +176,15 @@ bool ProcessNewBlock(
     const CBlock* pblock, 
     const bool fForceProcessing, 
     CDiskBlockPos *dbp = nullptr);
+/** Process an incoming block that already passed context-free checks (CheckBlockContextFree). */
+bool ProcessCheckedBlock(
+    CValidationState &state, 
+    const CChainParams& chainparams, 
+    const node_t &pfrom, 
+    const CBlock* pblock, 
+    const uint256 &hashBlock,
+    const bool fForceProcessing, 
+    CDiskBlockPos *dbp = nullptr);
 /** Check whether enough disk space is available for an incoming block */
 bool CheckDiskSpace(uint64_t nAdditionalBytes = 0);
 /** Open a block file (blk?????.dat) */
@@ -360,6 +370,17 @@ bool ConnectBlock(
     CCoinsViewCache& coins,
     bool fJustCheck = false);
 
+// proof-of-work checks of the block header
+typedef enum class _BlockPoWCheck
+{
+    NONE,       // proof of work is not checked (ingested blocks)
+    EQUIHASH,   // only Equihash solution is checked (regtest)
+    FULL        // Equihash solution and proof of work are checked
+} BlockPoWCheck;
+
+/** Get proof-of-work checks required for the block header, requires cs_main */
+BlockPoWCheck GetBlockPoWCheck(const CChainParams& chainparams, const uint256& hashBlock);
+
 /** Context-independent validity checks */
 bool CheckBlockHeader(
     const CBlockHeader& block,
@@ -367,6 +388,23 @@ bool CheckBlockHeader(
     CValidationState& state,
     const CChainParams& chainparams,
     bool fCheckPOW = true);
+bool CheckBlockHeader(
+    const CBlockHeader& block,
+    uint256& hashBlock,
+    CValidationState& state,
+    const CChainParams& chainparams,
+    const BlockPoWCheck powCheck);
+/** Block checks that do not access chain state and tickets, can be executed without cs_main */
+bool CheckBlockContextFree(
+    const CBlock& block,
+    uint256& hashBlock,
+    CValidationState& state,
+    const CChainParams& chainparams,
+    libzcash::ProofVerifier& verifier,
+    const BlockPoWCheck powCheck,
+    const bool fCheckMerkleRoot = true);
+/** Check mnid registration ticket of the block mined by MasterNode */
+bool CheckBlockMnidTicket(const CBlock& block, CValidationState& state, CPastelIDRegTicket &mnidTicket);
 
 bool CheckBlock(
     const CBlock& block,
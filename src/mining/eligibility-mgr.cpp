@@ -361,16 +361,14 @@ mining_eligibility_vector_t CMiningEligibilityManager::GetMnEligibilityInfo(uint
     
     nMiningEnabledCount = 0;
     masterNodeCtrl.masternodeManager.ForEachMasternode<mining_eligibility_vector_t>(
-        vMnEligibility, [&](mining_eligibility_vector_t &ctx, const masternode_t& pmn) -> void
+        vMnEligibility, [&](mining_eligibility_vector_t &ctx, const masternode_info_t& mnInfo) -> void
         {
-            if (!pmn)
+            if (!mnInfo.IsEligibleForMining())
                 return;
-            if (!pmn->IsEligibleForMining())
-                return;
-            if (pmn->IsOutpointSpent() || pmn->IsUpdateRequired())
+            if (mnInfo.IsOutpointSpent() || mnInfo.IsUpdateRequired())
 				return;
 			++nMiningEnabledCount;
-			const auto it = mapMnids.find(pmn->getMNPastelID());
+			const auto it = mapMnids.find(mnInfo.getMNPastelID());
             uint32_t nBlocksMined = 0;
             bool bEligibleForMining = false;
             if (it == mapMnids.cend())
@@ -381,14 +379,14 @@ mining_eligibility_vector_t CMiningEligibilityManager::GetMnEligibilityInfo(uint
 				return;
             int nLastMinedBlockHeight = -1;
             uint256 lastMinedBlockHash;
-            const auto itLastMined = mapMnidsLastMined.find(pmn->getMNPastelID());
+            const auto itLastMined = mapMnidsLastMined.find(mnInfo.getMNPastelID());
             if (itLastMined != mapMnidsLastMined.cend())
             {
                 nLastMinedBlockHeight = static_cast<int>(itLastMined->second.first);
                 lastMinedBlockHash = itLastMined->second.second;
             }
-            ctx.emplace_back(pmn->getMNPastelID(), bEligibleForMining, pmn->GetDesc(), 
-                pmn->GetActiveState(), nBlocksMined, nLastMinedBlockHeight, lastMinedBlockHash);
+            ctx.emplace_back(mnInfo.getMNPastelID(), bEligibleForMining, mnInfo.GetDesc(), 
+                mnInfo.GetActiveState(), nBlocksMined, nLastMinedBlockHeight, lastMinedBlockHash);
 	    });
 	return vMnEligibility;
 }
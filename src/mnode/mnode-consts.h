@@ -55,8 +55,12 @@ constexpr uint32_t MAX_IN_PROCESS_COLLECTION_TICKET_AGE = 7 * 24 * static_cast<u
 constexpr int64_t SN_ELIGIBILITY_CHECK_DELAY_SECS = 5 * 60;
 constexpr int SN_ELIGIBILITY_LAST_SEEN_TIME_SECS = 150;
 constexpr uint32_t MN_RECOVERY_LOOKBACK_BLOCKS = 100;
+// max number of entries in the masternode collateral cache
+constexpr size_t MAX_MN_COLLATERAL_CACHE_SIZE = 50'000;
 
 constexpr int DSEG_UPDATE_SECONDS        = 3 * 60 * 60;
+// max number of short ids accepted in the compact masternode list sync request (dsegc)
+constexpr size_t MAX_DSEG_COMPACT_SHORT_IDS = 100'000;
 
 constexpr int LAST_PAID_SCAN_BLOCKS      = 100;
 
@@ -78,6 +82,18 @@ constexpr auto MNCACHE_SERIALIZATION_VERSION_PREFIX = "CMasternodeMan-Version-";
 constexpr uint32_t MNCACHE_VERSION_OLD = 7;
 constexpr uint32_t MNCACHE_VERSION_PROTECTED = 8;
 constexpr uint32_t MNCACHE_VERSION_PROTECTED_HIST = 9;
+constexpr uint32_t MNCACHE_VERSION_HISTDB = 10; // historical top MNs are stored in the MN history DB
+
+// historical top masternodes DB
+constexpr auto MN_HISTORY_DB_SUBFOLDER = "mnhistory";
+constexpr size_t MN_HISTORY_DB_CACHE_SIZE = 8 << 20;
+// default number of blocks to keep historical top MNs for (0 - keep all)
+constexpr uint32_t DEFAULT_MN_HISTORY_DEPTH = 0;
+
+// -mnmsgthreads default (number of masternode message processing threads, 0 - process in the message handler thread)
+constexpr size_t DEFAULT_MN_MSG_THREADS = 1;
+// maximum number of masternode message processing threads
+constexpr size_t MAX_MN_MSG_THREADS = 4;
 
 constexpr auto MNPAYMENTS_CACHE_MAGIC_STR = "magicMasternodePaymentsCache";
 constexpr auto MNPAYMENTS_CACHE_FILENAME = "mnpayments.dat";
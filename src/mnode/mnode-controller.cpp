@@ -182,6 +182,7 @@ void CMasterNodeController::SetParameters()
     else{
         //TODO Pastel: assert
     }
+    collateralCache.SetCollateralAmount(MasternodeCollateral * COIN);
 }
 
 bool CMasterNodeController::IsOurMasterNode(const CPubKey &pubKey) const noexcept
@@ -359,6 +360,20 @@ bool CMasterNodeController::EnableMasterNode(ostringstream& strErrors, CServiceT
 
     // NOTE: Masternode should have no wallet
     m_fMasterNode = GetBoolArg("-masternode", false);
+    sigVerifyQueue.SetThreadCount(GetArg("-mnsigthreads", DEFAULT_MN_SIGVERIFY_THREADS));
+    messageQueue.SetThreadCount(GetArg("-mnmsgthreads", DEFAULT_MN_MSG_THREADS), MAX_MN_MSG_THREADS);
+    // queued messages are moved out of the peer receive buffer, so they are limited separately
+    messageQueue.SetMaxPeerQueueBytes(ReceiveFloodSize());
+    messageQueue.SetHandler([this](node_t& pfrom, string& strCommand, CDataStream& vRecv)
+        {
+            ProcessMessage(pfrom, strCommand, vRecv);
+        });
+    // message lane does not take the next message until the signature verification queue has space for it,
+    // so the messages are not rejected by the full queue and wait in the peer queues instead
+    messageQueue.SetGate(
+        [this]() { return sigVerifyQueue.TryReserve(); },
+        [this]() { sigVerifyQueue.ReleaseReservation(); });
+    sigVerifyQueue.SetResumeHandler([this]() { messageQueue.Resume(); });
 
     if ((m_fMasterNode || masternodeConfig.getCount() > 0) && !fTxIndex)
     {
@@ -422,10 +437,18 @@ bool CMasterNodeController::EnableMasterNode(ostringstream& strErrors, CServiceT
     // LOAD SERIALIZED DAT FILES INTO DATA CACHES FOR INTERNAL USE
     fs::path pathDB = GetDataDir();
 
+    uiInterface.InitMessage(translate("Loading masternode history..."));
+    string sHistoryDBError;
+    if (!masternodeManager.InitHistoryDB(sHistoryDBError))
+    {
+        strErrors << translate(sHistoryDBError.c_str());
+        return false;
+    }
+
+    InitCacheDBs();
     uiInterface.InitMessage(translate("Loading masternode cache..."));
-    CFlatDB<CMasternodeMan> flatDB1(MNCACHE_FILENAME, MNCACHE_CACHE_MAGIC_STR);
-    if (!flatDB1.Load(masternodeManager))
-        LogFnPrintf("WARNING ! Could not load masternode cache from [%s]", flatDB1.getFilePath());
+    if (!m_pMNCacheDB->Load(masternodeManager))
+        LogFnPrintf("WARNING ! Could not load masternode cache from [%s]", m_pMNCacheDB->getFilePath());
     else
     {
         masternodeManager.CleanupMnbs();
@@ -435,9 +458,8 @@ bool CMasterNodeController::EnableMasterNode(ostringstream& strErrors, CServiceT
     if (!masternodeManager.empty())
     {
         uiInterface.InitMessage(translate("Loading masternode payment cache..."));
-        CFlatDB<CMasternodePayments> flatDB2(MNPAYMENTS_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
-        if (!flatDB2.Load(masternodePayments))
-            LogFnPrintf("WARNING ! Could not load masternode payments cache from [%s]", flatDB2.getFilePath());
+        if (!m_pMNPaymentsDB->Load(masternodePayments))
+            LogFnPrintf("WARNING ! Could not load masternode payments cache from [%s]", m_pMNPaymentsDB->getFilePath());
     } else
         uiInterface.InitMessage(translate("Masternode cache is empty, skipping payments and governance cache..."));
 
@@ -452,10 +474,9 @@ bool CMasterNodeController::EnableMasterNode(ostringstream& strErrors, CServiceT
 #endif // GOVERNANCE_TICKETS
 
     uiInterface.InitMessage(translate("Loading fulfilled requests cache..."));
-    CFlatDB<CMasternodeRequestTracker> flatDB4(MN_REQUEST_TRACKER_FILENAME, MN_REQUEST_TRACKER_MAGIC_CACHE_STR);
-    if (!flatDB4.Load(requestTracker))
+    if (!m_pRequestTrackerDB->Load(requestTracker))
     {
-        strErrors << translate("Failed to load fulfilled requests cache from") + "\n" + flatDB4.getFilePath();
+        strErrors << translate("Failed to load fulfilled requests cache from") + "\n" + m_pRequestTrackerDB->getFilePath();
         return false;
     }
 
@@ -498,6 +519,11 @@ void CMasterNodeController::StartMasterNode(CServiceThreadGroup& threadGroup)
     string error;
     if (threadGroup.add_thread(error, make_shared<CMnbRequestConnectionsThread>()) == INVALID_THREAD_OBJECT_ID)
 		LogFnPrintf("Failed to start masternode broadcast re-requests thread. %s", error);
+
+    // masternode messages signature verification workers
+    sigVerifyQueue.create_workers(threadGroup);
+    // masternode message lane workers
+    messageQueue.create_workers(threadGroup);
 }
 
 void CMasterNodeController::StopMasterNode()
@@ -526,7 +552,7 @@ bool CMasterNodeController::AlreadyHave(const CInv& inv)
     switch (inv.type)
     {
     case MSG_MASTERNODE_MESSAGE:
-        return masternodeMessages.mapSeenMessages.count(inv.hash);
+        return masternodeMessages.HasSeenMessage(inv.hash);
 
 #ifdef GOVERNANCE_TICKETS
     case MSG_MASTERNODE_GOVERNANCE:
@@ -536,7 +562,7 @@ bool CMasterNodeController::AlreadyHave(const CInv& inv)
         {
             LOCK(cs_mapVotes);
             auto vi = masternodeGovernance.mapVotes.find(inv.hash);
-            return vi != masternodeGovernance.mapVotes.end() && !vi->second.ReprocessVote();
+            return vi != masternodeGovernance.mapVotes.end() && !vi->second.ReprocessVote(masternodeGovernance.GetCachedBlockHeight());
         }
 #endif // GOVERNANCE_TICKETS
 
@@ -571,13 +597,12 @@ bool CMasterNodeController::ProcessGetData(node_t& pfrom, const CInv& inv)
     {
         case MSG_MASTERNODE_MESSAGE:
         {
-            LOCK(cs_mapSeenMessages);
-            const auto vi = masternodeMessages.mapSeenMessages.find(inv.hash);
-            if (vi != masternodeMessages.mapSeenMessages.cend() && vi->second.IsVerified())
+            CMasternodeMessage message;
+            if (masternodeMessages.GetSeenMessage(inv.hash, message) && message.IsVerified())
             {
                 CDataStream ss(SER_NETWORK, PROTOCOL_VERSION);
                 ss.reserve(1000);
-                ss << masternodeMessages.mapSeenMessages[inv.hash];
+                ss << message;
                 pfrom->PushMessage(NetMsgType::MASTERNODEMESSAGE, ss);
                 bPushed = true;
             } 
@@ -665,17 +690,29 @@ bool CMasterNodeController::ProcessGetData(node_t& pfrom, const CInv& inv)
     return bPushed;
 }
 
+/**
+ * Create journaled cache DBs if not created yet.
+ */
+void CMasterNodeController::InitCacheDBs()
+{
+    if (!m_pMNCacheDB)
+        m_pMNCacheDB = make_unique<CJournaledFlatDB<CMasternodeMan>>(MNCACHE_FILENAME, MNCACHE_CACHE_MAGIC_STR);
+    if (!m_pMNPaymentsDB)
+        m_pMNPaymentsDB = make_unique<CJournaledFlatDB<CMasternodePayments>>(MNPAYMENTS_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
+    if (!m_pRequestTrackerDB)
+        m_pRequestTrackerDB = make_unique<CJournaledFlatDB<CMasternodeRequestTracker>>(MN_REQUEST_TRACKER_FILENAME, MN_REQUEST_TRACKER_MAGIC_CACHE_STR);
+}
+
 void CMasterNodeController::DumpCacheFiles()
 {
     try
     {
         // STORE DATA CACHES INTO SERIALIZED DAT FILES
-        CFlatDB<CMasternodeMan> flatDB1(MNCACHE_FILENAME, MNCACHE_CACHE_MAGIC_STR);
-        flatDB1.Dump(masternodeManager, false);
-        CFlatDB<CMasternodePayments> flatDB2(MNPAYMENTS_CACHE_FILENAME, MNPAYMENTS_CACHE_MAGIC_STR);
-        flatDB2.Dump(masternodePayments, false);
-        CFlatDB<CMasternodeRequestTracker> flatDB3(MN_REQUEST_TRACKER_FILENAME, MN_REQUEST_TRACKER_MAGIC_CACHE_STR);
-        flatDB3.Dump(requestTracker, false);
+        // masternode, payments and fulfilled requests caches append changes to their journals
+        InitCacheDBs();
+        m_pMNCacheDB->Dump(masternodeManager);
+        m_pMNPaymentsDB->Dump(masternodePayments);
+        m_pRequestTrackerDB->Dump(requestTracker);
         CFlatDB<CMasternodeMessageProcessor> flatDB4(MN_MESSAGES_FILENAME, MN_MESSAGES_MAGIC_CACHE_STR);
         flatDB4.Dump(masternodeMessages, false);
 #ifdef GOVERNANCE_TICKETS
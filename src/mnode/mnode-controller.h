@@ -17,6 +17,8 @@
 #include <mnode/mnode-validation.h>
 #include <mnode/mnode-governance.h>
 #include <mnode/mnode-messageproc.h>
+#include <mnode/mnode-sigverify.h>
+#include <netmsg/peer-msg-queue.h>
 #include <mnode/mnode-notificationinterface.h>
 #include <mnode/ticket-processor.h>
 #include <mnode/tickets/ticket-types.h>
@@ -28,6 +30,7 @@ public:
     CMasterNodeController() : 
         pacNotificationInterface(nullptr),
         semMasternodeOutbound(nullptr),
+        messageQueue("mn"),
         m_fMasterNode(false)
     {
         InvalidateParameters();
@@ -53,6 +56,12 @@ public:
     // Keep track of what node has/was asked for and when
     CMasternodeGovernance masternodeGovernance;
 #endif // GOVERNANCE_TICKETS
+    // Parallel signature verification for mnp, mnb, payment & governance votes
+    CMasternodeSigVerifyQueue sigVerifyQueue;
+    // Masternode messages lane - processed separately from the block & tx messages
+    CPeerMessageQueue messageQueue;
+    // Cache of the masternode collateral UTXOs
+    CMasternodeCollateralCache collateralCache;
 
     int MasternodeCollateral;
 
@@ -162,6 +171,12 @@ protected:
     mutable std::unordered_map<uint32_t, double> m_deflatorFactorCacheMap;
     mutable CSharedMutex m_deflatorFactorCacheMutex;
 
+    // journaled cache files, kept between dumps to find the changed records
+    std::unique_ptr<CJournaledFlatDB<CMasternodeMan>> m_pMNCacheDB;
+    std::unique_ptr<CJournaledFlatDB<CMasternodePayments>> m_pMNPaymentsDB;
+    std::unique_ptr<CJournaledFlatDB<CMasternodeRequestTracker>> m_pRequestTrackerDB;
+
+    void InitCacheDBs();
     void SetParameters();
     void InvalidateParameters();
     double getNetworkDifficulty(const CBlockIndex* blockindex, const bool bNetworkDifficulty) const;
@@ -4,6 +4,10 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 
+#include <map>
+#include <unordered_map>
+#include <mutex>
+
 #include <clientversion.h>
 #include <chainparams.h>
 #include <utils/fs.h>
@@ -12,6 +16,7 @@
 #include <utils/streams.h>
 #include <utils/hash.h>
 #include <utils/timer.h>
+#include <utils/enum_util.h>
 
 /** 
 *   Generic Dumping and Loading
@@ -21,7 +26,7 @@
 template<typename T>
 class CFlatDB
 {
-private:
+protected:
     enum class ReadResult
     {
         Ok,
@@ -37,18 +42,23 @@ private:
     fs::path pathDBNew;
     std::string strFilename;
     std::string strMagicMessage;
-
-    bool Write(const T& objToSave)
+    uint256 hashSnapshot; // checksum of the last read or written file
+
+    /**
+     * Serialize object with the file header and checksum into the pathDBNew file.
+     * 
+     * \param sMagicMessage - file specific magic message
+     * \param obj - object to serialize
+     * \return true if file was written successfully
+     */
+    template <typename Obj>
+    bool WriteFile(const std::string &sMagicMessage, const Obj& obj)
     {
-        // LOCK(objToSave.cs);
-
-        const int64_t nStart = GetTimeMillis();
-
         // serialize, checksum data up to that point, then append checksum
         CDataStream ssObj(SER_DISK, CLIENT_VERSION);
-        ssObj << strMagicMessage; // specific magic message for this type of object
+        ssObj << sMagicMessage; // specific magic message for this type of object
         ssObj << FLATDATA(Params().MessageStart()); //-V568 network specific magic number
-        ssObj << objToSave;
+        ssObj << obj;
         const uint256 hash = Hash(ssObj.begin(), ssObj.end());
         ssObj << hash;
 
@@ -69,25 +79,28 @@ private:
         try
         {
             fileout << ssObj;
+            FileCommit(fileout.Get());
         } catch (const std::exception &e)
         {
             return error("%s: Serialize or I/O error - %s", __func__, e.what());
         }
         fileout.fclose();
-
-        LogFnPrintf("Written info to %s  %dms", strFilename, GetTimeMillis() - nStart);
-        LogFnPrintf("     %s", objToSave.ToString());
-
+        hashSnapshot = hash;
         return true;
     }
 
-    ReadResult Read(T& objToLoad, std::string &error, bool fDryRun = false)
+    /**
+     * Read object from the pathDB file, verify checksum and file header.
+     * 
+     * \param sMagicMessage - expected file specific magic message
+     * \param obj - object to deserialize
+     * \param error - error message
+     * \return result of the read operation
+     */
+    template <typename Obj>
+    ReadResult ReadFile(const std::string &sMagicMessage, Obj& obj, std::string &error)
     {
-        //LOCK(objToLoad.cs);
-
         error.clear();
-        CTimer timer;
-        timer.start();
         // open input file, and associate with CAutoFile
         FILE* file = nullptr;
 #if defined(_MSC_VER) && (_MSC_VER >= 1400)
@@ -138,7 +151,7 @@ private:
             ssObj >> strMagicMessageTmp;
 
             // ... verify the message matches predefined one
-            if (strMagicMessage != strMagicMessageTmp)
+            if (sMagicMessage != strMagicMessageTmp)
             {
                 error = "Invalid magic message";
                 return ReadResult::IncorrectMagicMessage;
@@ -155,16 +168,72 @@ private:
                 return ReadResult::IncorrectMagicNumber;
             }
 
-            // de-serialize data into T object
-            ssObj >> objToLoad;
+            // de-serialize data into the object
+            ssObj >> obj;
         }
         catch (const std::exception &e)
         {
-            objToLoad.Clear();
             error = strprintf("Deserialize or I/O error at pos %zu/%zu - %s", 
                 ssObj.getReadPos(), nDataSize, e.what());
             return ReadResult::IncorrectFormat;
         }
+        hashSnapshot = hashIn;
+        return ReadResult::Ok;
+    }
+
+    /**
+     * Replace pathDB with the pathDBNew file written by WriteFile.
+     * 
+     * \return true if the file was replaced successfully
+     */
+    bool CommitFile()
+    {
+        try
+        {
+            bool bBackup = false;
+            fs::path pathDBbackup = pathDB;
+            pathDBbackup.replace_extension(".bak");
+            if (fs::exists(pathDB))
+            {
+                fs::rename(pathDB, pathDBbackup);
+                bBackup = true;
+            }
+            fs::rename(pathDBNew, pathDB);
+            if (bBackup)
+                fs::remove(pathDBbackup);
+        } catch (const std::exception& ex)
+        {
+            LogFnPrintf("Error writing to file [%s]. %s", pathDB.string(), ex.what());
+            return false;
+        }
+        return true;
+    }
+
+    bool Write(const T& objToSave)
+    {
+        // LOCK(objToSave.cs);
+
+        const int64_t nStart = GetTimeMillis();
+        if (!WriteFile(strMagicMessage, objToSave))
+            return false;
+
+        LogFnPrintf("Written info to %s  %dms", strFilename, GetTimeMillis() - nStart);
+        LogFnPrintf("     %s", objToSave.ToString());
+
+        return true;
+    }
+
+    ReadResult Read(T& objToLoad, std::string &error, bool fDryRun = false)
+    {
+        //LOCK(objToLoad.cs);
+
+        CTimer timer;
+        timer.start();
+        const ReadResult readResult = ReadFile(strMagicMessage, objToLoad, error);
+        if (readResult == ReadResult::IncorrectFormat)
+            objToLoad.Clear();
+        if (readResult != ReadResult::Ok)
+            return readResult;
         timer.stop();
         LogFnPrintf("Loaded info from %s  %zums", strFilename, timer.elapsedMilliseconds());
         LogFnPrintf("     %s", objToLoad.ToString());
@@ -178,6 +247,30 @@ private:
         return ReadResult::Ok;
     }
 
+    /**
+     * Log read error.
+     * 
+     * \param readResult - result of the Read operation
+     * \param error - error message
+     * \return false if file exists but can't be used and should be fixed manually
+     */
+    bool CheckReadResult(const ReadResult readResult, std::string &error) const
+    {
+        if (readResult == ReadResult::FileError)
+            LogFnPrintf("Missing file %s, will try to recreate", strFilename);
+        else if (readResult != ReadResult::Ok)
+        {
+            error = strprintf("Error reading %s. %s. ", strFilename, error);
+            if (readResult == ReadResult::IncorrectFormat)
+                error += "Magic is ok, but data has invalid format, will try to recreate";
+            else
+                error += "File format is unknown or invalid, please fix it manually";
+            LogFnPrintf(error);
+            if (readResult != ReadResult::IncorrectFormat)
+                return false;
+        }
+        return true;
+    }
 
 public:
     CFlatDB(const std::string &strFilenameIn, const std::string &strMagicMessageIn)
@@ -198,20 +291,7 @@ public:
         std::string error;
         LogFnPrintf("Reading info from %s...", strFilename);
         const ReadResult readResult = Read(objToLoad, error);
-        if (readResult == ReadResult::FileError)
-            LogFnPrintf("Missing file %s, will try to recreate", strFilename);
-        else if (readResult != ReadResult::Ok)
-        {
-            error = strprintf("Error reading %s. %s. ", strFilename, error);
-            if (readResult == ReadResult::IncorrectFormat)
-                error += "Magic is ok, but data has invalid format, will try to recreate";
-            else
-                error += "File format is unknown or invalid, please fix it manually";
-            LogFnPrintf(error);
-            if (readResult != ReadResult::IncorrectFormat)
-                return false;
-        }
-        return true;
+        return CheckReadResult(readResult, error);
     }
 
     bool Dump(const T& objToSave, const bool bCheckPrevFileFormat)
@@ -226,45 +306,513 @@ public:
             const ReadResult readResult = Read(tmpObjToLoad, error, true);
 
             // there was an error and it was not an error on file opening => do not proceed
-            if (readResult == ReadResult::FileError)
-                LogFnPrintf("Missing file %s, will try to recreate", strFilename);
-            else if (readResult != ReadResult::Ok)
-            {
-                error = strprintf("Error reading %s. %s. ", strFilename, error);
-                if (readResult == ReadResult::IncorrectFormat)
-                    error += "Magic is ok, but data has invalid format, will try to recreate";
-                else
-                    error += "File format is unknown or invalid, please fix it manually";
-                LogFnPrintf(error);
-                if (readResult != ReadResult::IncorrectFormat)
-                    return false;
-            }
+            if (!CheckReadResult(readResult, error))
+                return false;
         }
 
         LogFnPrintf("Writing [%s]...", pathDB.string());
-        if (Write(objToSave))
+        if (!Write(objToSave) || !CommitFile())
+            return false;
+        LogFnPrintf("%s dump finished, %dms", strFilename, GetTimeMillis() - nStart);
+        return true;
+    }
+};
+
+/**
+*   Journaled Dumping and Loading
+*   -----------------------------
+*   Object state is exported as a set of keyed records. The cache file keeps
+*   a compacted snapshot of all records, and <name>.journal keeps the delta log
+*   of record puts and erases appended by the dumps since the snapshot.
+*   Journal header refers to the snapshot checksum, so a journal left from the
+*   previous snapshot (crash during compaction) is ignored on load.
+*   Each dump appends one frame: <uint32 size><entries><checksum>; a frame
+*   interrupted by a crash fails the size or checksum check and is discarded
+*   on replay together with everything after it.
+*   Snapshot and journal headers have format version, files with another
+*   version are discarded and the next dump writes a new snapshot.
+*/
+
+// record key (record type + serialized key) -> serialized record value
+using flatdb_records_t = std::map<std::string, std::string>;
+
+constexpr auto FLATDB_SNAPSHOT_MAGIC_SUFFIX = "-snapshot";
+constexpr auto FLATDB_JOURNAL_MAGIC_SUFFIX = "-journal";
+// snapshot and journal format version, stored in the file headers
+constexpr uint32_t FLATDB_JOURNAL_FORMAT_VERSION = 1;
+
+/**
+ * Add record to the flat DB record map.
+ * 
+ * \param records - record map
+ * \param chRecordType - record type, first char of the record key
+ * \param key - record key
+ * \param value - record value
+ */
+template <typename K, typename V>
+void AddFlatDBRecord(flatdb_records_t &records, const char chRecordType, const K& key, const V& value)
+{
+    CDataStream ss(SER_DISK, CLIENT_VERSION);
+    ss << key;
+    std::string sKey(1, chRecordType);
+    sKey.append(ss.begin(), ss.end());
+    ss.clear();
+    ss << value;
+    records.emplace(std::move(sKey), std::string(ss.begin(), ss.end()));
+}
+
+/**
+ * Deserialize key and value of the flat DB record.
+ * Throws std::ios_base::failure if record can't be deserialized.
+ * 
+ * \param sKey - record key (record type + serialized key)
+ * \param sValue - serialized record value
+ * \param key - deserialized key
+ * \param value - deserialized value
+ */
+template <typename K, typename V>
+void ReadFlatDBRecord(const std::string &sKey, const std::string &sValue, K& key, V& value)
+{
+    CDataStream ssKey(sKey.data() + 1, sKey.data() + sKey.size(), SER_DISK, CLIENT_VERSION);
+    ssKey >> key;
+    CDataStream ssValue(sValue.data(), sValue.data() + sValue.size(), SER_DISK, CLIENT_VERSION);
+    ssValue >> value;
+}
+
+enum class FLATDB_JOURNAL_OP : uint8_t
+{
+    PUT = 1,
+    ERASE = 2
+};
+
+class CFlatDBJournalEntry
+{
+public:
+    FLATDB_JOURNAL_OP op = FLATDB_JOURNAL_OP::PUT;
+    std::string sKey;
+    std::string sValue; // empty for ERASE
+
+    CFlatDBJournalEntry() noexcept = default;
+    CFlatDBJournalEntry(const FLATDB_JOURNAL_OP opIn, const std::string &sKeyIn, const std::string &sValueIn = std::string()) :
+        op(opIn),
+        sKey(sKeyIn),
+        sValue(sValueIn)
+    {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        uint8_t nOp = to_integral_type(op);
+        READWRITE(nOp);
+        if (ser_action == SERIALIZE_ACTION::Read)
         {
+            if ((nOp != to_integral_type(FLATDB_JOURNAL_OP::PUT)) && (nOp != to_integral_type(FLATDB_JOURNAL_OP::ERASE)))
+                throw std::ios_base::failure(strprintf("Invalid journal operation %u", nOp));
+            op = static_cast<FLATDB_JOURNAL_OP>(nOp);
+        }
+        READWRITE(sKey);
+        READWRITE(sValue);
+    }
+};
+
+/**
+ * Journaled flat DB snapshot: <format version><records>.
+ * Records of the snapshot with another format version are not read.
+ */
+class CFlatDBSnapshot
+{
+public:
+    uint32_t nVersion = FLATDB_JOURNAL_FORMAT_VERSION;
+    flatdb_records_t records;
+
+    bool IsSupportedVersion() const noexcept { return nVersion == FLATDB_JOURNAL_FORMAT_VERSION; }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        READWRITE(nVersion);
+        if ((ser_action == SERIALIZE_ACTION::Read) && !IsSupportedVersion())
+            return;
+        READWRITE(records);
+    }
+};
+
+/**
+ * Flat DB with append-only journal.
+ * T should implement:
+ *   void GetFlatDBRecords(flatdb_records_t &records) const - export object state as records
+ *   void LoadFlatDBRecord(const std::string &sKey, const std::string &sValue) - add record to the object
+ *   void Clear(), void CheckAndRemove(), std::string ToString() const
+ */
+template<typename T>
+class CJournaledFlatDB : public CFlatDB<T>
+{
+    using ReadResult = typename CFlatDB<T>::ReadResult;
+
+public:
+    CJournaledFlatDB(const std::string &strFilenameIn, const std::string &strMagicMessageIn) :
+        CFlatDB<T>(strFilenameIn, strMagicMessageIn)
+    {
+        strSnapshotMagicMessage = strMagicMessageIn + FLATDB_SNAPSHOT_MAGIC_SUFFIX;
+        strJournalMagicMessage = strMagicMessageIn + FLATDB_JOURNAL_MAGIC_SUFFIX;
+        pathJournal = this->pathDB;
+        pathJournal.replace_extension(".journal");
+    }
+
+    std::string getJournalPath() const noexcept { return pathJournal.string(); }
+    uint64_t getJournalSize() const noexcept { return m_nJournalSize; }
+    uint64_t getSnapshotSize() const noexcept { return m_nSnapshotSize; }
+
+    /**
+     * Load object from the snapshot and replay the journal.
+     * Cache file in the full (non-journaled) format is loaded as is,
+     * it is replaced by the snapshot on the next dump.
+     * Snapshot with unsupported format version is discarded together with
+     * its journal, the object stays empty and the next dump writes a new snapshot.
+     * 
+     * \param objToLoad - object to load
+     * \return false if file exists but can't be used and should be fixed manually
+     */
+    bool Load(T& objToLoad)
+    {
+        std::unique_lock lck(m_JournalMutex);
+        std::string error;
+        LogFnPrintf("Reading info from %s...", this->strFilename);
+
+        CTimer timer;
+        timer.start();
+        m_bJournalValid = false;
+        m_nSnapshotSize = 0;
+        m_nJournalSize = 0;
+        m_mapRecordHashes.clear();
+
+        CFlatDBSnapshot snapshot;
+        auto &records = snapshot.records;
+        ReadResult readResult = this->ReadFile(strSnapshotMagicMessage, snapshot, error);
+        if (readResult == ReadResult::IncorrectMagicMessage)
+        {
+            LogFnPrintf("%s is not a journaled snapshot, loading full cache", this->strFilename);
+            return CFlatDB<T>::Load(objToLoad);
+        }
+        if ((readResult == ReadResult::Ok) && !snapshot.IsSupportedVersion())
+        {
+            LogFnPrintf("%s has unsupported snapshot format version %u (expected %u), discarded",
+                this->strFilename, snapshot.nVersion, FLATDB_JOURNAL_FORMAT_VERSION);
+            objToLoad.Clear();
+            RemoveJournal();
+            return true;
+        }
+        if (readResult == ReadResult::Ok)
+        {
+            m_nSnapshotSize = fs::file_size(this->pathDB);
+            const size_t nFrames = ReplayJournal(records);
             try
             {
-                bool bBackup = false;
-                fs::path pathDBbackup = pathDB;
-                pathDBbackup.replace_extension(".bak");
-                if (fs::exists(pathDB))
-                {
-                    fs::rename(pathDB, pathDBbackup);
-                    bBackup = true;
-                }
-                fs::rename(pathDBNew, pathDB);
-                if (bBackup)
-                    fs::remove(pathDBbackup);
-                LogFnPrintf("%s dump finished, %dms", strFilename, GetTimeMillis() - nStart);
-            } catch (const std::exception& ex)
+                objToLoad.Clear();
+                for (const auto& [sKey, sValue] : records)
+                    objToLoad.LoadFlatDBRecord(sKey, sValue);
+                timer.stop();
+                LogFnPrintf("Loaded %zu records from %s (%zu journal frames)  %zums",
+                    records.size(), this->strFilename, nFrames, timer.elapsedMilliseconds());
+            } catch (const std::exception &e)
             {
-                LogFnPrintf("Error writing to file [%s]. %s", pathDB.string(), ex.what());
-                return false;
+                objToLoad.Clear();
+                m_bJournalValid = false;
+                error = strprintf("Failed to load record - %s", e.what());
+                readResult = ReadResult::IncorrectFormat;
+            }
+        }
+        if (readResult != ReadResult::Ok)
+            return this->CheckReadResult(readResult, error);
+
+        for (const auto& [sKey, sValue] : records)
+            m_mapRecordHashes.emplace(sKey, Hash(sValue.data(), sValue.data() + sValue.size()));
+        LogFnPrintf("     %s", objToLoad.ToString());
+        LogFnPrintf("Cleaning...");
+        objToLoad.CheckAndRemove();
+        LogFnPrintf("     %s", objToLoad.ToString());
+        return true;
+    }
+
+    /**
+     * Append changed and erased records to the journal.
+     * Writes new snapshot and starts a new journal if there is no valid journal
+     * or the journal grew larger than the snapshot.
+     * 
+     * \param objToSave - object to save
+     * \return true if the object state was saved
+     */
+    bool Dump(const T& objToSave)
+    {
+        std::unique_lock lck(m_JournalMutex);
+        const int64_t nStart = GetTimeMillis();
+
+        CFlatDBSnapshot snapshot;
+        const auto &records = snapshot.records;
+        objToSave.GetFlatDBRecords(snapshot.records);
+
+        if (!m_bJournalValid || (m_nJournalSize > m_nSnapshotSize))
+            return Compact(snapshot, nStart);
+
+        std::vector<CFlatDBJournalEntry> vEntries;
+        std::unordered_map<std::string, uint256> mapChangedHashes;
+        size_t nMatched = 0;
+        for (const auto& [sKey, sValue] : records)
+        {
+            const uint256 hash = Hash(sValue.data(), sValue.data() + sValue.size());
+            const auto it = m_mapRecordHashes.find(sKey);
+            if (it != m_mapRecordHashes.cend())
+            {
+                ++nMatched;
+                if (it->second == hash)
+                    continue;
             }
+            vEntries.emplace_back(FLATDB_JOURNAL_OP::PUT, sKey, sValue);
+            mapChangedHashes.emplace(sKey, hash);
+        }
+        const size_t nPuts = vEntries.size();
+        // some of the stored records are not in the object anymore
+        if (nMatched < m_mapRecordHashes.size())
+        {
+            for (const auto& [sKey, hash] : m_mapRecordHashes)
+            {
+                if (records.find(sKey) == records.cend())
+                    vEntries.emplace_back(FLATDB_JOURNAL_OP::ERASE, sKey);
+            }
+        }
+        if (vEntries.empty())
+        {
+            LogFnPrintf("%s has no changes", this->strFilename);
+            return true;
+        }
+        if (!AppendJournal(vEntries))
+        {
+            m_bJournalValid = false;
+            return Compact(snapshot, nStart);
+        }
+        for (auto& [sKey, hash] : mapChangedHashes)
+            m_mapRecordHashes[sKey] = hash;
+        for (size_t i = nPuts; i < vEntries.size(); ++i)
+            m_mapRecordHashes.erase(vEntries[i].sKey);
+        LogFnPrintf("%s journal updated: %zu puts, %zu erases, %dms", this->strFilename,
+            nPuts, vEntries.size() - nPuts, GetTimeMillis() - nStart);
+        return true;
+    }
+
+protected:
+    fs::path pathJournal;
+    std::string strSnapshotMagicMessage;
+    std::string strJournalMagicMessage;
+
+    std::mutex m_JournalMutex;
+    // hashes of the records stored in the snapshot and journal
+    std::unordered_map<std::string, uint256> m_mapRecordHashes;
+    // journal file exists and extends the current snapshot
+    bool m_bJournalValid = false;
+    uint64_t m_nSnapshotSize = 0;
+    uint64_t m_nJournalSize = 0;
+
+    /**
+     * Write all records to the new snapshot and start a new journal.
+     * 
+     * \param snapshot - object state
+     * \param nStart - dump start time
+     * \return true if the snapshot was written
+     */
+    bool Compact(const CFlatDBSnapshot &snapshot, const int64_t nStart)
+    {
+        const auto &records = snapshot.records;
+        LogFnPrintf("Writing [%s] snapshot...", this->pathDB.string());
+        m_bJournalValid = false;
+        if (!this->WriteFile(strSnapshotMagicMessage, snapshot) || !this->CommitFile())
+            return false;
+        m_nSnapshotSize = fs::file_size(this->pathDB);
+
+        m_mapRecordHashes.clear();
+        m_mapRecordHashes.reserve(records.size());
+        for (const auto& [sKey, sValue] : records)
+            m_mapRecordHashes.emplace(sKey, Hash(sValue.data(), sValue.data() + sValue.size()));
+
+        // journal of the previous snapshot is not valid anymore
+        m_bJournalValid = CreateJournal();
+        LogFnPrintf("%s snapshot dump finished, %zu records, %dms", this->strFilename,
+            records.size(), GetTimeMillis() - nStart);
+        return true;
+    }
+
+    /**
+     * Create empty journal for the current snapshot.
+     * 
+     * \return true if journal was created
+     */
+    bool CreateJournal()
+    {
+        FILE* file = fopen(pathJournal.string().c_str(), "wb");
+        CAutoFile fileout(file, SER_DISK, CLIENT_VERSION);
+        if (fileout.IsNull())
+            return error("%s: Failed to open file %s", __func__, pathJournal.string());
+        try
+        {
+            CDataStream ss(SER_DISK, CLIENT_VERSION);
+            ss << strJournalMagicMessage;
+            ss << FLATDATA(Params().MessageStart()); //-V568 network specific magic number
+            ss << FLATDB_JOURNAL_FORMAT_VERSION;
+            ss << this->hashSnapshot;
+            fileout << ss;
+            FileCommit(fileout.Get());
+            m_nJournalSize = ss.size();
+        } catch (const std::exception &e)
+        {
+            return error("%s: Serialize or I/O error - %s", __func__, e.what());
         }
+        return true;
+    }
 
+    /**
+     * Remove journal file, journal is not valid anymore.
+     */
+    void RemoveJournal()
+    {
+        m_bJournalValid = false;
+        m_nJournalSize = 0;
+        try
+        {
+            fs::remove(pathJournal);
+        } catch (const std::exception &e)
+        {
+            LogFnPrintf("Failed to remove journal [%s] - %s", pathJournal.string(), e.what());
+        }
+    }
+
+    /**
+     * Append one frame with journal entries.
+     * 
+     * \param vEntries - journal entries
+     * \return true if the frame was written and committed to disk
+     */
+    bool AppendJournal(const std::vector<CFlatDBJournalEntry> &vEntries)
+    {
+        CDataStream ssFrame(SER_DISK, CLIENT_VERSION);
+        ssFrame << vEntries;
+        const uint32_t nFrameSize = static_cast<uint32_t>(ssFrame.size());
+        const uint256 hashFrame = Hash(ssFrame.begin(), ssFrame.end());
+
+        FILE* file = fopen(pathJournal.string().c_str(), "ab");
+        CAutoFile fileout(file, SER_DISK, CLIENT_VERSION);
+        if (fileout.IsNull())
+            return error("%s: Failed to open file %s", __func__, pathJournal.string());
+        try
+        {
+            fileout << nFrameSize;
+            fileout << ssFrame;
+            fileout << hashFrame;
+            FileCommit(fileout.Get());
+        } catch (const std::exception &e)
+        {
+            return error("%s: Serialize or I/O error - %s", __func__, e.what());
+        }
+        m_nJournalSize += sizeof(nFrameSize) + nFrameSize + sizeof(uint256);
         return true;
     }
+
+    /**
+     * Apply journal frames written after the current snapshot to the snapshot records.
+     * Journal is truncated after the last valid frame.
+     * 
+     * \param records - snapshot records
+     * \return number of applied frames
+     */
+    size_t ReplayJournal(flatdb_records_t &records)
+    {
+        if (!fs::exists(pathJournal))
+            return 0;
+        FILE* file = fopen(pathJournal.string().c_str(), "rb");
+        CAutoFile filein(file, SER_DISK, CLIENT_VERSION);
+        if (filein.IsNull())
+            return 0;
+        const auto nFileSize = fs::file_size(pathJournal);
+        v_uint8 vchData(nFileSize);
+        size_t nValidSize = 0;
+        size_t nFrames = 0;
+        try
+        {
+            if (nFileSize)
+                filein.read((char *)&vchData[0], nFileSize);
+            filein.fclose();
+
+            CDataStream ss(vchData, SER_DISK, CLIENT_VERSION);
+            std::string strMagicMessageTmp;
+            unsigned char pchMsgTmp[4];
+            uint32_t nVersionTmp = 0;
+            uint256 hashSnapshotTmp;
+            ss >> strMagicMessageTmp;
+            ss >> FLATDATA(pchMsgTmp);
+            ss >> nVersionTmp;
+            ss >> hashSnapshotTmp;
+            if ((strMagicMessageTmp != strJournalMagicMessage) ||
+                memcmp(pchMsgTmp, Params().MessageStart(), sizeof(pchMsgTmp)) ||
+                (nVersionTmp != FLATDB_JOURNAL_FORMAT_VERSION) ||
+                (hashSnapshotTmp != this->hashSnapshot))
+            {
+                LogFnPrintf("Journal [%s] does not match the snapshot, ignored", pathJournal.string());
+                return 0;
+            }
+            m_bJournalValid = true;
+            // CDataStream resets read position when all data is read, so count consumed bytes by the remaining size
+            nValidSize = nFileSize - ss.size();
+
+            v_uint8 vFrame;
+            std::vector<CFlatDBJournalEntry> vEntries;
+            while (ss.size() >= sizeof(uint32_t))
+            {
+                uint32_t nFrameSize = 0;
+                ss >> nFrameSize;
+                if (ss.size() < nFrameSize + sizeof(uint256))
+                    break;
+                vFrame.resize(nFrameSize);
+                if (nFrameSize)
+                    ss.read((char *)&vFrame[0], nFrameSize);
+                uint256 hashFrame;
+                ss >> hashFrame;
+                if (hashFrame != Hash(vFrame.begin(), vFrame.end()))
+                    break;
+                CDataStream ssFrame(vFrame, SER_DISK, CLIENT_VERSION);
+                vEntries.clear();
+                ssFrame >> vEntries;
+                for (auto& entry : vEntries)
+                {
+                    if (entry.op == FLATDB_JOURNAL_OP::PUT)
+                        records[entry.sKey] = std::move(entry.sValue);
+                    else
+                        records.erase(entry.sKey);
+                }
+                nValidSize = nFileSize - ss.size();
+                ++nFrames;
+            }
+        } catch (const std::exception &e)
+        {
+            LogFnPrintf("Failed to read journal [%s] - %s", pathJournal.string(), e.what());
+        }
+        if (!m_bJournalValid)
+            return 0;
+        m_nJournalSize = nValidSize;
+        if (nValidSize < nFileSize)
+        {
+            LogFnPrintf("Journal [%s] has incomplete data at %zu/%zu, truncating",
+                pathJournal.string(), nValidSize, nFileSize);
+            try
+            {
+                fs::resize_file(pathJournal, nValidSize);
+            } catch (const std::exception &e)
+            {
+                LogFnPrintf("Failed to truncate journal [%s] - %s", pathJournal.string(), e.what());
+                m_bJournalValid = false;
+            }
+        }
+        return nFrames;
+    }
 };
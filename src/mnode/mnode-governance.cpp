@@ -16,6 +16,8 @@ CCriticalSection cs_mapVotes;
 
 using namespace std;
 
+const string CMasternodeGovernance::SERIALIZATION_VERSION_STRING = "CMasternodeGovernance-Version-1";
+
 CAmount CMasternodeGovernance::GetGovernancePaymentForHeight(int nHeight)
 {
     const CChainParams& chainparams = Params();
@@ -323,7 +325,7 @@ void CMasternodeGovernance::ProcessMessage(node_t& pfrom, string& strCommand, CD
         vRecv >> ticket;
 
         const uint256 ticketId = ticket.GetHash();
-        pfrom->setAskFor.erase(ticketId);
+        pfrom->RemoveAskFor(ticketId);
 
         if(!masterNodeCtrl.masternodeSync.IsMasternodeListSynced())
             return;
@@ -363,14 +365,21 @@ void CMasternodeGovernance::ProcessMessage(node_t& pfrom, string& strCommand, CD
         LogPrintf("GOVERNANCE -- Got vote %s from peer=%d\n", vote.ToString(), pfrom->id);
 
         const uint256 voteId = vote.GetHash();
-        pfrom->setAskFor.erase(voteId);
+        pfrom->RemoveAskFor(voteId);
 
-        vector<CGovernanceVote> votesToCheck;
-        votesToCheck.emplace_back(std::move(vote));
-        if (!ProcessGovernanceVotes(true, votesToCheck, pfrom))
-            return;
+        // signature is recovered by the verification workers, votes are processed in order of arrival
+        auto pvote = make_shared<CGovernanceVote>(std::move(vote));
+        masterNodeCtrl.sigVerifyQueue.Submit(
+            [pvote]() { pvote->PrecomputeSignature(); },
+            [this, pfrom, pvote]()
+            {
+                vector<CGovernanceVote> votesToCheck;
+                votesToCheck.emplace_back(std::move(*pvote));
+                if (!ProcessGovernanceVotes(true, votesToCheck, pfrom.get()))
+                    return;
 
-        masterNodeCtrl.masternodeSync.BumpAssetLastTime("GOVERNANCEVOTE");
+                masterNodeCtrl.masternodeSync.BumpAssetLastTime("GOVERNANCEVOTE");
+            });
     }
 }
 
@@ -393,7 +402,7 @@ bool CMasternodeGovernance::ProcessGovernanceVotes(const bool bVoteOnlyMsg, vect
             const bool bVoteExists = vi != mapVotes.cend();
             if (bVoteExists)
             {
-                if (!vi->second.ReprocessVote())
+                if (!vi->second.ReprocessVote(nCachedBlockHeight))
                 {
                     LogPrintf("GOVERNANCEVOTE -- hash=%s, nHeight=%d seen\n", voteId.ToString(), nCachedBlockHeight);
                     continue;
@@ -620,22 +629,30 @@ bool CGovernanceTicket::AddVote(CGovernanceVote& voteNew, string& error)
         return false;
     }
 
+    size_t nVoteCount = 0;
     {
         unique_lock lock(m_sigVotesMapLock);
-        if (m_sigVotesMap.count(voteNew.vchSig))
+        // MN can vote only once for the ticket
+        const auto result = m_mapMnVotes.emplace(voteNew.vinMasternode.prevout, voteNew.bVote);
+        if (!result.second || m_sigVotesMap.count(voteNew.vchSig))
         {
+            if (result.second)
+                m_mapMnVotes.erase(result.first);
             error = strprintf("signature already exists: MN has already voted for this ticket = %s", voteId.ToString());
             LogFnPrintf("%s", error);
             return false;
         }
 
         m_sigVotesMap[voteNew.vchSig] = voteNew;
+        if (voteNew.bVote)
+            nYesVotes++;
+        else
+            nNoVotes++;
+        nVoteCount = m_sigVotesMap.size();
     }
-    if (voteNew.bVote)
-        nYesVotes++;
 
     LogFnPrintf("New vote for ticket = %s - %s vote; total votes(yes votes) - %zu(%d)",
-        voteId.ToString(), voteNew.bVote? "Yes" : "No", m_sigVotesMap.size(), nYesVotes);
+        voteId.ToString(), voteNew.bVote? "Yes" : "No", nVoteCount, nYesVotes);
     return true;
 }
 
@@ -684,7 +701,19 @@ void CGovernanceTicket::ForEachVote(const std::function<void(const CGovernanceVo
 size_t CGovernanceTicket::GetVoteCount() const
 {
     unique_lock lck(m_sigVotesMapLock);
-    return m_sigVotesMap.size();
+    return m_mapMnVotes.size();
+}
+
+/**
+ * Check if masternode has already voted for this ticket.
+ * 
+ * \param outpointMasternode - masternode collateral outpoint
+ * \return true if vote from this masternode exists
+ */
+bool CGovernanceTicket::HasVoted(const COutPoint& outpointMasternode) const
+{
+    unique_lock lck(m_sigVotesMapLock);
+    return m_mapMnVotes.count(outpointMasternode) > 0;
 }
 
 void CGovernanceTicket::InvalidateVote(const CGovernanceVote& vote)
@@ -694,11 +723,44 @@ void CGovernanceTicket::InvalidateVote(const CGovernanceVote& vote)
 
     unique_lock lck(m_sigVotesMapLock);
     auto it = m_sigVotesMap.find(vote.vchSig);
-    if (it != m_sigVotesMap.end())
+    if (it == m_sigVotesMap.end())
+        return;
+    const auto itTally = m_mapMnVotes.find(it->second.vinMasternode.prevout);
+    if (itTally != m_mapMnVotes.end())
+    {
+        // use the vote we have counted, not the one received
+        if (itTally->second)
+            nYesVotes = max(nYesVotes - 1, 0);
+        else
+            nNoVotes = max(nNoVotes - 1, 0);
+        m_mapMnVotes.erase(itTally);
+    }
+    m_sigVotesMap.erase(it);
+}
+
+/**
+ * Recalculate vote tallies from the ticket votes.
+ * Should be called under m_sigVotesMapLock.
+ */
+void CGovernanceTicket::RebuildVoteTally()
+{
+    m_mapMnVotes.clear();
+    nYesVotes = 0;
+    nNoVotes = 0;
+    for (auto it = m_sigVotesMap.begin(); it != m_sigVotesMap.end();)
     {
-        m_sigVotesMap.erase(it);
-        if (vote.bVote && nYesVotes > 0)
-            --nYesVotes;
+        const auto& vote = it->second;
+        // drop duplicate votes from the same masternode
+        if (!m_mapMnVotes.emplace(vote.vinMasternode.prevout, vote.bVote).second)
+        {
+            it = m_sigVotesMap.erase(it);
+            continue;
+        }
+        if (vote.bVote)
+            ++nYesVotes;
+        else
+            ++nNoVotes;
+        ++it;
     }
 }
 
@@ -717,8 +779,9 @@ string CGovernanceTicket::ToString()
             ", Note: " << strDescription <<
             ", Vote until block: " << nStopVoteBlockHeight <<
             (!VoteOpen()? "(Voting Closed!)": "") <<
-            ", Total votes: " << m_sigVotesMap.size() <<
-            ", Yes votes: " << nYesVotes;
+            ", Total votes: " << GetVoteCount() <<
+            ", Yes votes: " << nYesVotes <<
+            ", No votes: " << nNoVotes;
     if ( nLastPaymentBlockHeight != 0 ){
         info << ", Winner! Payment blocks " << nFirstPaymentBlockHeight << "-" << nLastPaymentBlockHeight <<
                 ", Amount paid: " << nAmountPaid/COIN;
@@ -742,11 +805,15 @@ void CGovernanceTicket::Relay()
     CNodeHelper::RelayInv(inv);
 }
 
+string CGovernanceVote::getMessage() const noexcept
+{
+    return vinMasternode.prevout.ToStringShort() + ticketId.ToString();
+}
+
 bool CGovernanceVote::Sign()
 {
     string strError;
-    string strMessage = vinMasternode.prevout.ToStringShort() +
-                ticketId.ToString();
+    const string strMessage = getMessage();
 
     LogFnPrintf("Vote to sign: %s (%s)", ToString(), strMessage);
 
@@ -769,8 +836,7 @@ bool CGovernanceVote::CheckSignature(const CPubKey& pubKeyMasternode, int stopVo
 {
     // do not ban by default
     nDos = 0;
-    // message to sign: "<mn_outpoint><ticketId>"
-    const string strMessage = vinMasternode.prevout.ToStringShort() + ticketId.ToString();
+    const string strMessage = getMessage();
 
     LogFnPrintf("Vote to check: %s (%s)", ToString(), strMessage);
 
@@ -789,6 +855,12 @@ bool CGovernanceVote::CheckSignature(const CPubKey& pubKeyMasternode, int stopVo
     return true;
 }
 
+void CGovernanceVote::PrecomputeSignature() const
+{
+    if (!vchSig.empty())
+        CMessageSigner::PrecomputeMessage(getMessage(), vchSig);
+}
+
 string CGovernanceVote::ToString() const noexcept
 {
     ostringstream info;
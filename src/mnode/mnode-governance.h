@@ -64,20 +64,24 @@ public:
         return ss.GetHash();
     }
 
+    // get vote message to sign: "<mn_outpoint><ticketId>"
+    std::string getMessage() const noexcept;
     bool Sign();
     bool CheckSignature(const CPubKey& pubKeyMasternode, int stopVoteHeight, int &nDos) const;
+    // recover public key from the vote signature into the signature recovery cache
+    void PrecomputeSignature() const;
     void Relay();
 
     bool IsVerified() const noexcept { return !vchSig.empty(); }
     void MarkAsNotVerified() noexcept { vchSig.clear(); }
 
-    bool ReprocessVote() const
+    // check if the vote waiting for the ticket should be processed again at the given block height
+    bool ReprocessVote(const int nHeight) const noexcept
     {
         if (nWaitForTicketRank == 0 || nWaitForTicketRank > 3)
             return false;
 
-        LOCK(cs_main);
-        return chainActive.Height() > nSyncBlockHeight + nWaitForTicketRank*5;
+        return nHeight > nSyncBlockHeight + nWaitForTicketRank*5;
     }
 
     void SetReprocessWaiting(const int nBlockHeight) noexcept
@@ -102,6 +106,7 @@ public:
     
     int             nStopVoteBlockHeight{0};        // blockheight when the voting for this ticket ends
     int             nYesVotes{0};
+    int             nNoVotes{0};
 
     //if a winner
     int             nFirstPaymentBlockHeight{0};    // blockheight when the payment to this ticket starts
@@ -118,10 +123,13 @@ public:
         strDescription = ticket.strDescription;
         nStopVoteBlockHeight = ticket.nStopVoteBlockHeight;
         nYesVotes = ticket.nYesVotes;
+        nNoVotes = ticket.nNoVotes;
         nFirstPaymentBlockHeight = ticket.nFirstPaymentBlockHeight;
         nLastPaymentBlockHeight = ticket.nLastPaymentBlockHeight;
         ticketId = ticket.ticketId;
+        std::unique_lock<std::mutex> lock(ticket.m_sigVotesMapLock);
         m_sigVotesMap = ticket.m_sigVotesMap;
+        m_mapMnVotes = ticket.m_mapMnVotes;
     }
 
     CGovernanceTicket &operator=(const CGovernanceTicket &ticket) noexcept
@@ -134,12 +142,14 @@ public:
             strDescription = ticket.strDescription;
             nStopVoteBlockHeight = ticket.nStopVoteBlockHeight;
             nYesVotes = ticket.nYesVotes;
+            nNoVotes = ticket.nNoVotes;
             nFirstPaymentBlockHeight = ticket.nFirstPaymentBlockHeight;
             nLastPaymentBlockHeight = ticket.nLastPaymentBlockHeight;
             ticketId = ticket.ticketId;
             {
-                std::unique_lock<std::mutex> lock(m_sigVotesMapLock);
+                std::scoped_lock lock(m_sigVotesMapLock, ticket.m_sigVotesMapLock);
                 m_sigVotesMap = ticket.m_sigVotesMap;
+                m_mapMnVotes = ticket.m_mapMnVotes;
             }
         }
         return *this;
@@ -151,6 +161,7 @@ public:
         strDescription(description),
         nStopVoteBlockHeight(height),
         nYesVotes(0),
+        nNoVotes(0),
         nFirstPaymentBlockHeight(0),
         nLastPaymentBlockHeight(0)
     {}
@@ -173,6 +184,20 @@ public:
         READWRITE(nFirstPaymentBlockHeight);
         READWRITE(nLastPaymentBlockHeight);
         READWRITE(ticketId);
+        // vote tallies are persisted in governance.dat only,
+        // tallies of the ticket received from the network are always recalculated
+        if (s.GetType() & SER_DISK)
+        {
+            READWRITE(nNoVotes);
+            std::unique_lock<std::mutex> lock(m_sigVotesMapLock);
+            READWRITE(m_mapMnVotes);
+        }
+        if (ser_action == SERIALIZE_ACTION::Read)
+        {
+            std::unique_lock<std::mutex> lock(m_sigVotesMapLock);
+            if (!(s.GetType() & SER_DISK) || (m_mapMnVotes.size() != m_sigVotesMap.size()))
+                RebuildVoteTally();
+        }
     }
 
     bool VoteOpen(const int height) const noexcept { return height <= nStopVoteBlockHeight; }
@@ -183,6 +208,7 @@ public:
     // call fnProcessVote for each governance vote
     void ForEachVote(const std::function<void(const CGovernanceVote&)> &fnProcessVote) const;
     size_t GetVoteCount() const;
+    bool HasVoted(const COutPoint& outpointMasternode) const;
     void InvalidateVote(const CGovernanceVote& vote);
 
     uint256 GetHash() const;
@@ -194,6 +220,11 @@ protected:
     mutable std::mutex m_sigVotesMapLock;
     // map of <vote signature> -> <vote>, access protected by m_sigVotesMapLock
     std::map<v_uint8, CGovernanceVote> m_sigVotesMap;
+    // vote tally - map of <masternode outpoint> -> <yes/no vote>, access protected by m_sigVotesMapLock
+    std::map<COutPoint, bool> m_mapMnVotes;
+
+    // recalculate vote tallies from m_sigVotesMap, should be called under m_sigVotesMapLock
+    void RebuildVoteTally();
 };
 
 class CMasternodeGovernance
@@ -209,6 +240,9 @@ public:
     std::map<uint256, CGovernanceTicket> mapTickets;
     std::map<int, uint256> mapPayments;
 
+    // governance.dat version with persisted vote tallies
+    static const std::string SERIALIZATION_VERSION_STRING;
+
     CMasternodeGovernance() : nMaxPaidTicketsToStore(5000), nCachedBlockHeight(0) {}
 
     ADD_SERIALIZE_METHODS;
@@ -216,8 +250,48 @@ public:
     template <typename Stream>
     inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
     {
+        std::string strVersion;
+        bool bLegacyFormat = false;
+        if (ser_action == SERIALIZE_ACTION::Read)
+        {
+            // governance.dat written before tallies were added has no version string
+            bLegacyFormat = true;
+            do
+            {
+                const size_t nSerializedVersionSize = SERIALIZATION_VERSION_STRING.length();
+                if (s.size() < nSerializedVersionSize + 1)
+                    break;
+                const size_t nSize = static_cast<size_t>(ser_readdata8(s));
+                if (nSize != nSerializedVersionSize)
+                {
+                    s.rewind(1);
+                    break;
+                }
+                strVersion.resize(nSize);
+                s.read(strVersion.data(), nSize);
+                if (strVersion != SERIALIZATION_VERSION_STRING)
+                {
+                    s.rewind(nSize + 1);
+                    break;
+                }
+                bLegacyFormat = false;
+            } while (false);
+        }
+        else
+        {
+            strVersion = SERIALIZATION_VERSION_STRING;
+            READWRITE(strVersion);
+        }
+
         LOCK2(cs_mapTickets,cs_mapPayments);
-        READWRITE(mapTickets);
+        if (bLegacyFormat)
+        {
+            // legacy tickets have no persisted tallies - read them as network tickets to rebuild tallies from the votes
+            OverrideStream<Stream> sLegacy(&s, s.GetType() & ~SER_DISK, s.GetVersion());
+            ::SerReadWrite(sLegacy, mapTickets, ser_action);
+        }
+        else
+            READWRITE(mapTickets);
         READWRITE(mapPayments);
         LOCK(cs_mapVotes);
         READWRITE(mapVotes);
@@ -248,6 +322,7 @@ public:
 
     std::string ToString() const;
     void Clear();
+    int GetCachedBlockHeight() const noexcept { return nCachedBlockHeight; }
 
     void UpdatedBlockTip(const CBlockIndex *pindex);
 
@@ -0,0 +1,169 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <utils/util.h>
+#include <utils/hash.h>
+#include <utils/streams.h>
+#include <mnode/mnode-histdb.h>
+
+using namespace std;
+
+/**
+ * Open MN history DB.
+ * 
+ * \param dbPath - path to the DB directory
+ * \param nCacheSize - LevelDB cache size in bytes
+ * \param bWipe - if true - erase all existing records
+ * \param nDepth - number of blocks to keep top MNs for (0 - keep all)
+ * \return true if DB was successfully opened
+ */
+bool CMasternodeHistoryDB::Init(const fs::path &dbPath, const size_t nCacheSize, const bool bWipe, const uint32_t nDepth)
+{
+    try
+    {
+        m_pDB = make_unique<CDBWrapper>(dbPath, nCacheSize, false, bWipe);
+    } catch (const exception& e)
+    {
+        LogFnPrintf("ERROR: failed to open MN history DB [%s]. %s", dbPath.string(), e.what());
+        m_pDB.reset();
+        return false;
+    }
+    m_nDepth = nDepth;
+    m_nPrunedHeight = 0;
+    m_mapMasternodes.clear();
+    m_mapSnapshotHashes.clear();
+    return true;
+}
+
+/**
+ * Write top masternodes for the block.
+ * Masternode snapshot is written when masternode is seen in top MNs for the first time
+ * and overwritten when masternode data is changed.
+ * 
+ * \param nHeight - block height
+ * \param vTopMNs - top masternodes for the block
+ * \return true if top MNs were written to the DB
+ */
+bool CMasternodeHistoryDB::WriteTopMNs(const uint32_t nHeight, const masternode_vector_t &vTopMNs)
+{
+    if (!m_pDB)
+        return false;
+    CDBBatch batch(*m_pDB);
+    v_outpoints vOutpoints, vWrittenOutpoints;
+    vOutpoints.reserve(vTopMNs.size());
+    for (const auto &pmn : vTopMNs)
+    {
+        if (!pmn)
+            continue;
+        const auto &outpoint = pmn->getOutPoint();
+        vOutpoints.push_back(outpoint);
+        CDataStream ss(SER_DISK, CLIENT_VERSION);
+        ss << *pmn;
+        const uint256 hash = Hash(ss.begin(), ss.end());
+        const auto it = m_mapSnapshotHashes.find(outpoint);
+        if ((it != m_mapSnapshotHashes.cend()) && (it->second == hash))
+            continue;
+        batch.Write(make_pair(MN_HISTORY_MN_PREFIX, outpoint), *pmn);
+        m_mapSnapshotHashes[outpoint] = hash;
+        m_mapMasternodes[outpoint] = pmn;
+        vWrittenOutpoints.push_back(outpoint);
+    }
+    batch.Write(mn_history_height_key_t(nHeight), vOutpoints);
+    if (m_pDB->WriteBatch(batch))
+        return true;
+    // snapshots were not written - write them again next time
+    for (const auto &outpoint : vWrittenOutpoints)
+        m_mapSnapshotHashes.erase(outpoint);
+    return false;
+}
+
+bool CMasternodeHistoryDB::HasTopMNs(const uint32_t nHeight) const
+{
+    if (!m_pDB)
+        return false;
+    return m_pDB->Exists(mn_history_height_key_t(nHeight));
+}
+
+bool CMasternodeHistoryDB::ReadTopMNs(const uint32_t nHeight, v_outpoints &vOutpoints) const
+{
+    vOutpoints.clear();
+    if (!m_pDB)
+        return false;
+    return m_pDB->Read(mn_history_height_key_t(nHeight), vOutpoints);
+}
+
+/**
+ * Read masternode snapshot stored with the top MNs.
+ * Loaded snapshots are kept in memory.
+ * 
+ * \param outpoint - masternode collateral outpoint
+ * \return masternode or nullptr if not found
+ */
+masternode_t CMasternodeHistoryDB::ReadMasternode(const COutPoint &outpoint)
+{
+    const auto it = m_mapMasternodes.find(outpoint);
+    if (it != m_mapMasternodes.cend())
+        return it->second;
+    if (!m_pDB)
+        return nullptr;
+    auto pmn = make_shared<CMasternode>();
+    if (!m_pDB->Read(make_pair(MN_HISTORY_MN_PREFIX, outpoint), *pmn))
+        return nullptr;
+    m_mapMasternodes.emplace(outpoint, pmn);
+    return pmn;
+}
+
+/**
+ * Erase top masternodes for the blocks older than MN history depth.
+ * Masternode snapshots are not pruned - there is one record per masternode.
+ * 
+ * \param nTipHeight - current chain height
+ * \return number of pruned blocks
+ */
+size_t CMasternodeHistoryDB::Prune(const uint32_t nTipHeight)
+{
+    if (!m_pDB || !m_nDepth || (nTipHeight <= m_nDepth))
+        return 0;
+    const uint32_t nPruneHeight = nTipHeight - m_nDepth;
+    if (nPruneHeight <= m_nPrunedHeight)
+        return 0;
+    size_t nPruned = 0;
+    CDBBatch batch(*m_pDB);
+    auto pIter = m_pDB->NewIterator();
+    for (pIter->Seek(mn_history_height_key_t(m_nPrunedHeight)); pIter->Valid(); pIter->Next())
+    {
+        mn_history_height_key_t key;
+        if (!pIter->GetKey(key) || (key.nHeight >= nPruneHeight))
+            break;
+        batch.Erase(key);
+        ++nPruned;
+    }
+    pIter.reset();
+    if (nPruned && !m_pDB->WriteBatch(batch))
+        return 0;
+    m_nPrunedHeight = nPruneHeight;
+    return nPruned;
+}
+
+void CMasternodeHistoryDB::Clear()
+{
+    m_mapMasternodes.clear();
+    m_mapSnapshotHashes.clear();
+    m_nPrunedHeight = 0;
+    if (!m_pDB)
+        return;
+    CDBBatch batch(*m_pDB);
+    auto pIter = m_pDB->NewIterator();
+    for (pIter->SeekToFirst(); pIter->Valid(); pIter->Next())
+    {
+        // top MNs key can't be parsed as masternode snapshot key and vice versa
+        mn_history_height_key_t key;
+        pair<char, COutPoint> mnKey;
+        if (pIter->GetKey(key))
+            batch.Erase(key);
+        else if (pIter->GetKey(mnKey))
+            batch.Erase(mnKey);
+    }
+    pIter.reset();
+    m_pDB->WriteBatch(batch, true);
+}
@@ -0,0 +1,83 @@
+#pragma once
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <memory>
+#include <map>
+
+#include <utils/fs.h>
+#include <utils/serialize.h>
+#include <dbwrapper.h>
+#include <mnode/mnode-masternode.h>
+
+// MN history DB record prefixes
+constexpr char MN_HISTORY_TOP_MNS_PREFIX = 'T';  // <T><height> -> vector of top MN outpoints
+constexpr char MN_HISTORY_MN_PREFIX = 'M';       // <M><outpoint> -> masternode snapshot
+
+/**
+ * MN history DB key for the top masternodes of the block.
+ * Height is stored in big-endian format to keep records ordered by block height.
+ */
+typedef struct _mn_history_height_key_t
+{
+    uint32_t nHeight = 0;
+
+    _mn_history_height_key_t() noexcept = default;
+    _mn_history_height_key_t(const uint32_t nBlockHeight) noexcept :
+        nHeight(nBlockHeight)
+    {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, static_cast<uint8_t>(MN_HISTORY_TOP_MNS_PREFIX));
+        ser_writedata32be(s, nHeight);
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        if (ser_readdata8(s) != static_cast<uint8_t>(MN_HISTORY_TOP_MNS_PREFIX))
+            throw std::ios_base::failure("not a top MNs key");
+        nHeight = ser_readdata32be(s);
+    }
+} mn_history_height_key_t;
+
+/**
+ * LevelDB-backed store of the historical top masternodes.
+ * Top masternodes are appended once per block, masternode snapshots are stored
+ * once per masternode (overwritten when masternode data changes) and loaded on demand.
+ * Not thread-safe, protected by CMasternodeMan::cs_mnHist.
+ */
+class CMasternodeHistoryDB
+{
+public:
+    CMasternodeHistoryDB() noexcept = default;
+
+    // open MN history DB
+    bool Init(const fs::path &dbPath, const size_t nCacheSize, const bool bWipe, const uint32_t nDepth);
+    bool IsInitialized() const noexcept { return m_pDB != nullptr; }
+    uint32_t GetDepth() const noexcept { return m_nDepth; }
+
+    // write top masternodes for the block
+    bool WriteTopMNs(const uint32_t nHeight, const masternode_vector_t &vTopMNs);
+    // check if top masternodes for the block are stored
+    bool HasTopMNs(const uint32_t nHeight) const;
+    // read top masternode outpoints for the block
+    bool ReadTopMNs(const uint32_t nHeight, v_outpoints &vOutpoints) const;
+    // read masternode snapshot
+    masternode_t ReadMasternode(const COutPoint &outpoint);
+    // erase top masternodes for the blocks below nTipHeight - depth
+    size_t Prune(const uint32_t nTipHeight);
+    // erase all records
+    void Clear();
+
+protected:
+    std::unique_ptr<CDBWrapper> m_pDB;
+    uint32_t m_nDepth = 0;
+    uint32_t m_nPrunedHeight = 0;  // top MNs below this height were pruned
+    // masternode snapshots loaded from the DB or written to the DB
+    std::map<COutPoint, masternode_t> m_mapMasternodes;
+    // hashes of the masternode snapshots written to the DB by this instance
+    std::map<COutPoint, uint256> m_mapSnapshotHashes;
+};
@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <random>
 #include <fstream>
+#include <tuple>
 
 #include <extlibs/json.hpp>
 
@@ -33,6 +34,12 @@
 using namespace std;
 using json = nlohmann::json;
 
+// mncache journaled flat DB record types
+constexpr char MNCACHE_RECORD_MASTERNODE = 'm';
+constexpr char MNCACHE_RECORD_SEEN_MNB = 'b';
+constexpr char MNCACHE_RECORD_SEEN_MNP = 'p';
+constexpr char MNCACHE_RECORD_WATCHDOG_VOTE_TIME = 'w';
+
 constexpr auto ERRMSG_MNLIST_NOT_SYNCED = "Masternode list is not synced";
 constexpr auto ERRMSG_MNLIST_EMPTY = "Masternode list is empty";
 constexpr auto ERRMSG_MN_BLOCK_NOT_FOUND = "Block %d not found";
@@ -47,15 +54,6 @@ struct CompareLastPaidBlock
     }
 };
 
-struct CompareScoreMN
-{
-    bool operator()(const pair<arith_uint256, const masternode_t>& t1,
-                    const pair<arith_uint256, const masternode_t>& t2) const noexcept
-    {
-        return (t1.first != t2.first) ? (t1.first < t2.first) : (t1.second->get_vin() < t2.second->get_vin());
-    }
-};
-
 struct CompareByAddr
 {
     bool operator()(const masternode_t &t1, const masternode_t &t2) const noexcept
@@ -70,77 +68,83 @@ CMasternodeMan::CMasternodeMan() noexcept:
 {}
 
 /**
- * Convert old historical top MNs map to the new format with MN index (2 maps).
- * Should be call under cs_mnMgr lock.
+ * Open historical top MNs DB.
+ * Historical top MNs loaded from the old mncache.dat before DB was opened are moved to the DB.
  * 
- * \param tempMapHistoricalTopMNs
+ * \param error - error message
+ * \return true if MN history DB was successfully opened
  */
-void CMasternodeMan::ConvertOldHistoricalMNs(masternode_history_map_t&& tempMapHistoricalTopMNs)
+bool CMasternodeMan::InitHistoryDB(string &error)
 {
-    if (tempMapHistoricalTopMNs.empty())
-        return;
-
-    LogFnPrint("masternode", "Converting old historical top MNs map to the new format");
-
-    v_uint32 vBlockTopMN;
-    vBlockTopMN.reserve(20);
+    const auto dbPath = GetDataDir() / MN_HISTORY_DB_SUBFOLDER;
+    const int64_t nDepth = GetArg("-mnhistorydepth", DEFAULT_MN_HISTORY_DEPTH);
+    if (nDepth < 0)
+    {
+        error = strprintf("Invalid -mnhistorydepth value: %" PRId64, nDepth);
+        return false;
+    }
+    LOCK(cs_mnHist);
+    if (!m_HistoryDB.Init(dbPath, MN_HISTORY_DB_CACHE_SIZE, false, static_cast<uint32_t>(nDepth)))
+    {
+        error = strprintf("Failed to open MN history DB [%s]", dbPath.string());
+        return false;
+    }
+    if (!m_mapPendingHistoricalTopMNs.empty())
+    {
+        for (const auto& [nBlockHeight, vTopMNs] : m_mapPendingHistoricalTopMNs)
+            m_HistoryDB.WriteTopMNs(nBlockHeight, vTopMNs);
+        m_mapPendingHistoricalTopMNs.clear();
+    }
+    return true;
+}
 
+/**
+ * Convert historical top MNs map with MN index (2 maps) read from mncache.dat
+ * to the map of <block height> -> <vector of top masternodes>.
+ * 
+ * \param mapHistoricalMNCache - map of <mn historical cache id> -> <mn shared_ptr>
+ * \param mapHistoricalTopMNs - map of <block height> -> <vector of mn historical cache ids>
+ * \param mapHistoricalTopMNsRet - returns converted map
+ */
+void CMasternodeMan::ConvertHistoricalMNCache(const unordered_map<uint32_t, masternode_t> &mapHistoricalMNCache,
+    const unordered_map<uint32_t, v_uint32> &mapHistoricalTopMNs, masternode_history_map_t &mapHistoricalTopMNsRet) const
+{
+    mapHistoricalTopMNsRet.clear();
+    mapHistoricalTopMNsRet.reserve(mapHistoricalTopMNs.size());
+    for (const auto& [nBlockHeight, vTopMNCacheIds] : mapHistoricalTopMNs)
     {
-        LOCK(cs_mnHist);
-        for (auto& [nBlockHeight, vTopMN] : tempMapHistoricalTopMNs)
+        masternode_vector_t vTopMNs;
+        vTopMNs.reserve(vTopMNCacheIds.size());
+        for (const auto nMNCacheId : vTopMNCacheIds)
         {
-            vBlockTopMN.clear();
-            for (auto& pmn : vTopMN)
-            {
-                if (!pmn)
-                    continue;
-
-                const auto& outpoint = pmn->getOutPoint();
-                const auto& sOutpoint = outpoint.ToStringShort();
-                
-                uint32_t nMNCacheId;
-                const auto& it = m_mapHistoricalMNCacheOutpoints.find(sOutpoint);
-                if (it == m_mapHistoricalMNCacheOutpoints.cend())
-                {
-                    nMNCacheId = m_nLastHistoricalMNCacheID++;
-                    m_mapHistoricalMNCacheOutpoints.emplace(sOutpoint, nMNCacheId);
-                } else
-                    nMNCacheId = it->second;
-                vBlockTopMN.push_back(nMNCacheId);
-                if (m_mapHistoricalMNCache.find(nMNCacheId) == m_mapHistoricalMNCache.cend())
-                {
-                    // try to find this masternode in the masternodes map
-                    auto itMN = mapMasternodes.find(outpoint);
-                    if (itMN != mapMasternodes.end())
-                        m_mapHistoricalMNCache.emplace(nMNCacheId, itMN->second);
-                    else
-                        m_mapHistoricalMNCache.emplace(nMNCacheId, std::move(pmn));
-                }
-            }
-            m_mapHistoricalTopMNs.insert_or_assign(nBlockHeight, std::move(vBlockTopMN));
+            const auto it = mapHistoricalMNCache.find(nMNCacheId);
+            if ((it != mapHistoricalMNCache.cend()) && it->second)
+                vTopMNs.push_back(it->second);
         }
+        mapHistoricalTopMNsRet.emplace(nBlockHeight, std::move(vTopMNs));
     }
-    tempMapHistoricalTopMNs.clear();
 }
 
 /**
- * Find MNs in historical cache that already exist in masternodes map.
+ * Move historical top MNs read from the old mncache.dat to the MN history DB.
+ * If MN history DB is not opened yet - top MNs are kept until InitHistoryDB is called.
+ * 
+ * \param mapHistoricalTopMNs - map of <block height> -> <vector of top masternodes>
  */
-void CMasternodeMan::ProcessHistoricalMNCache()
+void CMasternodeMan::MigrateHistoricalTopMNs(masternode_history_map_t&& mapHistoricalTopMNs)
 {
     LOCK(cs_mnHist);
-
-    for (auto& [sOutpoint, pmn] : m_mapHistoricalMNCache)
+    if (!m_HistoryDB.IsInitialized())
     {
-        if (!pmn)
-            continue;
-
-        const auto& outpoint = pmn->getOutPoint();
-        auto itMN = mapMasternodes.find(outpoint);
-        if (itMN == mapMasternodes.end())
-            continue;
-        // use the shared_ptr from the masternodes map
-        pmn = itMN->second;
+        for (auto& [nBlockHeight, vTopMNs] : mapHistoricalTopMNs)
+            m_mapPendingHistoricalTopMNs.insert_or_assign(nBlockHeight, std::move(vTopMNs));
+        return;
+    }
+    LogFnPrintf("Moving %zu historical top MNs records to the MN history DB", mapHistoricalTopMNs.size());
+    for (const auto& [nBlockHeight, vTopMNs] : mapHistoricalTopMNs)
+    {
+        if (!m_HistoryDB.HasTopMNs(nBlockHeight))
+            m_HistoryDB.WriteTopMNs(nBlockHeight, vTopMNs);
     }
 }
 
@@ -158,11 +162,13 @@ bool CMasternodeMan::Add(masternode_t &pmn)
     LOCK(cs_mnMgr);
 
     const auto& outpoint = pmn->getOutPoint();
-    if (Has(outpoint))
+    if (mapMasternodes.find(outpoint) != mapMasternodes.cend())
         return false;
 
     LogFnPrint("masternode", "Adding new Masternode: addr=%s, %zu now", pmn->get_address(), size() + 1);
     mapMasternodes[outpoint] = pmn;
+    MasternodeListChanged();
+    PublishMasternodeSnapshot();
     return true;
 }
 
@@ -218,10 +224,21 @@ void CMasternodeMan::Check(const bool bLockMgr)
 		LogFnPrint("masternode", "Number of masternodes has changed: [%zu] -> [%zu]", m_nLastMasternodeCount, size());
 		m_nLastMasternodeCount = size();
 	}
+    // drop cached collaterals of the removed masternodes and
+    // read all collaterals missing in the cache at once
+    vector<COutPoint> vOutpoints;
+    vOutpoints.reserve(mapMasternodes.size());
+    for (const auto& [outpoint, pmn] : mapMasternodes)
+    {
+        if (pmn && !pmn->IsUnitTest() && !pmn->IsOutpointSpent())
+            vOutpoints.push_back(outpoint);
+    }
+    masterNodeCtrl.collateralCache.Retain(vOutpoints);
+    masterNodeCtrl.collateralCache.Prefetch(vOutpoints);
     for (auto& [outpoint, pmn] : mapMasternodes)
     {
         if (pmn)
-            pmn->Check(false, SKIP_LOCK);
+            pmn->Check();
     }
 }
 
@@ -285,6 +302,7 @@ void CMasternodeMan::CheckAndRemove()
 
                 // and finally remove it from the masternode list
                 itMN = mapMasternodes.erase(itMN);
+                MasternodeListChanged();
                 continue;
             }
 
@@ -370,6 +388,7 @@ void CMasternodeMan::CheckAndRemove()
             } else
                 ++itMnbReplies;
         }
+        PublishMasternodeSnapshot();
     }
 
     CleanupMaps();
@@ -581,6 +600,8 @@ void CMasternodeMan::ClearCache(const std::set<MNCacheItem> &setCacheItems)
     if (setCacheItems.count(MNCacheItem::MN_LIST))
     {
         mapMasternodes.clear();
+        MasternodeListChanged();
+        PublishMasternodeSnapshot();
         LogFnPrintf("Cleared Masternode list cache");
     }
     if (setCacheItems.count(MNCacheItem::SEEN_MN_BROADCAST))
@@ -621,8 +642,8 @@ void CMasternodeMan::ClearCache(const std::set<MNCacheItem> &setCacheItems)
     if (setCacheItems.count(MNCacheItem::HISTORICAL_TOP_MNS))
     {
         LOCK(cs_mnHist);
-        m_mapHistoricalMNCache.clear();
-        m_mapHistoricalTopMNs.clear();
+        m_mapPendingHistoricalTopMNs.clear();
+        m_HistoryDB.Clear();
         LogFnPrintf("Cleared Masternode historical top MNs cache");
     }
 }
@@ -631,6 +652,8 @@ void CMasternodeMan::Clear()
 {
     LOCK(cs_mnMgr);
     mapMasternodes.clear();
+    MasternodeListChanged();
+    PublishMasternodeSnapshot();
     mAskedUsForMasternodeList.clear();
     mWeAskedForMasternodeList.clear();
     mWeAskedForMasternodeListEntry.clear();
@@ -639,14 +662,129 @@ void CMasternodeMan::Clear()
     nLastWatchdogVoteTime = 0;
 }
 
+/**
+ * Export masternode cache as journaled flat DB records.
+ * One record per masternode, seen broadcast and seen ping.
+ * 
+ * \param records - records to fill in
+ */
+void CMasternodeMan::GetFlatDBRecords(flatdb_records_t &records) const
+{
+    LOCK(cs_mnMgr);
+    for (const auto& [outpoint, pmn] : mapMasternodes)
+    {
+        if (pmn)
+            AddFlatDBRecord(records, MNCACHE_RECORD_MASTERNODE, outpoint, *pmn);
+    }
+    for (const auto& [hash, mnb] : mapSeenMasternodeBroadcast)
+        AddFlatDBRecord(records, MNCACHE_RECORD_SEEN_MNB, hash, mnb);
+    for (const auto& [hash, mnp] : mapSeenMasternodePing)
+        AddFlatDBRecord(records, MNCACHE_RECORD_SEEN_MNP, hash, mnp);
+    AddFlatDBRecord(records, MNCACHE_RECORD_WATCHDOG_VOTE_TIME, string(), nLastWatchdogVoteTime);
+}
+
+/**
+ * Load one journaled flat DB record into the masternode cache.
+ * Throws exception if the record can't be deserialized.
+ * 
+ * \param sKey - record key
+ * \param sValue - serialized record value
+ */
+void CMasternodeMan::LoadFlatDBRecord(const string &sKey, const string &sValue)
+{
+    if (sKey.empty())
+        throw runtime_error("empty mncache record key");
+    LOCK(cs_mnMgr);
+    switch (sKey[0])
+    {
+        case MNCACHE_RECORD_MASTERNODE:
+        {
+            COutPoint outpoint;
+            auto pmn = make_shared<CMasternode>();
+            ReadFlatDBRecord(sKey, sValue, outpoint, *pmn);
+            mapMasternodes[outpoint] = pmn;
+            MasternodeListChanged();
+        } break;
+
+        case MNCACHE_RECORD_SEEN_MNB:
+        {
+            uint256 hash;
+            pair<int64_t, CMasternodeBroadcast> mnb;
+            ReadFlatDBRecord(sKey, sValue, hash, mnb);
+            mapSeenMasternodeBroadcast[hash] = move(mnb);
+        } break;
+
+        case MNCACHE_RECORD_SEEN_MNP:
+        {
+            uint256 hash;
+            CMasterNodePing mnp;
+            ReadFlatDBRecord(sKey, sValue, hash, mnp);
+            mapSeenMasternodePing[hash] = move(mnp);
+        } break;
+
+        case MNCACHE_RECORD_WATCHDOG_VOTE_TIME:
+        {
+            string sDummy;
+            ReadFlatDBRecord(sKey, sValue, sDummy, nLastWatchdogVoteTime);
+        } break;
+
+        default:
+            throw runtime_error(strprintf("unknown mncache record type '%c'", sKey[0]));
+    }
+}
+
+/**
+ * Masternodes were added to or removed from the list.
+ * Invalidates cached scores and resets the masternode list snapshot.
+ * Should be called under cs_mnMgr.
+ */
+void CMasternodeMan::MasternodeListChanged()
+{
+    m_ScoreEngine.Invalidate();
+    atomic_store(&m_pMasternodesSnapshot, masternode_map_snapshot_t());
+}
+
+/**
+ * Publish new snapshot of the masternode list if it was reset by the list change.
+ * Should be called under cs_mnMgr.
+ * 
+ * \return current masternode list snapshot
+ */
+CMasternodeMan::masternode_map_snapshot_t CMasternodeMan::PublishMasternodeSnapshot() const
+{
+    auto pMasternodes = atomic_load(&m_pMasternodesSnapshot);
+    if (pMasternodes)
+        return pMasternodes;
+    pMasternodes = make_shared<const masternode_map_t>(mapMasternodes);
+    atomic_store(&m_pMasternodesSnapshot, pMasternodes);
+    return pMasternodes;
+}
+
+/**
+ * Get immutable snapshot of the masternode list.
+ * Masternode objects are shared with the live list, so their state is current,
+ * only the list membership is as of the last add/remove.
+ * Takes cs_mnMgr only if the snapshot was reset and not published yet.
+ * 
+ * \return masternode list snapshot
+ */
+CMasternodeMan::masternode_map_snapshot_t CMasternodeMan::GetMasternodeSnapshot() const
+{
+    auto pMasternodes = atomic_load(&m_pMasternodesSnapshot);
+    if (pMasternodes)
+        return pMasternodes;
+    LOCK(cs_mnMgr);
+    return PublishMasternodeSnapshot();
+}
+
 uint32_t CMasternodeMan::CountMasternodes(const function<bool(const masternode_t&)>& fnMnFilter,
     const int nProtocolVersion) const noexcept
 {
-    LOCK(cs_mnMgr);
+    const auto pMasternodes = GetMasternodeSnapshot();
 
     const int nMNProtocolVersion = nProtocolVersion == -1 ? masterNodeCtrl.GetSupportedProtocolVersion() : nProtocolVersion;
     uint32_t nCount = 0;
-    for (const auto& [outpoint, pmn] : mapMasternodes)
+    for (const auto& [outpoint, pmn] : *pMasternodes)
     {
         if (!pmn)
             continue;
@@ -740,20 +878,183 @@ void CMasternodeMan::DsegUpdate(node_t& pnode)
         }
     }
 
-    pnode->PushMessage(NetMsgType::DSEG, CTxIn());
+    // peer that supports compact list sync sends us only missing or changed entries
+    const bool bCompact = pnode->nVersion >= MN_DSEG_COMPACT_VERSION;
+    if (bCompact)
+        pnode->PushMessage(NetMsgType::DSEGCOMPACT, GetListDigest());
+    else
+        pnode->PushMessage(NetMsgType::DSEG, CTxIn());
     int64_t askAgain = GetTime() + DSEG_UPDATE_SECONDS;
     mWeAskedForMasternodeList[pnode->addr] = askAgain;
 
-    LogFnPrint("masternode", "asked %s for the list", pnode->addr.ToString());
+    LogFnPrint("masternode", "asked %s for the %slist", pnode->addr.ToString(), bCompact ? "compact " : "");
 }
 
-masternode_t CMasternodeMan::Get(const bool bLockMgr, const COutPoint& outpoint)
+void CMasternodeListDigest::Finalize()
 {
-    // Theses mutexes are recursive so double locking by the same thread is safe.
-    LOCK_COND(bLockMgr, cs_mnMgr);
+    sort(vShortIds.begin(), vShortIds.end());
+    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
+    ss << vShortIds;
+    hashList = ss.GetHash();
+}
+
+bool CMasternodeListDigest::Contains(const uint64_t nShortId) const noexcept
+{
+    return binary_search(vShortIds.cbegin(), vShortIds.cend(), nShortId);
+}
+
+/**
+ * Get digest of our masternode list for the compact list sync request.
+ * Includes only entries that can be sent on the list sync request (CanSendListEntry),
+ * so the digest of the same list is equal on both sides.
+ * 
+ * \return masternode list digest with short ids of mnb and last mnp hashes
+ */
+CMasternodeListDigest CMasternodeMan::GetListDigest() const
+{
+    CMasternodeListDigest digest;
+    LOCK(cs_mnMgr);
+    digest.vShortIds.reserve(mapMasternodes.size() * 2);
+    for (const auto& [outpoint, pmn] : mapMasternodes)
+    {
+        if (!pmn || !CanSendListEntry(pmn))
+            continue;
+        digest.Add(CMasternodeBroadcast(*pmn).GetHash());
+        digest.Add(pmn->getLastPing().GetHash());
+    }
+    digest.Finalize();
+    return digest;
+}
+
+/**
+ * Check full masternode list request rate limit for the peer.
+ * Should be called under cs_mnMgr.
+ * 
+ * \param pfrom - peer that requested masternode list
+ * \return false if peer already asked us for the list recently
+ */
+bool CMasternodeMan::CheckListRequestRateLimit(const node_t& pfrom)
+{
+    AssertLockHeld(cs_mnMgr);
+
+    // local network
+    const bool isLocal = (pfrom->addr.IsRFC1918() || pfrom->addr.IsLocal());
+    if (isLocal || !Params().IsMainNet())
+        return true;
+
+    const auto it = mAskedUsForMasternodeList.find(pfrom->addr);
+    if (it != mAskedUsForMasternodeList.end() && it->second > GetTime())
+    {
+        Misbehaving(pfrom->GetId(), 34);
+        LogFnPrintf("DSEG -- peer already asked me for the list, peer=%d", pfrom->id);
+        return false;
+    }
+    int64_t askAgain = GetTime() + DSEG_UPDATE_SECONDS;
+    mAskedUsForMasternodeList[pfrom->addr] = askAgain;
+    return true;
+}
+
+/**
+ * Check if masternode entry can be sent to the peer on list sync request.
+ * 
+ * \param pmn - masternode
+ * \return true if masternode entry can be sent
+ */
+bool CMasternodeMan::CanSendListEntry(const masternode_t& pmn) const noexcept
+{
+    // do not send local network masternode
+    if (!Params().IsRegTest() &&
+        (pmn->get_addr().IsRFC1918() || pmn->get_addr().IsLocal()))
+        return false;
+    // do not send outdated masternodes or masternodes with partial info
+    return !pmn->IsUpdateRequired() && !pmn->hasPartialInfo();
+}
+
+/**
+ * Process compact masternode list sync request (dsegc).
+ * Sends inventory only for the masternode broadcasts and pings
+ * which short ids are not found in the peer's list digest.
+ * 
+ * \param pfrom - peer that requested masternode list
+ * \param digest - peer's masternode list digest
+ */
+void CMasternodeMan::ProcessCompactListRequest(const node_t& pfrom, CMasternodeListDigest& digest)
+{
+    LOCK(cs_mnMgr);
+
+    if (!CheckListRequestRateLimit(pfrom))
+        return;
+
+    // find entries missing or changed on the peer side
+    CMasternodeListDigest ourDigest;
+    ourDigest.vShortIds.reserve(mapMasternodes.size() * 2);
+    vector<tuple<CMasternodeBroadcast, CMasterNodePing, uint256, uint256>> vEntries;
+    vEntries.reserve(mapMasternodes.size());
+    for (const auto& [outpoint, pmn] : mapMasternodes)
+    {
+        if (!pmn || !CanSendListEntry(pmn))
+            continue;
+        CMasternodeBroadcast mnb(*pmn);
+        CMasterNodePing mnp(pmn->getLastPing());
+        const uint256 hashMNB = mnb.GetHash();
+        const uint256 hashMNP = mnp.GetHash();
+        ourDigest.Add(hashMNB);
+        ourDigest.Add(hashMNP);
+        vEntries.emplace_back(std::move(mnb), std::move(mnp), hashMNB, hashMNP);
+    }
+    ourDigest.Finalize();
+
+    int nInvCount = 0;
+    if (ourDigest.hashList != digest.hashList)
+    {
+        // short ids should be sorted by the peer, but do not rely on it
+        if (!is_sorted(digest.vShortIds.cbegin(), digest.vShortIds.cend()))
+            sort(digest.vShortIds.begin(), digest.vShortIds.end());
+        const auto fnHasShortId = [&](const uint256& hash) -> bool
+        {
+            return digest.Contains(CMasternodeListDigest::GetShortId(hash));
+        };
+        for (const auto& [mnb, mnp, hashMNB, hashMNP] : vEntries)
+        {
+            bool bSent = false;
+            if (!fnHasShortId(hashMNB))
+            {
+                SetSeenMnb(hashMNB, GetTime(), mnb);
+                pfrom->PushInventory(CInv(MSG_MASTERNODE_ANNOUNCE, hashMNB));
+                bSent = true;
+            }
+            if (!fnHasShortId(hashMNP))
+            {
+                SetSeenMnp(hashMNP, mnp);
+                pfrom->PushInventory(CInv(MSG_MASTERNODE_PING, hashMNP));
+                bSent = true;
+            }
+            if (bSent)
+                ++nInvCount;
+        }
+    }
+    pfrom->PushMessage(NetMsgType::SYNCSTATUSCOUNT, to_integral_type(CMasternodeSync::MasternodeSyncState::List), nInvCount);
+    LogFnPrintf("DSEGC -- Sent %d of %zu Masternode invs to peer %d", nInvCount, vEntries.size(), pfrom->id);
+}
 
-    auto it = mapMasternodes.find(outpoint);
-    if (it == mapMasternodes.end())
+/**
+ * Get masternode by outpoint.
+ * 
+ * \param bLockMgr - if false, caller holds cs_mnMgr and the live list is used,
+ *                   otherwise lookup is done in the masternode list snapshot without locking
+ * \param outpoint - masternode collateral outpoint
+ * \return masternode or nullptr if not found
+ */
+masternode_t CMasternodeMan::Get(const bool bLockMgr, const COutPoint& outpoint)
+{
+    if (!bLockMgr)
+    {
+        const auto it = mapMasternodes.find(outpoint);
+        return it == mapMasternodes.cend() ? nullptr : it->second;
+    }
+    const auto pMasternodes = GetMasternodeSnapshot();
+    const auto it = pMasternodes->find(outpoint);
+    if (it == pMasternodes->cend())
         return nullptr;
 
     return it->second;
@@ -761,10 +1062,12 @@ masternode_t CMasternodeMan::Get(const bool bLockMgr, const COutPoint& outpoint)
 
 bool CMasternodeMan::GetMasternodeInfo(const bool bLock, const COutPoint& outpoint, masternode_info_t& mnInfoRet) const noexcept
 {
-    LOCK_COND(bLock, cs_mnMgr);
+    // caller holds cs_mnMgr - use the live list
+    const auto pMasternodes = bLock ? GetMasternodeSnapshot() : masternode_map_snapshot_t();
+    const auto &mapMNs = bLock ? *pMasternodes : mapMasternodes;
 
-    const auto it = mapMasternodes.find(outpoint);
-    if (it == mapMasternodes.cend())
+    const auto it = mapMNs.find(outpoint);
+    if (it == mapMNs.cend())
         return false;
     const auto pmn = it->second;
     if (!pmn)
@@ -775,8 +1078,8 @@ bool CMasternodeMan::GetMasternodeInfo(const bool bLock, const COutPoint& outpoi
 
 bool CMasternodeMan::GetMasternodeInfo(const CPubKey& pubKeyMasternode, masternode_info_t& mnInfoRet) const noexcept
 {
-    LOCK(cs_mnMgr);
-    for (const auto& [outpoint, pmn]: mapMasternodes)
+    const auto pMasternodes = GetMasternodeSnapshot();
+    for (const auto& [outpoint, pmn]: *pMasternodes)
     {
         if (!pmn)
             continue;
@@ -791,8 +1094,9 @@ bool CMasternodeMan::GetMasternodeInfo(const CPubKey& pubKeyMasternode, masterno
 
 bool CMasternodeMan::GetMasternodeInfo(const bool bLock, const CScript& payee, masternode_info_t& mnInfoRet) const noexcept
 {
-    LOCK_COND(bLock, cs_mnMgr);
-    for (const auto& [outpoint, pmn]: mapMasternodes)
+    // caller holds cs_mnMgr - use the live list
+    const auto pMasternodes = bLock ? GetMasternodeSnapshot() : masternode_map_snapshot_t();
+    for (const auto& [outpoint, pmn]: bLock ? *pMasternodes : mapMasternodes)
     {
         if (!pmn)
             continue;
@@ -835,8 +1139,8 @@ bool CMasternodeMan::GetAndCacheMasternodeInfo(const std::string& sPastelID, mas
 
 bool CMasternodeMan::Has(const COutPoint& outpoint)
 {
-    LOCK(cs_mnMgr);
-    return mapMasternodes.find(outpoint) != mapMasternodes.end();
+    const auto pMasternodes = GetMasternodeSnapshot();
+    return pMasternodes->find(outpoint) != pMasternodes->cend();
 }
 
 bool CMasternodeMan::HasPayee(const bool bLock, const CScript& payee) noexcept
@@ -1007,8 +1311,22 @@ masternode_info_t CMasternodeMan::FindRandomNotInVec(const v_outpoints &vecToExc
     return masternode_info_t();
 }
 
+/**
+ * Get masternode scores for the given block.
+ * Scores are cached per block by the score engine, only requested top scores are sorted.
+ * Should be called under cs_mnMgr lock.
+ * 
+ * \param error - error message
+ * \param blockHash - block hash to calculate scores for
+ * \param vecMasternodeScoresRet - masternode scores ordered by score desc
+ * \param nMinProtocol - minimum protocol version
+ * \param nMaxCount - max number of top scores to return, 0 - return all
+ * \param pnMasternodeCount - if not nullptr - returns total number of masternodes that support nMinProtocol
+ * \return true if at least one masternode score was returned
+ */
 bool CMasternodeMan::GetMasternodeScores(string &error, const uint256& blockHash, 
-    CMasternodeMan::score_pair_vec_t& vecMasternodeScoresRet, int nMinProtocol) const noexcept
+    CMasternodeMan::score_pair_vec_t& vecMasternodeScoresRet, int nMinProtocol,
+    const size_t nMaxCount, size_t *pnMasternodeCount) const noexcept
 {
     vecMasternodeScoresRet.clear();
     if (!masterNodeCtrl.masternodeSync.IsMasternodeListSynced())
@@ -1025,13 +1343,16 @@ bool CMasternodeMan::GetMasternodeScores(string &error, const uint256& blockHash
         return false;
     }
 
-    // calculate scores
-    for (auto& [outpoint, pmn]: mapMasternodes)
+    try
+    {
+        const size_t nMasternodeCount = m_ScoreEngine.GetTopScores(mapMasternodes, blockHash, nMinProtocol, nMaxCount, vecMasternodeScoresRet);
+        if (pnMasternodeCount)
+            *pnMasternodeCount = nMasternodeCount;
+    } catch (const exception& e)
     {
-        if (pmn && pmn->nProtocolVersion >= nMinProtocol)
-            vecMasternodeScoresRet.emplace_back(pmn->CalculateScore(blockHash), pmn);
+        error = strprintf("Failed to calculate masternode scores. %s", e.what());
+        return false;
     }
-    sort(vecMasternodeScoresRet.rbegin(), vecMasternodeScoresRet.rend(), CompareScoreMN());
     if (vecMasternodeScoresRet.empty())
     {
 		error = strprintf("No Masternodes found that supports protocol %d", nMinProtocol);
@@ -1062,25 +1383,18 @@ bool CMasternodeMan::GetMasternodeRank(string &error, const COutPoint& outpoint,
     // ensure consistent locking order cs_main -> cs_mnMgr
     LOCK2(cs_main, cs_mnMgr);
 
-    score_pair_vec_t vecMasternodeScores;
-    if (!GetMasternodeScores(error, blockHash, vecMasternodeScores, nMinProtocol))
+    if (mapMasternodes.empty())
     {
-        error = strprintf(ERRMSG_MN_GET_SCORES, nBlockHeight, error);
+        error = strprintf(ERRMSG_MN_GET_SCORES, nBlockHeight, ERRMSG_MNLIST_EMPTY);
         return false;
     }
 
-    int nRank = 0;
-    for (const auto& scorePair: vecMasternodeScores)
-    {
-        nRank++;
-        if (scorePair.second->getOutPoint() == outpoint)
-        {
-            nRankRet = nRank;
-            return true;
-        }
-    }
-
-    return false;
+    // rank is calculated from the cached block scores without sorting
+    const int nRank = m_ScoreEngine.GetRank(mapMasternodes, blockHash, outpoint, nMinProtocol);
+    if (nRank <= 0)
+        return false;
+    nRankRet = nRank;
+    return true;
 }
 
 /**
@@ -1090,9 +1404,12 @@ bool CMasternodeMan::GetMasternodeRank(string &error, const COutPoint& outpoint,
  * \param vecMasternodeRanksRet - vector of masternode ranks
  * \param nBlockHeight - block height to get mn ranks for
  * \param nMinProtocol - minimum protocol version
+ * \param nMaxRanks - max number of top ranks to return, 0 - return all
+ * \param pnMasternodeCount - if not nullptr - returns total number of masternodes that support nMinProtocol
  * \return GetTopMasterNodeStatus - status of the operation
  */
-GetTopMasterNodeStatus CMasternodeMan::GetMasternodeRanks(string &error, CMasternodeMan::rank_pair_vec_t& vecMasternodeRanksRet, int nBlockHeight, int nMinProtocol) const
+GetTopMasterNodeStatus CMasternodeMan::GetMasternodeRanks(string &error, CMasternodeMan::rank_pair_vec_t& vecMasternodeRanksRet, 
+    int nBlockHeight, int nMinProtocol, const size_t nMaxRanks, size_t *pnMasternodeCount) const
 {
     vecMasternodeRanksRet.clear();
     error.clear();
@@ -1113,12 +1430,13 @@ GetTopMasterNodeStatus CMasternodeMan::GetMasternodeRanks(string &error, CMaster
     LOCK2(cs_main, cs_mnMgr);
 
     score_pair_vec_t vecMasternodeScores;
-    if (!GetMasternodeScores(error, blockHash, vecMasternodeScores, nMinProtocol))
+    if (!GetMasternodeScores(error, blockHash, vecMasternodeScores, nMinProtocol, nMaxRanks, pnMasternodeCount))
     {
         error = strprintf(ERRMSG_MN_GET_SCORES, nBlockHeight, error);
         return GetTopMasterNodeStatus::GET_MN_SCORES_FAILED;
     }
 
+    vecMasternodeRanksRet.reserve(vecMasternodeScores.size());
     int nRank = 0;
     for (auto& scorePair : vecMasternodeScores)
     {
@@ -1171,6 +1489,65 @@ pair<CService, set<uint256> > CMasternodeMan::PopScheduledMnbRequestConnection()
     return make_pair(pairFront.first, std::move(setResult));
 }
 
+/**
+ * Process masternode ping (mnp) received from the peer.
+ * Called by the masternode signature verification queue in order of mnp arrival.
+ *
+ * \param pfrom - node that sent the ping
+ * \param mnp - masternode ping
+ */
+void CMasternodeMan::ProcessPing(const node_t& pfrom, const CMasterNodePing& mnp)
+{
+    const uint256 hashPing = mnp.GetHash();
+    const bool bIsExpired = mnp.IsExpired(); // older than 180 mins (10800 secs)
+    LogFnPrint("masternode", "MNPING -- hash='%s', masternode='%s' (%" PRId64 " secs old%s), peer=%d",
+        hashPing.ToString(), mnp.GetDesc(), mnp.getAgeInSecs(), bIsExpired ? ", expired" : "", pfrom->id);
+
+    // Need LOCK2 here to ensure consistent locking order because the CheckAndUpdate call below locks cs_main
+    LOCK2(cs_main, cs_mnMgr);
+
+    if (bIsExpired)
+    {
+        EraseSeenMnp(hashPing); // make sure it is not in the seen mnp cache
+        return;
+    }
+
+    if (mapSeenMasternodePing.count(hashPing))
+        return; //seen
+    SetSeenMnp(hashPing, mnp);
+
+    LogFnPrint("masternode", "MNPING -- hash='%s', masternode='%s' new", hashPing.ToString(), mnp.GetDesc());
+
+    // see if we have this Masternode
+    const auto &outpoint = mnp.getOutPoint();
+    auto pmn = Get(SKIP_LOCK, outpoint);
+
+    // too late, new MNANNOUNCE is required
+    if (pmn && pmn->IsNewStartRequired())
+    {
+        // apparently we have this masternode alive (it sent this ping and it is not expired), check mnb
+        if (!pmn->IsBroadcastedWithin(masterNodeCtrl.MasternodeExpirationSeconds))
+        {
+            LogFnPrint("masternode", "MNPING -- hash='%s', masternode='%s', new mnb required (last broadcast %" PRId64 " secs ago)", 
+                hashPing.ToString(), mnp.GetDesc(), pmn->GetLastBroadcastAge());
+            return;
+        }
+    }
+
+    int nDos = 0;
+    if (pmn && pmn->setLastPingAndCheck(mnp, false, nDos))
+        return;
+
+    if (nDos > 0)
+        Misbehaving(pfrom->GetId(), nDos); // if anything significant failed, mark that node 
+    else if (pmn)
+        return; // nothing significant failed, mn is a known one too
+
+    // something significant is broken or mn is unknown,
+    // we might have to ask for a masternode entry once
+    AskForMN(pfrom, outpoint);
+}
+
 void CMasternodeMan::ProcessMessage(node_t& pfrom, string& strCommand, CDataStream& vRecv)
 {
     if (strCommand == NetMsgType::MNANNOUNCE) // Masternode Broadcast (mnb)
@@ -1178,20 +1555,38 @@ void CMasternodeMan::ProcessMessage(node_t& pfrom, string& strCommand, CDataStre
         CMasternodeBroadcast mnb;
         vRecv >> mnb;
 
-        pfrom->setAskFor.erase(mnb.GetHash());
+        pfrom->RemoveAskFor(mnb.GetHash());
         if (!masterNodeCtrl.masternodeSync.IsBlockchainSynced())
             return;
 
+        const uint256 hashMNB = mnb.GetHash();
         LogFnPrint("masternode", "MNANNOUNCE -- Masternode announce (%s v%hd), hash='%s', masternode='%s', peer=%d",
-           strCommand, mnb.GetVersion(), mnb.GetHash().ToString(), mnb.GetDesc(), pfrom->id);
+           strCommand, mnb.GetVersion(), hashMNB.ToString(), mnb.GetDesc(), pfrom->id);
 
-        int nDos = 0;
-        if (CheckMnbAndUpdateMasternodeList(USE_LOCK, USE_LOCK, pfrom, mnb, nDos))
-	    {
-            // use announced Masternode as a peer, time penalty 2hrs
-            addrman.Add(CAddress(mnb.get_addr(), NODE_NETWORK), pfrom->addr, 2 * 60 * 60);
-        } else if(nDos > 0)
-            Misbehaving(pfrom->GetId(), nDos);
+        {
+            // already seen mnb is not sent to the verification workers, just update the time it was seen
+            LOCK(cs_mnMgr);
+            if (mapSeenMasternodeBroadcast.count(hashMNB) && !IsMnbRecoveryRequested(hashMNB))
+            {
+                UpdateSeenMnbTime(hashMNB, GetTime());
+                return;
+            }
+        }
+
+        // signatures are recovered by the verification workers, mnb is processed in order of arrival
+        auto pmnb = make_shared<CMasternodeBroadcast>(std::move(mnb));
+        masterNodeCtrl.sigVerifyQueue.Submit(
+            [pmnb]() { pmnb->PrecomputeSignatures(); },
+            [this, pfrom, pmnb]()
+            {
+                int nDos = 0;
+                if (CheckMnbAndUpdateMasternodeList(USE_LOCK, USE_LOCK, pfrom, *pmnb, nDos))
+                {
+                    // use announced Masternode as a peer, time penalty 2hrs
+                    addrman.Add(CAddress(pmnb->get_addr(), NODE_NETWORK), pfrom->addr, 2 * 60 * 60);
+                } else if (nDos > 0)
+                    Misbehaving(pfrom->GetId(), nDos);
+            });
 
     } else if (strCommand == NetMsgType::MNPING) { // Masternode Ping (mnp)
 
@@ -1199,57 +1594,22 @@ void CMasternodeMan::ProcessMessage(node_t& pfrom, string& strCommand, CDataStre
         vRecv >> mnp;
 
         const uint256 hashPing = mnp.GetHash();
-        pfrom->setAskFor.erase(hashPing);
+        pfrom->RemoveAskFor(hashPing);
         if (!masterNodeCtrl.masternodeSync.IsBlockchainSynced())
             return;
 
-        const bool bIsExpired = mnp.IsExpired(); // older than 180 mins (10800 secs)
-        LogFnPrint("masternode", "MNPING -- hash='%s', masternode='%s' (%" PRId64 " secs old%s), peer=%d",
-            hashPing.ToString(), mnp.GetDesc(), mnp.getAgeInSecs(), bIsExpired ? ", expired" : "", pfrom->id);
-
-        // Need LOCK2 here to ensure consistent locking order because the CheckAndUpdate call below locks cs_main
-        LOCK2(cs_main, cs_mnMgr);
-
-        if (bIsExpired)
-        {
-            EraseSeenMnp(hashPing); // make sure it is not in the seen mnp cache
-            return;
-        }
-
-        if (mapSeenMasternodePing.count(hashPing))
-            return; //seen
-        SetSeenMnp(hashPing, mnp);
-
-        LogFnPrint("masternode", "MNPING -- hash='%s', masternode='%s' new", hashPing.ToString(), mnp.GetDesc());
-
-        // see if we have this Masternode
-        const auto &outpoint = mnp.getOutPoint();
-        auto pmn = Get(SKIP_LOCK, outpoint);
-
-        // too late, new MNANNOUNCE is required
-        if (pmn && pmn->IsNewStartRequired())
         {
-            // apparently we have this masternode alive (it sent this ping and it is not expired), check mnb
-            if (!pmn->IsBroadcastedWithin(masterNodeCtrl.MasternodeExpirationSeconds))
-            {
-                LogFnPrint("masternode", "MNPING -- hash='%s', masternode='%s', new mnb required (last broadcast %" PRId64 " secs ago)", 
-                    hashPing.ToString(), mnp.GetDesc(), pmn->GetLastBroadcastAge());
+            // skip signature recovery for the already seen mnp
+            LOCK(cs_mnMgr);
+            if (mapSeenMasternodePing.count(hashPing))
                 return;
-            }
         }
 
-        int nDos = 0;
-        if (pmn && pmn->setLastPingAndCheck(mnp, false, nDos))
-			return;
-
-        if (nDos > 0)
-            Misbehaving(pfrom->GetId(), nDos); // if anything significant failed, mark that node 
-        else if (pmn)
-            return; // nothing significant failed, mn is a known one too
-
-        // something significant is broken or mn is unknown,
-        // we might have to ask for a masternode entry once
-        AskForMN(pfrom, outpoint);
+        // signature is recovered by the verification workers, mnp is processed in order of arrival
+        auto pmnp = make_shared<CMasterNodePing>(std::move(mnp));
+        masterNodeCtrl.sigVerifyQueue.Submit(
+            [pmnp]() { pmnp->PrecomputeSignature(); },
+            [this, pfrom, pmnp]() { ProcessPing(pfrom, *pmnp); });
 
     } else if (strCommand == NetMsgType::DSEG) { // Request for us to get Masternode list or specific entry (dseg)
         // Ignore such requests until we are fully synced.
@@ -1266,25 +1626,9 @@ void CMasternodeMan::ProcessMessage(node_t& pfrom, string& strCommand, CDataStre
 
         LOCK(cs_mnMgr);
 
-        const auto& chainparams = Params();
-        if (vin == CTxIn()) // only should ask for this once
-        { 
-            // local network
-            const bool isLocal = (pfrom->addr.IsRFC1918() || pfrom->addr.IsLocal());
-
-            if (!isLocal && chainparams.IsMainNet())
-            {
-                const auto it = mAskedUsForMasternodeList.find(pfrom->addr);
-                if (it != mAskedUsForMasternodeList.end() && it->second > GetTime())
-                {
-                    Misbehaving(pfrom->GetId(), 34);
-                    LogFnPrintf("DSEG -- peer already asked me for the list, peer=%d", pfrom->id);
-                    return;
-                }
-                int64_t askAgain = GetTime() + DSEG_UPDATE_SECONDS;
-                mAskedUsForMasternodeList[pfrom->addr] = askAgain;
-            }
-        } //else, asking for a specific node which is ok
+        // only should ask for this once, asking for a specific node is ok
+        if ((vin == CTxIn()) && !CheckListRequestRateLimit(pfrom))
+            return;
 
         int nInvCount = 0;
 
@@ -1294,13 +1638,8 @@ void CMasternodeMan::ProcessMessage(node_t& pfrom, string& strCommand, CDataStre
                 continue;
             if (vin != CTxIn() && vin != pmn->get_vin())
                 continue; // asked for specific vin but we are not there yet
-            if (!chainparams.IsRegTest() && 
-                (pmn->get_addr().IsRFC1918() || pmn->get_addr().IsLocal()))
-                    continue; // do not send local network masternode
-
-            // do not send outdated masternodes or masternodes with partial info
-            if (pmn->IsUpdateRequired() || pmn->hasPartialInfo())
-                continue; 
+            if (!CanSendListEntry(pmn))
+                continue;
 
             CMasternodeBroadcast mnb(*pmn);
             CMasterNodePing mnp(pmn->getLastPing());
@@ -1333,6 +1672,22 @@ void CMasternodeMan::ProcessMessage(node_t& pfrom, string& strCommand, CDataStre
         // smth weird happen - someone asked us for vin we have no idea about?
         LogFnPrint("masternode", "DSEG -- No invs sent to peer %d", pfrom->id);
 
+    } else if (strCommand == NetMsgType::DSEGCOMPACT) { // Request for us to send missing or changed Masternode list entries (dsegc)
+        // Ignore such requests until we are fully synced.
+        if (!masterNodeCtrl.IsSynced())
+            return;
+
+        CMasternodeListDigest digest;
+        vRecv >> digest;
+
+        if (digest.vShortIds.size() > MAX_DSEG_COMPACT_SHORT_IDS)
+        {
+            Misbehaving(pfrom->GetId(), 20);
+            LogFnPrintf("DSEGC -- too many short ids (%zu), peer=%d", digest.vShortIds.size(), pfrom->id);
+            return;
+        }
+        ProcessCompactListRequest(pfrom, digest);
+
     } else if (strCommand == NetMsgType::MNVERIFY) { // Masternode Verify (mnv)
 
         // Need LOCK2 here to ensure consistent locking order because the all functions below call GetBlockHash which locks cs_main
@@ -1341,7 +1696,7 @@ void CMasternodeMan::ProcessMessage(node_t& pfrom, string& strCommand, CDataStre
         CMasternodeVerification mnv;
         vRecv >> mnv;
 
-        pfrom->setAskFor.erase(mnv.GetHash());
+        pfrom->RemoveAskFor(mnv.GetHash());
 
         if (!masterNodeCtrl.masternodeSync.IsMasternodeListSynced())
             return;
@@ -2098,7 +2453,7 @@ bool CMasternodeMan::ProcessRecoveryReply(const uint256 &hashMNB, const node_t&
     // simulate Check
     CMasternode mnTemp(mnb);
     mnTemp.setLastPing(mnb.getLastPing());
-    mnTemp.Check(true, SKIP_LOCK);
+    mnTemp.Check(true);
     const bool bIsValidStateForAutoStart = mnTemp.IsValidStateForAutoStart(mnTemp.GetActiveState());
     LogFnPrint("masternode", "masternode '%s' recovery broadcast [%s] processed, projected masternode state: %s (%svalid for auto-start)",
         pmn->GetDesc(), hashMNB.ToString(), mnTemp.GetStateString(), bIsValidStateForAutoStart ? "" : "not ");
@@ -2368,14 +2723,14 @@ bool CMasternodeMan::IsWatchdogActive()
 
 void CMasternodeMan::CheckMasternode(const CPubKey& pubKeyMasternode, bool fForce)
 {
-    LOCK(cs_mnMgr);
+    // cs_main is needed to read the collateral if it's not in the cache
+    LOCK2(cs_main, cs_mnMgr);
 
     for (auto& [outpoint, pmn]: mapMasternodes)
     {
         if (pmn && pmn->pubKeyMasternode == pubKeyMasternode)
         {
-            // cs_main can't be locked inside Check() because it will violate the locking order [cs_main -> cs_mnMgr]
-            pmn->Check(fForce, SKIP_LOCK);
+            pmn->Check(fForce);
             return;
         }
     }
@@ -2450,29 +2805,15 @@ void CMasternodeMan::UpdatedBlockTip(const CBlockIndex *pindex)
     // SELECT AND STORE TOP MASTERNODEs
     string error;
     masternode_vector_t vTopMNs;
-    v_uint32 vTopMNCacheIds;
     const GetTopMasterNodeStatus status = CalculateTopMNsForBlock(error, vTopMNs, nCachedBlockHeight);
     if (status == GetTopMasterNodeStatus::SUCCEEDED)
     {
-        vTopMNCacheIds.reserve(vTopMNs.size());
         LOCK(cs_mnHist);
-        for (const auto& pMN : vTopMNs)
-        {
-            if (!pMN)
-                continue;
-            const auto& sOutpoint = pMN->getOutPoint().ToStringShort();
-            const auto it = m_mapHistoricalMNCacheOutpoints.find(sOutpoint);
-            if (it == m_mapHistoricalMNCacheOutpoints.cend())
-            {
-                const auto nMNCacheId = m_nLastHistoricalMNCacheID++;
-                m_mapHistoricalMNCacheOutpoints.emplace(sOutpoint, nMNCacheId);
-                m_mapHistoricalMNCache.emplace(nMNCacheId, pMN);
-                vTopMNCacheIds.push_back(nMNCacheId);
-            } else
-                vTopMNCacheIds.push_back(it->second);
-        }
-
-        m_mapHistoricalTopMNs.emplace(nCachedBlockHeight, std::move(vTopMNCacheIds));
+        // top MNs are calculated only once per block - keep the first stored result
+        if (!m_HistoryDB.HasTopMNs(nCachedBlockHeight) &&
+            !m_HistoryDB.WriteTopMNs(nCachedBlockHeight, vTopMNs))
+            LogFnPrintf("ERROR: Failed to store Top MasterNodes for block %d", nCachedBlockHeight);
+        m_HistoryDB.Prune(nCachedBlockHeight);
     }
     else if (!is_enum_any_of(status, 
                 GetTopMasterNodeStatus::SUCCEEDED_FROM_HISTORY,
@@ -2493,23 +2834,34 @@ GetTopMasterNodeStatus CMasternodeMan::CalculateTopMNsForBlock(string &error, ma
 {
     vTopMNs.clear();
     error.clear();
-    rank_pair_vec_t vMasternodeRanks;
-    GetTopMasterNodeStatus status = GetMasternodeRanks(error, vMasternodeRanks, nBlockHeight);
-    if ((status == GetTopMasterNodeStatus::SUCCEEDED) && (vMasternodeRanks.size() < masterNodeCtrl.getMasternodeTopMNsNumberMin()))
-    {
-        error = strprintf("Not enough masternodes found for block %d, min required %d but found %zu",
-            nBlockHeight, masterNodeCtrl.getMasternodeTopMNsNumberMin(), vMasternodeRanks.size());
-        return GetTopMasterNodeStatus::NOT_ENOUGH_MNS;
-    }
-    if (status != GetTopMasterNodeStatus::SUCCEEDED)
-        return status;
-    
-    for (auto &[rank, pmn]: vMasternodeRanks)
-    {
-        if (bSkipValidCheck || pmn->IsValidForPayment())
-            vTopMNs.push_back(pmn);
-        if (vTopMNs.size() == masterNodeCtrl.getMasternodeTopMNsNumber())
+    const size_t nTopMNsNumber = masterNodeCtrl.getMasternodeTopMNsNumber();
+    // only top part of the ranks is needed, request more if some of the top MNs are not valid for payment
+    size_t nMaxRanks = nTopMNsNumber;
+    while (true)
+    {
+        rank_pair_vec_t vMasternodeRanks;
+        size_t nMasternodeCount = 0;
+        GetTopMasterNodeStatus status = GetMasternodeRanks(error, vMasternodeRanks, nBlockHeight, 0, nMaxRanks, &nMasternodeCount);
+        if ((status == GetTopMasterNodeStatus::SUCCEEDED) && (nMasternodeCount < masterNodeCtrl.getMasternodeTopMNsNumberMin()))
+        {
+            error = strprintf("Not enough masternodes found for block %d, min required %d but found %zu",
+                nBlockHeight, masterNodeCtrl.getMasternodeTopMNsNumberMin(), nMasternodeCount);
+            return GetTopMasterNodeStatus::NOT_ENOUGH_MNS;
+        }
+        if (status != GetTopMasterNodeStatus::SUCCEEDED)
+            return status;
+
+        vTopMNs.clear();
+        for (auto &[rank, pmn]: vMasternodeRanks)
+        {
+            if (bSkipValidCheck || pmn->IsValidForPayment())
+                vTopMNs.push_back(pmn);
+            if (vTopMNs.size() == nTopMNsNumber)
+                break;
+        }
+        if ((vTopMNs.size() >= nTopMNsNumber) || (vMasternodeRanks.size() >= nMasternodeCount))
             break;
+        nMaxRanks *= 2;
     }
     return GetTopMasterNodeStatus::SUCCEEDED;
 }
@@ -2521,33 +2873,40 @@ GetTopMasterNodeStatus CMasternodeMan::GetTopMNsForBlock(string &error, masterno
 
     error.clear();
 
+    v_outpoints vOutpoints;
+    bool bFound = false;
     {
         LOCK(cs_mnHist);
-
-        const auto it = m_mapHistoricalTopMNs.find(nBlockHeight);
-        if (it != m_mapHistoricalTopMNs.cend())
+        bFound = m_HistoryDB.ReadTopMNs(nBlockHeight, vOutpoints);
+    }
+    if (bFound)
+    {
+        vTopMNs.clear();
+        vTopMNs.reserve(vOutpoints.size());
+        masternode_t pmn;
+        for (const auto& outpoint : vOutpoints)
         {
-            vTopMNs.clear();
-            const auto& vTopMNCacheIds = it->second;
-            vTopMNs.reserve(vTopMNCacheIds.size());
-            for (const auto& nMNCacheId : vTopMNCacheIds)
+            // use the masternode from the masternodes map if it still exists
+            pmn = Get(USE_LOCK, outpoint);
+            if (!pmn)
             {
-                const auto it = m_mapHistoricalMNCache.find(nMNCacheId);
-                if (it == m_mapHistoricalMNCache.cend())
-                {
-                    error = strprintf("Historical MN #%d not found", nMNCacheId);
-                    return GetTopMasterNodeStatus::HISTORY_NOT_FOUND;
-                }
-                vTopMNs.push_back(it->second);
+                LOCK(cs_mnHist);
+                pmn = m_HistoryDB.ReadMasternode(outpoint);
+            }
+            if (!pmn)
+            {
+                error = strprintf("Historical MN %s not found", outpoint.ToStringShort());
+                return GetTopMasterNodeStatus::HISTORY_NOT_FOUND;
             }
-            if (vTopMNs.size() >= masterNodeCtrl.getMasternodeTopMNsNumberMin())
-                return GetTopMasterNodeStatus::SUCCEEDED_FROM_HISTORY;
-            error = strprintf("Top MNs historical ranks count (%zu) for block %d are less than required (%zu)",
-                vTopMNs.size(), nBlockHeight, masterNodeCtrl.getMasternodeTopMNsNumberMin());
+            vTopMNs.push_back(std::move(pmn));
         }
-        else
-            error = strprintf("Top MNs historical ranks for block %d not found", nBlockHeight);
+        if (vTopMNs.size() >= masterNodeCtrl.getMasternodeTopMNsNumberMin())
+            return GetTopMasterNodeStatus::SUCCEEDED_FROM_HISTORY;
+        error = strprintf("Top MNs historical ranks count (%zu) for block %d are less than required (%zu)",
+            vTopMNs.size(), nBlockHeight, masterNodeCtrl.getMasternodeTopMNsNumberMin());
     }
+    else
+        error = strprintf("Top MNs historical ranks for block %d not found", nBlockHeight);
     if (bCalculateIfNotSeen)
         return CalculateTopMNsForBlock(error, vTopMNs, nBlockHeight, bCalculateIfNotSeen);
     return GetTopMasterNodeStatus::HISTORY_NOT_FOUND;
@@ -15,15 +15,48 @@
 #include <utils/str_types.h>
 #include <utils/sync.h>
 #include <net.h>
+#include <mnode/mnode-db.h>
 #include <mnode/mnode-masternode.h>
+#include <mnode/mnode-score.h>
+#include <mnode/mnode-histdb.h>
 
 std::set<MNCacheItem> getAllMNCacheItems() noexcept;
 
+/**
+ * Digest of the masternode list used by the compact masternode list sync (dsegc).
+ * Each list entry is represented by two short ids: of the masternode broadcast (mnb) hash
+ * and of the last masternode ping (mnp) hash.
+ * Peer replies with inventory only for the broadcasts and pings missing in the digest.
+ */
+class CMasternodeListDigest
+{
+public:
+    // hash of the sorted short ids
+    uint256 hashList;
+    // sorted short ids of the mnb and mnp hashes
+    v_uint64 vShortIds;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        READWRITE(hashList);
+        READWRITE(vShortIds);
+    }
+
+    static uint64_t GetShortId(const uint256& hash) noexcept { return hash.GetCheapHash(); }
+    void Add(const uint256& hash) { vShortIds.push_back(GetShortId(hash)); }
+    // sort short ids and calculate the list hash
+    void Finalize();
+    bool Contains(const uint64_t nShortId) const noexcept;
+};
+
 class CMasternodeMan
 {
 public:
-    using score_pair_t = std::pair<arith_uint256, masternode_t>;
-    using score_pair_vec_t = std::vector<score_pair_t>;
+    using score_pair_t = CMasternodeScoreEngine::score_pair_t;
+    using score_pair_vec_t = CMasternodeScoreEngine::score_pair_vec_t;
 
     // map pair <rank> -> <masternode_t>
     using rank_pair_t = std::pair<int, masternode_t>;
@@ -34,6 +67,10 @@ public:
     // map of <mn_outpoint> -> <masternode_t>
     using recovery_masternodes_t = std::map<COutPoint, masternode_t> ;
     using masternode_history_map_t = std::unordered_map<uint32_t, masternode_vector_t>;
+    // map of <mn_outpoint> -> <masternode_t>
+    using masternode_map_t = CMasternodeScoreEngine::masternode_map_t;
+    // immutable copy of the masternode list, shared with readers
+    using masternode_map_snapshot_t = std::shared_ptr<const masternode_map_t>;
 
 public:
     // Keep track of all broadcasts I've seen
@@ -52,7 +89,7 @@ public:
         std::string strVersion;
         const bool bRead = ser_action == SERIALIZE_ACTION::Read;
         bool bProtectedMode = !bRead;
-        bool bOldMNHistMode = true;
+        uint32_t nVersion = MNCACHE_VERSION_HISTDB;
         auto guardMNReadMode = sg::make_scope_guard([&]() noexcept 
         {
             CMasternode::fCompatibilityReadMode = false;
@@ -64,7 +101,6 @@ public:
 				throw unexpected_serialization_version(strprintf("CMasternodeManager: unexpected serialization version prefix: '%s'", strVersion));
             // extract serialization version
             std::string strSerVersion = strVersion.substr(strlen(MNCACHE_SERIALIZATION_VERSION_PREFIX));
-            uint32_t nVersion = 0;
             if (!str_to_uint32_check(strSerVersion.c_str(), strSerVersion.size(), nVersion))
                 throw unexpected_serialization_version(strprintf("CMasternodeManager: unexpected serialization version: '%s'", strVersion));
             if (nVersion == MNCACHE_VERSION_OLD)
@@ -72,17 +108,14 @@ public:
                 bProtectedMode = false;
                 CMasternode::fCompatibilityReadMode = true;
             }
-            else if (nVersion >= MNCACHE_VERSION_PROTECTED && nVersion <= MNCACHE_VERSION_PROTECTED_HIST)
-            {
+            else if (nVersion >= MNCACHE_VERSION_PROTECTED && nVersion <= MNCACHE_VERSION_HISTDB)
                 bProtectedMode = true;
-                bOldMNHistMode = nVersion == MNCACHE_VERSION_PROTECTED;
-            } 
             else
                 throw unexpected_serialization_version(strprintf("CMasternodeManager: unexpected serialization version: '%s'", strVersion));
         }
         else
         {
-            strVersion = MNCACHE_SERIALIZATION_VERSION_PREFIX + std::to_string(MNCACHE_VERSION_PROTECTED_HIST);
+            strVersion = MNCACHE_SERIALIZATION_VERSION_PREFIX + std::to_string(MNCACHE_VERSION_HISTDB);
             READWRITE(strVersion);
         }
         try
@@ -113,29 +146,28 @@ public:
                 READWRITE(dummyMapMnRecoveryGoodReplies);
             }
             READWRITE(nLastWatchdogVoteTime);
+            if (bRead)
+                MasternodeListChanged();
 
             if (bProtectedMode)
             {
                 READWRITE_PROTECTED(mapSeenMasternodeBroadcast);
                 READWRITE_PROTECTED(mapSeenMasternodePing);
-                if (bRead)
-                {
-                    if (bOldMNHistMode)
-                        READWRITE_PROTECTED(tempMapHistoricalTopMNs);
-                    else
-                    {
-                        READWRITE_PROTECTED(m_mapHistoricalMNCache);
-                        READWRITE_PROTECTED(m_mapHistoricalTopMNs);
-                        READWRITE_PROTECTED(m_mapHistoricalMNCacheOutpoints);
-                        READWRITE(m_nLastHistoricalMNCacheID);
-                    }
-                }
-                else // write mode
+                // historical top MNs are stored in the MN history DB since MNCACHE_VERSION_HISTDB,
+                // older versions are read here and migrated to the MN history DB
+                if (bRead && (nVersion == MNCACHE_VERSION_PROTECTED))
+                    READWRITE_PROTECTED(tempMapHistoricalTopMNs);
+                else if (bRead && (nVersion == MNCACHE_VERSION_PROTECTED_HIST))
                 {
-                    READWRITE_PROTECTED(m_mapHistoricalMNCache);
-                    READWRITE_PROTECTED(m_mapHistoricalTopMNs);
-                    READWRITE_PROTECTED(m_mapHistoricalMNCacheOutpoints);
-                    READWRITE(m_nLastHistoricalMNCacheID);
+                    std::unordered_map<uint32_t, masternode_t> mapHistoricalMNCache;
+                    std::unordered_map<uint32_t, v_uint32> mapHistoricalTopMNs;
+                    std::unordered_map<std::string, uint32_t> mapHistoricalMNCacheOutpoints;
+                    uint32_t nLastHistoricalMNCacheID = 0;
+                    READWRITE_PROTECTED(mapHistoricalMNCache);
+                    READWRITE_PROTECTED(mapHistoricalTopMNs);
+                    READWRITE_PROTECTED(mapHistoricalMNCacheOutpoints);
+                    READWRITE(nLastHistoricalMNCacheID);
+                    ConvertHistoricalMNCache(mapHistoricalMNCache, mapHistoricalTopMNs, tempMapHistoricalTopMNs);
                 }
             }
             else
@@ -144,13 +176,8 @@ public:
                 READWRITE(mapSeenMasternodePing);
                 READWRITE(tempMapHistoricalTopMNs);
             }
-            if (bRead)
-            {
-                if (bOldMNHistMode)
-                    ConvertOldHistoricalMNs(std::move(tempMapHistoricalTopMNs));
-                else
-                    ProcessHistoricalMNCache();
-            }
+            if (bRead && !tempMapHistoricalTopMNs.empty())
+                MigrateHistoricalTopMNs(std::move(tempMapHistoricalTopMNs));
 
         } catch (const std::exception& e)
         {
@@ -162,7 +189,18 @@ public:
 
     CMasternodeMan() noexcept;
 
-    void ConvertOldHistoricalMNs(masternode_history_map_t && tempMapHistoricalTopMNs);
+    // export masternode cache as journaled flat DB records
+    void GetFlatDBRecords(flatdb_records_t &records) const;
+    // load one journaled flat DB record into the masternode cache
+    void LoadFlatDBRecord(const std::string &sKey, const std::string &sValue);
+
+    // open historical top MNs DB
+    bool InitHistoryDB(std::string &error);
+    // convert historical top MNs read from mncache.dat (MNCACHE_VERSION_PROTECTED_HIST)
+    void ConvertHistoricalMNCache(const std::unordered_map<uint32_t, masternode_t> &mapHistoricalMNCache,
+        const std::unordered_map<uint32_t, v_uint32> &mapHistoricalTopMNs, masternode_history_map_t &mapHistoricalTopMNsRet) const;
+    // move historical top MNs read from mncache.dat to the MN history DB
+    void MigrateHistoricalTopMNs(masternode_history_map_t && mapHistoricalTopMNs);
 
     /// Add an entry
     bool Add(masternode_t &mn);
@@ -186,13 +224,21 @@ public:
     uint32_t CountMasternodes(const std::function<bool(const masternode_t&)> &fnMnFilter,
         const int nProtocolVersion = -1) const noexcept;
 
+    // get immutable snapshot of the masternode list, does not wait for cs_mnMgr
+    // unless the list was changed and snapshot was not published yet
+    masternode_map_snapshot_t GetMasternodeSnapshot() const;
+
+    // process all masternodes from the list snapshot, callback gets immutable copy of the masternode info
     template <typename _context>
-    void ForEachMasternode(_context& ctx, const std::function<void(_context&, const masternode_t&)>& fnProcessNode) const
+    void ForEachMasternode(_context& ctx, const std::function<void(_context&, const masternode_info_t&)>& fnProcessNode) const
     {
-		LOCK(cs_mnMgr);
-		for (const auto& mn : mapMasternodes)
-			fnProcessNode(ctx, mn.second);
-	}
+        const auto pSnapshot = GetMasternodeSnapshot();
+        for (const auto& [outpoint, pmn] : *pSnapshot)
+        {
+            if (pmn)
+                fnProcessNode(ctx, pmn->GetInfo());
+        }
+    }
 
     // Count Masternodes filtered by nProtocolVersion.
     // Masternode nProtocolVersion should match or be above the one specified in param here.
@@ -208,6 +254,7 @@ public:
     uint32_t GetCachedBlockHeight() const noexcept { return nCachedBlockHeight; }
 
     void DsegUpdate(node_t& pnode);
+    CMasternodeListDigest GetListDigest() const;
 
     masternode_t Get(const bool bLockMgr, const COutPoint& outpoint);
     bool Has(const COutPoint& outpoint);
@@ -227,15 +274,18 @@ public:
     /// Find a random entry
     masternode_info_t FindRandomNotInVec(const v_outpoints &vecToExclude, int nProtocolVersion = -1);
 
-    auto GetFullMasternodeMap() const noexcept { return mapMasternodes; }
+    masternode_map_t GetFullMasternodeMap() const { return *GetMasternodeSnapshot(); }
 
-    GetTopMasterNodeStatus GetMasternodeRanks(std::string &error, rank_pair_vec_t& vecMasternodeRanksRet, int nBlockHeight = -1, int nMinProtocol = 0) const;
+    GetTopMasterNodeStatus GetMasternodeRanks(std::string &error, rank_pair_vec_t& vecMasternodeRanksRet, int nBlockHeight = -1, int nMinProtocol = 0,
+        const size_t nMaxRanks = 0, size_t *pnMasternodeCount = nullptr) const;
     bool GetMasternodeRank(std::string &error, const COutPoint &outpoint, int& nRankRet, int nBlockHeight = -1, int nMinProtocol = 0);
 
     void ProcessMasternodeConnections();
     std::pair<CService, std::set<uint256> > PopScheduledMnbRequestConnection();
 
     void ProcessMessage(node_t& pfrom, std::string& strCommand, CDataStream& vRecv);
+    void ProcessPing(const node_t& pfrom, const CMasterNodePing& mnp);
+    void ProcessCompactListRequest(const node_t& pfrom, CMasternodeListDigest& digest);
 
     void DoFullVerificationStep();
     void CheckSameAddr();
@@ -298,8 +348,12 @@ private:
     std::atomic_uint32_t nCachedBlockHeight;
     size_t m_nLastMasternodeCount = 0;
 
-    // map to hold all MNs
-    std::map<COutPoint, masternode_t> mapMasternodes;
+    // map to hold all MNs, protected by cs_mnMgr
+    masternode_map_t mapMasternodes;
+    // read-only copy of mapMasternodes for the lock-free readers (Get, Has, GetMasternodeInfo...),
+    // reset on each list change and published again by the writer or by the first reader,
+    // accessed with std::atomic_load/atomic_store
+    mutable masternode_map_snapshot_t m_pMasternodesSnapshot;
     // who's asked for the Masternode list and the last time
     std::map<CNetAddr, int64_t> mAskedUsForMasternodeList;
     // who we asked for the Masternode list and the last time
@@ -321,23 +375,31 @@ private:
     std::map<uint256, COutPoint> m_mapScheduledMnbForRelay;
     std::map<uint256, COutPoint> m_mapScheduledMnpForRelay;
 
-    // these maps are protected by cs_mnHist
-    // map of <mn historical cache id> -> <mn shared_ptr>
-    std::unordered_map<uint32_t, masternode_t> m_mapHistoricalMNCache;
-    // map of <block height> -> <vector of top masternodes (represented as mn historical cache ids)>
-    std::unordered_map<uint32_t, v_uint32> m_mapHistoricalTopMNs;
-    // map of <mn outpoint> -> <mn historical cache id>
-    std::unordered_map<std::string, uint32_t> m_mapHistoricalMNCacheOutpoints;
-    uint32_t m_nLastHistoricalMNCacheID = 0;
+    // historical top MNs DB, protected by cs_mnHist
+    CMasternodeHistoryDB m_HistoryDB;
+    // historical top MNs read from mncache.dat before MN history DB was opened, protected by cs_mnHist
+    masternode_history_map_t m_mapPendingHistoricalTopMNs;
 
     int64_t nLastWatchdogVoteTime;
 
     friend class CMasternodeSync;
 
-    bool GetMasternodeScores(std::string &error, const uint256& blockHash, score_pair_vec_t& vecMasternodeScoresRet, int nMinProtocol = 0) const noexcept;
+    // masternode scores cached per block, protected by cs_mnMgr
+    mutable CMasternodeScoreEngine m_ScoreEngine;
+
+    // should be called under cs_mnMgr when masternodes are added to or removed from mapMasternodes
+    void MasternodeListChanged();
+    // publish new snapshot of the masternode list if it was reset, should be called under cs_mnMgr
+    masternode_map_snapshot_t PublishMasternodeSnapshot() const;
+
+    bool GetMasternodeScores(std::string &error, const uint256& blockHash, score_pair_vec_t& vecMasternodeScoresRet, int nMinProtocol = 0,
+        const size_t nMaxCount = 0, size_t *pnMasternodeCount = nullptr) const noexcept;
 
     bool ProcessRecoveryReply(const uint256 &hashMNB, const node_t& pfrom, const CMasternodeBroadcast &mnb, masternode_t &pmn);
     void PopulateMasternodeRecoveryList(recovery_masternodes_t &mapRecoveryMasternodes) const;
     void CleanupMaps();
-    void ProcessHistoricalMNCache();
+    // check full masternode list request rate limit for the peer, should be called under cs_mnMgr
+    bool CheckListRequestRateLimit(const node_t& pfrom);
+    // check if masternode entry can be sent to the peer on list sync request
+    bool CanSendListEntry(const masternode_t& pmn) const noexcept;
 };
@@ -122,6 +122,12 @@ bool CMasterNodePing::CheckSignature(CPubKey& pubKeyMasternode, int &nDos) const
     return true;
 }
 
+void CMasterNodePing::PrecomputeSignature() const
+{
+    if (!m_vchSig.empty())
+        CMessageSigner::PrecomputeMessage(getMessage(), m_vchSig);
+}
+
 CMasterNodePing::MNP_CHECK_RESULT CMasterNodePing::SimpleCheck(int& nDos) const noexcept
 {
     // don't ban by default
@@ -429,32 +435,36 @@ bool CMasternode::UpdateFromNewBroadcast(const CMasternodeBroadcast& mnb)
         LogFnPrint("masternode", "masternode '%s' ignoring mnb v%hd", mnb.GetDesc(), mnb.GetVersion());
         return false;
     }
-    pubKeyMasternode = mnb.pubKeyMasternode;
-    sigTime = mnb.sigTime;
-    vchSig = mnb.vchSig;
-    nProtocolVersion = mnb.nProtocolVersion;
-    m_addr = mnb.m_addr;
-    strExtraLayerAddress = mnb.strExtraLayerAddress;
-    strExtraLayerP2P = mnb.strExtraLayerP2P;
-    strExtraLayerCfg = mnb.strExtraLayerCfg;
-    if (mnb.GetVersion() >= 2)
+    // GetInfo() can be called by the lock-free readers of the masternode list snapshot
     {
-        const bool bEligibleForMining = m_bEligibleForMining;
-        SetEligibleForMining(mnb.IsEligibleForMining());
-        if (bEligibleForMining != mnb.IsEligibleForMining())
-            LogFnPrint("masternode", "eligibleForMining=%d", mnb.IsEligibleForMining());
-    }
-    if (mnb.GetVersion() >= 1)
-    {
-        m_nMNFeePerMB = mnb.m_nMNFeePerMB;
-        m_nTicketChainStorageFeePerKB = mnb.m_nTicketChainStorageFeePerKB;
-        m_nSenseComputeFee = mnb.m_nSenseComputeFee;
-        m_nSenseProcessingFeePerMB = mnb.m_nSenseProcessingFeePerMB;
+        LOCK(cs_mn);
+        pubKeyMasternode = mnb.pubKeyMasternode;
+        sigTime = mnb.sigTime;
+        vchSig = mnb.vchSig;
+        nProtocolVersion = mnb.nProtocolVersion;
+        m_addr = mnb.m_addr;
+        strExtraLayerAddress = mnb.strExtraLayerAddress;
+        strExtraLayerP2P = mnb.strExtraLayerP2P;
+        strExtraLayerCfg = mnb.strExtraLayerCfg;
+        if (mnb.GetVersion() >= 2)
+        {
+            const bool bEligibleForMining = m_bEligibleForMining;
+            SetEligibleForMining(mnb.IsEligibleForMining());
+            if (bEligibleForMining != mnb.IsEligibleForMining())
+                LogFnPrint("masternode", "eligibleForMining=%d", mnb.IsEligibleForMining());
+        }
+        if (mnb.GetVersion() >= 1)
+        {
+            m_nMNFeePerMB = mnb.m_nMNFeePerMB;
+            m_nTicketChainStorageFeePerKB = mnb.m_nTicketChainStorageFeePerKB;
+            m_nSenseComputeFee = mnb.m_nSenseComputeFee;
+            m_nSenseProcessingFeePerMB = mnb.m_nSenseProcessingFeePerMB;
+        }
+        m_nVersion = mnb.GetVersion();
+        m_nPoSeBanScore = 0;
+        m_nPoSeBanHeight = 0;
+        nTimeLastChecked = 0;
     }
-    m_nVersion = mnb.GetVersion();
-    m_nPoSeBanScore = 0;
-    m_nPoSeBanHeight = 0;
-    nTimeLastChecked = 0;
     int nDos = 0;
     if (mnb.IsLastPingDefined())
         setLastPingAndCheck(mnb.getLastPing(), true, nDos);
@@ -489,9 +499,18 @@ arith_uint256 CMasternode::CalculateScore(const uint256& blockHash)
         VerifyCollateral(collateralStatus, m_collateralMinConfBlockHash);
     }
     
-    // Deterministically calculate a "score" for a Masternode based on any given (block)hash
-    CHashWriter ss(SER_GETHASH, PROTOCOL_VERSION);
-    ss << m_vin.prevout << m_collateralMinConfBlockHash << blockHash;
+    // Deterministically calculate a "score" for a Masternode based on any given (block)hash.
+    // Hash writer state for the static prefix (outpoint + collateral hash) is calculated once
+    // and reused for all blocks.
+    if (!m_scoreHashPrefix || (m_scoreHashPrefix->outpoint != m_vin.prevout) ||
+        (m_scoreHashPrefix->collateralMinConfBlockHash != m_collateralMinConfBlockHash))
+    {
+        m_scoreHashPrefix.emplace(score_hash_prefix_t{ m_vin.prevout, m_collateralMinConfBlockHash,
+            CHashWriter(SER_GETHASH, PROTOCOL_VERSION) });
+        m_scoreHashPrefix->hashWriter << m_vin.prevout << m_collateralMinConfBlockHash;
+    }
+    CHashWriter ss(m_scoreHashPrefix->hashWriter);
+    ss << blockHash;
     return UintToArith256(ss.GetHash());
 }
 
@@ -505,14 +524,16 @@ CMasternode::CollateralStatus CMasternode::CheckCollateral(const COutPoint& outp
 {
     AssertLockHeld(cs_main);
 
-    CCoins coins;
-    if (!GetUTXOCoin(outpoint, coins))
+    // collateral coin is read from the collateral cache, coins tip is read only on cache miss
+    CAmount nValue = 0;
+    int nHeight = 0;
+    if (!masterNodeCtrl.collateralCache.GetCoin(outpoint, nValue, nHeight))
         return CollateralStatus::UTXO_NOT_FOUND;
 
-    if (coins.vout[outpoint.n].nValue != masterNodeCtrl.MasternodeCollateral*COIN)
+    if (nValue != masterNodeCtrl.MasternodeCollateral*COIN)
         return CollateralStatus::INVALID_AMOUNT;
 
-    nHeightRet = coins.nHeight;
+    nHeightRet = nHeight;
     return CollateralStatus::OK;
 }
 
@@ -550,10 +571,11 @@ bool CMasternode::CheckAndUpdateMNID(string &error)
 /**
  * Check & update Masternode's state.
  * 
+ * Should be called under cs_main to check the collateral.
+ * 
  * \param fForce - force update
- * \param bLockMain - if true, try to lock cs_main
  */
-void CMasternode::Check(const bool fForce, const bool bLockMain)
+void CMasternode::Check(const bool fForce)
 {
     LOCK(cs_mn);
 
@@ -571,11 +593,7 @@ void CMasternode::Check(const bool fForce, const bool bLockMain)
 
     if (!fUnitTest)
     {
-        TRY_LOCK_COND(bLockMain, cs_main, lockMain);
-        if (bLockMain && !lockMain)
-            return;
-
-        CollateralStatus err = CheckCollateral(m_vin.prevout);
+        const CollateralStatus err = CheckCollateral(m_vin.prevout);
         if (err == CollateralStatus::UTXO_NOT_FOUND)
         {
             LogFnPrint("masternode", "Failed to find Masternode UTXO, masternode=%s", GetDesc());
@@ -730,6 +748,7 @@ bool CMasternode::IsValidNetAddr(const CService &addr)
 
 masternode_info_t CMasternode::GetInfo() const noexcept
 {
+    LOCK(cs_mn);
     masternode_info_t info{*this};
     info.nTimeLastPing = m_lastPing.getSigTime();
     info.fInfoValid = true;
@@ -744,6 +763,7 @@ string CMasternode::GetStatus() const
 
 void CMasternode::setLastPing(const CMasterNodePing& lastPing) noexcept
 {
+    LOCK(cs_mn);
     m_lastPing = lastPing;
 }
 
@@ -1278,7 +1298,7 @@ CMasternodeBroadcast::MNB_UPDATE_RESULT CMasternodeBroadcast::Update(string& err
         return MNB_UPDATE_RESULT::OLDER;
     }
 
-    pmn->Check(false, SKIP_LOCK);
+    pmn->Check();
 
     // masternode is banned by PoSe
     if (pmn->IsPoSeBanned())
@@ -1311,7 +1331,7 @@ CMasternodeBroadcast::MNB_UPDATE_RESULT CMasternodeBroadcast::Update(string& err
         LogFnPrintf("Got UPDATED Masternode '%s' entry: addr=%s (v%hd, mnb '%s')", pmn->GetDesc(), 
             m_addr.ToString(), GetVersion(), hashMNB.ToString());
         if (pmn->UpdateFromNewBroadcast(*this))
-            pmn->Check(true, SKIP_LOCK);
+            pmn->Check(true);
         masterNodeCtrl.masternodeSync.BumpAssetLastTime(__METHOD_NAME__);
     }
 
@@ -1381,16 +1401,20 @@ bool CMasternodeBroadcast::CheckOutpoint(int& nDos, uint256 &collateralMinConfBl
     return true;
 }
 
+string CMasternodeBroadcast::getMessage() const noexcept
+{
+    return m_addr.ToString(false) + to_string(sigTime) +
+        pubKeyCollateralAddress.GetID().ToString() + pubKeyMasternode.GetID().ToString() +
+        to_string(nProtocolVersion);
+}
+
 bool CMasternodeBroadcast::Sign(const CKey& keyCollateralAddress)
 {
     string strError;
-    string strMessage;
 
     sigTime = GetAdjustedTime();
 
-    strMessage = m_addr.ToString(false) + to_string(sigTime) +
-                    pubKeyCollateralAddress.GetID().ToString() + pubKeyMasternode.GetID().ToString() +
-                    to_string(nProtocolVersion);
+    const string strMessage = getMessage();
 
     if (!CMessageSigner::SignMessage(strMessage, vchSig, keyCollateralAddress))
     {
@@ -1411,9 +1435,7 @@ bool CMasternodeBroadcast::CheckSignature(int& nDos) const
 {
     nDos = 0;
     string strError;
-    string strMessage = m_addr.ToString(false) + to_string(sigTime) +
-                    pubKeyCollateralAddress.GetID().ToString() + pubKeyMasternode.GetID().ToString() +
-                    to_string(nProtocolVersion);
+    const string strMessage = getMessage();
 
     KeyIO keyIO(m_chainparams);
     const CTxDestination dest = pubKeyCollateralAddress.GetID();
@@ -1432,6 +1454,13 @@ bool CMasternodeBroadcast::CheckSignature(int& nDos) const
     return true;
 }
 
+void CMasternodeBroadcast::PrecomputeSignatures() const
+{
+    if (!vchSig.empty())
+        CMessageSigner::PrecomputeMessage(getMessage(), vchSig);
+    m_lastPing.PrecomputeSignature();
+}
+
 void CMasternodeBroadcast::Relay() const
 {
     const uint256 hash = GetHash();
@@ -7,9 +7,11 @@
 #include <map>
 #include <vector>
 #include <memory>
+#include <optional>
 
 #include <utils/enum_util.h>
 #include <utils/arith_uint256.h>
+#include <utils/hash.h>
 #include <key.h>
 #include <consensus/validation.h>
 #include <timedata.h>
@@ -111,6 +113,8 @@ public:
 
     bool Sign(const CKey& keyMasternode, const CPubKey& pubKeyMasternode);
     bool CheckSignature(CPubKey& pubKeyMasternode, int &nDos) const;
+    // recover public key from the ping signature into the signature recovery cache
+    void PrecomputeSignature() const;
     MNP_CHECK_RESULT SimpleCheck(int& nDos) const noexcept;
     void Relay() const;
 
@@ -344,9 +348,10 @@ public:
     bool NeedUpdateFromBroadcast(const CMasternodeBroadcast& mnb) const noexcept;
     bool UpdateFromNewBroadcast(const CMasternodeBroadcast& mnb);
 
+    bool IsUnitTest() const noexcept { return fUnitTest; }
     static CollateralStatus CheckCollateral(const COutPoint& outpoint);
     static CollateralStatus CheckCollateral(const COutPoint& outpoint, int& nHeightRet);
-    void Check(const bool fForce = false, const bool bLockMain = false);
+    void Check(const bool fForce = false);
 
     int64_t GetLastBroadcastAge() const noexcept { return GetAdjustedTime() - sigTime; }
     bool IsBroadcastedWithin(const int nSeconds) const noexcept { return GetAdjustedTime() - sigTime < nSeconds; }
@@ -408,6 +413,7 @@ public:
     
     bool VerifyCollateral(CollateralStatus& collateralStatus, uint256 &collateralMinConfBlockHash) const;
     void SetCollateralMinConfBlockHash(const uint256& blockHash) noexcept { m_collateralMinConfBlockHash = blockHash; }
+    const uint256& GetCollateralMinConfBlockHash() const noexcept { return m_collateralMinConfBlockHash; }
     void UpdateWatchdogVoteTime(const uint64_t nVoteTime = 0);
 
 protected:
@@ -429,6 +435,15 @@ protected:
     // height of the last block where there was a payment to this masternode
     int m_nBlockLastPaid{};
 
+    // hash writer state after the static part of the MN score hash: collateral outpoint + m_collateralMinConfBlockHash
+    typedef struct _score_hash_prefix_t
+    {
+        COutPoint outpoint;
+        uint256 collateralMinConfBlockHash;
+        CHashWriter hashWriter;
+    } score_hash_prefix_t;
+    std::optional<score_hash_prefix_t> m_scoreHashPrefix;
+
     CAmount m_nMNFeePerMB = 0;                 // 0 means default (masterNodeCtrl.m_nMasternodeFeePerMBDefault)
     CAmount m_nTicketChainStorageFeePerKB = 0; // 0 means default (masterNodeCtrl.m_nTicketChainStorageFeePerKBDefault)
     CAmount m_nSenseComputeFee = 0;            // 0 means default (masterNodeCtrl.m_nSenseComputeFeeDefault)
@@ -586,8 +601,12 @@ public:
     MNB_UPDATE_RESULT Update(std::string &error, masternode_t &pmn, int& nDos) const;
     bool CheckOutpoint(int& nDos, uint256 &collateralMinConfBlockHash) const;
 
+    // get broadcast message to sign
+    std::string getMessage() const noexcept;
     bool Sign(const CKey& keyCollateralAddress);
     bool CheckSignature(int& nDos) const;
+    // recover public keys from the broadcast and last ping signatures into the signature recovery cache
+    void PrecomputeSignatures() const;
     void Relay() const;
     // check if pinged after sigTime
     bool IsPingedAfter(const int64_t &sigTime) const noexcept;
@@ -168,27 +168,35 @@ void CMasternodeMessageProcessor::ProcessMessage(node_t& pFrom, string& strComma
 
         const uint256 messageId = message.GetHash();
 
-        pFrom->setAskFor.erase(messageId);
+        pFrom->RemoveAskFor(messageId);
 
         if (!masterNodeCtrl.masternodeSync.IsMasternodeListSynced())
             return;
 
+        // expired message could be already removed from the seen messages, don't accept it again
+        if (!IsMessageTimeValid(message.sigTime, GetAdjustedTime()))
+        {
+            LogFnPrint("masternode", "MASTERNODEMESSAGE -- hash=%s, from=%s has invalid time %" PRId64,
+                messageId.ToString(), message.vinMasternodeFrom.ToString(), message.sigTime);
+            return;
+        }
+
 //        check
 //        cs_mapLatestSender
 
         {
             LOCK(cs_mapSeenMessages);
 
-            auto vi = mapSeenMessages.find(messageId);
-            if (vi != mapSeenMessages.end())
+            if (HasSeenMessage(messageId))
             {
                 LogFnPrintf("MASTERNODEMESSAGE -- hash=%s, from=%s seen", messageId.ToString(), message.vinMasternodeFrom.ToString());
                 return;
             }
 
-            mapSeenMessages[messageId] = message;
-            mapSeenMessages[messageId].MarkAsNotVerified(); // this removes signature in the message inside map, so we can skip this message from new syncs and as "seen"
-                                                            // but if message is correct it will replace the one inside the map
+            CMasternodeMessage messageNotVerified(message);
+            messageNotVerified.MarkAsNotVerified(); // this removes signature in the message inside map, so we can skip this message from new syncs and as "seen"
+                                                    // but if message is correct it will replace the one inside the map
+            AddSeenMessage(messageId, messageNotVerified);
         }
 
 //        if no vinMasternodeFrom - we only accept messages encrypted with our public key!!!!
@@ -223,10 +231,7 @@ void CMasternodeMessageProcessor::ProcessMessage(node_t& pFrom, string& strComma
         }
 
         // signature verified - replace with message with signature
-        {
-            LOCK(cs_mapSeenMessages);
-            mapSeenMessages[messageId] = message;
-        }
+        AddSeenMessage(messageId, message);
         //Is it message to us?
         //If 1) we are Masternode and 2) recipient's outpoint is OUR outpoint
         //... then this is message to us
@@ -236,7 +241,7 @@ void CMasternodeMessageProcessor::ProcessMessage(node_t& pFrom, string& strComma
         {
             //TODO Pastel: DecryptMessage()
             LOCK(cs_mapOurMessages);
-            mapOurMessages[messageId] = message;
+            AddOurMessage(messageId, message);
             bOurMessage = true;
             // Update new fee of the sender masternode
             bool bSetFee = false;
@@ -302,24 +307,7 @@ void CMasternodeMessageProcessor::CheckAndRemove()
 {
     if(!masterNodeCtrl.masternodeSync.IsBlockchainSynced()) return;
 
-    LOCK(cs_mapSeenMessages);
-
-    for (auto& mnpair : mapSeenMessages) {
-
-        CMasternodeMessage& item = mnpair.second;
-
-        //TODO Pastel: remove old (1 day old?) stuff from Seen map - mapSeenMessages
-
-        // if () {
-        //     //process...
-        //     ++it;
-        // } else if() {
-        //     //remove...
-        //     map<....>.erase(it++);
-        // } else {
-        //     ++it;
-        // }
-    }
+    EnforceLimits(GetTime());
     LogFnPrintf("%s", ToString());
 }
 
@@ -328,16 +316,303 @@ void CMasternodeMessageProcessor::Clear()
     LOCK2(cs_mapSeenMessages, cs_mapOurMessages);
     mapSeenMessages.clear();
     mapOurMessages.clear();
+    m_SeenLRU.clear();
+    m_OurLRU.clear();
+    m_mapSeenByRecipient.clear();
+    m_OurByTime.clear();
+}
+
+size_t CMasternodeMessageProcessor::Size() const noexcept
+{
+    LOCK(cs_mapSeenMessages);
+    return mapSeenMessages.size();
+}
+
+size_t CMasternodeMessageProcessor::SizeOur() const noexcept
+{
+    LOCK(cs_mapOurMessages);
+    return mapOurMessages.size();
 }
 
 string CMasternodeMessageProcessor::ToString() const
 {
     ostringstream info;
-    info << "Seen messages: " << (int)mapSeenMessages.size() <<
-            "; Our messages: " << (int)mapOurMessages.size();
+    info << "Seen messages: " << Size() <<
+            "; Our messages: " << SizeOur();
     return info.str();
 }
 
+bool CMasternodeMessageProcessor::HasSeenMessage(const uint256& messageId) const noexcept
+{
+    LOCK(cs_mapSeenMessages);
+    return mapSeenMessages.find(messageId) != mapSeenMessages.cend();
+}
+
+/**
+ * Get seen message by id and mark it as recently used.
+ * 
+ * \param messageId - message hash
+ * \param message - returns message
+ * \return true if message was found
+ */
+bool CMasternodeMessageProcessor::GetSeenMessage(const uint256& messageId, CMasternodeMessage& message)
+{
+    LOCK(cs_mapSeenMessages);
+    const auto it = mapSeenMessages.find(messageId);
+    if (it == mapSeenMessages.cend())
+        return false;
+    m_SeenLRU.Touch(messageId, GetTime());
+    message = it->second;
+    return true;
+}
+
+/**
+ * Add or replace seen message.
+ * Least recently used messages are evicted if the number of seen messages exceeds the limit.
+ * 
+ * \param messageId - message hash
+ * \param message - masternode message
+ */
+void CMasternodeMessageProcessor::AddSeenMessage(const uint256& messageId, const CMasternodeMessage& message)
+{
+    LOCK(cs_mapSeenMessages);
+    const auto result = mapSeenMessages.insert_or_assign(messageId, message);
+    if (result.second)
+        m_mapSeenByRecipient[message.vinMasternodeTo.prevout].emplace(message.sigTime, messageId);
+    m_SeenLRU.Touch(messageId, GetTime());
+
+    uint256 hash;
+    while (m_SeenLRU.GetEvictionCandidate(hash, m_nMaxSeenMessages, 0) && (hash != messageId))
+        EraseSeenMessage(hash);
+}
+
+/**
+ * Add message to this masternode.
+ * Oldest messages are evicted if the number of our messages exceeds the limit.
+ * 
+ * \param messageId - message hash
+ * \param message - masternode message
+ */
+void CMasternodeMessageProcessor::AddOurMessage(const uint256& messageId, const CMasternodeMessage& message)
+{
+    LOCK(cs_mapOurMessages);
+    const auto result = mapOurMessages.insert_or_assign(messageId, message);
+    if (result.second)
+        m_OurByTime.emplace(message.sigTime, messageId);
+    m_OurLRU.Touch(messageId, GetTime());
+
+    uint256 hash;
+    while (m_OurLRU.GetEvictionCandidate(hash, m_nMaxOurMessages, 0) && (hash != messageId))
+        EraseOurMessage(hash);
+}
+
+void CMasternodeMessageProcessor::EraseSeenMessage(const uint256& messageId)
+{
+    AssertLockHeld(cs_mapSeenMessages);
+    m_SeenLRU.Erase(messageId);
+    const auto it = mapSeenMessages.find(messageId);
+    if (it == mapSeenMessages.end())
+        return;
+    const auto itRecipient = m_mapSeenByRecipient.find(it->second.vinMasternodeTo.prevout);
+    if (itRecipient != m_mapSeenByRecipient.end())
+    {
+        itRecipient->second.erase(make_pair(it->second.sigTime, messageId));
+        if (itRecipient->second.empty())
+            m_mapSeenByRecipient.erase(itRecipient);
+    }
+    mapSeenMessages.erase(it);
+}
+
+void CMasternodeMessageProcessor::EraseOurMessage(const uint256& messageId)
+{
+    AssertLockHeld(cs_mapOurMessages);
+    m_OurLRU.Erase(messageId);
+    const auto it = mapOurMessages.find(messageId);
+    if (it == mapOurMessages.end())
+        return;
+    m_OurByTime.erase(make_pair(it->second.sigTime, messageId));
+    mapOurMessages.erase(it);
+}
+
+/**
+ * Check masternode message time.
+ * Messages older than seen messages expiration time can be replayed after they were removed
+ * from the seen messages, so they are not accepted.
+ * 
+ * \param nSigTime - message time
+ * \param nTime - current time
+ * \return true if message time is valid
+ */
+bool CMasternodeMessageProcessor::IsMessageTimeValid(const int64_t nSigTime, const int64_t nTime) noexcept
+{
+    return (nSigTime >= nTime - MN_MESSAGES_SEEN_EXPIRATION_SECS) &&
+           (nSigTime <= nTime + MN_MESSAGES_MAX_FUTURE_SECS);
+}
+
+/**
+ * Remove expired messages and messages over the size limits.
+ * 
+ * \param nTime - current time
+ */
+void CMasternodeMessageProcessor::EnforceLimits(const int64_t nTime)
+{
+    uint256 hash;
+    size_t nSeenRemoved = 0, nOurRemoved = 0;
+    {
+        LOCK(cs_mapSeenMessages);
+        while (m_SeenLRU.GetEvictionCandidate(hash, m_nMaxSeenMessages, nTime - MN_MESSAGES_SEEN_EXPIRATION_SECS))
+        {
+            EraseSeenMessage(hash);
+            ++nSeenRemoved;
+        }
+    }
+    {
+        LOCK(cs_mapOurMessages);
+        while (m_OurLRU.GetEvictionCandidate(hash, m_nMaxOurMessages, nTime - MN_MESSAGES_OUR_EXPIRATION_SECS))
+        {
+            EraseOurMessage(hash);
+            ++nOurRemoved;
+        }
+    }
+    if (nSeenRemoved || nOurRemoved)
+        LogFnPrint("masternode", "removed %zu seen and %zu our messages", nSeenRemoved, nOurRemoved);
+}
+
+/**
+ * Rebuild message indexes after loading messages from the cache file.
+ * Messages are ordered by message time in LRU indexes, expired messages are removed.
+ */
+void CMasternodeMessageProcessor::RebuildIndexes()
+{
+    AssertLockHeld(cs_mapSeenMessages);
+    AssertLockHeld(cs_mapOurMessages);
+
+    const int64_t nNow = GetTime();
+    m_SeenLRU.clear();
+    m_mapSeenByRecipient.clear();
+    message_time_set_t setSeenByTime;
+    for (const auto& [messageId, message] : mapSeenMessages)
+    {
+        setSeenByTime.emplace(message.sigTime, messageId);
+        m_mapSeenByRecipient[message.vinMasternodeTo.prevout].emplace(message.sigTime, messageId);
+    }
+    for (const auto& [nTime, messageId] : setSeenByTime)
+        m_SeenLRU.Touch(messageId, min(nTime, nNow));
+
+    m_OurLRU.clear();
+    m_OurByTime.clear();
+    for (const auto& [messageId, message] : mapOurMessages)
+        m_OurByTime.emplace(message.sigTime, messageId);
+    for (const auto& [nTime, messageId] : m_OurByTime)
+        m_OurLRU.Touch(messageId, min(nTime, nNow));
+
+    EnforceLimits(nNow);
+}
+
+size_t CMasternodeMessageProcessor::ForEachMessage(const message_time_set_t& setMessages, const map<uint256, CMasternodeMessage>& mapMessages,
+    const size_t nOffset, const size_t nLimit, const mn_message_func_t& fnProcess)
+{
+    size_t nIndex = 0, nProcessed = 0;
+    for (const auto& [nTime, messageId] : setMessages)
+    {
+        if (nIndex++ < nOffset)
+            continue;
+        if (nLimit && (nProcessed >= nLimit))
+            break;
+        const auto it = mapMessages.find(messageId);
+        if (it == mapMessages.cend())
+            continue;
+        fnProcess(messageId, it->second);
+        ++nProcessed;
+    }
+    return setMessages.size();
+}
+
+/**
+ * Call fnProcess for the page of messages to this masternode ordered by message time.
+ * 
+ * \param nOffset - number of messages to skip
+ * \param nLimit - max number of messages to process, 0 - no limit
+ * \param fnProcess - function to call for each message
+ * \return total number of messages to this masternode
+ */
+size_t CMasternodeMessageProcessor::ForEachOurMessage(const size_t nOffset, const size_t nLimit, const mn_message_func_t& fnProcess) const
+{
+    LOCK(cs_mapOurMessages);
+    return ForEachMessage(m_OurByTime, mapOurMessages, nOffset, nLimit, fnProcess);
+}
+
+/**
+ * Call fnProcess for the page of seen messages to the given masternode ordered by message time.
+ * 
+ * \param outpointTo - recipient masternode collateral outpoint
+ * \param nOffset - number of messages to skip
+ * \param nLimit - max number of messages to process, 0 - no limit
+ * \param fnProcess - function to call for each message
+ * \return total number of seen messages to the masternode
+ */
+size_t CMasternodeMessageProcessor::ForEachMessageTo(const COutPoint& outpointTo, const size_t nOffset, const size_t nLimit, const mn_message_func_t& fnProcess) const
+{
+    LOCK(cs_mapSeenMessages);
+    const auto it = m_mapSeenByRecipient.find(outpointTo);
+    if (it == m_mapSeenByRecipient.cend())
+        return 0;
+    return ForEachMessage(it->second, mapSeenMessages, nOffset, nLimit, fnProcess);
+}
+
+/**
+ * Add message hash to the LRU index or mark it as the most recently used.
+ * 
+ * \param hash - message hash
+ * \param nTime - access time
+ */
+void CMasternodeMessageLRU::Touch(const uint256& hash, const int64_t nTime)
+{
+    const auto it = m_mapIndex.find(hash);
+    if (it != m_mapIndex.end())
+    {
+        it->second->second = nTime;
+        m_List.splice(m_List.end(), m_List, it->second);
+        return;
+    }
+    m_List.emplace_back(hash, nTime);
+    m_mapIndex.emplace(hash, prev(m_List.end()));
+}
+
+void CMasternodeMessageLRU::Erase(const uint256& hash)
+{
+    const auto it = m_mapIndex.find(hash);
+    if (it == m_mapIndex.end())
+        return;
+    m_List.erase(it->second);
+    m_mapIndex.erase(it);
+}
+
+/**
+ * Get least recently used message hash that should be evicted.
+ * 
+ * \param hash - returns least recently used message hash
+ * \param nMaxSize - max number of messages in the index
+ * \param nExpireBefore - messages last used before this time are expired
+ * \return true if the least recently used message should be evicted
+ */
+bool CMasternodeMessageLRU::GetEvictionCandidate(uint256& hash, const size_t nMaxSize, const int64_t nExpireBefore) const noexcept
+{
+    if (m_List.empty())
+        return false;
+    const auto& [hashLRU, nTime] = m_List.front();
+    if ((m_List.size() <= nMaxSize) && (nTime >= nExpireBefore))
+        return false;
+    hash = hashLRU;
+    return true;
+}
+
+void CMasternodeMessageLRU::clear() noexcept
+{
+    m_List.clear();
+    m_mapIndex.clear();
+}
+
 // TODO Pastel: Message (msg) shall be encrypted before sending using recipient's public key
 //so only recipient can see its content. Should this be part of MessageProcessor???
 void CMasternodeMessageProcessor::SendMessage(const CPubKey& pubKeyTo, const CMasternodeMessageType msgType, const string& msg)
@@ -349,9 +624,9 @@ void CMasternodeMessageProcessor::SendMessage(const CPubKey& pubKeyTo, const CMa
     const uint256 messageId = message->GetHash();
     
     LOCK(cs_mapSeenMessages);
-    if (!mapSeenMessages.count(messageId))
+    if (!HasSeenMessage(messageId))
     {
-        mapSeenMessages[messageId] = *message;
+        AddSeenMessage(messageId, *message);
         message->Relay();
     }
 }
@@ -3,6 +3,10 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 #include <map>
+#include <set>
+#include <list>
+#include <unordered_map>
+#include <functional>
 
 #include <utils/enum_util.h>
 #include <utils/sync.h>
@@ -14,6 +18,16 @@ extern CCriticalSection cs_mapOurMessages;
 
 constexpr auto MN_MESSAGES_FILENAME = "messages.dat";
 constexpr auto MN_MESSAGES_MAGIC_CACHE_STR = "magicMessagesCache";
+// max number of seen masternode messages to keep
+constexpr size_t MN_MESSAGES_MAX_SEEN = 50'000;
+// max number of messages to this masternode to keep
+constexpr size_t MN_MESSAGES_MAX_OUR = 10'000;
+// seen masternode messages not accessed within this time are removed
+constexpr int64_t MN_MESSAGES_SEEN_EXPIRATION_SECS = 24 * 60 * 60;
+// messages to this masternode older than this time are removed
+constexpr int64_t MN_MESSAGES_OUR_EXPIRATION_SECS = 30 * 24 * 60 * 60;
+// max allowed time of the message in the future
+constexpr int64_t MN_MESSAGES_MAX_FUTURE_SECS = 60 * 60;
 
 bool Sign(const std::string& message, std::string& signatureBase64, std::string& error_ret);
 bool Sign(const std::string& message, v_uint8& signature, std::string& error_ret);
@@ -83,17 +97,43 @@ public:
     static std::unique_ptr<CMasternodeMessage> Create(const CPubKey& pubKeyTo, CMasternodeMessageType msgType, const std::string& msg);
 };
 
-class CMasternodeMessageProcessor
+/**
+ * LRU index of the masternode message hashes.
+ * Hashes are ordered by the last access time - least recently used first.
+ */
+class CMasternodeMessageLRU
 {
 public:
-    std::map<uint256, CMasternodeMessage> mapSeenMessages;
-    std::map<uint256, CMasternodeMessage> mapOurMessages;
+    // add message hash or mark it as the most recently used
+    void Touch(const uint256& hash, const int64_t nTime);
+    void Erase(const uint256& hash);
+    // get least recently used hash if the index exceeds nMaxSize or it was last used before nExpireBefore
+    bool GetEvictionCandidate(uint256& hash, const size_t nMaxSize, const int64_t nExpireBefore) const noexcept;
+    size_t size() const noexcept { return m_mapIndex.size(); }
+    void clear() noexcept;
+
+private:
+    using lru_list_t = std::list<std::pair<uint256, int64_t>>;
+
+    // <message hash, last access time>, least recently used first
+    lru_list_t m_List;
+    std::unordered_map<uint256, lru_list_t::iterator, BlockHasher> m_mapIndex;
+};
 
+using mn_message_func_t = std::function<void(const uint256&, const CMasternodeMessage&)>;
+
+class CMasternodeMessageProcessor
+{
+public:
     // TODO Pastel - DDoS protection
 //    std::map<uint256, > mapLatestSenders;
 //    std::map<CNetAddr, int64_t> mapLatestSenders; how many time during last hour(?) or time ago
 
-    CMasternodeMessageProcessor() noexcept = default;
+    CMasternodeMessageProcessor(const size_t nMaxSeenMessages = MN_MESSAGES_MAX_SEEN,
+        const size_t nMaxOurMessages = MN_MESSAGES_MAX_OUR) noexcept :
+        m_nMaxSeenMessages(nMaxSeenMessages),
+        m_nMaxOurMessages(nMaxOurMessages)
+    {}
 
     ADD_SERIALIZE_METHODS;
 
@@ -103,6 +143,8 @@ public:
         LOCK2(cs_mapSeenMessages, cs_mapOurMessages);
         READWRITE(mapSeenMessages);
         READWRITE(mapOurMessages);
+        if (ser_action == SERIALIZE_ACTION::Read)
+            RebuildIndexes();
     }
 
 public:
@@ -110,9 +152,49 @@ public:
     void ProcessMessage(node_t &pFrom, std::string &strCommand, CDataStream &vRecv);
     void CheckAndRemove();
     void Clear();
-    size_t Size() const noexcept { return mapSeenMessages.size(); }
-    size_t SizeOur() const noexcept { return mapOurMessages.size(); }
+    size_t Size() const noexcept;
+    size_t SizeOur() const noexcept;
     std::string ToString() const;
     
     void SendMessage(const CPubKey& pubKeyTo, const CMasternodeMessageType msgType, const std::string& msg);
+
+    bool HasSeenMessage(const uint256& messageId) const noexcept;
+    bool GetSeenMessage(const uint256& messageId, CMasternodeMessage& message);
+    void AddSeenMessage(const uint256& messageId, const CMasternodeMessage& message);
+    void AddOurMessage(const uint256& messageId, const CMasternodeMessage& message);
+    // remove expired messages and messages over the size limits
+    void EnforceLimits(const int64_t nTime);
+    // check that message time is not too old to be in the seen messages or in the future
+    static bool IsMessageTimeValid(const int64_t nSigTime, const int64_t nTime) noexcept;
+
+    // call fnProcess for the page of our messages ordered by message time, returns total number of our messages
+    size_t ForEachOurMessage(const size_t nOffset, const size_t nLimit, const mn_message_func_t& fnProcess) const;
+    // call fnProcess for the page of seen messages sent to the masternode, returns total number of such messages
+    size_t ForEachMessageTo(const COutPoint& outpointTo, const size_t nOffset, const size_t nLimit, const mn_message_func_t& fnProcess) const;
+
+protected:
+    // set of <message time, message hash> ordered by message time
+    using message_time_set_t = std::set<std::pair<int64_t, uint256>>;
+
+    // all seen messages, protected by cs_mapSeenMessages
+    std::map<uint256, CMasternodeMessage> mapSeenMessages;
+    // messages to this masternode, protected by cs_mapOurMessages
+    std::map<uint256, CMasternodeMessage> mapOurMessages;
+
+    size_t m_nMaxSeenMessages;
+    size_t m_nMaxOurMessages;
+    // LRU index of the seen messages, protected by cs_mapSeenMessages
+    CMasternodeMessageLRU m_SeenLRU;
+    // LRU index of our messages, protected by cs_mapOurMessages
+    CMasternodeMessageLRU m_OurLRU;
+    // index of the seen messages by recipient masternode outpoint, protected by cs_mapSeenMessages
+    std::map<COutPoint, message_time_set_t> m_mapSeenByRecipient;
+    // our messages ordered by message time, protected by cs_mapOurMessages
+    message_time_set_t m_OurByTime;
+
+    void EraseSeenMessage(const uint256& messageId);
+    void EraseOurMessage(const uint256& messageId);
+    void RebuildIndexes();
+    static size_t ForEachMessage(const message_time_set_t& setMessages, const std::map<uint256, CMasternodeMessage>& mapMessages,
+        const size_t nOffset, const size_t nLimit, const mn_message_func_t& fnProcess);
 };
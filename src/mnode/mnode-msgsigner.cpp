@@ -7,6 +7,7 @@
 #include <key_io.h>
 
 #include <mnode/mnode-msgsigner.h>
+#include <mnode/mnode-sigverify.h>
 
 bool CMessageSigner::GetKeysFromSecret(const std::string &strSecret, CKey& keyRet, CPubKey& pubkeyRet)
 {
@@ -37,6 +38,15 @@ bool CMessageSigner::VerifyMessage(const CPubKey pubkey, const v_uint8& vchSig,
     return CHashSigner::VerifyHash(ss.GetHash(), pubkey, vchSig, strErrorRet);
 }
 
+void CMessageSigner::PrecomputeMessage(const std::string &strMessage, const v_uint8& vchSig)
+{
+    CHashWriter ss(SER_GETHASH, 0);
+    ss << STR_MSG_MAGIC;
+    ss << strMessage;
+
+    CHashSigner::PrecomputeHash(ss.GetHash(), vchSig);
+}
+
 bool CHashSigner::SignHash(const uint256& hash, const CKey &key, v_uint8& vchSigRet)
 {
     return key.SignCompact(hash, vchSigRet);
@@ -44,20 +54,38 @@ bool CHashSigner::SignHash(const uint256& hash, const CKey &key, v_uint8& vchSig
 
 bool CHashSigner::VerifyHash(const uint256& hash, const CPubKey &pubkey, const v_uint8& vchSig, std::string& strErrorRet)
 {
-    CPubKey pubkeyFromSig;
-    if (!pubkeyFromSig.RecoverCompact(hash, vchSig))
+    // public key could be already recovered by the signature verification workers
+    bool bRecovered = false;
+    CKeyID keyIDFromSig;
+    if (!gl_SigRecoveryCache.Get(hash, vchSig, bRecovered, keyIDFromSig))
+    {
+        CPubKey pubkeyFromSig;
+        bRecovered = pubkeyFromSig.RecoverCompact(hash, vchSig);
+        if (bRecovered)
+            keyIDFromSig = pubkeyFromSig.GetID();
+    }
+    if (!bRecovered)
     {
         strErrorRet = "Error recovering public key.";
         return false;
     }
 
-    if (pubkeyFromSig.GetID() != pubkey.GetID())
+    if (keyIDFromSig != pubkey.GetID())
     {
         strErrorRet = strprintf("Keys don't match: pubkey=%s, pubkeyFromSig=%s, hash=%s, vchSig=%s",
-                    pubkey.GetID().ToString(), pubkeyFromSig.GetID().ToString(), hash.ToString(),
+                    pubkey.GetID().ToString(), keyIDFromSig.ToString(), hash.ToString(),
                     EncodeBase64(&vchSig[0], vchSig.size()));
         return false;
     }
 
     return true;
 }
+
+void CHashSigner::PrecomputeHash(const uint256& hash, const v_uint8& vchSig)
+{
+    if (gl_SigRecoveryCache.Contains(hash, vchSig))
+        return;
+    CPubKey pubkeyFromSig;
+    const bool bRecovered = pubkeyFromSig.RecoverCompact(hash, vchSig);
+    gl_SigRecoveryCache.Add(hash, vchSig, bRecovered, bRecovered ? pubkeyFromSig.GetID() : CKeyID());
+}
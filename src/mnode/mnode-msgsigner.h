@@ -17,6 +17,8 @@ public:
     static bool SignMessage(const std::string &strMessage, v_uint8& vchSigRet, const CKey key);
     /// Verify the message signature, returns true if succcessful
     static bool VerifyMessage(const CPubKey pubkey, const v_uint8& vchSig, const std::string strMessage, std::string& strErrorRet);
+    /// Recover the public key from the message signature and keep it in the signature recovery cache
+    static void PrecomputeMessage(const std::string &strMessage, const v_uint8& vchSig);
 };
 
 /** Helper class for signing hashes and checking their signatures
@@ -28,4 +30,6 @@ public:
     static bool SignHash(const uint256& hash, const CKey &key, v_uint8& vchSigRet);
     /// Verify the hash signature, returns true if succcessful
     static bool VerifyHash(const uint256& hash, const CPubKey &pubkey, const v_uint8& vchSig, std::string& strErrorRet);
+    /// Recover the public key from the hash signature and keep it in the signature recovery cache
+    static void PrecomputeHash(const uint256& hash, const v_uint8& vchSig);
 };
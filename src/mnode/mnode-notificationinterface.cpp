@@ -27,6 +27,12 @@ void CACNotificationInterface::NotifyHeaderTip(const CBlockIndex *pindexNew, boo
     masterNodeCtrl.masternodeSync.NotifyHeaderTip(pindexNew, fInitialDownload);
 }
 
+void CACNotificationInterface::ChainTip(const CBlockIndex *pindex, const CBlock *pblock, SaplingMerkleTree saplingTree, bool added)
+{
+    masterNodeCtrl.masternodeTickets.ChainTip(pindex, pblock, added);
+    masterNodeCtrl.collateralCache.ChainTip(pblock, added);
+}
+
 void CACNotificationInterface::UpdatedBlockTip(const CBlockIndex *pindexNew, bool fInitialDownload)
 {
     masterNodeCtrl.masternodeSync.UpdatedBlockTip(pindexNew, fInitialDownload);
@@ -18,6 +18,10 @@ using namespace std;
 
 const string CMasternodePayments::SERIALIZATION_VERSION_STRING = "CMasternodePayments-Version-1";
 
+// mnpayments journaled flat DB record types
+constexpr char MNPAYMENTS_RECORD_VOTE = 'v';
+constexpr char MNPAYMENTS_RECORD_BLOCK_PAYEES = 'b';
+
 CAmount CMasternodePayments::GetMasternodePayment(const int nHeight, const CAmount blockValue) const noexcept
 {
     return blockValue/5; // ALWAYS 20%
@@ -78,6 +82,75 @@ void CMasternodePayments::Clear()
     LOCK2(cs_mapMasternodeBlockPayees, cs_mapMasternodePaymentVotes);
     mapMasternodeBlockPayees.clear();
     mapMasternodePaymentVotes.clear();
+    mapVoteHeightBuckets.clear();
+}
+
+/**
+ * Add payment vote hash to the height bucket.
+ * Should be called only once for the new vote, cs_mapMasternodePaymentVotes should be locked.
+ * 
+ * \param hash - payment vote hash
+ * \param nBlockHeight - vote block height
+ */
+void CMasternodePayments::AddVoteToHeightIndex(const uint256 &hash, const int nBlockHeight)
+{
+    mapVoteHeightBuckets[nBlockHeight].push_back(hash);
+}
+
+/**
+ * Rebuild payment vote height buckets from the votes map.
+ */
+void CMasternodePayments::RebuildVoteHeightIndex()
+{
+    mapVoteHeightBuckets.clear();
+    for (const auto& [hash, vote] : mapMasternodePaymentVotes)
+        AddVoteToHeightIndex(hash, vote.nBlockHeight);
+}
+
+/**
+ * Export payment votes and block payees as journaled flat DB records.
+ * 
+ * \param records - records to fill in
+ */
+void CMasternodePayments::GetFlatDBRecords(flatdb_records_t &records) const
+{
+    LOCK2(cs_mapMasternodeBlockPayees, cs_mapMasternodePaymentVotes);
+    for (const auto& [hash, vote] : mapMasternodePaymentVotes)
+        AddFlatDBRecord(records, MNPAYMENTS_RECORD_VOTE, hash, vote);
+    for (const auto& [nBlockHeight, blockPayees] : mapMasternodeBlockPayees)
+        AddFlatDBRecord(records, MNPAYMENTS_RECORD_BLOCK_PAYEES, nBlockHeight, blockPayees);
+}
+
+/**
+ * Load one journaled flat DB record.
+ * Throws exception if the record can't be deserialized.
+ * 
+ * \param sKey - record key
+ * \param sValue - serialized record value
+ */
+void CMasternodePayments::LoadFlatDBRecord(const string &sKey, const string &sValue)
+{
+    if (sKey.empty())
+        throw runtime_error("empty mnpayments record key");
+    LOCK2(cs_mapMasternodeBlockPayees, cs_mapMasternodePaymentVotes);
+    if (sKey[0] == MNPAYMENTS_RECORD_VOTE)
+    {
+        uint256 hash;
+        CMasternodePaymentVote vote;
+        ReadFlatDBRecord(sKey, sValue, hash, vote);
+        const int nBlockHeight = vote.nBlockHeight;
+        if (mapMasternodePaymentVotes.insert_or_assign(hash, move(vote)).second)
+            AddVoteToHeightIndex(hash, nBlockHeight);
+    }
+    else if (sKey[0] == MNPAYMENTS_RECORD_BLOCK_PAYEES)
+    {
+        int nBlockHeight = 0;
+        CMasternodeBlockPayees blockPayees;
+        ReadFlatDBRecord(sKey, sValue, nBlockHeight, blockPayees);
+        mapMasternodeBlockPayees[nBlockHeight] = blockPayees;
+    }
+    else
+        throw runtime_error(strprintf("unknown mnpayments record type '%c'", sKey[0]));
 }
 
 bool CMasternodePayments::CanVote(COutPoint outMasternode, int nBlockHeight)
@@ -95,7 +168,6 @@ bool CMasternodePayments::CanVote(COutPoint outMasternode, int nBlockHeight)
 
 void CMasternodePayments::ProcessMessage(node_t &pfrom, string& strCommand, CDataStream& vRecv)
 {
-    KeyIO keyIO(Params());
     if (strCommand == NetMsgType::MASTERNODEPAYMENTSYNC) { //Masternode Payments Request Sync
 
         // Ignore such requests until we are fully synced.
@@ -125,7 +197,7 @@ void CMasternodePayments::ProcessMessage(node_t &pfrom, string& strCommand, CDat
         vRecv >> vote;
 
         const uint256 nHash = vote.GetHash();
-        pfrom->setAskFor.erase(nHash);
+        pfrom->RemoveAskFor(nHash);
 
         // TODO: clear setAskFor for MSG_MASTERNODE_PAYMENT_BLOCK too
 
@@ -142,82 +214,106 @@ void CMasternodePayments::ProcessMessage(node_t &pfrom, string& strCommand, CDat
             }
 
             // Avoid processing same vote multiple times
-            mapMasternodePaymentVotes[nHash] = vote;
+            auto itVote = mapMasternodePaymentVotes.emplace(nHash, vote).first;
+            AddVoteToHeightIndex(nHash, vote.nBlockHeight);
             // but first mark vote as non-verified,
             // AddPaymentVote() below should take care of it if vote is actually ok
-            mapMasternodePaymentVotes[nHash].MarkAsNotVerified();
+            itVote->second.MarkAsNotVerified();
         }
 
-        int nFirstBlock = nCachedBlockHeight - GetStorageLimit();
-        if (vote.nBlockHeight < nFirstBlock || vote.nBlockHeight > nCachedBlockHeight+20)
-        {
-            LogFnPrint("mnpayments", "MASTERNODEPAYMENTVOTE -- vote out of range: nFirstBlock=%d, nBlockHeight=%d, nHeight=%d", nFirstBlock, vote.nBlockHeight, nCachedBlockHeight);
-            return;
-        }
+        // signature is recovered by the verification workers, votes are processed in order of arrival
+        auto pvote = make_shared<CMasternodePaymentVote>(std::move(vote));
+        masterNodeCtrl.sigVerifyQueue.Submit(
+            [pvote]() { pvote->PrecomputeSignature(); },
+            [this, pfrom, pvote]() { ProcessPaymentVote(pfrom, *pvote); });
+    }
+}
 
-        string strError;
-        if (!vote.IsValid(pfrom, nCachedBlockHeight, strError))
-        {
-            LogFnPrint("mnpayments", "MASTERNODEPAYMENTVOTE -- invalid message, error: %s", strError);
-            return;
-        }
+/**
+ * Process masternode payment vote received from the peer.
+ * Called by the masternode signature verification queue in order of vote arrival.
+ *
+ * \param pfrom - node that sent the vote
+ * \param vote - masternode payment vote
+ */
+void CMasternodePayments::ProcessPaymentVote(const node_t& pfrom, CMasternodePaymentVote& vote)
+{
+    const uint256 nHash = vote.GetHash();
+    const int nFirstBlock = nCachedBlockHeight - GetStorageLimit();
+    if (vote.nBlockHeight < nFirstBlock || vote.nBlockHeight > nCachedBlockHeight+20)
+    {
+        LogFnPrint("mnpayments", "MASTERNODEPAYMENTVOTE -- vote out of range: nFirstBlock=%d, nBlockHeight=%d, nHeight=%d", nFirstBlock, vote.nBlockHeight, nCachedBlockHeight);
+        return;
+    }
 
-        if (!CanVote(vote.vinMasternode.prevout, vote.nBlockHeight))
-        {
-            LogFnPrintf("MASTERNODEPAYMENTVOTE -- masternode already voted, masternode=%s", vote.vinMasternode.prevout.ToStringShort());
-            return;
-        }
+    string strError;
+    if (!vote.IsValid(pfrom, nCachedBlockHeight, strError))
+    {
+        LogFnPrint("mnpayments", "MASTERNODEPAYMENTVOTE -- invalid message, error: %s", strError);
+        return;
+    }
 
-        masternode_info_t mnInfo;
-        if (!masterNodeCtrl.masternodeManager.GetMasternodeInfo(true, vote.vinMasternode.prevout, mnInfo))
-        {
-            // mn was not found, so we can't check vote, some info is probably missing
-            LogFnPrintf("MASTERNODEPAYMENTVOTE -- masternode is missing %s", vote.vinMasternode.prevout.ToStringShort());
-            masterNodeCtrl.masternodeManager.AskForMN(pfrom, vote.vinMasternode.prevout);
-            return;
-        }
+    if (!CanVote(vote.vinMasternode.prevout, vote.nBlockHeight))
+    {
+        LogFnPrintf("MASTERNODEPAYMENTVOTE -- masternode already voted, masternode=%s", vote.vinMasternode.prevout.ToStringShort());
+        return;
+    }
+
+    masternode_info_t mnInfo;
+    if (!masterNodeCtrl.masternodeManager.GetMasternodeInfo(true, vote.vinMasternode.prevout, mnInfo))
+    {
+        // mn was not found, so we can't check vote, some info is probably missing
+        LogFnPrintf("MASTERNODEPAYMENTVOTE -- masternode is missing %s", vote.vinMasternode.prevout.ToStringShort());
+        masterNodeCtrl.masternodeManager.AskForMN(pfrom, vote.vinMasternode.prevout);
+        return;
+    }
 
-        int nDos = 0;
-        if (!vote.CheckSignature(mnInfo.pubKeyMasternode, nCachedBlockHeight, nDos))
+    int nDos = 0;
+    if (!vote.CheckSignature(mnInfo.pubKeyMasternode, nCachedBlockHeight, nDos))
+    {
+        if (nDos)
         {
-            if (nDos)
-            {
-                LogFnPrintf("MASTERNODEPAYMENTVOTE -- ERROR: invalid signature");
-                Misbehaving(pfrom->GetId(), nDos);
-            } else {
-                // only warn about anything non-critical (i.e. nDos == 0) in debug mode
-                LogFnPrint("mnpayments", "MASTERNODEPAYMENTVOTE -- WARNING: invalid signature");
-            }
-            // Either our info or vote info could be outdated.
-            // In case our info is outdated, ask for an update,
-            masterNodeCtrl.masternodeManager.AskForMN(pfrom, vote.vinMasternode.prevout);
-            // but there is nothing we can do if vote info itself is outdated
-            // (i.e. it was signed by a mn which changed its key),
-            // so just quit here.
-            return;
+            LogFnPrintf("MASTERNODEPAYMENTVOTE -- ERROR: invalid signature");
+            Misbehaving(pfrom->GetId(), nDos);
+        } else {
+            // only warn about anything non-critical (i.e. nDos == 0) in debug mode
+            LogFnPrint("mnpayments", "MASTERNODEPAYMENTVOTE -- WARNING: invalid signature");
         }
+        // Either our info or vote info could be outdated.
+        // In case our info is outdated, ask for an update,
+        masterNodeCtrl.masternodeManager.AskForMN(pfrom, vote.vinMasternode.prevout);
+        // but there is nothing we can do if vote info itself is outdated
+        // (i.e. it was signed by a mn which changed its key),
+        // so just quit here.
+        return;
+    }
 
-        CTxDestination dest;
-        ExtractDestination(vote.payee, dest);
-        string address = keyIO.EncodeDestination(dest);
+    KeyIO keyIO(Params());
+    CTxDestination dest;
+    ExtractDestination(vote.payee, dest);
+    string address = keyIO.EncodeDestination(dest);
 
-        LogFnPrint("mnpayments", "MASTERNODEPAYMENTVOTE -- vote: address=%s, nBlockHeight=%d, nHeight=%d, prevout=%s, hash=%s new",
-                    address, vote.nBlockHeight, nCachedBlockHeight, vote.vinMasternode.prevout.ToStringShort(), nHash.ToString());
+    LogFnPrint("mnpayments", "MASTERNODEPAYMENTVOTE -- vote: address=%s, nBlockHeight=%d, nHeight=%d, prevout=%s, hash=%s new",
+                address, vote.nBlockHeight, nCachedBlockHeight, vote.vinMasternode.prevout.ToStringShort(), nHash.ToString());
 
-        if (AddPaymentVote(vote))
-        {
-            vote.Relay();
-            masterNodeCtrl.masternodeSync.BumpAssetLastTime("MASTERNODEPAYMENTVOTE");
-        }
+    if (AddPaymentVote(vote))
+    {
+        vote.Relay();
+        masterNodeCtrl.masternodeSync.BumpAssetLastTime("MASTERNODEPAYMENTVOTE");
     }
 }
 
+string CMasternodePaymentVote::getMessage() const noexcept
+{
+    return vinMasternode.prevout.ToStringShort() +
+        to_string(nBlockHeight) +
+        ScriptToAsmStr(payee);
+}
+
 bool CMasternodePaymentVote::Sign()
 {
     string strError;
-    string strMessage = vinMasternode.prevout.ToStringShort() +
-                to_string(nBlockHeight) +
-                ScriptToAsmStr(payee);
+    const string strMessage = getMessage();
 
     if (!CMessageSigner::SignMessage(strMessage, vchSig, masterNodeCtrl.activeMasternode.keyMasternode))
     {
@@ -275,13 +371,13 @@ bool CMasternodePayments::AddPaymentVote(const CMasternodePaymentVote& vote)
 
     LOCK2(cs_mapMasternodeBlockPayees, cs_mapMasternodePaymentVotes);
 
-    mapMasternodePaymentVotes[vote.GetHash()] = vote;
-    if (!mapMasternodeBlockPayees.count(vote.nBlockHeight))
-    {
-       CMasternodeBlockPayees blockPayees(vote.nBlockHeight);
-       mapMasternodeBlockPayees[vote.nBlockHeight] = blockPayees;
-    }
-    mapMasternodeBlockPayees[vote.nBlockHeight].AddPayee(vote);
+    const uint256 hash = vote.GetHash();
+    if (mapMasternodePaymentVotes.insert_or_assign(hash, vote).second)
+        AddVoteToHeightIndex(hash, vote.nBlockHeight);
+    auto itBlock = mapMasternodeBlockPayees.find(vote.nBlockHeight);
+    if (itBlock == mapMasternodeBlockPayees.end())
+        itBlock = mapMasternodeBlockPayees.emplace(vote.nBlockHeight, CMasternodeBlockPayees(vote.nBlockHeight)).first;
+    itBlock->second.AddPayee(vote);
     return true;
 }
 
@@ -476,8 +572,9 @@ bool CMasternodePayments::IsTransactionValid(const CTransaction& txNew, int nBlo
 {
     LOCK(cs_mapMasternodeBlockPayees);
 
-    if (mapMasternodeBlockPayees.count(nBlockHeight))
-        return mapMasternodeBlockPayees[nBlockHeight].IsTransactionValid(txNew);
+    const auto it = mapMasternodeBlockPayees.find(nBlockHeight);
+    if (it != mapMasternodeBlockPayees.cend())
+        return it->second.IsTransactionValid(txNew);
     
     LogFnPrint("mnpayments", "no winner MN for block - %d", nBlockHeight);
     return true;
@@ -490,19 +587,26 @@ void CMasternodePayments::CheckAndRemove()
 
     LOCK2(cs_mapMasternodeBlockPayees, cs_mapMasternodePaymentVotes);
 
-    const int nLimit = GetStorageLimit();
+    // keep votes and payment blocks for the last GetStorageLimit() blocks
+    const int nMinBlockHeight = nCachedBlockHeight - GetStorageLimit();
 
-    auto it = mapMasternodePaymentVotes.begin();
-    while (it != mapMasternodePaymentVotes.end())
+    // expire whole height buckets - the cost does not depend on the total number of votes
+    const auto itBucketEnd = mapVoteHeightBuckets.lower_bound(nMinBlockHeight);
+    for (auto it = mapVoteHeightBuckets.cbegin(); it != itBucketEnd; ++it)
     {
-        CMasternodePaymentVote vote = it->second;
+        LogFnPrint("mnpayments", "Removing %zu old Masternode payment votes: nBlockHeight=%d", it->second.size(), it->first);
+        for (const auto& hash : it->second)
+            mapMasternodePaymentVotes.erase(hash);
+    }
+    mapVoteHeightBuckets.erase(mapVoteHeightBuckets.cbegin(), itBucketEnd);
+    mapMasternodeBlockPayees.erase(mapMasternodeBlockPayees.cbegin(), mapMasternodeBlockPayees.lower_bound(nMinBlockHeight));
 
-        if (nCachedBlockHeight - vote.nBlockHeight > nLimit)
-        {
-            LogFnPrint("mnpayments", "Removing old Masternode payment: nBlockHeight=%d", vote.nBlockHeight);
-            it = mapMasternodePaymentVotes.erase(it);
-            mapMasternodeBlockPayees.erase(vote.nBlockHeight);
-        } else
+    // last votes older than storage limit can't block new votes
+    for (auto it = mapMasternodesLastVote.begin(); it != mapMasternodesLastVote.end(); )
+    {
+        if (it->second < nMinBlockHeight)
+            it = mapMasternodesLastVote.erase(it);
+        else
             ++it;
     }
     LogFnPrintf("%s", ToString());
@@ -793,10 +897,7 @@ bool CMasternodePaymentVote::CheckSignature(const CPubKey& pubKeyMasternode, int
     // do not ban by default
     nDos = 0;
 
-    string strMessage = vinMasternode.prevout.ToStringShort() +
-                to_string(nBlockHeight) +
-                ScriptToAsmStr(payee);
-
+    const string strMessage = getMessage();
     string strError;
     if (!CMessageSigner::VerifyMessage(pubKeyMasternode, vchSig, strMessage, strError))
     {
@@ -811,6 +912,12 @@ bool CMasternodePaymentVote::CheckSignature(const CPubKey& pubKeyMasternode, int
     return true;
 }
 
+void CMasternodePaymentVote::PrecomputeSignature() const
+{
+    if (!vchSig.empty())
+        CMessageSigner::PrecomputeMessage(getMessage(), vchSig);
+}
+
 string CMasternodePaymentVote::ToString() const
 {
     ostringstream info;
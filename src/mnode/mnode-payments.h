@@ -5,8 +5,10 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #include <main.h>
+#include <mnode/mnode-db.h>
 #include <mnode/mnode-masternode.h>
 
 class CMasternodePaymentVote;
@@ -139,8 +141,12 @@ public:
         return ss.GetHash();
     }
 
+    // get vote message to sign
+    std::string getMessage() const noexcept;
     bool Sign();
     bool CheckSignature(const CPubKey& pubKeyMasternode, int nValidationHeight, int &nDos);
+    // recover public key from the vote signature into the signature recovery cache
+    void PrecomputeSignature() const;
 
     bool IsValid(const node_t& pnode, int nValidationHeight, std::string& strError) const;
     void Relay();
@@ -151,6 +157,9 @@ public:
     std::string ToString() const;
 };
 
+// masternode payment votes by vote hash
+using payment_votes_map_t = std::unordered_map<uint256, CMasternodePaymentVote, BlockHasher>;
+
 /**
  * This class manages all Masternode payments.
  */
@@ -160,7 +169,7 @@ public:
     static const std::string SERIALIZATION_VERSION_STRING;
 
     // map of masternode payment votes
-    std::map<uint256, CMasternodePaymentVote> mapMasternodePaymentVotes;
+    payment_votes_map_t mapMasternodePaymentVotes;
     // map of masternode payment blocks
     std::map<int, CMasternodeBlockPayees> mapMasternodeBlockPayees;
 
@@ -225,10 +234,17 @@ public:
             READWRITE(mapMasternodePaymentVotes);
             READWRITE(mapMasternodeBlockPayees);
         }
+        if (bRead)
+            RebuildVoteHeightIndex();
     }
 
     void Clear();
 
+    // export payment votes and block payees as journaled flat DB records
+    void GetFlatDBRecords(flatdb_records_t &records) const;
+    // load one journaled flat DB record
+    void LoadFlatDBRecord(const std::string &sKey, const std::string &sValue);
+
     bool AddPaymentVote(const CMasternodePaymentVote& vote);
     bool HasVerifiedPaymentVote(const uint256 &hashIn) const noexcept;
     bool ProcessBlock(int nBlockHeight);
@@ -248,12 +264,15 @@ public:
     bool CanVote(COutPoint outMasternode, int nBlockHeight);
 
     void ProcessMessage(node_t &pfrom, std::string& strCommand, CDataStream& vRecv);
+    void ProcessPaymentVote(const node_t& pfrom, CMasternodePaymentVote& vote);
     std::string GetRequiredPaymentsString(int nBlockHeight);
     void FillMasterNodePayment(CMutableTransaction& txNew, int nBlockHeight, CAmount blockReward, CTxOut& txoutMasternodeRet);
     std::string ToString() const;
 
     size_t GetBlockCount() const noexcept { return mapMasternodeBlockPayees.size(); }
     size_t GetVoteCount() const noexcept { return mapMasternodePaymentVotes.size(); }
+    // number of block heights with payment votes
+    size_t GetVoteHeightCount() const noexcept { return mapVoteHeightBuckets.size(); }
 
     bool IsEnoughData();
     int GetStorageLimit();
@@ -273,5 +292,12 @@ protected:
 
     // Keep track of current block height
     int nCachedBlockHeight;
+
+    // payment vote hashes bucketed by block height (protected by cs_mapMasternodePaymentVotes),
+    // used to expire old votes without scanning all of them
+    std::map<int, v_uint256> mapVoteHeightBuckets;
+
+    void AddVoteToHeightIndex(const uint256 &hash, const int nBlockHeight);
+    void RebuildVoteHeightIndex();
 };
 
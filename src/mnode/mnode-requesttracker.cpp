@@ -11,6 +11,9 @@
 
 using namespace std;
 
+// netfulfilled journaled flat DB record types
+constexpr char MN_REQUEST_TRACKER_RECORD_ADDR = 'a';
+
 void CMasternodeRequestTracker::AddFulfilledRequest(CAddress addr, string strRequest)
 {
     LOCK(cs_mapFulfilledRequests);
@@ -77,6 +80,24 @@ void CMasternodeRequestTracker::Clear()
     mapFulfilledRequests.clear();
 }
 
+void CMasternodeRequestTracker::GetFlatDBRecords(flatdb_records_t &records) const
+{
+    LOCK(cs_mapFulfilledRequests);
+    for (const auto& [addr, mapEntry] : mapFulfilledRequests)
+        AddFlatDBRecord(records, MN_REQUEST_TRACKER_RECORD_ADDR, addr, mapEntry);
+}
+
+void CMasternodeRequestTracker::LoadFlatDBRecord(const string &sKey, const string &sValue)
+{
+    if (sKey.empty() || (sKey[0] != MN_REQUEST_TRACKER_RECORD_ADDR))
+        throw runtime_error("unknown netfulfilled record type");
+    CNetAddr addr;
+    fulfilledreqmapentry_t mapEntry;
+    ReadFlatDBRecord(sKey, sValue, addr, mapEntry);
+    LOCK(cs_mapFulfilledRequests);
+    mapFulfilledRequests[addr] = move(mapEntry);
+}
+
 string CMasternodeRequestTracker::ToString() const
 {
     ostringstream info;
@@ -4,6 +4,7 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 #include <protocol.h>
+#include <mnode/mnode-db.h>
 
 constexpr auto MN_REQUEST_TRACKER_FILENAME = "netfulfilled.dat";
 constexpr auto MN_REQUEST_TRACKER_MAGIC_CACHE_STR = "magicFulfilledCache";
@@ -18,7 +19,7 @@ private:
 
     //keep track of what node has/was asked for and when
     fulfilledreqmap_t mapFulfilledRequests;
-    CCriticalSection cs_mapFulfilledRequests;
+    mutable CCriticalSection cs_mapFulfilledRequests;
 
 public:
     CMasternodeRequestTracker() {}
@@ -40,5 +41,10 @@ public:
     void CheckAndRemove();
     void Clear();
 
+    // export fulfilled requests as journaled flat DB records (one per address)
+    void GetFlatDBRecords(flatdb_records_t &records) const;
+    // load one journaled flat DB record
+    void LoadFlatDBRecord(const std::string &sKey, const std::string &sValue);
+
     std::string ToString() const;
 };
@@ -0,0 +1,165 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <algorithm>
+
+#include <mnode/mnode-score.h>
+
+using namespace std;
+
+/**
+ * Masternode score ordering: higher score first, equal scores are ordered by vin desc.
+ */
+bool CMasternodeScoreEngine::isScoreGreater(const mn_score_t &s1, const mn_score_t &s2) noexcept
+{
+    if (s1.nScore != s2.nScore)
+        return s1.nScore > s2.nScore;
+    return s2.pmn->get_vin() < s1.pmn->get_vin();
+}
+
+void CMasternodeScoreEngine::Invalidate() noexcept
+{
+    m_mapBlockScores.clear();
+}
+
+/**
+ * Get cached masternode scores for the block or calculate them.
+ * Cached scores are checked against the current masternode list: if masternode list size
+ * or masternode collateral hash changed - scores are recalculated.
+ * 
+ * \param mapMasternodes - current masternode list
+ * \param blockHash - block hash to calculate scores for
+ * \return masternode scores for the block
+ */
+CMasternodeScoreEngine::block_scores_t& CMasternodeScoreEngine::getBlockScores(const masternode_map_t &mapMasternodes,
+    const uint256 &blockHash)
+{
+    auto it = m_mapBlockScores.find(blockHash);
+    if (it != m_mapBlockScores.end())
+    {
+        auto &blockScores = it->second;
+        bool bValid = blockScores.vScores.size() == mapMasternodes.size();
+        for (auto &score : blockScores.vScores)
+        {
+            if (!bValid)
+                break;
+            bValid = score.pmn->GetCollateralMinConfBlockHash() == score.collateralMinConfBlockHash;
+        }
+        if (bValid)
+        {
+            blockScores.nLastUsed = ++m_nUseCounter;
+            return blockScores;
+        }
+        m_mapBlockScores.erase(it);
+    }
+
+    // evict least recently used block
+    if (m_nMaxCachedBlocks && (m_mapBlockScores.size() >= m_nMaxCachedBlocks))
+    {
+        auto itLRU = min_element(m_mapBlockScores.begin(), m_mapBlockScores.end(),
+            [](const auto &a, const auto &b) { return a.second.nLastUsed < b.second.nLastUsed; });
+        m_mapBlockScores.erase(itLRU);
+    }
+
+    block_scores_t blockScores;
+    blockScores.vScores.reserve(mapMasternodes.size());
+    for (const auto& [outpoint, pmn] : mapMasternodes)
+    {
+        if (!pmn)
+            continue;
+        mn_score_t score;
+        score.nScore = pmn->CalculateScore(blockHash);
+        score.collateralMinConfBlockHash = pmn->GetCollateralMinConfBlockHash();
+        score.pmn = pmn;
+        blockScores.vScores.emplace_back(std::move(score));
+    }
+    blockScores.nLastUsed = ++m_nUseCounter;
+    return m_mapBlockScores.emplace(blockHash, std::move(blockScores)).first->second;
+}
+
+/**
+ * Make sure that at least nCount top scores are sorted.
+ * 
+ * \param blockScores - block masternode scores
+ * \param nCount - number of top scores to sort
+ */
+void CMasternodeScoreEngine::sortTop(block_scores_t &blockScores, const size_t nCount)
+{
+    auto &v = blockScores.vScores;
+    const size_t nSortCount = min(nCount, v.size());
+    if (nSortCount <= blockScores.nSorted)
+        return;
+    // all entries after nSorted have lower scores than the sorted part
+    if (nSortCount == v.size())
+        sort(v.begin() + blockScores.nSorted, v.end(), isScoreGreater);
+    else
+        partial_sort(v.begin() + blockScores.nSorted, v.begin() + nSortCount, v.end(), isScoreGreater);
+    blockScores.nSorted = nSortCount;
+}
+
+/**
+ * Get top masternode scores for the block.
+ * 
+ * \param mapMasternodes - current masternode list
+ * \param blockHash - block hash
+ * \param nMinProtocol - min masternode protocol version
+ * \param nMaxCount - max number of top scores to return, 0 - return all
+ * \param vScores - returns masternode scores ordered by score desc
+ * \return total number of masternodes that support nMinProtocol
+ */
+size_t CMasternodeScoreEngine::GetTopScores(const masternode_map_t &mapMasternodes, const uint256 &blockHash,
+    const int nMinProtocol, const size_t nMaxCount, score_pair_vec_t &vScores)
+{
+    vScores.clear();
+    auto &blockScores = getBlockScores(mapMasternodes, blockHash);
+    const auto &v = blockScores.vScores;
+    const size_t nTotal = count_if(v.cbegin(), v.cend(),
+        [nMinProtocol](const mn_score_t &score) { return score.pmn->nProtocolVersion >= nMinProtocol; });
+    const size_t nCount = nMaxCount ? min(nMaxCount, nTotal) : nTotal;
+    vScores.reserve(nCount);
+    // sort more entries if some of the top masternodes do not support nMinProtocol
+    size_t nSortCount = nCount;
+    size_t nIndex = 0;
+    while (vScores.size() < nCount)
+    {
+        sortTop(blockScores, nSortCount);
+        for (; (nIndex < blockScores.nSorted) && (vScores.size() < nCount); ++nIndex)
+        {
+            const auto &score = v[nIndex];
+            if (score.pmn->nProtocolVersion >= nMinProtocol)
+                vScores.emplace_back(score.nScore, score.pmn);
+        }
+        if (blockScores.nSorted == v.size())
+            break;
+        nSortCount = max(nSortCount * 2, blockScores.nSorted + 1);
+    }
+    return nTotal;
+}
+
+/**
+ * Get masternode rank for the block.
+ * Rank is calculated without sorting: 1 + number of masternodes with higher score.
+ * 
+ * \param mapMasternodes - current masternode list
+ * \param blockHash - block hash
+ * \param outpoint - masternode collateral outpoint
+ * \param nMinProtocol - min masternode protocol version
+ * \return masternode rank (1-based) or 0 if masternode was not found
+ */
+int CMasternodeScoreEngine::GetRank(const masternode_map_t &mapMasternodes, const uint256 &blockHash,
+    const COutPoint &outpoint, const int nMinProtocol)
+{
+    auto &blockScores = getBlockScores(mapMasternodes, blockHash);
+    const auto &v = blockScores.vScores;
+    const auto itMN = find_if(v.cbegin(), v.cend(),
+        [&outpoint](const mn_score_t &score) { return score.pmn->getOutPoint() == outpoint; });
+    if ((itMN == v.cend()) || (itMN->pmn->nProtocolVersion < nMinProtocol))
+        return 0;
+    int nRank = 1;
+    for (const auto &score : v)
+    {
+        if ((score.pmn->nProtocolVersion >= nMinProtocol) && isScoreGreater(score, *itMN))
+            ++nRank;
+    }
+    return nRank;
+}
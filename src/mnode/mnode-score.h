@@ -0,0 +1,68 @@
+#pragma once
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include <utils/uint256.h>
+#include <utils/arith_uint256.h>
+#include <mnode/mnode-masternode.h>
+
+// max number of blocks with cached masternode scores
+constexpr size_t MAX_MN_SCORE_CACHED_BLOCKS = 20;
+
+/**
+ * Masternode score engine.
+ * Calculates masternode scores for the given block and keeps them in a per-block cache,
+ * so multiple rank queries for the same block (payments, governance, RPC) do not recalculate
+ * scores. Scores are sorted lazily - only the requested top part of the list is sorted.
+ * Should be accessed under CMasternodeMan::cs_mnMgr lock.
+ */
+class CMasternodeScoreEngine
+{
+public:
+    using score_pair_t = std::pair<arith_uint256, masternode_t>;
+    using score_pair_vec_t = std::vector<score_pair_t>;
+    using masternode_map_t = std::map<COutPoint, masternode_t>;
+
+    CMasternodeScoreEngine(const size_t nMaxCachedBlocks = MAX_MN_SCORE_CACHED_BLOCKS) noexcept :
+        m_nMaxCachedBlocks(nMaxCachedBlocks)
+    {}
+
+    // get top masternode scores (ordered by score desc) for the block, nMaxCount=0 - get all
+    size_t GetTopScores(const masternode_map_t &mapMasternodes, const uint256 &blockHash, const int nMinProtocol,
+        const size_t nMaxCount, score_pair_vec_t &vScores);
+    // get masternode rank for the block (1-based), 0 if masternode not found
+    int GetRank(const masternode_map_t &mapMasternodes, const uint256 &blockHash, const COutPoint &outpoint,
+        const int nMinProtocol);
+    // invalidate all cached scores, should be called on masternode list change
+    void Invalidate() noexcept;
+    // number of blocks with cached scores
+    size_t GetCachedBlockCount() const noexcept { return m_mapBlockScores.size(); }
+
+protected:
+    typedef struct _mn_score_t
+    {
+        arith_uint256 nScore;
+        masternode_t pmn;
+        uint256 collateralMinConfBlockHash; // collateral hash used to calculate score
+    } mn_score_t;
+
+    typedef struct _block_scores_t
+    {
+        std::vector<mn_score_t> vScores; // scores for all masternodes
+        size_t nSorted = 0;              // number of entries at the beginning of vScores in the final order
+        uint64_t nLastUsed = 0;          // LRU counter
+    } block_scores_t;
+
+    size_t m_nMaxCachedBlocks;
+    uint64_t m_nUseCounter = 0;
+    // block hash -> masternode scores
+    std::unordered_map<uint256, block_scores_t> m_mapBlockScores;
+
+    block_scores_t& getBlockScores(const masternode_map_t &mapMasternodes, const uint256 &blockHash);
+    static void sortTop(block_scores_t &blockScores, const size_t nCount);
+    static bool isScoreGreater(const mn_score_t &s1, const mn_score_t &s2) noexcept;
+};
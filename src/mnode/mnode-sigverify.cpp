@@ -0,0 +1,314 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <utils/hash.h>
+#include <utils/util.h>
+#include <mnode/mnode-sigverify.h>
+
+using namespace std;
+
+CSigRecoveryCache gl_SigRecoveryCache;
+
+uint256 CSigRecoveryCache::GetCacheKey(const uint256 &hash, const v_uint8 &vchSig)
+{
+    CHashWriter ss(SER_GETHASH, 0);
+    ss << hash;
+    ss << vchSig;
+    return ss.GetHash();
+}
+
+/**
+ * Add public key recovery result to the cache.
+ *
+ * \param hash - signed message hash
+ * \param vchSig - compact signature
+ * \param bRecovered - true if public key was successfully recovered from the signature
+ * \param keyID - id of the recovered public key
+ */
+void CSigRecoveryCache::Add(const uint256 &hash, const v_uint8 &vchSig, const bool bRecovered, const CKeyID &keyID)
+{
+    if (!m_nMaxSize)
+        return;
+    const uint256 key = GetCacheKey(hash, vchSig);
+    unique_lock lock(m_Mutex);
+    const auto result = m_mapRecovered.emplace(key, recovery_result_t{ bRecovered, keyID });
+    if (!result.second)
+        return;
+    m_EvictionQueue.push_back(key);
+    while (m_EvictionQueue.size() > m_nMaxSize)
+    {
+        m_mapRecovered.erase(m_EvictionQueue.front());
+        m_EvictionQueue.pop_front();
+    }
+}
+
+/**
+ * Get public key recovery result from the cache.
+ *
+ * \param hash - signed message hash
+ * \param vchSig - compact signature
+ * \param bRecovered - returns true if public key was successfully recovered from the signature
+ * \param keyID - returns id of the recovered public key
+ * \return true if the recovery result was found in the cache
+ */
+bool CSigRecoveryCache::Get(const uint256 &hash, const v_uint8 &vchSig, bool &bRecovered, CKeyID &keyID) const
+{
+    const uint256 key = GetCacheKey(hash, vchSig);
+    unique_lock lock(m_Mutex);
+    const auto it = m_mapRecovered.find(key);
+    if (it == m_mapRecovered.cend())
+        return false;
+    bRecovered = it->second.bRecovered;
+    keyID = it->second.keyID;
+    return true;
+}
+
+bool CSigRecoveryCache::Contains(const uint256 &hash, const v_uint8 &vchSig) const
+{
+    const uint256 key = GetCacheKey(hash, vchSig);
+    unique_lock lock(m_Mutex);
+    return m_mapRecovered.count(key) > 0;
+}
+
+size_t CSigRecoveryCache::size() const noexcept
+{
+    unique_lock lock(m_Mutex);
+    return m_mapRecovered.size();
+}
+
+void CSigRecoveryCache::clear() noexcept
+{
+    unique_lock lock(m_Mutex);
+    m_mapRecovered.clear();
+    m_EvictionQueue.clear();
+}
+
+CMasternodeSigVerifyQueue::CMasternodeSigVerifyQueue(const size_t nMaxQueueSize) noexcept :
+    m_nMaxQueueSize(nMaxQueueSize),
+    m_nReserved(0),
+    m_bRejected(false),
+    m_nThreadCount(DEFAULT_MN_SIGVERIFY_THREADS),
+    m_nWorkers(0),
+    m_bApplying(false),
+    m_bStopRequested(false)
+{}
+
+void CMasternodeSigVerifyQueue::SetThreadCount(const int64_t nThreadCount)
+{
+    if (nThreadCount <= 0)
+        m_nThreadCount = GetNumCores();
+    else
+        m_nThreadCount = static_cast<size_t>(nThreadCount);
+    if (m_nThreadCount > MAX_MN_SIGVERIFY_THREADS)
+        m_nThreadCount = MAX_MN_SIGVERIFY_THREADS;
+}
+
+/**
+ * Create masternode signature verification workers.
+ *
+ * \param threadGroup - add workers to this thread group
+ */
+void CMasternodeSigVerifyQueue::create_workers(CServiceThreadGroup &threadGroup)
+{
+    if (!m_nThreadCount)
+    {
+        LogPrintf("Masternode signature verification queue is disabled\n");
+        return;
+    }
+    LogPrintf("Using %zu threads for masternode signature verification\n", m_nThreadCount);
+    string sThreadName, error;
+    for (size_t i = 0; i < m_nThreadCount; ++i)
+    {
+        sThreadName = strprintf("mn-sig%d", i + 1);
+        threadGroup.add_thread(error, make_shared<CMasternodeSigVerifyWorker>(this, sThreadName.c_str()), true);
+    }
+}
+
+void CMasternodeSigVerifyQueue::Execute(const sigverify_func_t &fn, const char *szStage)
+{
+    try
+    {
+        fn();
+    } catch (const exception &e) {
+        LogFnPrintf("ERROR: exception in %s stage: %s", szStage, e.what());
+    } catch (...) {
+        LogFnPrintf("ERROR: unknown exception in %s stage", szStage);
+    }
+}
+
+/**
+ * Submit masternode message for the signature verification.
+ * Does not block - message is rejected if the queue is full.
+ * Space reserved by TryReserve() is always available to the reservation owner.
+ *
+ * \param fnVerify - signature verification function (called by the worker without locks)
+ * \param fnApply - message processing function (called in submission order)
+ * \return false if the queue is full and the message was not accepted
+ */
+bool CMasternodeSigVerifyQueue::Submit(sigverify_func_t &&fnVerify, sigverify_func_t &&fnApply)
+{
+    unique_lock lock(m_Mutex);
+    if (!m_nWorkers || m_bStopRequested)
+    {
+        // no workers - process message inline
+        lock.unlock();
+        Execute(fnVerify, "verify");
+        Execute(fnApply, "apply");
+        return true;
+    }
+    if (m_ApplyQueue.size() >= m_nMaxQueueSize)
+    {
+        m_bRejected = true;
+        lock.unlock();
+        LogFnPrint("masternode", "masternode signature verification queue is full, message rejected");
+        return false;
+    }
+    auto pJob = make_shared<sigverify_job_t>();
+    pJob->fnVerify = std::move(fnVerify);
+    pJob->fnApply = std::move(fnApply);
+    m_VerifyQueue.push_back(pJob);
+    m_ApplyQueue.push_back(std::move(pJob));
+    m_condWorker.notify_one();
+    return true;
+}
+
+/**
+ * Reserve the queue space for one message.
+ * Reserved space is taken into account by the next reservations,
+ * so all reservation owners can submit their message.
+ *
+ * \return false if the queue is full, resume handler is called when the space is available
+ */
+bool CMasternodeSigVerifyQueue::TryReserve()
+{
+    unique_lock lock(m_Mutex);
+    if (m_nWorkers && !m_bStopRequested && (m_ApplyQueue.size() + m_nReserved >= m_nMaxQueueSize))
+    {
+        m_bRejected = true;
+        return false;
+    }
+    ++m_nReserved;
+    return true;
+}
+
+void CMasternodeSigVerifyQueue::ReleaseReservation()
+{
+    unique_lock lock(m_Mutex);
+    if (m_nReserved)
+        --m_nReserved;
+    NotifyResume(lock);
+}
+
+/**
+ * Call resume handler if the message or reservation was rejected
+ * and the queue is at most half full now.
+ *
+ * \param lock - locked queue mutex, unlocked while the handler is called
+ */
+void CMasternodeSigVerifyQueue::NotifyResume(unique_lock<mutex> &lock)
+{
+    if (!m_bRejected)
+        return;
+    if (m_nWorkers && !m_bStopRequested && (m_ApplyQueue.size() + m_nReserved > m_nMaxQueueSize / 2))
+        return;
+    m_bRejected = false;
+    if (!m_fnResume)
+        return;
+    const auto fnResume = m_fnResume;
+    lock.unlock();
+    fnResume();
+    lock.lock();
+}
+
+void CMasternodeSigVerifyQueue::WaitForEmpty()
+{
+    unique_lock lock(m_Mutex);
+    m_condSubmit.wait(lock, [this]() { return !m_nWorkers || (m_ApplyQueue.empty() && !m_bApplying); });
+}
+
+size_t CMasternodeSigVerifyQueue::size() const
+{
+    unique_lock lock(m_Mutex);
+    return m_ApplyQueue.size();
+}
+
+size_t CMasternodeSigVerifyQueue::GetWorkerCount() const
+{
+    unique_lock lock(m_Mutex);
+    return m_nWorkers;
+}
+
+/**
+ * Apply verified messages from the head of the queue.
+ * Only one worker at a time applies messages, so they are processed in submission order.
+ *
+ * \param lock - locked queue mutex
+ */
+void CMasternodeSigVerifyQueue::ApplyVerified(unique_lock<mutex> &lock)
+{
+    if (m_bApplying)
+        return;
+    m_bApplying = true;
+    while (!m_bStopRequested && !m_ApplyQueue.empty() && m_ApplyQueue.front()->bVerified)
+    {
+        auto pJob = std::move(m_ApplyQueue.front());
+        m_ApplyQueue.pop_front();
+        lock.unlock();
+        Execute(pJob->fnApply, "apply");
+        lock.lock();
+        NotifyResume(lock);
+    }
+    m_bApplying = false;
+    m_condSubmit.notify_all();
+}
+
+void CMasternodeSigVerifyQueue::Worker(const CServiceThread *pThread)
+{
+    unique_lock lock(m_Mutex);
+    ++m_nWorkers;
+    while (true)
+    {
+        m_condWorker.wait(lock, [&]() { return m_bStopRequested || pThread->shouldStop() || !m_VerifyQueue.empty(); });
+        if (m_bStopRequested || pThread->shouldStop())
+            break;
+        auto pJob = m_VerifyQueue.front();
+        m_VerifyQueue.pop_front();
+        lock.unlock();
+        Execute(pJob->fnVerify, "verify");
+        lock.lock();
+        pJob->bVerified = true;
+        ApplyVerified(lock);
+    }
+    if (--m_nWorkers == 0)
+    {
+        // messages not applied yet are dropped on shutdown
+        if (!m_ApplyQueue.empty())
+            LogFnPrintf("%zu masternode messages were not processed", m_ApplyQueue.size());
+        m_VerifyQueue.clear();
+        m_ApplyQueue.clear();
+        NotifyResume(lock);
+    }
+    m_condSubmit.notify_all();
+}
+
+void CMasternodeSigVerifyQueue::stop()
+{
+    unique_lock lock(m_Mutex);
+    m_bStopRequested = true;
+    m_condWorker.notify_all();
+    m_condSubmit.notify_all();
+    NotifyResume(lock);
+}
+
+void CMasternodeSigVerifyWorker::execute()
+{
+    if (m_pQueue)
+        m_pQueue->Worker(this);
+}
+
+void CMasternodeSigVerifyWorker::stop() noexcept
+{
+    CServiceThread::stop();
+    if (m_pQueue)
+        m_pQueue->stop();
+}
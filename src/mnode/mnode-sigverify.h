@@ -0,0 +1,159 @@
+#pragma once
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+
+#include <utils/uint256.h>
+#include <utils/vector_types.h>
+#include <utils/svc_thread.h>
+#include <pubkey.h>
+#include <main.h>
+
+/** -mnsigthreads default (number of masternode signature verification threads, 0 = auto) */
+constexpr size_t DEFAULT_MN_SIGVERIFY_THREADS = 0;
+/** Maximum number of masternode signature verification threads allowed */
+constexpr size_t MAX_MN_SIGVERIFY_THREADS = 8;
+/** Max number of messages waiting in the masternode signature verification queue */
+constexpr size_t MN_SIGVERIFY_QUEUE_MAX_SIZE = 10'000;
+/** Max number of recovered public keys kept in the signature recovery cache */
+constexpr size_t MN_SIG_RECOVERY_CACHE_MAX_SIZE = 50'000;
+
+/**
+ * Cache of the public keys recovered from the compact signatures.
+ * Key is a hash of the (message hash, signature) pair, value - recovered key id.
+ * Failed recoveries are cached as well, so the invalid signature is not recovered twice.
+ * Oldest entries are evicted first when the cache is full.
+ */
+class CSigRecoveryCache
+{
+public:
+    CSigRecoveryCache(const size_t nMaxSize = MN_SIG_RECOVERY_CACHE_MAX_SIZE) noexcept :
+        m_nMaxSize(nMaxSize)
+    {}
+
+    void Add(const uint256 &hash, const v_uint8 &vchSig, const bool bRecovered, const CKeyID &keyID);
+    bool Get(const uint256 &hash, const v_uint8 &vchSig, bool &bRecovered, CKeyID &keyID) const;
+    bool Contains(const uint256 &hash, const v_uint8 &vchSig) const;
+    size_t size() const noexcept;
+    void clear() noexcept;
+
+private:
+    typedef struct _recovery_result_t
+    {
+        bool bRecovered;
+        CKeyID keyID;
+    } recovery_result_t;
+
+    mutable std::mutex m_Mutex;
+    size_t m_nMaxSize;
+    std::unordered_map<uint256, recovery_result_t, BlockHasher> m_mapRecovered;
+    std::deque<uint256> m_EvictionQueue;
+
+    static uint256 GetCacheKey(const uint256 &hash, const v_uint8 &vchSig);
+};
+
+extern CSigRecoveryCache gl_SigRecoveryCache;
+
+using sigverify_func_t = std::function<void()>;
+using sigverify_resume_func_t = std::function<void()>;
+
+/**
+ * Queue for the masternode messages (mnp, mnb, payment & governance votes) signature verification.
+ * Each message is submitted as a pair of functions:
+ *   - fnVerify - called by one of the worker threads in parallel with other messages,
+ *                should not take any locks - only recover public keys from the message signatures
+ *                (see CMessageSigner::PrecomputeMessage), results are stored in the gl_SigRecoveryCache;
+ *   - fnApply  - called strictly in the submission order after fnVerify is done,
+ *                processes the message the usual way - signature checks are served from the cache,
+ *                so DoS scoring stays exactly the same as for the inline processing.
+ * If there are no worker threads - both functions are called inline by Submit().
+ * Submit() never blocks - message is rejected if the queue is full. Callers that should not
+ * lose messages reserve the queue space with TryReserve() before taking the message
+ * for processing and keep it queued while the reservation fails; resume handler is called
+ * when the queue has free space again.
+ */
+class CMasternodeSigVerifyQueue
+{
+public:
+    CMasternodeSigVerifyQueue(const size_t nMaxQueueSize = MN_SIGVERIFY_QUEUE_MAX_SIZE) noexcept;
+
+    void SetThreadCount(const int64_t nThreadCount);
+    size_t GetThreadCount() const noexcept { return m_nThreadCount; }
+    // number of running signature verification workers
+    size_t GetWorkerCount() const;
+
+    // create signature verification workers
+    void create_workers(CServiceThreadGroup &threadGroup);
+
+    // returns false if the queue is full, message is not processed in this case
+    bool Submit(sigverify_func_t &&fnVerify, sigverify_func_t &&fnApply);
+    // reserve the queue space for one message, returns false if the queue is full
+    bool TryReserve();
+    // release the space reserved by TryReserve() after the message was submitted or skipped
+    void ReleaseReservation();
+    // set function called when the queue has free space after the message or reservation was rejected
+    void SetResumeHandler(sigverify_resume_func_t &&fnResume) { m_fnResume = std::move(fnResume); }
+    // wait until all submitted messages are applied
+    void WaitForEmpty();
+    size_t size() const;
+
+    // worker thread loop
+    void Worker(const CServiceThread *pThread);
+    void stop();
+
+protected:
+    typedef struct _sigverify_job_t
+    {
+        sigverify_func_t fnVerify;
+        sigverify_func_t fnApply;
+        bool bVerified = false;
+    } sigverify_job_t;
+    using sigverify_job_ptr_t = std::shared_ptr<sigverify_job_t>;
+
+    mutable std::mutex m_Mutex;
+    // workers wait for new messages to verify
+    std::condition_variable m_condWorker;
+    // WaitForEmpty() waits for the empty queue
+    std::condition_variable m_condSubmit;
+    // messages waiting for signature verification
+    std::deque<sigverify_job_ptr_t> m_VerifyQueue;
+    // all messages not applied yet, in submission order
+    std::deque<sigverify_job_ptr_t> m_ApplyQueue;
+    size_t m_nMaxQueueSize;
+    // number of messages the queue space is reserved for
+    size_t m_nReserved;
+    // true if the message or reservation was rejected since the queue was full
+    bool m_bRejected;
+    sigverify_resume_func_t m_fnResume;
+    size_t m_nThreadCount;
+    // number of running workers
+    size_t m_nWorkers;
+    // true if one of the workers is applying verified messages
+    bool m_bApplying;
+    bool m_bStopRequested;
+
+    void ApplyVerified(std::unique_lock<std::mutex> &lock);
+    void NotifyResume(std::unique_lock<std::mutex> &lock);
+    static void Execute(const sigverify_func_t &fn, const char *szStage);
+};
+
+class CMasternodeSigVerifyWorker : public CServiceThread
+{
+public:
+    CMasternodeSigVerifyWorker(CMasternodeSigVerifyQueue *pQueue, const char *szThreadName) :
+        CServiceThread(szThreadName),
+        m_pQueue(pQueue)
+    {}
+
+    void execute() override;
+    void stop() noexcept override;
+
+private:
+    CMasternodeSigVerifyQueue *m_pQueue;
+};
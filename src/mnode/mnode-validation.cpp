@@ -36,6 +36,193 @@ bool GetUTXOCoin(const COutPoint& outpoint, CCoins& coins)
     return true;
 }
 
+/**
+ * Get masternode collateral coin.
+ * Reads coin from the coins tip (locks cs_main) in case it's not found in the cache.
+ * 
+ * \param outpoint - collateral outpoint
+ * \param nValueRet - returns collateral amount
+ * \param nHeightRet - returns height of the block with collateral transaction
+ * \return false if collateral UTXO is not found
+ */
+bool CMasternodeCollateralCache::GetCoin(const COutPoint& outpoint, CAmount& nValueRet, int& nHeightRet)
+{
+    uint64_t nGeneration = 0;
+    {
+        unique_lock lock(m_Mutex);
+        const auto it = m_mapCoins.find(outpoint);
+        if (it != m_mapCoins.cend())
+        {
+            nValueRet = it->second.nValue;
+            nHeightRet = it->second.nHeight;
+            return true;
+        }
+        nGeneration = m_nGeneration;
+    }
+    collateral_coin_t coin;
+    if (!ReadCoin(outpoint, coin))
+        return false;
+    {
+        unique_lock lock(m_Mutex);
+        // do not cache the coin if it could be spent while we were reading it
+        if (nGeneration == m_nGeneration)
+            AddCoin(outpoint, coin);
+    }
+    nValueRet = coin.nValue;
+    nHeightRet = coin.nHeight;
+    return true;
+}
+
+bool CMasternodeCollateralCache::ReadCoin(const COutPoint& outpoint, collateral_coin_t& coin) const
+{
+    CCoins coins;
+    if (!GetUTXOCoin(outpoint, coins))
+        return false;
+    coin.nValue = coins.vout[outpoint.n].nValue;
+    coin.nHeight = coins.nHeight;
+    return true;
+}
+
+bool CMasternodeCollateralCache::IsCached(const COutPoint& outpoint) const
+{
+    unique_lock lock(m_Mutex);
+    return m_mapCoins.count(outpoint) > 0;
+}
+
+/**
+ * Read all collaterals missing in the cache under one cs_main lock.
+ * 
+ * \param vOutpoints - collateral outpoints
+ */
+void CMasternodeCollateralCache::Prefetch(const vector<COutPoint>& vOutpoints)
+{
+    vector<COutPoint> vMissing;
+    {
+        unique_lock lock(m_Mutex);
+        for (const auto& outpoint : vOutpoints)
+        {
+            if (!m_mapCoins.count(outpoint))
+                vMissing.push_back(outpoint);
+        }
+    }
+    if (vMissing.empty())
+        return;
+
+    // cache invalidation is called under cs_main, so the coins can't be spent while we hold it
+    LOCK(cs_main);
+    collateral_coin_t coin;
+    for (const auto& outpoint : vMissing)
+    {
+        if (ReadCoin(outpoint, coin))
+            Add(outpoint, coin.nValue, coin.nHeight);
+    }
+}
+
+void CMasternodeCollateralCache::SetCollateralAmount(const CAmount nCollateralAmount)
+{
+    unique_lock lock(m_Mutex);
+    if (m_nCollateralAmount == nCollateralAmount)
+        return;
+    m_nCollateralAmount = nCollateralAmount;
+    m_mapCoins.clear();
+}
+
+/**
+ * Add collateral coin to the cache.
+ * 
+ * \param outpoint - collateral outpoint
+ * \param nValue - coin amount
+ * \param nHeight - height of the block with collateral transaction
+ * eturn false if the coin was not cached (amount is not the collateral amount or cache is full)
+ */
+bool CMasternodeCollateralCache::Add(const COutPoint& outpoint, const CAmount nValue, const int nHeight)
+{
+    unique_lock lock(m_Mutex);
+    return AddCoin(outpoint, collateral_coin_t{ nValue, nHeight });
+}
+
+bool CMasternodeCollateralCache::AddCoin(const COutPoint& outpoint, const collateral_coin_t& coin)
+{
+    // coins with other amounts are not valid collaterals, so they are never cached
+    if (coin.nValue != m_nCollateralAmount)
+        return false;
+    auto it = m_mapCoins.find(outpoint);
+    if (it != m_mapCoins.end())
+    {
+        it->second = coin;
+        return true;
+    }
+    if (m_mapCoins.size() >= m_nMaxSize)
+        return false;
+    m_mapCoins.emplace(outpoint, coin);
+    return true;
+}
+
+/**
+ * Remove cached collaterals that are not used by the masternodes.
+ * 
+ * \param vOutpoints - sorted collateral outpoints of the masternodes
+ */
+void CMasternodeCollateralCache::Retain(const vector<COutPoint>& vOutpoints)
+{
+    unique_lock lock(m_Mutex);
+    auto itOutpoint = vOutpoints.cbegin();
+    auto it = m_mapCoins.begin();
+    while (it != m_mapCoins.end())
+    {
+        while (itOutpoint != vOutpoints.cend() && *itOutpoint < it->first)
+            ++itOutpoint;
+        if (itOutpoint != vOutpoints.cend() && *itOutpoint == it->first)
+            ++it;
+        else
+            it = m_mapCoins.erase(it);
+    }
+}
+
+/**
+ * Invalidate cached collaterals spent by the connected block or created by the disconnected block.
+ * Called under cs_main.
+ * 
+ * \param pBlock - connected or disconnected block
+ * \param bAdded - true if block was connected, false if disconnected
+ */
+void CMasternodeCollateralCache::ChainTip(const CBlock* pBlock, const bool bAdded)
+{
+    if (!pBlock)
+        return;
+    unique_lock lock(m_Mutex);
+    ++m_nGeneration;
+    if (m_mapCoins.empty())
+        return;
+    for (const auto& tx : pBlock->vtx)
+    {
+        if (bAdded)
+        {
+            for (const auto& txin : tx.vin)
+                m_mapCoins.erase(txin.prevout);
+            continue;
+        }
+        // all outputs of the disconnected transaction are not in UTXO set anymore
+        const uint256 txid = tx.GetHash();
+        auto it = m_mapCoins.lower_bound(COutPoint(txid, 0));
+        while (it != m_mapCoins.end() && it->first.hash == txid)
+            it = m_mapCoins.erase(it);
+    }
+}
+
+size_t CMasternodeCollateralCache::size() const
+{
+    unique_lock lock(m_Mutex);
+    return m_mapCoins.size();
+}
+
+void CMasternodeCollateralCache::clear()
+{
+    unique_lock lock(m_Mutex);
+    m_mapCoins.clear();
+    ++m_nGeneration;
+}
+
 int GetUTXOHeight(const COutPoint& outpoint)
 {
     // -1 means UTXO is yet unknown or already spent
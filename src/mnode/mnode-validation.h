@@ -3,15 +3,65 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 #include <string>
+#include <map>
+#include <mutex>
 
 #include <main.h>
 #include <wallet/wallet.h>
+#include <mnode/mnode-consts.h>
 
 bool GetBlockHash(uint256& hashRet, int nBlockHeight);
 bool GetUTXOCoin(const COutPoint& outpoint, CCoins& coins);
 int GetUTXOHeight(const COutPoint& outpoint);
 int GetUTXOConfirmations(const COutPoint& outpoint);
 
+/**
+ * Cache of the masternode collateral UTXOs (amount and height) keyed by outpoint.
+ * Only unspent coins with the collateral amount are cached, cache size is limited by nMaxSize.
+ * Cached entry is invalidated when:
+ *   - block that spends the collateral is connected;
+ *   - block that created the collateral is disconnected;
+ *   - masternode with this collateral is removed from the masternode list (Retain).
+ * Cache misses are read from the coins tip, batches of misses are read under one cs_main lock.
+ */
+class CMasternodeCollateralCache
+{
+public:
+    CMasternodeCollateralCache(const size_t nMaxSize = MAX_MN_COLLATERAL_CACHE_SIZE) noexcept :
+        m_nMaxSize(nMaxSize),
+        m_nCollateralAmount(0),
+        m_nGeneration(0)
+    {}
+
+    // set masternode collateral amount, only coins with this amount are cached
+    void SetCollateralAmount(const CAmount nCollateralAmount);
+    bool GetCoin(const COutPoint& outpoint, CAmount& nValueRet, int& nHeightRet);
+    bool IsCached(const COutPoint& outpoint) const;
+    void Prefetch(const std::vector<COutPoint>& vOutpoints);
+    bool Add(const COutPoint& outpoint, const CAmount nValue, const int nHeight);
+    void Retain(const std::vector<COutPoint>& vOutpoints);
+    void ChainTip(const CBlock* pBlock, const bool bAdded);
+    size_t size() const;
+    void clear();
+
+private:
+    typedef struct _collateral_coin_t
+    {
+        CAmount nValue;
+        int nHeight;
+    } collateral_coin_t;
+
+    mutable std::mutex m_Mutex;
+    std::map<COutPoint, collateral_coin_t> m_mapCoins;
+    size_t m_nMaxSize;
+    CAmount m_nCollateralAmount;
+    // incremented on each invalidation, protects from caching the coin read before invalidation
+    uint64_t m_nGeneration;
+
+    bool ReadCoin(const COutPoint& outpoint, collateral_coin_t& coin) const;
+    bool AddCoin(const COutPoint& outpoint, const collateral_coin_t& coin);
+};
+
 void FillOtherBlockPayments(CMutableTransaction& txNew, int nBlockHeight, CAmount blockReward, CTxOut& txoutMasternodeRet, CTxOut& txoutGovernanceRet);
 
 #ifdef ENABLE_WALLET
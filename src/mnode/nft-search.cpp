@@ -0,0 +1,235 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <array>
+
+#include <utils/str_utils.h>
+#include <utils/tinyformat.h>
+#include <utils/utilstrencodings.h>
+#include <mnode/tickets/nft-reg.h>
+#include <mnode/nft-search.h>
+
+using namespace std;
+using json = nlohmann::json;
+
+// app ticket properties stored in the NFT search attributes record (used by fuzzy search)
+static const array<const char*, 5> NFT_SEARCH_ATTR_PROPS =
+{
+    "creator_name",
+    "nft_title",
+    "nft_series_name",
+    "nft_keyword_set",
+    "creator_written_statement"
+};
+
+bool IsNFTSearchAttrProperty(const string &sPropName) noexcept
+{
+    for (const auto szPropName : NFT_SEARCH_ATTR_PROPS)
+    {
+        if (sPropName == szPropName)
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Decode base64-encoded NFT ticket and parse ascii85-encoded app ticket json.
+ *
+ * \param sNFTTicket - base64-encoded NFT ticket
+ * \param jApp - returns parsed app ticket json (empty if NFT ticket has no app ticket)
+ * \param error - returns error message if failed
+ * \return true if NFT ticket was successfully parsed
+ */
+bool ParseNFTAppTicket(const string &sNFTTicket, json &jApp, string &error) noexcept
+{
+    jApp.clear();
+    try
+    {
+        bool bInvalid = false;
+        // NFT ticket data are base64 encoded
+        string sData = DecodeBase64(sNFTTicket, &bInvalid);
+        if (bInvalid)
+        {
+            error = "failed to decode base64 encoded NFT ticket";
+            return false;
+        }
+        const json j = json::parse(sData);
+        if (!j.contains(NFT_TICKET_APP_OBJ))
+            return true;
+        const json& jAppTicketBase85 = j[NFT_TICKET_APP_OBJ];
+        if (!jAppTicketBase85.is_string())
+            return true;
+        sData = DecodeAscii85(jAppTicketBase85.get<string>(), &bInvalid);
+        if (bInvalid)
+        {
+            error = "failed to decode ascii85 encoded NFT app ticket";
+            return false;
+        }
+        jApp = json::parse(sData);
+    } catch (const exception& ex)
+    {
+        error = strprintf("failed to parse NFT ticket json. %s", SAFE_SZ(ex.what()));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Fill NFT search attributes from the parsed app ticket json.
+ *
+ * \param nTotalCopies - number of NFT copies
+ * \param jApp - parsed app ticket json
+ * \param attr - NFT search attributes
+ * \param error - returns error message if failed
+ * \return true if search attributes were successfully created
+ */
+bool BuildNFTSearchAttributes(const uint32_t nTotalCopies, const json &jApp, nft_search_attr_t &attr,
+    string &error) noexcept
+{
+    attr = nft_search_attr_t();
+    attr.nTotalCopies = nTotalCopies;
+    if (!jApp.is_object())
+        return true;
+    try
+    {
+        if (jApp.contains("rareness_score"))
+        {
+            attr.bHasRarenessScore = true;
+            jApp["rareness_score"].get_to(attr.nRarenessScore);
+        }
+        if (jApp.contains("nsfw_score"))
+        {
+            attr.bHasNsfwScore = true;
+            jApp["nsfw_score"].get_to(attr.nNsfwScore);
+        }
+        if (jApp.contains("thumbnail_hash") && jApp["thumbnail_hash"].is_string())
+        {
+            attr.bHasThumbnailHash = true;
+            jApp["thumbnail_hash"].get_to(attr.sThumbnailHash);
+        }
+        for (const auto szPropName : NFT_SEARCH_ATTR_PROPS)
+        {
+            if (!jApp.contains(szPropName))
+                continue;
+            const json& jProp = jApp[szPropName];
+            nft_search_prop_t prop;
+            if (jProp.is_string())
+            {
+                prop.type = NFT_SEARCH_PROP_TYPE::String;
+                jProp.get_to(prop.sValue);
+                lowercase(prop.sValue);
+            } else if (jProp.is_boolean())
+            {
+                prop.type = NFT_SEARCH_PROP_TYPE::Bool;
+                prop.sValue = jProp.get<bool>() ? "1" : "0";
+            } else if (jProp.is_number())
+            {
+                prop.type = NFT_SEARCH_PROP_TYPE::Number;
+                prop.sValue = to_string(jProp);
+            }
+            attr.mapProps.emplace(szPropName, std::move(prop));
+        }
+    } catch (const exception& ex)
+    {
+        error = strprintf("failed to get NFT search attributes from app ticket. %s", SAFE_SZ(ex.what()));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Check if search property value passes fuzzy search filter.
+ * Same rules as in isValuePassFuzzyFilter are applied.
+ *
+ * \param prop - search property value
+ * \param sLowercasedFilterValue - lowercased filter value
+ * \return true if value passes the filter
+ */
+bool IsNFTSearchPropPassFuzzyFilter(const nft_search_prop_t &prop, const string &sLowercasedFilterValue) noexcept
+{
+    switch (prop.type)
+    {
+        case NFT_SEARCH_PROP_TYPE::String:
+            // case insensitive substring search
+            return prop.sValue.find(sLowercasedFilterValue) != string::npos;
+
+        case NFT_SEARCH_PROP_TYPE::Bool:
+        {
+            bool bValue = false;
+            // filter value should be convertible to bool
+            if (!str_tobool(sLowercasedFilterValue, bValue))
+                return false;
+            return (prop.sValue == "1") == bValue;
+        }
+
+        case NFT_SEARCH_PROP_TYPE::Number:
+            return prop.sValue == sLowercasedFilterValue;
+
+        default:
+            break;
+    }
+    return false;
+}
+
+/**
+ * Get unique n-gram tokens of the lowercased string value.
+ * Every string that contains the value as a substring has all these tokens.
+ * 
+ * \param sLowercasedValue - lowercased string value
+ * \return set of n-gram tokens, empty if value is shorter than n-gram size
+ */
+s_strings GetNFTKeywordNGramTokens(const string &sLowercasedValue)
+{
+    s_strings tokens;
+    if (sLowercasedValue.size() < NFT_KEYWORD_NGRAM_SIZE)
+        return tokens;
+    string sToken;
+    for (size_t i = 0; i + NFT_KEYWORD_NGRAM_SIZE <= sLowercasedValue.size(); ++i)
+    {
+        sToken = NFT_KEYWORD_TOKEN_NGRAM;
+        sToken.append(sLowercasedValue, i, NFT_KEYWORD_NGRAM_SIZE);
+        tokens.insert(sToken);
+    }
+    return tokens;
+}
+
+/**
+ * Get NFT keyword index tokens for all fuzzy search properties.
+ * Properties not defined in the app ticket get "missing" token - fuzzy search
+ * skips filters for such properties.
+ * 
+ * \param attr - NFT search attributes
+ * \param mapTokens - returns map of property name -> index tokens
+ */
+void GetNFTKeywordIndexTokens(const nft_search_attr_t &attr, map<string, s_strings> &mapTokens)
+{
+    mapTokens.clear();
+    for (const auto szPropName : NFT_SEARCH_ATTR_PROPS)
+    {
+        const auto it = attr.mapProps.find(szPropName);
+        if (it == attr.mapProps.cend())
+        {
+            mapTokens[szPropName].emplace(1, NFT_KEYWORD_TOKEN_MISSING);
+            continue;
+        }
+        const auto &prop = it->second;
+        switch (prop.type)
+        {
+            case NFT_SEARCH_PROP_TYPE::String:
+                mapTokens.emplace(szPropName, GetNFTKeywordNGramTokens(prop.sValue));
+                break;
+
+            case NFT_SEARCH_PROP_TYPE::Bool:
+                mapTokens[szPropName].emplace(NFT_KEYWORD_TOKEN_BOOL + prop.sValue);
+                break;
+
+            case NFT_SEARCH_PROP_TYPE::Number:
+                mapTokens[szPropName].emplace(NFT_KEYWORD_TOKEN_NUMBER + prop.sValue);
+                break;
+
+            default:
+                // property never passes fuzzy filter
+                break;
+        }
+    }
+}
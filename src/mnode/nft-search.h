@@ -0,0 +1,137 @@
+#pragma once
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <map>
+#include <string>
+
+#include <extlibs/json.hpp>
+#include <utils/serialize.h>
+#include <utils/enum_util.h>
+#include <utils/set_types.h>
+
+// NFT search property value type
+enum class NFT_SEARCH_PROP_TYPE : uint8_t
+{
+    String = 0, // lowercased string
+    Bool = 1,   // "1" or "0"
+    Number = 2, // number converted to string
+    Other = 3   // property type that is not supported by fuzzy search
+};
+
+// NFT search property value
+typedef struct _nft_search_prop_t
+{
+    NFT_SEARCH_PROP_TYPE type = NFT_SEARCH_PROP_TYPE::Other;
+    std::string sValue;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        uint8_t nType = to_integral_type(type);
+        READWRITE(nType);
+        if (ser_action == SERIALIZE_ACTION::Read)
+            type = static_cast<NFT_SEARCH_PROP_TYPE>(nType);
+        READWRITE(sValue);
+    }
+} nft_search_prop_t;
+
+/**
+ * NFT search attributes record: NFT registration ticket txid -> search attributes.
+ * Precomputed from the NFT registration ticket and its app ticket, so NFT search
+ * does not need to read, decode and parse NFT registration ticket.
+ */
+typedef struct _nft_search_attr_t
+{
+    static constexpr uint8_t CURRENT_VERSION = 1;
+
+    uint8_t nVersion = CURRENT_VERSION;
+    uint32_t nTotalCopies = 0;
+    bool bHasRarenessScore = false;
+    uint32_t nRarenessScore = 0;
+    bool bHasNsfwScore = false;
+    uint32_t nNsfwScore = 0;
+    bool bHasThumbnailHash = false;
+    std::string sThumbnailHash;
+    // fuzzy search properties: app ticket property name -> value
+    std::map<std::string, nft_search_prop_t> mapProps;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        READWRITE(nVersion);
+        READWRITE(nTotalCopies);
+        READWRITE(bHasRarenessScore);
+        READWRITE(nRarenessScore);
+        READWRITE(bHasNsfwScore);
+        READWRITE(nNsfwScore);
+        READWRITE(bHasThumbnailHash);
+        READWRITE(sThumbnailHash);
+        READWRITE(mapProps);
+    }
+} nft_search_attr_t;
+
+// NFT search fuzzy filter
+typedef struct _nft_fuzzy_filter_t
+{
+    std::string sPropName;              // app ticket property name
+    std::string sFilterValue;           // filter value
+    std::string sLowercasedFilterValue; // lowercased filter value
+    bool bHasSearchAttr = false;        // property value is stored in NFT search attributes
+} nft_fuzzy_filter_t;
+
+// length of the n-grams used by NFT keyword index for string properties
+constexpr size_t NFT_KEYWORD_NGRAM_SIZE = 3;
+
+// NFT keyword index token kinds (first char of the token)
+constexpr char NFT_KEYWORD_TOKEN_NGRAM = 's';   // n-gram of the string property value
+constexpr char NFT_KEYWORD_TOKEN_NUMBER = 'n';  // number property value
+constexpr char NFT_KEYWORD_TOKEN_BOOL = 'b';    // bool property value
+constexpr char NFT_KEYWORD_TOKEN_MISSING = 'm'; // property is not defined in the app ticket
+
+/**
+ * NFT keyword index key: <property name><token><NFT registration ticket txid>.
+ * All records for the same property name and token are stored together,
+ * so the list of NFTs for the token can be read with one DB seek.
+ */
+typedef struct _nft_keyword_index_key_t
+{
+    std::string sPropName; // app ticket property name
+    std::string sToken;    // index token (see NFT_KEYWORD_TOKEN_* for token kinds)
+    std::string sRegTxId;  // NFT registration ticket txid
+
+    _nft_keyword_index_key_t() noexcept = default;
+    _nft_keyword_index_key_t(const std::string &sProp, const std::string &sTokenValue, const std::string &sTxId) :
+        sPropName(sProp),
+        sToken(sTokenValue),
+        sRegTxId(sTxId)
+    {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        READWRITE(sPropName);
+        READWRITE(sToken);
+        READWRITE(sRegTxId);
+    }
+} nft_keyword_index_key_t;
+
+// check if app ticket property name is stored in the NFT search attributes record
+bool IsNFTSearchAttrProperty(const std::string &sPropName) noexcept;
+// decode base64-encoded NFT ticket and parse app ticket json
+bool ParseNFTAppTicket(const std::string &sNFTTicket, nlohmann::json &jApp, std::string &error) noexcept;
+// fill NFT search attributes from the parsed app ticket json
+bool BuildNFTSearchAttributes(const uint32_t nTotalCopies, const nlohmann::json &jApp, nft_search_attr_t &attr,
+    std::string &error) noexcept;
+// check if search property value passes fuzzy filter (filter value should be lowercased)
+bool IsNFTSearchPropPassFuzzyFilter(const nft_search_prop_t &prop, const std::string &sLowercasedFilterValue) noexcept;
+// get all NFT keyword index tokens for the NFT search attributes: property name -> tokens
+void GetNFTKeywordIndexTokens(const nft_search_attr_t &attr, std::map<std::string, s_strings> &mapTokens);
+// get unique n-gram tokens of the lowercased string value
+s_strings GetNFTKeywordNGramTokens(const std::string &sLowercasedValue);
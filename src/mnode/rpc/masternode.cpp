@@ -1068,15 +1068,30 @@ As json rpc:
     return retVal;
 }
 
+// default number of messages returned by "masternode message list-to"
+constexpr size_t MN_MESSAGE_LIST_DEFAULT_LIMIT = 100;
+
+static size_t get_message_page_param(const UniValue& params, const size_t nParam, const size_t nDefault, const char *szParamName)
+{
+    if (params.size() <= nParam)
+        return nDefault;
+    const int64_t nValue = get_long_number(params[nParam]);
+    if (nValue < 0)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Invalid '%s' parameter, should be non-negative", szParamName));
+    return static_cast<size_t>(nValue);
+}
+
 UniValue masternode_message(const UniValue& params, const bool fHelp, KeyIO &keyIO)
 {
-    RPC_CMD_PARSER2(MSG, params, sign, send, print, list);
+    RPC_CMD_PARSER2(MSG, params, sign, send, print, list, list__to);
 
-    if (fHelp || (params.size() < 2 || params.size() > 4) || !MSG.IsCmdSupported())
+    if (fHelp || (params.size() < 2 || params.size() > 6) || !MSG.IsCmdSupported())
         throw JSONRPCError(RPC_INVALID_PARAMETER,
 R"(Correct usage is:
     masternode message send <mnPubKey> <message> - Send <message> to masternode identified by the <mnPubKey>
-    masternode message list - List received <messages>
+    masternode message list [offset] [limit] - List received <messages> ordered by message time
+    masternode message list-to <txid> <index> [offset] [limit] - List seen <messages> to masternode identified by the collateral outpoint,
+        returns up to 100 messages by default
     masternode message print <messageID> - Print received <message> by <messageID>
     masternode message sign <message> <x> - Sign <message> using masternodes key
         if x is presented and not 0 - it will also returns the public key
@@ -1103,16 +1118,48 @@ R"(Correct usage is:
             if (!masterNodeCtrl.IsMasterNode())
                 throw JSONRPCError(RPC_INTERNAL_ERROR, "This is not a masternode - only Masternode can send/receive/sign messages");
 
+            const size_t nOffset = get_message_page_param(params, 2, 0, "offset");
+            const size_t nLimit = get_message_page_param(params, 3, 0, "limit");
             UniValue arr(UniValue::VARR);
-            for (const auto& [msgHash, msg] : masterNodeCtrl.masternodeMessages.mapOurMessages)
-            {
-                UniValue obj(UniValue::VOBJ);
-                obj.pushKV(msgHash.ToString(), messageToJson(msg));
-                arr.push_back(std::move(obj));
-            }
+            masterNodeCtrl.masternodeMessages.ForEachOurMessage(nOffset, nLimit,
+                [&](const uint256& msgHash, const CMasternodeMessage& msg)
+                {
+                    UniValue obj(UniValue::VOBJ);
+                    obj.pushKV(msgHash.ToString(), messageToJson(msg));
+                    arr.push_back(std::move(obj));
+                });
             return arr;
         } break;
 
+        case RPC_CMD_MSG::list__to: {
+            if (params.size() < 4)
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Masternode collateral outpoint <txid> <index> is required");
+            string error;
+            uint256 collateral_txid;
+            if (!parse_uint256(error, collateral_txid, params[2].get_str(), "MasterNode collateral txid"))
+                throw JSONRPCError(RPC_INVALID_PARAMETER, 
+                    strprintf("Invalid 'txid' parameter. %s", error.c_str()));
+            const int nTxIndex = get_number(params[3]);
+            if (nTxIndex < 0)
+                throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid outpoint index parameter");
+            const size_t nOffset = get_message_page_param(params, 4, 0, "offset");
+            const size_t nLimit = get_message_page_param(params, 5, MN_MESSAGE_LIST_DEFAULT_LIMIT, "limit");
+
+            UniValue arr(UniValue::VARR);
+            const size_t nTotal = masterNodeCtrl.masternodeMessages.ForEachMessageTo(COutPoint(collateral_txid, nTxIndex), nOffset, nLimit,
+                [&](const uint256& msgHash, const CMasternodeMessage& msg)
+                {
+                    UniValue obj(UniValue::VOBJ);
+                    obj.pushKV(msgHash.ToString(), messageToJson(msg));
+                    arr.push_back(std::move(obj));
+                });
+            UniValue retVal(UniValue::VOBJ);
+            retVal.pushKV("total", static_cast<uint64_t>(nTotal));
+            retVal.pushKV("offset", static_cast<uint64_t>(nOffset));
+            retVal.pushKV("messages", std::move(arr));
+            return retVal;
+        } break;
+
         case RPC_CMD_MSG::print:
             if (!masterNodeCtrl.IsMasterNode())
                 throw JSONRPCError(RPC_INTERNAL_ERROR, "This is not a masternode - only Masternode can send/receive/sign messages");
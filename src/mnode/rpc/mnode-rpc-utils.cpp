@@ -22,3 +22,16 @@ UniValue GenerateSendTicketResult(tuple<string, string> &&resultIDs)
 
     return result;
 }
+
+/**
+ * Create UniValue that holds already serialized json (object or array).
+ * Value has VRAW type and is written by UniValue::write as is, so json data
+ * is not parsed and copied into the UniValue DOM. Should be used only for the rpc results.
+ * 
+ * \param sJSON - serialized json
+ * \return univalue that can be returned as rpc result
+ */
+UniValue GetRawJSONValue(string &&sJSON)
+{
+    return UniValue(UniValue::VRAW, std::move(sJSON));
+}
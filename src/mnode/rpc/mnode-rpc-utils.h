@@ -4,13 +4,17 @@
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 #include <tuple>
 #include <string>
+#include <vector>
 
 #include <univalue.h>
 
 UniValue GenerateSendTicketResult(std::tuple<std::string, std::string>&& resultIDs);
+// create UniValue that holds already serialized json
+UniValue GetRawJSONValue(std::string &&sJSON);
 
 /**
  * Generate json array by the list of tickets.
+ * Tickets json is not parsed, array is returned as a raw json value.
  * 
  * \param vTickets - list of tickets
  * \return json array
@@ -20,13 +24,13 @@ UniValue getJSONforTickets(const std::vector<_TicketType> &vTickets)
 {
     if (vTickets.empty())
         return NullUniValue;
-	UniValue tArray(UniValue::VARR);
-    tArray.reserve(vTickets.size());
+    std::string sJSON("[");
     for (const auto& tkt : vTickets)
     {
-		UniValue obj(UniValue::VOBJ);
-		obj.read(tkt.ToJSON());
-		tArray.push_back(obj);
-	}
-	return tArray;
+        if (sJSON.size() > 1)
+            sJSON += ',';
+        sJSON += tkt.ToJSON();
+    }
+    sJSON += ']';
+    return GetRawJSONValue(std::move(sJSON));
 }
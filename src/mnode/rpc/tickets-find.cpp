@@ -20,9 +20,7 @@ static UniValue getTickets(const string& key, T2 key2 = "", Lambda otherFunc = n
     {
         uint32_t block = CPastelTicketProcessor::GetTicketBlockHeightInActiveChain(uint256S(ticket.GetTxId()));
         ticket.SetBlock(block);
-        UniValue obj(UniValue::VOBJ);
-        obj.read(ticket.ToJSON());
-        return obj;
+        return GetRawJSONValue(ticket.ToJSON());
     }
     auto vTickets = T::FindAllTicketByMVKey(key);
     if (vTickets.empty() && otherFunc)
@@ -104,11 +102,7 @@ As json rpc
     case RPC_CMD_FIND::id: {
         CPastelIDRegTicket ticket;
         if (CPastelIDRegTicket::FindTicketInDb(key, ticket))
-        {
-            UniValue obj(UniValue::VOBJ);
-            obj.read(ticket.ToJSON());
-            return obj;
-        }
+            return GetRawJSONValue(ticket.ToJSON());
     } break;
 
     case RPC_CMD_FIND::nft:
@@ -214,11 +208,7 @@ As json rpc
     {
 		CContractTicket ticket;
         if (CContractTicket::FindTicketInDb(key, ticket))
-        {
-			UniValue obj(UniValue::VOBJ);
-			obj.read(ticket.ToJSON());
-			return obj;
-		}
+            return GetRawJSONValue(ticket.ToJSON());
         // if it is not primary or secondary keys, then it could be ticket sub type
         ContractTickets_t vTickets = masterNodeCtrl.masternodeTickets.FindTicketsByMVKey<CContractTicket>(key);
         UniValue tArray = getJSONforTickets<CContractTicket>(vTickets);
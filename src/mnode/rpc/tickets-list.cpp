@@ -8,6 +8,7 @@
 #include <mnode/tickets/tickets-all.h>
 #include <mnode/mnode-controller.h>
 #include <mnode/rpc/tickets-list.h>
+#include <mnode/rpc/mnode-rpc-utils.h>
 
 using namespace std;
 
@@ -19,10 +20,11 @@ UniValue tickets_list(const UniValue& params)
         sell, offer, buy, accept, trade, transfer,
         down, royalty, username, ethereumaddress, 
         action, action__act, contract);
-    if ((params.size() < 2 || params.size() > 4) || !LIST.IsCmdSupported())
+    if ((params.size() < 2 || params.size() > 7) || !LIST.IsCmdSupported())
         throw JSONRPCError(RPC_INVALID_PARAMETER,
-R"(tickets list "type" ("filter") ("minheight")
-List all tickets of the specific type registered in the system
+R"(tickets list "type" ("filter") ("minheight") ("start") ("count")
+List all tickets of the specific type registered in the system.
+Tickets are returned in the order of block height they were registered at.
 
 Available types:
   id      - List PastelID registration tickets. Without filter parameter lists ALL (both masternode and personal) Pastel IDs.
@@ -94,10 +96,17 @@ Available types:
 
 Arguments:
 1. minheight	 - (optional) minimum height for returned tickets (only tickets registered after this height will be returned).
+2. start         - (optional) number of matching tickets to skip, default is 0.
+3. count         - (optional) max number of tickets to return, default is 0 (no limit).
+                   For offer, accept and transfer tickets start and count parameters should follow
+                   "filter" "pastelID" "minheight" parameters (pastelID can be empty).
 
 Example: List ALL Pastel ID tickets:
 )" + HelpExampleCli("tickets list id", "") +
 R"(
+Example: List first 100 NFT tickets registered after block 100000:
+)" + HelpExampleCli("tickets list nft all 100000 0 100", "") +
+R"(
 As json rpc
 )" + HelpExampleRpc("tickets", R"("list", "id")"));
 
@@ -118,6 +127,22 @@ As json rpc
     if (params.size() > 3 && !bSpecialParsingLogic)
         minheight = get_number(params[3]);
 
+    // paging parameters follow minheight
+    ticket_list_page_t page;
+    const size_t nPageParamIndex = bSpecialParsingLogic ? 5 : 4;
+    if (params.size() > nPageParamIndex)
+    {
+        const int64_t nStart = get_long_number(params[nPageParamIndex]);
+        rpc_check_unsigned_param<uint32_t>("start", nStart);
+        page.nStart = static_cast<size_t>(nStart);
+    }
+    if (params.size() > nPageParamIndex + 1)
+    {
+        const int64_t nCount = get_long_number(params[nPageParamIndex + 1]);
+        rpc_check_unsigned_param<uint32_t>("count", nCount);
+        page.nCount = static_cast<size_t>(nCount);
+    }
+
     // limit minheight for testnet for NFT, Action, Collection & Offer/Accept/Transfer tickets
     if (Params().IsTestNet() && !minheight && 
         is_enum_any_of(LIST.cmd(), 
@@ -135,54 +160,55 @@ As json rpc
             RPC_CMD_LIST::trade))
         minheight = TESTNET_CUTOFF_MINHEIGHT;
 
-    UniValue obj(UniValue::VARR);
+    // tickets json array is passed to the rpc reply as is
+    string sJSON;
     switch (LIST.cmd())
     {
     case RPC_CMD_LIST::id: {
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListTickets<CPastelIDRegTicket>(minheight));
+            sJSON = masterNodeCtrl.masternodeTickets.ListTickets<CPastelIDRegTicket>(minheight, page);
         else if (filter == "mn")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterPastelIDTickets(minheight, 1));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterPastelIDTickets(minheight, 1, nullptr, page);
         else if (filter == "personal")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterPastelIDTickets(minheight, 2));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterPastelIDTickets(minheight, 2, nullptr, page);
         else if (filter == "mine") {
             const auto mapIDs = CPastelID::GetStoredPastelIDs(true);
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterPastelIDTickets(minheight, 3, &mapIDs));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterPastelIDTickets(minheight, 3, &mapIDs, page);
         }
     } break;
 
     case RPC_CMD_LIST::nft: {
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListTickets<CNFTRegTicket>(minheight));
+            sJSON = masterNodeCtrl.masternodeTickets.ListTickets<CNFTRegTicket>(minheight, page);
         else if (filter == "active")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterNFTTickets(minheight, 1));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterNFTTickets(minheight, 1, page);
         else if (filter == "inactive")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterNFTTickets(minheight, 2));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterNFTTickets(minheight, 2, page);
         else if ((filter == "transferred") || (filter == "sold"))
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterNFTTickets(minheight, 3));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterNFTTickets(minheight, 3, page);
     } break;
 
     case RPC_CMD_LIST::act: {
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListTickets<CNFTActivateTicket>(minheight));
+            sJSON = masterNodeCtrl.masternodeTickets.ListTickets<CNFTActivateTicket>(minheight, page);
         else if (filter == "available")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterActTickets(minheight, 1));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterActTickets(minheight, 1, page);
         else if ((filter == "transferred") || (filter == "sold"))
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterActTickets(minheight, 2));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterActTickets(minheight, 2, page);
     } break;
 
     case RPC_CMD_LIST::collection: {
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListTickets<CollectionRegTicket>(minheight));
+            sJSON = masterNodeCtrl.masternodeTickets.ListTickets<CollectionRegTicket>(minheight, page);
         else if (filter == "active")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterCollectionTickets(1));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterCollectionTickets(minheight, 1, page);
         else if (filter == "inactive")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterCollectionTickets(2));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterCollectionTickets(minheight, 2, page);
     } break;
 
     case RPC_CMD_LIST::collection__act: {
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListTickets<CollectionActivateTicket>(minheight));
+            sJSON = masterNodeCtrl.masternodeTickets.ListTickets<CollectionActivateTicket>(minheight, page);
     } break;
 
     case RPC_CMD_LIST::sell:
@@ -206,7 +232,7 @@ As json rpc
             filter = params[2].get_str();
             if (params.size() > 3)
             {
-                if (params[3].get_str().find_first_not_of("0123456789") == string::npos)
+                if (!params[3].get_str().empty() && params[3].get_str().find_first_not_of("0123456789") == string::npos)
                     minheight = get_number(params[3]); // This means min_height is input.
                 else
                     pastelID = params[3].get_str(); // This means pastelID is input
@@ -218,15 +244,15 @@ As json rpc
             }
         }
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterOfferTickets(minheight, 0, pastelID));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterOfferTickets(minheight, 0, pastelID, page);
         else if (filter == "available")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterOfferTickets(minheight, 1, pastelID));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterOfferTickets(minheight, 1, pastelID, page);
         else if (filter == "unavailable")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterOfferTickets(minheight, 2, pastelID));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterOfferTickets(minheight, 2, pastelID, page);
         else if (filter == "expired")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterOfferTickets(minheight, 3, pastelID));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterOfferTickets(minheight, 3, pastelID, page);
         else if ((filter == "transferred") || (filter == "sold"))
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterOfferTickets(minheight, 4, pastelID));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterOfferTickets(minheight, 4, pastelID, page);
     } break;
 
     case RPC_CMD_LIST::buy:
@@ -247,7 +273,7 @@ As json rpc
         } else if (params.size() > 2) {
             filter = params[2].get_str();
             if (params.size() > 3) {
-                if (params[3].get_str().find_first_not_of("0123456789") == string::npos)
+                if (!params[3].get_str().empty() && params[3].get_str().find_first_not_of("0123456789") == string::npos)
                     minheight = get_number(params[3]); // This means min_height is input.
                 else
                     pastelID = params[3].get_str(); // This means pastelID is input
@@ -259,11 +285,11 @@ As json rpc
             }
         }
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterAcceptTickets(minheight, 0, pastelID));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterAcceptTickets(minheight, 0, pastelID, page);
         else if (filter == "expired")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterAcceptTickets(minheight, 1, pastelID));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterAcceptTickets(minheight, 1, pastelID, page);
         else if ((filter == "transferred") || (filter == "sold"))
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterAcceptTickets(minheight, 2, pastelID));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterAcceptTickets(minheight, 2, pastelID, page);
     } break;
 
     case RPC_CMD_LIST::trade:
@@ -285,7 +311,7 @@ As json rpc
             filter = params[2].get_str();
             if (params.size() > 3)
             {
-                if (params[3].get_str().find_first_not_of("0123456789") == string::npos)
+                if (!params[3].get_str().empty() && params[3].get_str().find_first_not_of("0123456789") == string::npos)
                     minheight = get_number(params[3]); // This means min_height is input.
                 else
                     pastelID = params[3].get_str(); // This means pastelID is input
@@ -296,55 +322,57 @@ As json rpc
             }
         }
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterTransferTickets(minheight, 0, pastelID));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterTransferTickets(minheight, 0, pastelID, page);
         else if (filter == "available")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterTransferTickets(minheight, 1, pastelID));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterTransferTickets(minheight, 1, pastelID, page);
         else if ((filter == "transferred") || (filter == "sold"))
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterTransferTickets(minheight, 2, pastelID));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterTransferTickets(minheight, 2, pastelID, page);
     } break;
 
     case RPC_CMD_LIST::royalty: {
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListTickets<CNFTRoyaltyTicket>(minheight));
+            sJSON = masterNodeCtrl.masternodeTickets.ListTickets<CNFTRoyaltyTicket>(minheight, page);
     } break;
 
     case RPC_CMD_LIST::username: {
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListTickets<CChangeUsernameTicket>(minheight));
+            sJSON = masterNodeCtrl.masternodeTickets.ListTickets<CChangeUsernameTicket>(minheight, page);
     } break;
 
     case RPC_CMD_LIST::ethereumaddress: {
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListTickets<CChangeEthereumAddressTicket>(minheight));
+            sJSON = masterNodeCtrl.masternodeTickets.ListTickets<CChangeEthereumAddressTicket>(minheight, page);
     } break;
 
     case RPC_CMD_LIST::action: {
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListTickets<CActionRegTicket>(minheight));
+            sJSON = masterNodeCtrl.masternodeTickets.ListTickets<CActionRegTicket>(minheight, page);
         else if (filter == "active")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterActionTickets(minheight, 1));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterActionTickets(minheight, 1, page);
         else if (filter == "inactive")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterActionTickets(minheight, 2));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterActionTickets(minheight, 2, page);
         else if (filter == "transferred")
-            obj.read(masterNodeCtrl.masternodeTickets.ListFilterActionTickets(minheight, 3));
+            sJSON = masterNodeCtrl.masternodeTickets.ListFilterActionTickets(minheight, 3, page);
     } break;
 
     case RPC_CMD_LIST::action__act:
         if (filter == "all")
-            obj.read(masterNodeCtrl.masternodeTickets.ListTickets<CActionActivateTicket>(minheight));
+            sJSON = masterNodeCtrl.masternodeTickets.ListTickets<CActionActivateTicket>(minheight, page);
         break;
 
     case RPC_CMD_LIST::contract:
     {
 		if (filter == "all")
-			obj.read(masterNodeCtrl.masternodeTickets.ListTickets<CContractTicket>(minheight));
+			sJSON = masterNodeCtrl.masternodeTickets.ListTickets<CContractTicket>(minheight, page);
 		else
-			obj.read(masterNodeCtrl.masternodeTickets.ListFilterContractTickets(minheight, filter));
+			sJSON = masterNodeCtrl.masternodeTickets.ListFilterContractTickets(minheight, filter, page);
 	} break;
 
     default:
         break;
     } // switch RPC_CMD_LIST::cmd()
 
-    return obj;
+    if (sJSON.empty())
+        return UniValue(UniValue::VARR);
+    return GetRawJSONValue(std::move(sJSON));
 }
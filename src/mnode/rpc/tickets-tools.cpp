@@ -382,21 +382,17 @@ UniValue thumbids_search(const search_thumbids_t &p)
     /**
      * matchedNftTicket function is called when the NFT registration ticket has been found that matches all search criterias.
      * 
-     * \param pTicket - pointer to NFT registration ticket (CNFTRegTicket)
-     * \param jNftAppTicket - parsed json "app ticket" from 'NFT Reg Ticket'
+     * \param sRegTxId - NFT registration ticket txid
+     * \param attr - NFT search attributes of the NFT registration ticket
      * \return result array count (to break iterating through the tickets when result limit has been reached)
      */
-    function<size_t(const CPastelTicket*, const json&)> matchedNftTicket = [&](const CPastelTicket* pTicket, const json& jNftAppTicket) -> size_t
+    nft_search_match_func_t matchedNftTicket = [&](const string &sRegTxId, const nft_search_attr_t &attr) -> size_t
     {
-        const CNFTRegTicket* pNftTicket = dynamic_cast<const CNFTRegTicket*>(pTicket);
-        if (!pNftTicket)
+        if (!attr.bHasThumbnailHash)
             return resultArray.size();
-        if (!jNftAppTicket.contains("thumbnail_hash"))
-            return resultArray.size();
-        string sThumbHash = jNftAppTicket["thumbnail_hash"];
         UniValue matchObj(UniValue::VOBJ);
-        matchObj.pushKV(RPC_KEY_TXID, pNftTicket->GetTxId());
-        matchObj.pushKV("thumbnail_hash", std::move(sThumbHash));
+        matchObj.pushKV(RPC_KEY_TXID, sRegTxId);
+        matchObj.pushKV("thumbnail_hash", attr.sThumbnailHash);
         resultArray.push_back(std::move(matchObj));
         return resultArray.size();
     };
@@ -511,11 +507,81 @@ As json rpc
 	return ticket->ToJSON();
 }
 
+UniValue tickets_tools_ticketcachestats(const UniValue& params)
+{
+    if (params.size() > 3)
+        throw JSONRPCError(RPC_INVALID_PARAMETER,
+R"(tickets tools ticketcachestats ("ticket_type")
+Get statistics of the in-memory ticket cache.
+
+Arguments:
+1. "ticket_type" (string, optional) Ticket type name to get statistics for (all ticket types if not defined).
+
+Returns:
+{
+    "max_size": n,          // max number of cached entries per ticket type
+    "hits": n,              // total number of cache hits
+    "misses": n,            // total number of cache misses
+    "entries": n,           // total number of cached entries
+    "types": {
+        "ticket_type": {
+            "hits": n,          // number of cache hits
+            "misses": n,        // number of cache misses
+            "evictions": n,     // number of entries evicted from the cache
+            "invalidations": n, // number of entries invalidated by ticket DB updates
+            "entries": n        // current number of cached entries
+        }, ...
+    }
+}
+)" + HelpExampleCli("tickets tools ticketcachestats", "nft") +
+R"(
+As json rpc
+)" + HelpExampleRpc("tickets", R"("tools", "ticketcachestats", "nft")"));
+
+    string sTicketType;
+    if (params.size() > 2)
+        sTicketType = params[2].get_str();
+
+    const auto& ticketProcessor = masterNodeCtrl.masternodeTickets;
+    UniValue typesObj(UniValue::VOBJ);
+    uint64_t nTotalHits = 0, nTotalMisses = 0;
+    size_t nTotalEntries = 0;
+    bool bFound = false;
+    for (uint8_t id = to_integral_type(TicketID::PastelID); id != to_integral_type(TicketID::COUNT); ++id)
+    {
+        const auto& ticketInfo = TICKET_INFO[id];
+        if (!sTicketType.empty() && !str_icmp(sTicketType, ticketInfo.szName))
+            continue;
+        bFound = true;
+        const auto stats = ticketProcessor.GetTicketCacheStats(static_cast<TicketID>(id));
+        UniValue statsObj(UniValue::VOBJ);
+        statsObj.pushKV("hits", stats.nHits);
+        statsObj.pushKV("misses", stats.nMisses);
+        statsObj.pushKV("evictions", stats.nEvictions);
+        statsObj.pushKV("invalidations", stats.nInvalidations);
+        statsObj.pushKV("entries", stats.nEntries);
+        typesObj.pushKV(ticketInfo.szName, std::move(statsObj));
+        nTotalHits += stats.nHits;
+        nTotalMisses += stats.nMisses;
+        nTotalEntries += stats.nEntries;
+    }
+    if (!bFound)
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("Unknown ticket type '%s'", sTicketType));
+
+    UniValue result(UniValue::VOBJ);
+    result.pushKV("max_size", ticketProcessor.GetTicketCacheMaxSize());
+    result.pushKV("hits", nTotalHits);
+    result.pushKV("misses", nTotalMisses);
+    result.pushKV("entries", nTotalEntries);
+    result.pushKV("types", std::move(typesObj));
+    return result;
+}
+
 UniValue tickets_tools(const UniValue& params)
 {
     RPC_CMD_PARSER2(TOOLS, params, printtradingchain, getregbytrade, getregbytransfer,
         gettotalstoragefee, estimatenftstoragefee, validateusername, validateethereumaddress,
-        validateownership, searchthumbids, decoderawtransaction, feeandburnreport);
+        validateownership, searchthumbids, decoderawtransaction, feeandburnreport, ticketcachestats);
 
     if (!TOOLS.IsCmdSupported() || params.size() < 2)
         throw runtime_error(
@@ -535,6 +601,7 @@ Available commands:
   validateownership       ... validate item ownership by Pastel ID
   searchthumbids          ... search for the NFT registration tickets and thumbnail hash
   decoderawtransaction    ... decode raw ticket transaction
+  ticketcachestats        ... get ticket cache statistics
   
 Examples:
 )"
@@ -582,6 +649,10 @@ Examples:
 			result = tickets_tools_decoderawtransaction(params);
 			break;
 
+        case RPC_CMD_TOOLS::ticketcachestats:
+            result = tickets_tools_ticketcachestats(params);
+            break;
+
         default:
             break;
     } // switch (TOOLS.cmd())
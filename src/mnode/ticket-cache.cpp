@@ -0,0 +1,332 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <mnode/tickets/tickets-all.h>
+#include <mnode/ticket-cache.h>
+
+using namespace std;
+
+/**
+ * Call functor f with the TicketTypeMapper<id> object for the given ticket type.
+ *
+ * \param id - ticket type
+ * \param f - functor, ticket class can be accessed as typename decltype(mapper)::TicketType
+ * \return false if ticket type is not supported
+ */
+template <typename F>
+static bool visitTicketType(const TicketID id, F &&f)
+{
+    switch (id)
+    {
+        case TicketID::PastelID:        f(TicketTypeMapper<TicketID::PastelID>{}); break;
+        case TicketID::NFT:             f(TicketTypeMapper<TicketID::NFT>{}); break;
+        case TicketID::Activate:        f(TicketTypeMapper<TicketID::Activate>{}); break;
+        case TicketID::Offer:           f(TicketTypeMapper<TicketID::Offer>{}); break;
+        case TicketID::Accept:          f(TicketTypeMapper<TicketID::Accept>{}); break;
+        case TicketID::Transfer:        f(TicketTypeMapper<TicketID::Transfer>{}); break;
+        case TicketID::Down:            f(TicketTypeMapper<TicketID::Down>{}); break;
+        case TicketID::Royalty:         f(TicketTypeMapper<TicketID::Royalty>{}); break;
+        case TicketID::Username:        f(TicketTypeMapper<TicketID::Username>{}); break;
+        case TicketID::EthereumAddress: f(TicketTypeMapper<TicketID::EthereumAddress>{}); break;
+        case TicketID::ActionReg:       f(TicketTypeMapper<TicketID::ActionReg>{}); break;
+        case TicketID::ActionActivate:  f(TicketTypeMapper<TicketID::ActionActivate>{}); break;
+        case TicketID::CollectionReg:   f(TicketTypeMapper<TicketID::CollectionReg>{}); break;
+        case TicketID::CollectionAct:   f(TicketTypeMapper<TicketID::CollectionAct>{}); break;
+        case TicketID::Contract:        f(TicketTypeMapper<TicketID::Contract>{}); break;
+
+        default:
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Copy ticket data from src to dst.
+ *
+ * \param dst - destination ticket
+ * \param src - source ticket
+ * \return false if tickets have different types
+ */
+bool CopyTicket(CPastelTicket &dst, const CPastelTicket &src) noexcept
+{
+    if (dst.ID() != src.ID())
+        return false;
+    try
+    {
+        return visitTicketType(src.ID(), [&](auto mapper)
+        {
+            using _TicketType = typename decltype(mapper)::TicketType;
+            static_cast<_TicketType &>(dst) = static_cast<const _TicketType &>(src);
+        });
+    } catch (...)
+    {
+        return false;
+    }
+}
+
+/**
+ * Create a copy of the ticket.
+ *
+ * \param ticket - ticket to clone
+ * \return shared pointer to the new ticket or nullptr
+ */
+static shared_ptr<CPastelTicket> cloneTicket(const CPastelTicket &ticket)
+{
+    shared_ptr<CPastelTicket> clone;
+    visitTicketType(ticket.ID(), [&](auto mapper)
+    {
+        using _TicketType = typename decltype(mapper)::TicketType;
+        clone = make_shared<_TicketType>(static_cast<const _TicketType &>(ticket));
+    });
+    return clone;
+}
+
+void CTicketCache::SetMaxSize(const size_t nMaxSize)
+{
+    unique_lock lck(m_Lock);
+    m_nMaxSize = nMaxSize;
+    for (auto &tc : m_Cache)
+    {
+        while (tc.lru.size() > m_nMaxSize)
+        {
+            tc.map.erase(tc.lru.back().sKey);
+            tc.lru.pop_back();
+            ++tc.stats.nEvictions;
+        }
+    }
+}
+
+uint64_t CTicketCache::GetGeneration() const noexcept
+{
+    unique_lock lck(m_Lock);
+    return m_nGeneration;
+}
+
+CTicketCache::ticket_type_cache_t* CTicketCache::getTypeCache(const TicketID id) noexcept
+{
+    const auto nIndex = to_integral_type(id);
+    if (nIndex >= m_Cache.size())
+        return nullptr;
+    return &m_Cache[nIndex];
+}
+
+/**
+ * Find cache entry by key and move it to the front of the LRU list.
+ * Updates hit/miss statistics. Should be called under m_Lock.
+ *
+ * \param tc - ticket type cache
+ * \param sKey - real DB key
+ * \return pointer to the cache entry or nullptr if not found
+ */
+const CTicketCache::cache_entry_t* CTicketCache::findEntry(ticket_type_cache_t &tc, const string &sKey)
+{
+    const auto it = tc.map.find(sKey);
+    if (it == tc.map.cend())
+    {
+        ++tc.stats.nMisses;
+        return nullptr;
+    }
+    ++tc.stats.nHits;
+    if (it->second != tc.lru.begin())
+        tc.lru.splice(tc.lru.begin(), tc.lru, it->second);
+    return &(*it->second);
+}
+
+/**
+ * Add or replace cache entry, evict least recently used entries if needed.
+ * Should be called under m_Lock.
+ */
+void CTicketCache::putEntry(ticket_type_cache_t &tc, cache_entry_t &&entry)
+{
+    const auto it = tc.map.find(entry.sKey);
+    if (it != tc.map.cend())
+    {
+        *it->second = std::move(entry);
+        tc.lru.splice(tc.lru.begin(), tc.lru, it->second);
+        return;
+    }
+    tc.lru.emplace_front(std::move(entry));
+    tc.map.emplace(tc.lru.front().sKey, tc.lru.begin());
+    while (tc.lru.size() > m_nMaxSize)
+    {
+        tc.map.erase(tc.lru.back().sKey);
+        tc.lru.pop_back();
+        ++tc.stats.nEvictions;
+    }
+}
+
+/**
+ * Find cached ticket by primary key.
+ *
+ * \param id - ticket type
+ * \param sKeyOne - ticket primary key
+ * \param ticket - ticket object to copy cached data to
+ * \return true if ticket was found in cache
+ */
+bool CTicketCache::GetTicket(const TicketID id, const string &sKeyOne, CPastelTicket &ticket)
+{
+    if (!IsEnabled())
+        return false;
+    shared_ptr<CPastelTicket> cachedTicket;
+    {
+        unique_lock lck(m_Lock);
+        auto tc = getTypeCache(id);
+        if (!tc)
+            return false;
+        const auto pEntry = findEntry(*tc, sKeyOne);
+        if (!pEntry || !pEntry->ticket)
+            return false;
+        cachedTicket = pEntry->ticket;
+    }
+    // cached tickets are never modified, so copy can be done outside of the lock
+    return CopyTicket(ticket, *cachedTicket);
+}
+
+bool CTicketCache::HasTicket(const TicketID id, const string &sKeyOne, uint32_t &nBlockHeight)
+{
+    if (!IsEnabled())
+        return false;
+    unique_lock lck(m_Lock);
+    auto tc = getTypeCache(id);
+    if (!tc)
+        return false;
+    const auto pEntry = findEntry(*tc, sKeyOne);
+    if (!pEntry || !pEntry->ticket)
+        return false;
+    nBlockHeight = pEntry->ticket->GetBlock();
+    return true;
+}
+
+/**
+ * Add ticket read from the DB to the cache.
+ *
+ * \param ticket - ticket to cache (copy is stored)
+ * \param nGeneration - cache generation captured before reading ticket from DB
+ */
+void CTicketCache::PutTicket(const CPastelTicket &ticket, const uint64_t nGeneration)
+{
+    if (!IsEnabled())
+        return;
+    const auto id = ticket.ID();
+    cache_entry_t entry;
+    try
+    {
+        entry.ticket = cloneTicket(ticket);
+    } catch (const bad_alloc&)
+    {
+        return;
+    }
+    if (!entry.ticket)
+        return;
+    entry.sKey = ticket.KeyOne();
+
+    unique_lock lck(m_Lock);
+    if (nGeneration != m_nGeneration)
+        return;
+    auto tc = getTypeCache(id);
+    if (!tc)
+        return;
+    putEntry(*tc, std::move(entry));
+}
+
+bool CTicketCache::GetKeys(const TicketID id, const string &sRealKey, v_strings &vKeys)
+{
+    if (!IsEnabled())
+        return false;
+    unique_lock lck(m_Lock);
+    auto tc = getTypeCache(id);
+    if (!tc)
+        return false;
+    const auto pEntry = findEntry(*tc, sRealKey);
+    if (!pEntry || pEntry->ticket)
+        return false;
+    vKeys = pEntry->vKeys;
+    return true;
+}
+
+void CTicketCache::PutKeys(const TicketID id, const string &sRealKey, const v_strings &vKeys, const uint64_t nGeneration)
+{
+    if (!IsEnabled())
+        return;
+    unique_lock lck(m_Lock);
+    if (nGeneration != m_nGeneration)
+        return;
+    auto tc = getTypeCache(id);
+    if (!tc)
+        return;
+    cache_entry_t entry;
+    entry.sKey = sRealKey;
+    entry.vKeys = vKeys;
+    putEntry(*tc, std::move(entry));
+}
+
+/**
+ * Invalidate cache entry by real DB key (keyOne, @2@keyTwo or @M@mvKey).
+ * Always increments cache generation.
+ */
+void CTicketCache::Invalidate(const TicketID id, const string &sRealKey)
+{
+    unique_lock lck(m_Lock);
+    ++m_nGeneration;
+    auto tc = getTypeCache(id);
+    if (!tc)
+        return;
+    const auto it = tc->map.find(sRealKey);
+    if (it == tc->map.cend())
+        return;
+    tc->lru.erase(it->second);
+    tc->map.erase(it);
+    ++tc->stats.nInvalidations;
+}
+
+/**
+ * Invalidate all cached tickets registered at height nHeight or above.
+ * Used when blocks are disconnected from the active chain.
+ *
+ * \param nHeight - min block height of the tickets to invalidate
+ * \return number of invalidated tickets
+ */
+size_t CTicketCache::InvalidateFromHeight(const uint32_t nHeight)
+{
+    size_t nInvalidated = 0;
+    unique_lock lck(m_Lock);
+    ++m_nGeneration;
+    for (auto &tc : m_Cache)
+    {
+        for (auto it = tc.lru.begin(); it != tc.lru.end();)
+        {
+            if (it->ticket && it->ticket->IsBlockEqualOrNewerThan(nHeight))
+            {
+                tc.map.erase(it->sKey);
+                it = tc.lru.erase(it);
+                ++tc.stats.nInvalidations;
+                ++nInvalidated;
+            } else
+                ++it;
+        }
+    }
+    return nInvalidated;
+}
+
+void CTicketCache::Clear()
+{
+    unique_lock lck(m_Lock);
+    ++m_nGeneration;
+    for (auto &tc : m_Cache)
+    {
+        tc.stats.nInvalidations += tc.lru.size();
+        tc.map.clear();
+        tc.lru.clear();
+    }
+}
+
+ticket_cache_stats_t CTicketCache::GetStats(const TicketID id) const
+{
+    unique_lock lck(m_Lock);
+    const auto nIndex = to_integral_type(id);
+    if (nIndex >= m_Cache.size())
+        return {};
+    auto stats = m_Cache[nIndex].stats;
+    stats.nEntries = m_Cache[nIndex].lru.size();
+    return stats;
+}
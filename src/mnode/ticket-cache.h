@@ -0,0 +1,99 @@
+#pragma once
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <utils/vector_types.h>
+#include <mnode/tickets/ticket-types.h>
+#include <mnode/tickets/ticket.h>
+
+// default max number of cached entries per ticket type
+constexpr size_t DEFAULT_TICKET_CACHE_SIZE = 5000;
+
+// copy ticket data from src to dst, both tickets must have the same type
+bool CopyTicket(CPastelTicket &dst, const CPastelTicket &src) noexcept;
+
+// ticket cache statistics for one ticket type
+typedef struct _ticket_cache_stats_t
+{
+    uint64_t nHits = 0;          // number of cache hits
+    uint64_t nMisses = 0;        // number of cache misses
+    uint64_t nEvictions = 0;     // number of entries evicted by LRU policy
+    uint64_t nInvalidations = 0; // number of entries invalidated by DB updates
+    size_t nEntries = 0;         // current number of cached entries
+} ticket_cache_stats_t;
+
+/**
+ * In-memory LRU cache for the decoded tickets stored in the ticket DB.
+ * Keeps separate bounded LRU list for each ticket type.
+ * Cache mirrors the ticket DB records:
+ *   - <keyOne> -> decoded ticket
+ *   - @2@<keyTwo> -> keyOne
+ *   - <@M@mvKey><keyOne> records -> list of keyOne (cached by @M@<mvKey>)
+ * Every ticket DB update should invalidate affected cache entries.
+ * Generation counter is used to prevent caching of the data read from DB
+ * concurrently with the DB update.
+ */
+class CTicketCache
+{
+public:
+    CTicketCache() noexcept = default;
+
+    // set max number of cached entries per ticket type (0 - cache disabled)
+    void SetMaxSize(const size_t nMaxSize);
+    size_t GetMaxSize() const noexcept { return m_nMaxSize; }
+    bool IsEnabled() const noexcept { return m_nMaxSize > 0; }
+    // get current cache generation (changed on every invalidation)
+    uint64_t GetGeneration() const noexcept;
+
+    // find ticket by primary key, copy cached ticket to the ticket object
+    bool GetTicket(const TicketID id, const std::string &sKeyOne, CPastelTicket &ticket);
+    // check if ticket with primary key is cached, returns ticket block height
+    bool HasTicket(const TicketID id, const std::string &sKeyOne, uint32_t &nBlockHeight);
+    // add ticket to the cache if cache generation has not been changed since nGeneration
+    void PutTicket(const CPastelTicket &ticket, const uint64_t nGeneration);
+
+    // find primary key(s) by secondary key or mv key (real DB keys with prefix)
+    bool GetKeys(const TicketID id, const std::string &sRealKey, v_strings &vKeys);
+    void PutKeys(const TicketID id, const std::string &sRealKey, const v_strings &vKeys, const uint64_t nGeneration);
+
+    // invalidate cache entry by real DB key
+    void Invalidate(const TicketID id, const std::string &sRealKey);
+    // invalidate all cached tickets with block height >= nHeight
+    size_t InvalidateFromHeight(const uint32_t nHeight);
+    void Clear();
+
+    ticket_cache_stats_t GetStats(const TicketID id) const;
+
+protected:
+    typedef struct _cache_entry_t
+    {
+        std::string sKey;
+        std::shared_ptr<CPastelTicket> ticket; // for primary key entries
+        v_strings vKeys;                       // for secondary & mv key entries
+    } cache_entry_t;
+    using cache_list_t = std::list<cache_entry_t>;
+
+    typedef struct _ticket_type_cache_t
+    {
+        cache_list_t lru; // most recently used entries at front
+        std::unordered_map<std::string, cache_list_t::iterator> map;
+        ticket_cache_stats_t stats;
+    } ticket_type_cache_t;
+
+    mutable std::mutex m_Lock;
+    // max cache size can be changed by SetMaxSize, read by IsEnabled/GetMaxSize without the lock
+    std::atomic_size_t m_nMaxSize = 0;
+    uint64_t m_nGeneration = 0;
+    std::array<ticket_type_cache_t, to_integral_type(TicketID::COUNT)> m_Cache;
+
+    ticket_type_cache_t* getTypeCache(const TicketID id) noexcept;
+    const cache_entry_t* findEntry(ticket_type_cache_t &tc, const std::string &sKey);
+    void putEntry(ticket_type_cache_t &tc, cache_entry_t &&entry);
+};
@@ -5,13 +5,18 @@
 
 #include <txmempool.h>
 #include <mnode/ticket-processor.h>
+#include <mnode/ticket-txmempool.h>
 
+/**
+ * Search for Pastel tickets of one type in the local memory pool.
+ * Uses ticket key indexes maintained by CTicketTxMemPoolTracker.
+ */
 class CPastelTicketMemPoolProcessor
 {
 public:
     CPastelTicketMemPoolProcessor(const TicketID ticket_id);
 
-    virtual void Initialize(const CTxMemPool &pool, tx_mempool_tracker_t pMemPoolTracker = nullptr);
+    virtual void Initialize(tx_mempool_tracker_t pMemPoolTracker = nullptr);
 
     /**
      * Find Pastel ticket by primary key.
@@ -23,44 +28,24 @@ public:
     template <typename _TicketType>
     bool FindTicket(_TicketType& ticket) const noexcept
     {
-        const auto sKey = ticket.KeyOne();
-        bool bRet = false;
-        for (const auto& tkt : m_vTicket)
-        {
-            if (sKey == tkt->KeyOne())
-            {
-                ticket = *dynamic_cast<_TicketType*>(tkt.get());
-                bRet = true;
-                break;
-            }
-        }
-        return bRet;
+        if (!m_pTracker)
+            return false;
+        return copyTicket(m_pTracker->findTicket(m_TicketID, ticket.KeyOne()), ticket);
     }
 
     /**
      * Find Pastel ticket by secondary key.
-     * Uses ticket.KeyOne() as a search key.
+     * Uses ticket.KeyTwo() as a search key.
      * 
      * \param ticket - returns ticket if found
-     * \return - true if ticket was found by primary key
+     * \return - true if ticket was found by secondary key
      */
     template <typename _TicketType>
     bool FindTicketBySecondaryKey(_TicketType& ticket) const noexcept
     {
-        if (!ticket.HasKeyTwo())
+        if (!m_pTracker || !ticket.HasKeyTwo())
             return false;
-        const std::string sKeyTwo = ticket.KeyTwo();
-        bool bRet = false;
-        for (const auto& tkt : m_vTicket)
-        {
-            if (sKeyTwo == tkt->KeyTwo())
-            {
-                ticket = *dynamic_cast<_TicketType*>(tkt.get());
-                bRet = true;
-                break;
-            }
-        }
-        return bRet;
+        return copyTicket(m_pTracker->findTicketBySecondaryKey(m_TicketID, ticket.KeyTwo()), ticket);
     }
     // check if ticket exists by primary key
     bool TicketExists(const std::string& sKeyOne) const noexcept;
@@ -71,6 +56,24 @@ public:
 
 protected: 
     TicketID m_TicketID; 
-    // tickets in mempool with m_TicketID
-    PastelTickets_t m_vTicket;
+    // mempool tracker with ticket key indexes
+    std::shared_ptr<CTicketTxMemPoolTracker> m_pTracker;
+
+    template <typename _TicketType>
+    static bool copyTicket(const MemPoolTicketPtr &pTicket, _TicketType& ticket) noexcept
+    {
+        if (!pTicket)
+            return false;
+        const auto pTypedTicket = dynamic_cast<const _TicketType*>(pTicket.get());
+        if (!pTypedTicket)
+            return false;
+        try
+        {
+            ticket = *pTypedTicket;
+        } catch (...)
+        {
+            return false;
+        }
+        return true;
+    }
 };
@@ -3,6 +3,9 @@
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 
 #include <cinttypes>
+#include <future>
+#include <thread>
+#include <condition_variable>
 #include <extlibs/json.hpp>
 
 #if defined(HAVE_CONFIG_H)
@@ -18,6 +21,7 @@
 #include <init.h>
 #include <accept_to_mempool.h>
 #include <txdb/txdb.h>
+#include <blockscanner.h>
 #include <mnode/tickets/ticket-types.h>
 #include <mnode/tickets/tickets-all.h>
 #include <mnode/mnode-controller.h>
@@ -49,13 +53,360 @@ void CPastelTicketProcessor::InitTicketDB()
 
     // create DB for each ticket type
     for (uint8_t id = to_integral_type(TicketID::PastelID); id != to_integral_type(TicketID::COUNT); ++id)
-        dbs.emplace(static_cast<TicketID>(id), make_unique<CDBWrapper>(ticketsDir / TICKET_INFO[id].szDBSubFolder, nTicketDBCache, false, fReindex));
+    {
+        auto pDB = make_unique<CDBWrapper>(ticketsDir / TICKET_INFO[id].szDBSubFolder, nTicketDBCache, false, fReindex);
+        // upgrade ticket DB created by the previous versions
+        uint32_t nDBVersion = 0;
+        if (!pDB->Read(string(TICKET_DB_VERSION_KEY), nDBVersion) || (nDBVersion < TICKET_DB_VERSION))
+        {
+            if (pDB->WasCreated() || fReindex || migrateTicketDB(static_cast<TicketID>(id), *pDB, nDBVersion))
+                pDB->Write(string(TICKET_DB_VERSION_KEY), TICKET_DB_VERSION, true);
+        }
+        dbs.emplace(static_cast<TicketID>(id), std::move(pDB));
+    }
 
-    LogFnPrintf("...ticket database has been initialized (%hhu ticket types%s)",
-        to_integral_type(TicketID::COUNT), fReindex ? ", clean db" : "");
+    // ticket txid index, built from the existing ticket DBs by BuildTicketTxIdIndex when the block index is loaded
+    m_pTxIdIndexDB = make_unique<CDBWrapper>(ticketsDir / TICKET_TXIDX_DB_SUBFOLDER, nTicketDBCache, false, fReindex);
+    if (m_pTxIdIndexDB->WasCreated())
+        setIndexBuilt(TICKET_TXIDX_DB_SUBFOLDER, false);
+    // ticket height index, built from the existing ticket DBs until the build is completed
+    m_pHeightIndexDB = make_unique<CDBWrapper>(ticketsDir / TICKET_HEIGHTIDX_DB_SUBFOLDER, nTicketDBCache, false, fReindex);
+    if (m_pHeightIndexDB->WasCreated())
+        setIndexBuilt(TICKET_HEIGHTIDX_DB_SUBFOLDER, false);
+    if (!isIndexBuilt(TICKET_HEIGHTIDX_DB_SUBFOLDER))
+        buildTicketHeightIndex();
+    // NFT search attributes and NFT keyword index, built from the existing NFT registration tickets
+    // if any of these DBs is created, search attributes have outdated version or the previous build was interrupted
+    m_pNftSearchDB = make_unique<CDBWrapper>(ticketsDir / TICKET_NFTSEARCH_DB_SUBFOLDER, nTicketDBCache, false, fReindex);
+    m_pNftKeywordDB = make_unique<CDBWrapper>(ticketsDir / TICKET_NFTKEYWORD_DB_SUBFOLDER, nTicketDBCache, false, fReindex);
+    uint8_t nNftSearchVersion = 0;
+    if (!m_pNftSearchDB->Read(string(TICKET_DB_VERSION_KEY), nNftSearchVersion) ||
+        (nNftSearchVersion < nft_search_attr_t::CURRENT_VERSION) ||
+        m_pNftSearchDB->WasCreated() || m_pNftKeywordDB->WasCreated())
+        setIndexBuilt(TICKET_NFTKEYWORD_DB_SUBFOLDER, false);
+    if (!isIndexBuilt(TICKET_NFTKEYWORD_DB_SUBFOLDER))
+        buildNFTKeywordIndex();
+
+    // max number of decoded tickets cached per ticket type
+    const int64_t nTicketCacheSize = GetArg("-ticketcachesize", DEFAULT_TICKET_CACHE_SIZE);
+    m_TicketCache.SetMaxSize(static_cast<size_t>(max<int64_t>(nTicketCacheSize, 0)));
+
+    LogFnPrintf("...ticket database has been initialized (%hhu ticket types%s, ticket cache size %zu)",
+        to_integral_type(TicketID::COUNT), fReindex ? ", clean db" : "", m_TicketCache.GetMaxSize());
     m_bTicketDBInitialized = true;
 }
 
+/**
+ * Check whether ticket index was completely built.
+ * Index build completion marker is stored in the PastelID ticket DB.
+ *
+ * \param szIndexName - index DB subfolder name
+ * \return true if index build completion marker exists
+ */
+bool CPastelTicketProcessor::isIndexBuilt(const char *szIndexName) const
+{
+    const auto itDB = dbs.find(TicketID::PastelID);
+    if (itDB == dbs.cend())
+        return false;
+    return itDB->second->Exists(string(TICKET_INDEX_BUILT_KEY_PREFIX) + szIndexName);
+}
+
+/**
+ * Write or erase ticket index build completion marker.
+ *
+ * \param szIndexName - index DB subfolder name
+ * \param bBuilt - true to write the marker, false to erase it
+ */
+void CPastelTicketProcessor::setIndexBuilt(const char *szIndexName, const bool bBuilt)
+{
+    const auto itDB = dbs.find(TicketID::PastelID);
+    if (itDB == dbs.cend())
+        return;
+    const string sKey = string(TICKET_INDEX_BUILT_KEY_PREFIX) + szIndexName;
+    if (bBuilt)
+        itDB->second->Write(sKey, uint8_t(1), true);
+    else
+        itDB->second->Erase(sKey, true);
+}
+
+/**
+ * Build ticket txid index for the tickets added to the ticket DB by the previous versions.
+ * Index is built only once - completion marker is written after all tickets are indexed,
+ * interrupted build is restarted on the next node start.
+ * Each block with tickets is read from disk only once.
+ */
+void CPastelTicketProcessor::BuildTicketTxIdIndex()
+{
+    AssertLockHeld(cs_main);
+    if (!m_pTxIdIndexDB || isIndexBuilt(TICKET_TXIDX_DB_SUBFOLDER))
+        return;
+
+    LogFnPrintf("Building ticket txid index...");
+    // ticket block height -> ticket txids
+    map<uint32_t, s_strings> mapTicketTxIds;
+    for (const auto& [id, pDB] : dbs)
+    {
+        ProcessAllTickets(id, [&](string&& sKey, const PastelTicketPtr& ticket) -> bool
+        {
+            mapTicketTxIds[ticket->GetBlock()].insert(ticket->GetTxId());
+            return true;
+        });
+    }
+    const auto& consensusParams = Params().GetConsensus();
+    size_t nCount = 0;
+    string error;
+    for (const auto& [nHeight, setTxIds] : mapTicketTxIds)
+    {
+        const auto pindex = chainActive[nHeight];
+        CBlock block;
+        if (!pindex || !ReadBlockFromDisk(block, pindex, consensusParams))
+        {
+            LogFnPrintf("WARNING: failed to read block at height %u, tickets from this block are not indexed", nHeight);
+            continue;
+        }
+        const uint256 hashBlock = pindex->GetBlockHash();
+        CDBBatch batch(*m_pTxIdIndexDB);
+        for (const auto& tx : block.vtx)
+        {
+            if (!setTxIds.count(tx.GetHash().GetHex()))
+                continue;
+            parsed_ticket_t parsedTicket;
+            if (!parseTicketTransaction(CMutableTransaction(tx), parsedTicket, error))
+                continue;
+            batch.Write(parsedTicket.hashTx, createTxIdIndex(parsedTicket, nHeight, hashBlock));
+            ++nCount;
+        }
+        if (!m_pTxIdIndexDB->WriteBatch(batch))
+        {
+            LogFnPrintf("ERROR: failed to write ticket txid index");
+            return;
+        }
+    }
+    m_pTxIdIndexDB->Sync();
+    setIndexBuilt(TICKET_TXIDX_DB_SUBFOLDER, true);
+    LogFnPrintf("...ticket txid index has been built (%zu tickets)", nCount);
+}
+
+/**
+ * Build ticket height index from the existing ticket DBs.
+ * Completion marker is written after all tickets are indexed,
+ * interrupted build is restarted on the next node start.
+ */
+void CPastelTicketProcessor::buildTicketHeightIndex()
+{
+    LogFnPrintf("Building ticket height index...");
+    size_t nCount = 0;
+    for (const auto& [id, pDB] : dbs)
+    {
+        CDBBatch batch(*m_pHeightIndexDB);
+        ProcessAllTickets(id, [&](string&& sKey, const PastelTicketPtr& ticket) -> bool
+        {
+            batch.Write(ticket_height_index_key_t(id, ticket->GetBlock(), sKey), uint8_t(0));
+            ++nCount;
+            return true;
+        });
+        if (!m_pHeightIndexDB->WriteBatch(batch, true))
+        {
+            LogFnPrintf("ERROR: failed to write ticket height index");
+            return;
+        }
+    }
+    setIndexBuilt(TICKET_HEIGHTIDX_DB_SUBFOLDER, true);
+    LogFnPrintf("...ticket height index has been built (%zu tickets)", nCount);
+}
+
+/**
+ * Ticket DB version 2 mv key record key: <@M@mvKey><primary key>.
+ * Used only to migrate ticket DB to the current format.
+ */
+typedef struct _ticket_mvkey_v2_t
+{
+    std::string sRealMVKey; // real mv key: @M@<mvKey>
+    std::string sKeyOne;    // ticket primary key
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        READWRITE(sRealMVKey);
+        READWRITE(sKeyOne);
+    }
+} ticket_mvkey_v2_t;
+
+/**
+ * Ticket DB version 3 mv key record key: <@M@mvKey><block height><primary key>.
+ * Used only to migrate ticket DB to the current format.
+ */
+typedef struct _ticket_mvkey_v3_t
+{
+    std::string sRealMVKey; // real mv key: @M@<mvKey>
+    uint32_t nHeight = 0;   // ticket block height
+    std::string sKeyOne;    // ticket primary key
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << sRealMVKey;
+        ser_writedata32be(s, nHeight);
+        s << sKeyOne;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        s >> sRealMVKey;
+        nHeight = ser_readdata32be(s);
+        s >> sKeyOne;
+    }
+} ticket_mvkey_v3_t;
+
+/**
+ * Migrate ticket DB from the version 1, 2 or 3 format.
+ * Converts mv key records "@M@<mvKey> -> vector of primary keys" (version 1),
+ * "<@M@<mvKey>><primary key> -> 0" (version 2) and "<@M@<mvKey>><block height><primary key> -> 0"
+ * (version 3) to one "<@M@<mvKey>><block height><tx index><primary key> -> 0" record per ticket.
+ * Version 1 records keep the order tickets were added in as tx index, versions 2 and 3
+ * do not have it - tickets from the same block are ordered by primary key.
+ * Version 1 and 2 records that are already in the current format are skipped,
+ * so interrupted migration can be restarted. Version 3 records cannot be told
+ * apart from the current ones, so they are migrated in one batch together with the DB version.
+ * 
+ * \param id - ticket type
+ * \param db - ticket DB
+ * \param nDBVersion - current ticket DB version
+ * \return true if DB was successfully migrated
+ */
+bool CPastelTicketProcessor::migrateTicketDB(const TicketID id, CDBWrapper& db, const uint32_t nDBVersion)
+{
+    LogFnPrintf("Upgrading %s ticket DB to version %u...", ::GetTicketDescription(id), TICKET_DB_VERSION);
+    size_t nMVKeyCount = 0;
+    unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    auto ticket = CreateTicket(id);
+    if (!ticket)
+        return false;
+    if (nDBVersion == 3)
+    {
+        CDBBatch batch(db);
+        ticket_mvkey_v3_t keyV3;
+        for (pcursor->SeekToFirst(); pcursor->Valid(); pcursor->Next())
+        {
+            if (!pcursor->GetKey(keyV3) || !str_starts_with(keyV3.sRealMVKey, TICKET_MVKEY_PREFIX) ||
+                (pcursor->GetKeySize() != GetSerializeSize(keyV3, SER_DISK, CLIENT_VERSION)))
+                continue;
+            batch.Erase(keyV3);
+            batch.Write(ticket_mvkey_t(keyV3.sRealMVKey, keyV3.nHeight, 0, keyV3.sKeyOne), uint8_t(0));
+            ++nMVKeyCount;
+        }
+        batch.Write(string(TICKET_DB_VERSION_KEY), TICKET_DB_VERSION);
+        if (!db.WriteBatch(batch, true))
+            return false;
+        LogFnPrintf("...%s ticket DB has been upgraded (%zu mv key records)", ::GetTicketDescription(id), nMVKeyCount);
+        return true;
+    }
+    string sKey;
+    v_strings vMainKeys;
+    ticket_mvkey_v2_t keyV2;
+    for (pcursor->SeekToFirst(); pcursor->Valid(); pcursor->Next())
+    {
+        sKey.clear();
+        if (!pcursor->GetKey(sKey) || !str_starts_with(sKey, TICKET_MVKEY_PREFIX))
+            continue;
+        CDBBatch batch(db);
+        vMainKeys.clear();
+        if (pcursor->GetKeySize() == GetSerializeSize(sKey, SER_DISK, CLIENT_VERSION))
+        {
+            // version 1: key contains only mv key, value - vector of primary keys
+            if (!pcursor->GetValue(vMainKeys))
+            {
+                LogFnPrintf("ERROR: failed to read mv key record [%s]", sKey);
+                return false;
+            }
+            batch.Erase(sKey);
+        } else if (pcursor->GetKey(keyV2) && !keyV2.sKeyOne.empty() &&
+            (pcursor->GetKeySize() == GetSerializeSize(keyV2, SER_DISK, CLIENT_VERSION)))
+        {
+            // version 2: key contains serialized primary key right after mv key
+            vMainKeys.push_back(keyV2.sKeyOne);
+            batch.Erase(keyV2);
+        } else
+            continue; // current format
+        for (uint32_t i = 0; i < vMainKeys.size(); ++i)
+        {
+            // height is taken from the stored ticket, records for the missing tickets are dropped
+            if (db.Read(vMainKeys[i], *ticket))
+                batch.Write(ticket_mvkey_t(sKey, ticket->GetBlock(), i, vMainKeys[i]), uint8_t(0));
+        }
+        if (!db.WriteBatch(batch))
+            return false;
+        ++nMVKeyCount;
+    }
+    db.Sync();
+    LogFnPrintf("...%s ticket DB has been upgraded (%zu mv key records)", ::GetTicketDescription(id), nMVKeyCount);
+    return true;
+}
+
+/**
+ * Remove all records from the NFT search attributes DB and NFT keyword index DB.
+ * Called before the NFT keyword index rebuild, so records created with the previous
+ * tokenization or for the removed NFT tickets do not stay in the index.
+ */
+void CPastelTicketProcessor::clearNFTSearchDBs()
+{
+    size_t nCount = 0;
+    CDBBatch keywordBatch(*m_pNftKeywordDB);
+    unique_ptr<CDBIterator> pcursor(m_pNftKeywordDB->NewIterator());
+    nft_keyword_index_key_t key;
+    for (pcursor->SeekToFirst(); pcursor->Valid(); pcursor->Next())
+    {
+        if (!pcursor->GetKey(key))
+            continue;
+        keywordBatch.Erase(key);
+        ++nCount;
+    }
+    m_pNftKeywordDB->WriteBatch(keywordBatch, true);
+
+    CDBBatch searchBatch(*m_pNftSearchDB);
+    pcursor = m_pNftSearchDB->NewIterator();
+    string sKey;
+    for (pcursor->SeekToFirst(); pcursor->Valid(); pcursor->Next())
+    {
+        if (!pcursor->GetKey(sKey))
+            continue;
+        searchBatch.Erase(sKey);
+        ++nCount;
+    }
+    m_pNftSearchDB->WriteBatch(searchBatch, true);
+    if (nCount)
+        LogFnPrintf("...removed %zu NFT search records", nCount);
+}
+
+/**
+ * Build NFT keyword index from the existing NFT registration tickets.
+ * Called on ticket DB initialization when the NFT search DBs are created,
+ * NFT search attributes version is changed or the previous build was interrupted.
+ * Also creates NFT search attributes records, so NFT search only reads these DBs.
+ * Completion marker is written after all NFT registration tickets are processed.
+ */
+void CPastelTicketProcessor::buildNFTKeywordIndex()
+{
+    LogFnPrintf("Building NFT keyword index...");
+    clearNFTSearchDBs();
+    size_t nCount = 0;
+    ProcessAllTickets(TicketID::NFT, [&](string&& sKey, const PastelTicketPtr& ticket) -> bool
+    {
+        nft_search_attr_t attr;
+        json jApp;
+        if (updateNFTSearchAttributes(*ticket, attr, jApp))
+            ++nCount;
+        return true;
+    });
+    m_pNftSearchDB->Write(string(TICKET_DB_VERSION_KEY), nft_search_attr_t::CURRENT_VERSION, true);
+    m_pNftKeywordDB->Sync();
+    setIndexBuilt(TICKET_NFTKEYWORD_DB_SUBFOLDER, true);
+    LogFnPrintf("...NFT keyword index has been built (%zu NFT tickets)", nCount);
+}
+
 /**
  * Create ticket unique_ptr by type.
  * 
@@ -132,41 +483,290 @@ PastelTicketPtr CPastelTicketProcessor::CreateTicket(const TicketID ticketId)
     return ticket;
 }
 
+/**
+ * Check if transaction has multisig outputs and can be a ticket transaction.
+ */
+static bool HasMultiSigOutputs(const CTransaction& tx)
+{
+    vector<v_uint8> vSolutions;
+    for (const auto& vout : tx.vout)
+    {
+        txnouttype typeRet;
+        vSolutions.clear();
+        if (Solver(vout.scriptPubKey, typeRet, vSolutions) && (typeRet == TX_MULTISIG))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Called when block is connected to or disconnected from the active chain.
+ * Keeps possible ticket transactions of the connected block in memory,
+ * so UpdatedBlockTip does not have to read the block from disk again.
+ * 
+ * \param pBlockIndex - block index
+ * \param pBlock - connected or disconnected block
+ * \param bAdded - true if block was connected
+ */
+void CPastelTicketProcessor::ChainTip(const CBlockIndex* pBlockIndex, const CBlock* pBlock, const bool bAdded)
+{
+    if (!pBlockIndex || !pBlock)
+        return;
+    const uint256 hashBlock = pBlockIndex->GetBlockHash();
+    unique_lock lck(m_PendingBlocksLock);
+    if (!bAdded)
+    {
+        m_mapPendingBlocks.erase(hashBlock);
+        return;
+    }
+    // block is read from disk by UpdatedBlockTip if it's not found here
+    if (m_mapPendingBlocks.size() >= MAX_PENDING_TICKET_BLOCKS)
+        return;
+    pending_block_txs_t pendingBlock;
+    pendingBlock.nHeight = static_cast<uint32_t>(pBlockIndex->nHeight);
+    for (const auto& tx : pBlock->vtx)
+    {
+        if (HasMultiSigOutputs(tx))
+            pendingBlock.vTx.push_back(tx);
+    }
+    m_mapPendingBlocks[hashBlock] = std::move(pendingBlock);
+}
+
 void CPastelTicketProcessor::UpdatedBlockTip(const CBlockIndex* pBlockIndex, bool fInitialDownload)
 {
     if (!pBlockIndex)
         return;
 
-    CBlock block;
-    if (!ReadBlockFromDisk(block, pBlockIndex, Params().GetConsensus()))
+    const uint256 hashBlock = pBlockIndex->GetBlockHash();
+    const uint32_t nHeight = static_cast<uint32_t>(pBlockIndex->nHeight);
+    bool bFound = false;
+    vector<CTransaction> vTx;
     {
-        LogFnPrintf("ERROR: Can't read block from disk");
-        return;
+        unique_lock lck(m_PendingBlocksLock);
+        const auto it = m_mapPendingBlocks.find(hashBlock);
+        if (it != m_mapPendingBlocks.end())
+        {
+            vTx = std::move(it->second.vTx);
+            bFound = true;
+        }
+        // drop this block and any stale blocks that won't be notified
+        for (auto itPending = m_mapPendingBlocks.begin(); itPending != m_mapPendingBlocks.end();)
+        {
+            if (itPending->second.nHeight <= nHeight)
+                itPending = m_mapPendingBlocks.erase(itPending);
+            else
+                ++itPending;
+        }
+    }
+    if (!bFound)
+    {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, pBlockIndex, Params().GetConsensus()))
+        {
+            LogFnPrintf("ERROR: Can't read block from disk");
+            return;
+        }
+        vTx = std::move(block.vtx);
+    }
+    // no need to sync ticket DB writes for every block during initial block download
+    processBlockTickets(vTx, pBlockIndex, !fInitialDownload);
+}
+
+/**
+ * Parse tickets from the block transactions and update ticket DB.
+ * All DB changes for the block are written at once.
+ * 
+ * \param vTx - block transactions
+ * \param pBlockIndex - block index
+ * \param bSync - if true - sync DB writes to disk
+ */
+void CPastelTicketProcessor::processBlockTickets(const vector<CTransaction>& vTx, const CBlockIndex* pBlockIndex, const bool bSync)
+{
+    CTicketDBBatch batch;
+    const uint256 hashBlock = pBlockIndex->GetBlockHash();
+    for (uint32_t nTxIndex = 0; nTxIndex < vTx.size(); ++nTxIndex)
+    {
+        CMutableTransaction mtx(vTx[nTxIndex]);
+        ParseTicketAndUpdateDB(mtx, pBlockIndex->nHeight, hashBlock, &batch, nTxIndex);
     }
+    commitDBBatch(batch, bSync);
+}
 
-    for (const auto& tx : block.vtx)
+/**
+ * Write all DB changes accumulated in the batch.
+ * Index DBs are written first and ticket DBs last, so tickets never become
+ * visible without their index records. Writing stops on the first failure,
+ * in this case full ticket DB repair is scheduled for the next node start.
+ * Ticket cache entries are invalidated after the DB update.
+ * 
+ * \param batch - ticket DB changes
+ * \param bSync - if true - sync DB writes to disk
+ * \return true if all changes were successfully written
+ */
+bool CPastelTicketProcessor::commitDBBatch(CTicketDBBatch &batch, const bool bSync)
+{
+    auto isTicketDB = [&](const CDBWrapper* pDB) -> bool
+    {
+        for (const auto& [id, pTicketDB] : dbs)
+        {
+            if (pTicketDB.get() == pDB)
+                return true;
+        }
+        return false;
+    };
+    bool bRet = true;
+    try
     {
-        CMutableTransaction mtx(tx);
-        ParseTicketAndUpdateDB(mtx, pBlockIndex->nHeight);
+        for (const bool bTicketDBs : { false, true })
+        {
+            for (auto& [pDB, pBatch] : batch.m_mapBatches)
+            {
+                if (isTicketDB(pDB) != bTicketDBs)
+                    continue;
+                if (!pDB->WriteBatch(*pBatch, bSync))
+                {
+                    bRet = false;
+                    break;
+                }
+            }
+            if (!bRet)
+                break;
+        }
+    } catch (const dbwrapper_error& e)
+    {
+        LogFnPrintf("ERROR: failed to write ticket DB changes. %s", e.what());
+        bRet = false;
+    }
+    batch.m_mapBatches.clear();
+    if (!bRet)
+    {
+        LogFnPrintf("ERROR: ticket DB changes were not written, ticket DB repair is scheduled for the next start");
+        ticket_db_repair_checkpoint_t checkpoint;
+        try
+        {
+            writeRepairCheckpoint(&checkpoint);
+        } catch (const dbwrapper_error& e)
+        {
+            LogFnPrintf("ERROR: failed to schedule ticket DB repair. %s", e.what());
+        }
     }
+    for (const auto& [id, sRealKey] : batch.m_vInvalidatedKeys)
+        m_TicketCache.Invalidate(id, sRealKey);
+    batch.m_vInvalidatedKeys.clear();
+    return bRet;
 }
 
-void CPastelTicketProcessor::UpdateDB_MVK(const CPastelTicket& ticket, const string& mvKey)
+/**
+ * Read ticket from the ticket DB by primary key.
+ * Ticket is returned from the ticket cache if found there, otherwise it's read from DB
+ * and added to the cache.
+ *
+ * \param db - ticket DB for the ticket type
+ * \param sKey - ticket primary key
+ * \param ticket - ticket object to return
+ * \return true if ticket was found
+ */
+bool CPastelTicketProcessor::readTicketFromDB(CDBWrapper& db, const string& sKey, CPastelTicket& ticket) const
+{
+    if (m_TicketCache.GetTicket(ticket.ID(), sKey, ticket))
+        return true;
+    const uint64_t nGeneration = m_TicketCache.GetGeneration();
+    if (!db.Read(sKey, ticket))
+        return false;
+    m_TicketCache.PutTicket(ticket, nGeneration);
+    return true;
+}
+
+/**
+ * Read primary keys from the ticket DB by real secondary key (@2@<keyTwo>)
+ * or real mv key (@M@<mvKey>) using ticket cache.
+ * Primary keys for the mv key are read with one prefix scan of the mv key records.
+ *
+ * \param id - ticket type
+ * \param db - ticket DB for the ticket type
+ * \param sRealKey - real secondary key or mv key
+ * \param vKeys - returns primary keys
+ * \return true if key was found
+ */
+bool CPastelTicketProcessor::readKeysFromDB(const TicketID id, CDBWrapper& db, const string& sRealKey, v_strings& vKeys) const
+{
+    vKeys.clear();
+    if (m_TicketCache.GetKeys(id, sRealKey, vKeys))
+        return true;
+    const uint64_t nGeneration = m_TicketCache.GetGeneration();
+    if (str_starts_with(sRealKey, TICKET_KEYTWO_PREFIX))
+    {
+        string sMainKey;
+        if (!db.Read(sRealKey, sMainKey))
+            return false;
+        vKeys.emplace_back(std::move(sMainKey));
+    } else
+    {
+        unique_ptr<CDBIterator> pcursor(db.NewIterator());
+        ticket_mvkey_t key(sRealKey, 0, 0, "");
+        for (pcursor->Seek(key); pcursor->Valid(); pcursor->Next())
+        {
+            if (!pcursor->GetKey(key) || (key.sRealMVKey != sRealKey))
+                break;
+            vKeys.emplace_back(std::move(key.sKeyOne));
+        }
+        if (vKeys.empty())
+            return false;
+    }
+    m_TicketCache.PutKeys(id, sRealKey, vKeys, nGeneration);
+    return true;
+}
+
+/**
+ * Find mv key records of the ticket added at the given block height.
+ * Transaction index of the stored ticket is not known, so all records
+ * for the mv key at this height are checked.
+ * 
+ * \param db - ticket DB
+ * \param sRealMVKey - real mv key (@M@<mvKey>)
+ * \param nHeight - ticket block height
+ * \param sKeyOne - ticket primary key
+ * \param vKeys - returns found mv key records
+ */
+void CPastelTicketProcessor::findMVKeyRecords(CDBWrapper& db, const string& sRealMVKey, const uint32_t nHeight,
+    const string& sKeyOne, vector<ticket_mvkey_t>& vKeys)
+{
+    unique_ptr<CDBIterator> pcursor(db.NewIterator());
+    ticket_mvkey_t key(sRealMVKey, nHeight, 0, "");
+    for (pcursor->Seek(key); pcursor->Valid(); pcursor->Next())
+    {
+        if (!pcursor->GetKey(key) || (key.sRealMVKey != sRealMVKey) || (key.nHeight != nHeight))
+            break;
+        if (key.sKeyOne == sKeyOne)
+            vKeys.push_back(key);
+    }
+}
+
+void CPastelTicketProcessor::UpdateDB_MVK(const CPastelTicket& ticket, const string& mvKey, const uint32_t nTxIndex,
+    CTicketDBBatch &batch)
 {
-    v_strings mainKeys;
     const auto realMVKey = RealMVKey(mvKey);
     auto itDB = dbs.find(ticket.ID());
     if (itDB == dbs.end())
         return;
-    itDB->second->Read(realMVKey, mainKeys);
-    if (find(mainKeys.cbegin(), mainKeys.cend(), ticket.KeyOne()) == mainKeys.cend())
-    {
-        mainKeys.emplace_back(ticket.KeyOne());
-        itDB->second->Write(realMVKey, mainKeys, true);
-    }
+    // mv key record is the same for the same ticket, so it can be safely overwritten
+    batch.Get(*itDB->second).Write(ticket_mvkey_t(realMVKey, ticket.GetBlock(), nTxIndex, ticket.KeyOne()), uint8_t(0));
+    batch.Invalidate(ticket.ID(), realMVKey);
 }
 
-bool CPastelTicketProcessor::UpdateDB(CPastelTicket &ticket, string& txid, const unsigned int nBlockHeight)
+/**
+ * Add ticket to the ticket DB.
+ * 
+ * \param ticket - ticket to add
+ * \param txid - ticket transaction id (moved to the ticket if not empty)
+ * \param nBlockHeight - ticket block height
+ * \param pBatch - if not nullptr - DB changes are added to the batch and written by the caller,
+ *                 otherwise changes are written immediately
+ * \param nTxIndex - ticket transaction index in the block
+ * \return true if ticket was added to the DB
+ */
+bool CPastelTicketProcessor::UpdateDB(CPastelTicket &ticket, string& txid, const unsigned int nBlockHeight, CTicketDBBatch *pBatch,
+    const uint32_t nTxIndex)
 {
     if (!txid.empty())
         ticket.SetTxId(std::move(txid));
@@ -175,17 +775,55 @@ bool CPastelTicketProcessor::UpdateDB(CPastelTicket &ticket, string& txid, const
     auto itDB = dbs.find(ticket.ID());
     if (itDB == dbs.end())
         return false;
-    itDB->second->Write(ticket.KeyOne(), ticket, true);
+    CTicketDBBatch localBatch;
+    CTicketDBBatch &batch = pBatch ? *pBatch : localBatch;
+    auto &dbBatch = batch.Get(*itDB->second);
+    // primary key can be reused by the ticket from another block or another transaction -
+    // remove height index and mv key records of the stored ticket, they include its block height and tx index
+    auto pStoredTicket = CreateTicket(ticket.ID());
+    if (pStoredTicket && readTicketFromDB(*itDB->second, ticket.KeyOne(), *pStoredTicket))
+    {
+        const uint32_t nStoredHeight = pStoredTicket->GetBlock();
+        if (m_pHeightIndexDB && (nStoredHeight != ticket.GetBlock()))
+            batch.Get(*m_pHeightIndexDB).Erase(ticket_height_index_key_t(ticket.ID(), nStoredHeight, ticket.KeyOne()));
+        v_strings vMVKeys;
+        if (pStoredTicket->HasMVKeyOne())
+            vMVKeys.emplace_back(pStoredTicket->MVKeyOne());
+        if (pStoredTicket->HasMVKeyTwo())
+            vMVKeys.emplace_back(pStoredTicket->MVKeyTwo());
+        if (pStoredTicket->HasMVKeyThree())
+            vMVKeys.emplace_back(pStoredTicket->MVKeyThree());
+        vector<ticket_mvkey_t> vStoredKeys;
+        for (const auto& sMVKey : vMVKeys)
+        {
+            const auto sRealMVKey = RealMVKey(sMVKey);
+            vStoredKeys.clear();
+            findMVKeyRecords(*itDB->second, sRealMVKey, nStoredHeight, ticket.KeyOne(), vStoredKeys);
+            for (const auto& key : vStoredKeys)
+                dbBatch.Erase(key);
+            batch.Invalidate(ticket.ID(), sRealMVKey);
+        }
+    }
+    dbBatch.Write(ticket.KeyOne(), ticket);
+    batch.Invalidate(ticket.ID(), ticket.KeyOne());
+    if (m_pHeightIndexDB)
+        batch.Get(*m_pHeightIndexDB).Write(ticket_height_index_key_t(ticket.ID(), ticket.GetBlock(), ticket.KeyOne()), uint8_t(0));
     if (ticket.HasKeyTwo())
-        itDB->second->Write(RealKeyTwo(ticket.KeyTwo()), ticket.KeyOne(), true);
+    {
+        const auto sRealKeyTwo = RealKeyTwo(ticket.KeyTwo());
+        dbBatch.Write(sRealKeyTwo, ticket.KeyOne());
+        batch.Invalidate(ticket.ID(), sRealKeyTwo);
+    }
 
     if (ticket.HasMVKeyOne())
-        UpdateDB_MVK(ticket, ticket.MVKeyOne());
+        UpdateDB_MVK(ticket, ticket.MVKeyOne(), nTxIndex, batch);
     if (ticket.HasMVKeyTwo())
-        UpdateDB_MVK(ticket, ticket.MVKeyTwo());
+        UpdateDB_MVK(ticket, ticket.MVKeyTwo(), nTxIndex, batch);
     if (ticket.HasMVKeyThree())
-        UpdateDB_MVK(ticket, ticket.MVKeyThree());
-        
+        UpdateDB_MVK(ticket, ticket.MVKeyThree(), nTxIndex, batch);
+
+    if (!pBatch)
+        return commitDBBatch(localBatch, true);
     //LogFnPrintf("tickets", "Ticket added into DB with key %s (txid - %s)", ticket.KeyOne(), ticket.ticketTnx);
     return true;
 }
@@ -564,51 +1202,154 @@ ticket_validation_t CPastelTicketProcessor::ValidateIfTicketTransaction(CValidat
     return tv;
 }
 
-bool CPastelTicketProcessor::ParseTicketAndUpdateDB(CMutableTransaction& tx, const unsigned int nBlockHeight)
+/**
+ * Parse ticket from the P2FMS transaction.
+ * 
+ * \param tx - ticket transaction
+ * \param parsedTicket - returns parsed ticket
+ * \param error - returns error if transaction is a ticket transaction, but ticket cannot be parsed
+ * \return true if ticket was successfully parsed, false if this is not a ticket or ticket is invalid
+ */
+bool CPastelTicketProcessor::parseTicketTransaction(const CMutableTransaction& tx, parsed_ticket_t &parsedTicket, string &error)
 {
-    string error_ret;
     CCompressedDataStream data_stream(SER_NETWORK, DATASTREAM_VERSION);
     TicketID ticket_id;
     uint32_t nMultiSigOutputsCount;
     CAmount nMultiSigTxTotalFee;
 
-    if (!preParseTicket(tx, data_stream, ticket_id, error_ret, 
+    error.clear();
+    string sPreParseError;
+    if (!preParseTicket(tx, data_stream, ticket_id, sPreParseError, 
         nMultiSigOutputsCount, nMultiSigTxTotalFee))
         return false;
 
     try
     {
-        string txid = tx.GetHash().GetHex();
-
-        LogFnPrintf("Processing ticket ['%s', txid=%s, nBlockHeight=%u]",
-            GetTicketDescription(ticket_id), txid, nBlockHeight);
-
         auto ticket = CreateTicket(ticket_id);
         if (!ticket)
-            error_ret = strprintf("unknown ticket type %hhu", to_integral_type<TicketID>(ticket_id));
-        else
         {
-            data_stream >> *ticket;
-            ticket->SetSerializedSize(data_stream.GetSavedDecompressedSize());
-            ticket->SetMultiSigOutputsCount(nMultiSigOutputsCount);
-            ticket->SetMultiSigTxTotalFee(nMultiSigTxTotalFee);
-            if (data_stream.IsCompressed())
-                ticket->SetCompressedSize(data_stream.GetSavedCompressedSize());           
-            return UpdateDB(*ticket, txid, nBlockHeight);
+            error = strprintf("unknown ticket type %hhu", to_integral_type<TicketID>(ticket_id));
+            return false;
         }
+        data_stream >> *ticket;
+        ticket->SetSerializedSize(data_stream.GetSavedDecompressedSize());
+        ticket->SetMultiSigOutputsCount(nMultiSigOutputsCount);
+        ticket->SetMultiSigTxTotalFee(nMultiSigTxTotalFee);
+        if (data_stream.IsCompressed())
+            ticket->SetCompressedSize(data_stream.GetSavedCompressedSize());
+        parsedTicket.ticket = std::move(ticket);
+        parsedTicket.hashTx = tx.GetHash();
+        parsedTicket.nMultiSigOutputsCount = nMultiSigOutputsCount;
+        parsedTicket.nMultiSigTxTotalFee = nMultiSigTxTotalFee;
+        return true;
     }
     catch (const exception& ex)
     {
-        error_ret = strprintf("Failed to parse and unpack ticket - %s", ex.what());
+        error = strprintf("Failed to parse and unpack ticket - %s", ex.what());
     }
     catch (...)
     {
-        error_ret = "Failed to parse and unpack ticket - Unknown exception";
+        error = "Failed to parse and unpack ticket - Unknown exception";
     }
+    error = strprintf("Invalid ticket ['%s', txid=%s]. ERROR: %s", 
+        GetTicketDescription(ticket_id), tx.GetHash().GetHex(), error);
+    return false;
+}
 
-    LogFnPrintf("Invalid ticket ['%s', txid=%s, nBlockHeight=%u]. ERROR: %s", 
-        GetTicketDescription(ticket_id), tx.GetHash().GetHex(), nBlockHeight, error_ret);
+/**
+ * Create txid index record for the parsed ticket.
+ *
+ * \param parsedTicket - ticket parsed from the transaction
+ * \param nBlockHeight - ticket block height
+ * \param hashBlock - ticket block hash
+ * \return txid index record
+ */
+ticket_txid_index_t CPastelTicketProcessor::createTxIdIndex(const parsed_ticket_t &parsedTicket, const uint32_t nBlockHeight,
+    const uint256 &hashBlock)
+{
+    const auto &ticket = parsedTicket.ticket;
+    ticket_txid_index_t txIndex;
+    txIndex.ticket_id = ticket->ID();
+    txIndex.sKeyOne = ticket->KeyOne();
+    txIndex.nHeight = nBlockHeight;
+    txIndex.hashBlock = hashBlock;
+    txIndex.nSerializedSize = static_cast<uint32_t>(ticket->GetSerializedSize());
+    txIndex.nCompressedSize = static_cast<uint32_t>(ticket->GetCompressedSize());
+    txIndex.nMultiSigOutputsCount = parsedTicket.nMultiSigOutputsCount;
+    txIndex.nMultiSigTxTotalFee = parsedTicket.nMultiSigTxTotalFee;
+    return txIndex;
+}
+
+/**
+ * Add parsed ticket to the ticket DB.
+ * If block hash is defined - ticket is also added to the txid index.
+ * 
+ * \param parsedTicket - ticket parsed from the transaction
+ * \param nBlockHeight - ticket block height
+ * \param hashBlock - ticket block hash
+ * \param pBatch - if not nullptr - ticket DB changes are added to the batch and written by the caller
+ * \return true if ticket was added to the ticket DB
+ */
+bool CPastelTicketProcessor::addTicketToDB(parsed_ticket_t &parsedTicket, const unsigned int nBlockHeight,
+    const uint256 &hashBlock, CTicketDBBatch *pBatch)
+{
+    auto &ticket = parsedTicket.ticket;
+    if (!ticket)
+        return false;
+    string txid = parsedTicket.hashTx.GetHex();
+    if (!UpdateDB(*ticket, txid, nBlockHeight, pBatch, parsedTicket.nTxIndex))
+        return false;
+    if (m_pTxIdIndexDB && !hashBlock.IsNull())
+    {
+        const auto txIndex = createTxIdIndex(parsedTicket, nBlockHeight, hashBlock);
+        if (pBatch)
+            pBatch->Get(*m_pTxIdIndexDB).Write(parsedTicket.hashTx, txIndex);
+        else
+            m_pTxIdIndexDB->Write(parsedTicket.hashTx, txIndex, true);
+    }
+    if (ticket->ID() == TicketID::NFT)
+    {
+        nft_search_attr_t attr;
+        json jApp;
+        updateNFTSearchAttributes(*ticket, attr, jApp);
+    }
+    return true;
+}
 
+/**
+ * Parse ticket transaction and add ticket to the ticket DB.
+ * If block hash is defined - ticket is also added to the txid index.
+ *
+ * \param tx - ticket transaction
+ * \param nBlockHeight - ticket block height
+ * \param hashBlock - ticket block hash
+ * \param pBatch - if not nullptr - ticket DB changes are added to the batch and written by the caller
+ * \param nTxIndex - ticket transaction index in the block
+ * \return true if ticket was added to the ticket DB
+ */
+bool CPastelTicketProcessor::ParseTicketAndUpdateDB(CMutableTransaction& tx, const unsigned int nBlockHeight, const uint256 &hashBlock,
+    CTicketDBBatch *pBatch, const uint32_t nTxIndex)
+{
+    string error;
+    parsed_ticket_t parsedTicket;
+    if (!parseTicketTransaction(tx, parsedTicket, error))
+    {
+        if (!error.empty())
+            LogFnPrintf("%s, nBlockHeight=%u", error, nBlockHeight);
+        return false;
+    }
+    parsedTicket.nTxIndex = nTxIndex;
+    LogFnPrintf("Processing ticket ['%s', txid=%s, nBlockHeight=%u]",
+        GetTicketDescription(parsedTicket.ticket->ID()), parsedTicket.hashTx.GetHex(), nBlockHeight);
+    try
+    {
+        return addTicketToDB(parsedTicket, nBlockHeight, hashBlock, pBatch);
+    }
+    catch (const exception& ex)
+    {
+        LogFnPrintf("ERROR: failed to add ticket [txid=%s, nBlockHeight=%u] to DB. %s",
+            parsedTicket.hashTx.GetHex(), nBlockHeight, ex.what());
+    }
     return false;
 }
 
@@ -642,8 +1383,45 @@ bool CPastelTicketProcessor::SerializeTicketToStream(const uint256& txid, string
     return true;
 }
 
+/**
+ * Read ticket from the ticket DB using txid index.
+ * Returns false if ticket txid is not indexed or ticket DB has a ticket
+ * with the same primary key registered by another transaction.
+ *
+ * \param txid - ticket transaction id
+ * \param ticket - returns ticket
+ * \param txIndex - returns txid index record
+ * \return true if ticket was found
+ */
+bool CPastelTicketProcessor::readTicketByTxId(const uint256& txid, PastelTicketPtr& ticket, ticket_txid_index_t& txIndex) const
+{
+    if (!m_pTxIdIndexDB)
+        return false;
+    if (!m_pTxIdIndexDB->Read(txid, txIndex))
+        return false;
+    const auto itDB = dbs.find(txIndex.ticket_id);
+    if (itDB == dbs.cend())
+        return false;
+    auto pTicket = CreateTicket(txIndex.ticket_id);
+    if (!pTicket)
+        return false;
+    if (!readTicketFromDB(*itDB->second, txIndex.sKeyOne, *pTicket))
+        return false;
+    // primary key can be reused by the newer ticket
+    if (!pTicket->IsTxId(txid.GetHex()))
+        return false;
+    pTicket->SetSerializedSize(txIndex.nSerializedSize);
+    pTicket->SetCompressedSize(txIndex.nCompressedSize);
+    pTicket->SetMultiSigOutputsCount(txIndex.nMultiSigOutputsCount);
+    pTicket->SetMultiSigTxTotalFee(txIndex.nMultiSigTxTotalFee);
+    ticket = std::move(pTicket);
+    return true;
+}
+
 /**
  * Get Pastel ticket by transaction id (txid).
+ * Ticket is read from the ticket DB using txid index if possible, otherwise
+ * ticket transaction is read and parsed.
  * May throw runtime_error exception in case:
  *  - transaction not found by txid
  *  - failed to parse ticket transaction
@@ -657,6 +1435,32 @@ bool CPastelTicketProcessor::SerializeTicketToStream(const uint256& txid, string
 PastelTicketPtr CPastelTicketProcessor::GetTicket(const uint256 &txid, uint256* pBlockHash,
     const CBlockIndex *pindexPrev)
 {
+    {
+        PastelTicketPtr ticket;
+        ticket_txid_index_t txIndex;
+        if (masterNodeCtrl.masternodeTickets.readTicketByTxId(txid, ticket, txIndex))
+        {
+            LOCK(cs_main);
+            // use indexed ticket only if its block is still in the active chain
+            const auto mi = mapBlockIndex.find(txIndex.hashBlock);
+            const CBlockIndex* pindex = (mi != mapBlockIndex.cend()) ? mi->second : nullptr;
+            if (pindex && chainActive.Contains(pindex))
+            {
+                if (pBlockHash)
+                    *pBlockHash = txIndex.hashBlock;
+                // if pindexPrev is defined - check if ticket is in the same branch as pindexPrev
+                if (pindexPrev && (pindexPrev->GetAncestor(pindex->nHeight) != pindex))
+                {
+                    LogFnPrintf("Ticket with txid=%s (height=%d) is in the active chain, but accessed from the forked chain on height=%d",
+                        txid.GetHex(), pindex->nHeight, pindexPrev->nHeight);
+                    return nullptr;
+                }
+                ticket->SetBlock(pindex->nHeight);
+                return ticket;
+            }
+        }
+    }
+
     string error;
     ticket_parse_data_t data;
     if (!SerializeTicketToStream(txid, error, data, true))
@@ -760,6 +1564,10 @@ EraseTicketResult CPastelTicketProcessor::EraseIfTicketTransaction(const uint256
 
     // deserialize data to ticket object
     data.data_stream >> *ticket;
+    if (m_pTxIdIndexDB)
+        m_pTxIdIndexDB->Erase(txid);
+    if (data.ticket_id == TicketID::NFT)
+        eraseNFTSearchAttributes(*ticket);
     if (!EraseTicketFromDB(error, *ticket))
     {
         error = strprintf("Failed to erase ticket from DB by txid=%s. %s", txid.GetHex(), error);
@@ -781,16 +1589,20 @@ bool CPastelTicketProcessor::CheckTicketExist(const CPastelTicket& ticket, const
     const auto itDB = dbs.find(ticket.ID());
     if (itDB == dbs.cend())
         return false;
-    if (!itDB->second->Exists(key))
+    uint32_t nExistingTicketBlockHeight = 0;
+    const bool bCached = m_TicketCache.HasTicket(ticket.ID(), key, nExistingTicketBlockHeight);
+    if (!bCached && !itDB->second->Exists(key))
         return false;
 
     if (pindexPrev)
     {
-        auto existingTicket = CreateTicket(ticket.ID());
-        bool bRet = itDB->second->Read(ticket.KeyOne(), *existingTicket);
-        if (!bRet)
-            return false;
-        const uint32_t nExistingTicketBlockHeight = existingTicket->GetBlock();
+        if (!bCached)
+        {
+            auto existingTicket = CreateTicket(ticket.ID());
+            if (!readTicketFromDB(*itDB->second, key, *existingTicket))
+                return false;
+            nExistingTicketBlockHeight = existingTicket->GetBlock();
+        }
         if (nExistingTicketBlockHeight == numeric_limits<uint32_t>::max())
 			return false;
         if (nExistingTicketBlockHeight > gl_nChainHeight)
@@ -816,22 +1628,27 @@ bool CPastelTicketProcessor::CheckTicketExistBySecondaryKey(const CPastelTicket&
     if (!ticket.HasKeyTwo())
         return false;
 
-    string mainKey;
+    v_strings vMainKeys;
     const auto sRealKeyTwo = RealKeyTwo(ticket.KeyTwo());
     const auto itDB = dbs.find(ticket.ID());
     if (itDB == dbs.cend())
         return false;
-    if (!itDB->second->Read(sRealKeyTwo, mainKey))
+    if (!readKeysFromDB(ticket.ID(), *itDB->second, sRealKeyTwo, vMainKeys) || vMainKeys.empty())
         return false;
-    if (!itDB->second->Exists(mainKey))
+    const string &mainKey = vMainKeys.front();
+    uint32_t nExistingTicketBlockHeight = 0;
+    const bool bCached = m_TicketCache.HasTicket(ticket.ID(), mainKey, nExistingTicketBlockHeight);
+    if (!bCached && !itDB->second->Exists(mainKey))
         return false;
     if (pindexPrev)
     {
-        auto existingTicket = CreateTicket(ticket.ID());
-        bool bRet = itDB->second->Read(mainKey, *existingTicket);
-        if (!bRet)
-			return false;
-        const uint32_t nExistingTicketBlockHeight = existingTicket->GetBlock();
+        if (!bCached)
+        {
+            auto existingTicket = CreateTicket(ticket.ID());
+            if (!readTicketFromDB(*itDB->second, mainKey, *existingTicket))
+                return false;
+            nExistingTicketBlockHeight = existingTicket->GetBlock();
+        }
         if (nExistingTicketBlockHeight == numeric_limits<uint32_t>::max())
 			return false;
         if (nExistingTicketBlockHeight > gl_nChainHeight)
@@ -860,7 +1677,7 @@ bool CPastelTicketProcessor::FindTicket(CPastelTicket& ticket, const CBlockIndex
     const auto itDB = dbs.find(ticket.ID());
     if (itDB == dbs.cend())
         return false;
-    bool bRet = itDB->second->Read(sKey, ticket);
+    bool bRet = readTicketFromDB(*itDB->second, sKey, ticket);
     if (bRet)
     do 
     {
@@ -905,7 +1722,36 @@ bool CPastelTicketProcessor::EraseTicketFromDB(string &error, const CPastelTicke
         return false;
     }
     const auto sKey = ticket.KeyOne();
-    return itDB->second->Erase(sKey);
+    // height index and mv key records are created using block height of the stored ticket
+    uint32_t nStoredHeight = ticket.GetBlock();
+    auto pStoredTicket = CreateTicket(ticket.ID());
+    if (pStoredTicket && readTicketFromDB(*itDB->second, sKey, *pStoredTicket))
+    {
+        nStoredHeight = pStoredTicket->GetBlock();
+        if (m_pHeightIndexDB)
+            m_pHeightIndexDB->Erase(ticket_height_index_key_t(ticket.ID(), nStoredHeight, sKey));
+    }
+    const bool bRet = itDB->second->Erase(sKey);
+    m_TicketCache.Invalidate(ticket.ID(), sKey);
+    // erase mv key records for this ticket
+    v_strings vMVKeys;
+    if (ticket.HasMVKeyOne())
+        vMVKeys.emplace_back(ticket.MVKeyOne());
+    if (ticket.HasMVKeyTwo())
+        vMVKeys.emplace_back(ticket.MVKeyTwo());
+    if (ticket.HasMVKeyThree())
+        vMVKeys.emplace_back(ticket.MVKeyThree());
+    vector<ticket_mvkey_t> vStoredKeys;
+    for (const auto& sMVKey : vMVKeys)
+    {
+        const auto sRealMVKey = RealMVKey(sMVKey);
+        vStoredKeys.clear();
+        findMVKeyRecords(*itDB->second, sRealMVKey, nStoredHeight, sKey, vStoredKeys);
+        for (const auto& key : vStoredKeys)
+            itDB->second->Erase(key);
+        m_TicketCache.Invalidate(ticket.ID(), sRealMVKey);
+    }
+    return bRet;
 }
 
 /**
@@ -919,10 +1765,12 @@ size_t CPastelTicketProcessor::EraseTicketsFromDbByList(const block_index_cvecto
     size_t nErasedCount = 0;
     string error;
     const auto &consensusParams = Params().GetConsensus();
+    uint32_t nMinHeight = numeric_limits<uint32_t>::max();
     for (const auto& pindex : vBlockIndex)
     {
         if (!pindex || !(pindex->nTx) || !(pindex->nStatus & BLOCK_HAVE_DATA))
             continue;
+        nMinHeight = min<uint32_t>(nMinHeight, static_cast<uint32_t>(pindex->nHeight));
         
         CBlock block;
         if (!ReadBlockFromDisk(block, pindex, consensusParams))
@@ -934,38 +1782,344 @@ size_t CPastelTicketProcessor::EraseTicketsFromDbByList(const block_index_cvecto
                 ++nErasedCount;
         }
 	}
+    // drop all cached tickets from the disconnected blocks
+    if (nMinHeight != numeric_limits<uint32_t>::max())
+        m_TicketCache.InvalidateFromHeight(nMinHeight);
     return nErasedCount;
 }
 
-void CPastelTicketProcessor::RepairTicketDB(const bool bUpdateUI)
+bool CPastelTicketProcessor::readRepairCheckpoint(ticket_db_repair_checkpoint_t &checkpoint) const
+{
+    const auto itDB = dbs.find(TicketID::PastelID);
+    if (itDB == dbs.cend())
+        return false;
+    return itDB->second->Read(string(TICKET_DB_REPAIR_KEY), checkpoint);
+}
+
+/**
+ * Check whether ticket DB repair was interrupted or scheduled after the ticket DB write failure.
+ * 
+ * \return true if ticket DB repair checkpoint exists
+ */
+bool CPastelTicketProcessor::IsRepairPending() const
+{
+    ticket_db_repair_checkpoint_t checkpoint;
+    return readRepairCheckpoint(checkpoint);
+}
+
+/**
+ * Write ticket DB repair checkpoint.
+ * 
+ * \param pCheckpoint - checkpoint to write, if nullptr - checkpoint is erased
+ */
+void CPastelTicketProcessor::writeRepairCheckpoint(const ticket_db_repair_checkpoint_t *pCheckpoint)
+{
+    const auto itDB = dbs.find(TicketID::PastelID);
+    if (itDB == dbs.cend())
+        return;
+    if (pCheckpoint)
+        itDB->second->Write(string(TICKET_DB_REPAIR_KEY), *pCheckpoint, true);
+    else
+        itDB->second->Erase(string(TICKET_DB_REPAIR_KEY), true);
+}
+
+/**
+ * Get ticket DB repair start height.
+ * Interrupted repair is resumed from the block next to the checkpoint
+ * if the checkpoint block is still in the active chain.
+ * 
+ * \param nTipHeight - active chain tip height
+ * \return block height to start ticket DB repair from
+ */
+uint32_t CPastelTicketProcessor::getRepairStartHeight(const uint32_t nTipHeight) const
 {
     AssertLockHeld(cs_main);
+    ticket_db_repair_checkpoint_t checkpoint;
+    if (!readRepairCheckpoint(checkpoint) || checkpoint.hashBlock.IsNull() || (checkpoint.nHeight >= nTipHeight))
+        return 1;
+    const auto pindexCheckpoint = chainActive[checkpoint.nHeight];
+    if (!pindexCheckpoint || (pindexCheckpoint->GetBlockHash() != checkpoint.hashBlock))
+        return 1;
+    return checkpoint.nHeight + 1;
+}
+
+/**
+ * Rebuild ticket DB from the blocks of the active chain.
+ * Blocks are read and tickets are parsed in parallel by the block scanner threads,
+ * parsed tickets are applied to the ticket DB by this thread in the block height order.
+ * Block scanner threads can run ahead of the applied block height by at most
+ * TICKET_DB_REPAIR_MAX_READY_BLOCKS blocks. If all scanner threads wait while the next
+ * block to apply is not read yet, blocks that are too far ahead are deferred -
+ * they are read by this thread when their turn comes.
+ * Tickets are applied under cs_main in batches of TICKET_DB_REPAIR_CHECKPOINT_BLOCKS blocks,
+ * cs_main is released between batches. Progress is saved to the ticket DB after each batch,
+ * interrupted repair is resumed from the last checkpoint.
+ * 
+ * \param bUpdateUI - if true - show repair progress in UI
+ */
+void CPastelTicketProcessor::RepairTicketDB(const bool bUpdateUI)
+{
+    AssertLockNotHeld(cs_main);
 
     string sMsg = translate("Repairing ticket database...");
     LogFnPrintf(sMsg);
     if (bUpdateUI)
         uiInterface.InitMessage(sMsg);
-    auto pindex = chainActive.Tip();
-    int nCount = 0;
-    int nTotal = pindex->nHeight;
-    int nLastPercentage = 0;
-    while (pindex && pindex != chainActive.Genesis())
+
+    // block disk position -> block height for all blocks to process
+    unordered_map<uint64_t, uint32_t> mapBlockHeights;
+    v_uint256 vBlockHashes;
+    vector<CDiskBlockPos> vBlockPos; // null position - block has no data
+    auto getBlockPosKey = [](const CDiskBlockPos &pos) -> uint64_t
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(pos.nFile)) << 32) | pos.nPos;
+    };
+    uint32_t nStartHeight = 1;
+    uint32_t nTipHeight = 0;
+    uint256 hashTip;
+    {
+        LOCK(cs_main);
+        const auto pindexTip = chainActive.Tip();
+        if (!pindexTip || (pindexTip->nHeight < 1))
+            return;
+        nTipHeight = static_cast<uint32_t>(pindexTip->nHeight);
+        hashTip = pindexTip->GetBlockHash();
+        nStartHeight = getRepairStartHeight(nTipHeight);
+        if (nStartHeight > 1)
+            LogFnPrintf("Resuming ticket database repair from height %u", nStartHeight);
+
+        const size_t nBlockCount = nTipHeight - nStartHeight + 1;
+        mapBlockHeights.reserve(nBlockCount);
+        vBlockHashes.resize(nBlockCount);
+        vBlockPos.resize(nBlockCount);
+        for (uint32_t nHeight = nStartHeight; nHeight <= nTipHeight; ++nHeight)
+        {
+            const auto pindex = chainActive[nHeight];
+            if (!pindex)
+                continue;
+            vBlockHashes[nHeight - nStartHeight] = pindex->GetBlockHash();
+            if (!(pindex->nStatus & BLOCK_HAVE_DATA))
+                continue;
+            vBlockPos[nHeight - nStartHeight] = pindex->GetBlockPos();
+            mapBlockHeights.emplace(getBlockPosKey(pindex->GetBlockPos()), nHeight);
+        }
+    }
+    const auto& consensusParams = Params().GetConsensus();
+
+    // tickets parsed by the block scanner threads
+    typedef struct _repair_block_t
+    {
+        bool bFailed = false;
+        bool bDeferred = false; // block was not read by the block scanner - too far ahead
+        uint256 hashBlock;
+        vector<parsed_ticket_t> vTickets;
+    } repair_block_t;
+    auto readRepairBlock = [&](const CDiskBlockPos &blockPos, const uint32_t nHeight, repair_block_t &repairBlock)
+    {
+        CBlock block;
+        if (!ReadBlockFromDisk(block, blockPos, consensusParams))
+        {
+            repairBlock.bFailed = true;
+            return;
+        }
+        string error;
+        repairBlock.hashBlock = block.GetHash();
+        for (uint32_t nTxIndex = 0; nTxIndex < block.vtx.size(); ++nTxIndex)
+        {
+            parsed_ticket_t parsedTicket;
+            if (parseTicketTransaction(CMutableTransaction(block.vtx[nTxIndex]), parsedTicket, error))
+            {
+                parsedTicket.nTxIndex = nTxIndex;
+                repairBlock.vTickets.emplace_back(std::move(parsedTicket));
+            }
+            else if (!error.empty())
+                LogFnPrintf("%s, nBlockHeight=%u", error, nHeight);
+        }
+    };
+    mutex mtxReady;
+    condition_variable cvReady; // notified when the block is added to mapReadyBlocks
+    condition_variable cvSpace; // notified when the next block height to apply is changed
+    map<uint32_t, repair_block_t> mapReadyBlocks; // block height -> parsed tickets
+    uint32_t nNextHeight = nStartHeight; // next block height to apply
+    size_t nActiveTasks = 0;  // number of running block scanner tasks
+    size_t nWaitingTasks = 0; // number of block scanner tasks waiting for the next block height to change
+    bool bDeferBlocks = false; // all scanner tasks wait for the block that is not read yet - defer blocks
+    bool bScanFinished = false;
+    atomic_bool bStopScan(false);
+
+    CBlockScanner blockScanner(vBlockHashes.front());
+    auto scanFuture = async(launch::async, [&]()
+    {
+        try
+        {
+            blockScanner.execute("tktrepair", [&](BlockScannerTask *pTask)
+            {
+                {
+                    unique_lock lck(mtxReady);
+                    ++nActiveTasks;
+                }
+                const size_t nEnd = min(pTask->nBlockOffsetIndexStart + pTask->nBlockOffsetIndexCount, pTask->vBlockOffsets.size());
+                for (size_t i = pTask->nBlockOffsetIndexStart; (i < nEnd) && !bStopScan; ++i)
+                {
+                    const CDiskBlockPos blockPos(pTask->nBlockFile, pTask->vBlockOffsets[i]);
+                    const auto it = mapBlockHeights.find(getBlockPosKey(blockPos));
+                    if (it == mapBlockHeights.cend())
+                        continue;
+                    const uint32_t nHeight = it->second;
+                    repair_block_t repairBlock;
+                    {
+                        // backpressure - wait until the block is close enough to the applied block height
+                        unique_lock lck(mtxReady);
+                        if (nHeight >= nNextHeight + TICKET_DB_REPAIR_MAX_READY_BLOCKS)
+                        {
+                            ++nWaitingTasks;
+                            cvReady.notify_one();
+                            cvSpace.wait(lck, [&]() { return bStopScan || bDeferBlocks ||
+                                (nHeight < nNextHeight + TICKET_DB_REPAIR_MAX_READY_BLOCKS); });
+                            --nWaitingTasks;
+                        }
+                        repairBlock.bDeferred = (nHeight >= nNextHeight + TICKET_DB_REPAIR_MAX_READY_BLOCKS);
+                    }
+                    if (!repairBlock.bDeferred)
+                        readRepairBlock(blockPos, nHeight, repairBlock);
+                    {
+                        unique_lock lck(mtxReady);
+                        mapReadyBlocks.emplace(nHeight, std::move(repairBlock));
+                    }
+                    cvReady.notify_one();
+                }
+                {
+                    unique_lock lck(mtxReady);
+                    --nActiveTasks;
+                }
+                cvReady.notify_one();
+            });
+        } catch (const exception& ex)
+        {
+            LogFnPrintf("ERROR: ticket database repair block scanner failed. %s", ex.what());
+        }
+        {
+            unique_lock lck(mtxReady);
+            bScanFinished = true;
+        }
+        cvReady.notify_one();
+    });
+
+    // apply tickets of the parsed blocks to the ticket DB under cs_main,
+    // returns false if the repaired blocks are no longer in the active chain or ticket DB write failed
+    CTicketDBBatch batch;
+    vector<pair<uint32_t, repair_block_t>> vBatchBlocks;
+    ticket_db_repair_checkpoint_t checkpoint;
+    checkpoint.nHeight = nStartHeight - 1;
+    size_t nTicketCount = 0;
+    auto applyBatch = [&]() -> bool
+    {
+        if (vBatchBlocks.empty())
+            return true;
+        LOCK(cs_main);
+        const auto pindexTip = chainActive[nTipHeight];
+        if (!pindexTip || (pindexTip->GetBlockHash() != hashTip))
+        {
+            LogFnPrintf("WARNING: active chain was reorganized during ticket database repair");
+            return false;
+        }
+        for (auto& [nHeight, repairBlock] : vBatchBlocks)
+        {
+            for (auto& parsedTicket : repairBlock.vTickets)
+            {
+                if (addTicketToDB(parsedTicket, nHeight, repairBlock.hashBlock, &batch))
+                    ++nTicketCount;
+            }
+        }
+        const bool bRet = commitDBBatch(batch, true);
+        if (bRet)
+        {
+            checkpoint.nHeight = vBatchBlocks.back().first;
+            checkpoint.hashBlock = vBatchBlocks.back().second.hashBlock;
+            writeRepairCheckpoint(&checkpoint);
+        }
+        vBatchBlocks.clear();
+        return bRet;
+    };
+
+    // collect parsed blocks in the block height order
+    uint32_t nLastPercentage = 0;
+    uint32_t nHeight = nStartHeight;
+    const uint32_t nTotal = nTipHeight - nStartHeight + 1;
+    bool bBatchFailed = false;
+    for (; nHeight <= nTipHeight; ++nHeight)
     {
-        if (pindex->nStatus & BLOCK_HAVE_DATA)
+        const size_t nIndex = nHeight - nStartHeight;
+        repair_block_t repairBlock;
+        if (!vBlockPos[nIndex].IsNull())
         {
-            UpdatedBlockTip(pindex, false);
+            {
+                unique_lock lck(mtxReady);
+                auto isReady = [&]() { return bScanFinished || (mapReadyBlocks.count(nHeight) > 0); };
+                cvReady.wait(lck, [&]() { return isReady() || (nActiveTasks && (nWaitingTasks == nActiveTasks)); });
+                if (!isReady())
+                {
+                    // all scanner tasks wait for the blocks too far ahead - let them defer these blocks
+                    bDeferBlocks = true;
+                    cvSpace.notify_all();
+                    cvReady.wait(lck, isReady);
+                    bDeferBlocks = false;
+                }
+                auto it = mapReadyBlocks.find(nHeight);
+                if (it == mapReadyBlocks.end())
+                {
+                    LogFnPrintf("ERROR: block at height %u was not read by the block scanner", nHeight);
+                    break;
+                }
+                repairBlock = std::move(it->second);
+                mapReadyBlocks.erase(it);
+                nNextHeight = nHeight + 1;
+            }
+            cvSpace.notify_all();
+            if (repairBlock.bDeferred)
+                readRepairBlock(vBlockPos[nIndex], nHeight, repairBlock);
+            if (repairBlock.bFailed)
+            {
+                LogFnPrintf("ERROR: Can't read block at height %u from disk", nHeight);
+                break;
+            }
+        } else
+            repairBlock.hashBlock = vBlockHashes[nIndex];
+        vBatchBlocks.emplace_back(nHeight, std::move(repairBlock));
 
-            int nCurrentPercentage = (nCount * 100) / nTotal;
-            if (bUpdateUI && (nCurrentPercentage != nLastPercentage))
+        if (vBatchBlocks.size() >= TICKET_DB_REPAIR_CHECKPOINT_BLOCKS)
+        {
+            if (!applyBatch())
             {
-                uiInterface.InitMessage(strprintf("Repairing ticket database %d%% ...", nCurrentPercentage));
-                nLastPercentage = nCurrentPercentage;
+                bBatchFailed = true;
+                break;
             }
         }
-        pindex = pindex->pprev;
-        ++nCount;
+        const uint32_t nCurrentPercentage = ((nIndex + 1) * 100) / nTotal;
+        if (nCurrentPercentage != nLastPercentage)
+        {
+            if (bUpdateUI)
+                uiInterface.InitMessage(strprintf("Repairing ticket database %u%% ...", nCurrentPercentage));
+            if (nCurrentPercentage % 10 == 0)
+                LogFnPrintf("Repairing ticket database %u%% (height %u, %zu tickets)", nCurrentPercentage, nHeight, nTicketCount);
+            nLastPercentage = nCurrentPercentage;
+        }
+    }
+    {
+        unique_lock lck(mtxReady);
+        bStopScan = true;
     }
-    LogFnPrintf("Ticket database has been repaired");
+    cvSpace.notify_all();
+    scanFuture.wait();
+
+    if (!bBatchFailed && applyBatch() && (nHeight > nTipHeight))
+    {
+        // repair is finished
+        LOCK(cs_main);
+        writeRepairCheckpoint(nullptr);
+        LogFnPrintf("Ticket database has been repaired (%zu tickets)", nTicketCount);
+    } else
+        LogFnPrintf("ERROR: ticket database repair stopped at height %u, it will be resumed on the next repair", checkpoint.nHeight);
     if (bUpdateUI)
 		uiInterface.ShowProgress(translate("Repaired Ticket Database..."), 100);
 }
@@ -984,7 +2138,7 @@ bool CPastelTicketProcessor::FindTicketBySecondaryKey(CPastelTicket& ticket, con
     if (!ticket.HasKeyTwo())
         return false;
 
-    string sMainKey;
+    v_strings vMainKeys;
     // get real secondary key: @2@ + key
     const auto sRealKeyTwo = RealKeyTwo(ticket.KeyTwo());
     // find in DB record: <real_secondary_key> -> <primary_key>
@@ -995,10 +2149,10 @@ bool CPastelTicketProcessor::FindTicketBySecondaryKey(CPastelTicket& ticket, con
         if (itDB == dbs.cend())
             break;
         
-        if (!itDB->second->Read(sRealKeyTwo, sMainKey))
+        if (!readKeysFromDB(ticket.ID(), *itDB->second, sRealKeyTwo, vMainKeys) || vMainKeys.empty())
             break;
 
-        if (!itDB->second->Read(sMainKey, ticket))
+        if (!readTicketFromDB(*itDB->second, vMainKeys.front(), ticket))
             break;
 
         if (ticket.IsBlockNewerThan(gl_nChainHeight))
@@ -1048,14 +2202,14 @@ vector<_TicketType> CPastelTicketProcessor::FindTicketsByMVKey(const string& mvK
     // get DB for the given ticket type
     const auto itDB = dbs.find(_TicketType::GetID());
     // find primary keys of the tickets with mvKey
-    if (itDB != dbs.cend() && itDB->second->Read(realMVKey, vMainKeys))
+    if (itDB != dbs.cend() && readKeysFromDB(_TicketType::GetID(), *itDB->second, realMVKey, vMainKeys))
     {
         const uint32_t nCurrentChainHeight = gl_nChainHeight;
         // read all tickets
         for (const auto& key : vMainKeys)
         {
             _TicketType ticket;
-            if (itDB->second->Read(key, ticket) && !ticket.IsBlockNewerThan(nCurrentChainHeight))
+            if (readTicketFromDB(*itDB->second, key, ticket) && !ticket.IsBlockNewerThan(nCurrentChainHeight))
             {
                 // check if this ticket is in the same chain as pindexPrev
                 if (pindexPrev)
@@ -1070,6 +2224,11 @@ vector<_TicketType> CPastelTicketProcessor::FindTicketsByMVKey(const string& mvK
                 tickets.emplace_back(ticket);
             }
         }
+        // mv key records are ordered by primary key - return tickets in the registration order
+        stable_sort(tickets.begin(), tickets.end(), [](const _TicketType& a, const _TicketType& b)
+            {
+                return a.GetBlock() < b.GetBlock();
+            });
     }
     return tickets;
 }
@@ -1091,8 +2250,9 @@ string CPastelTicketProcessor::getValueBySecondaryKey(const CPastelTicket& ticke
         const auto sRealKeyTwo = RealKeyTwo(ticket.KeyTwo());
         // find in DB record: <real_secondary_key> -> <primary_key>
         const auto itDB = dbs.find(ticket.ID());
-        if (itDB != dbs.cend())
-            itDB->second->Read(sRealKeyTwo, sMainKey);
+        v_strings vMainKeys;
+        if (itDB != dbs.cend() && readKeysFromDB(ticket.ID(), *itDB->second, sRealKeyTwo, vMainKeys) && !vMainKeys.empty())
+            sMainKey = std::move(vMainKeys.front());
     }
     return sMainKey;
 }
@@ -1132,70 +2292,6 @@ v_strings CPastelTicketProcessor::GetAllKeys(const TicketID id) const
     return vResults;
 }
 
-template <TicketID>
-struct TicketTypeMapper;
-
-template <> struct TicketTypeMapper<TicketID::PastelID>
-{
-	using TicketType = CPastelIDRegTicket;
-};
-template <> struct TicketTypeMapper<TicketID::NFT>
-{
-	using TicketType = CNFTRegTicket;
-};
-template <> struct TicketTypeMapper<TicketID::Activate>
-{
-	using TicketType = CNFTActivateTicket;
-};
-template <> struct TicketTypeMapper<TicketID::Offer>
-{
-	using TicketType = COfferTicket;
-};
-template <> struct TicketTypeMapper<TicketID::Accept>
-{
-	using TicketType = CAcceptTicket;
-};
-template <> struct TicketTypeMapper<TicketID::Transfer>
-{
-	using TicketType = CTransferTicket;
-};
-template <> struct TicketTypeMapper<TicketID::Down>
-{
-	using TicketType = CTakeDownTicket;
-};
-template <> struct TicketTypeMapper<TicketID::Royalty>
-{
-	using TicketType = CNFTRoyaltyTicket;
-};
-template <> struct TicketTypeMapper<TicketID::Username>
-{
-	using TicketType = CChangeUsernameTicket;
-};
-template <> struct TicketTypeMapper<TicketID::EthereumAddress>
-{
-	using TicketType = CChangeEthereumAddressTicket;
-};
-template <> struct TicketTypeMapper<TicketID::ActionReg>
-{
-	using TicketType = CActionRegTicket;
-};
-template <> struct TicketTypeMapper<TicketID::ActionActivate>
-{
-	using TicketType = CActionActivateTicket;
-};
-template <> struct TicketTypeMapper<TicketID::CollectionReg>
-{
-	using TicketType = CollectionRegTicket;
-};
-template <> struct TicketTypeMapper<TicketID::CollectionAct>
-{
-	using TicketType = CollectionActivateTicket;
-};
-template <> struct TicketTypeMapper<TicketID::Contract>
-{
-	using TicketType = CContractTicket;
-};
-
 template <TicketID ID>
 bool ReadTicketFromDB(unique_ptr<CDBIterator>& pcursor, string& sKey, PastelTicketPtr &ticket)
 {
@@ -1203,8 +2299,8 @@ bool ReadTicketFromDB(unique_ptr<CDBIterator>& pcursor, string& sKey, PastelTick
     typename TicketTypeMapper<ID>::TicketType dbTicket;
     if (pcursor->GetKey(sKey))
     {
-        if (str_starts_with(sKey, TICKET_KEYTWO_PREFIX) || 
-            str_starts_with(sKey, TICKET_MVKEY_PREFIX))
+        // skip secondary keys (@2@), mv keys (@M@) and DB version (@V@)
+        if (sKey.empty() || (sKey.front() == '@'))
         {
             sKey.clear();
             return false;
@@ -1348,59 +2444,127 @@ bool CPastelTicketProcessor::ProcessAllTickets(TicketID id, process_ticket_data_
 
 /**
  * Apply functor F for all tickets with type _TicketType.
+ * Tickets are always enumerated in block height order (then by primary key) using the height index,
+ * so the paging does not depend on nMinHeight.
+ * Only if the height index is not available - tickets are decoded in one forward scan
+ * of the ticket DB in primary key order, secondary and mv keys are skipped.
  * 
  * \param f - functor to apply
  *      if functor returns false - enumerations will be stopped
+ * \param nMinHeight - minimal block height of the tickets to enumerate
  */
 template <class _TicketType, typename F>
 void CPastelTicketProcessor::listTickets(F f, const uint32_t nMinHeight) const
 {
-    auto vKeys = GetAllKeys(_TicketType::GetID());
-    for (auto& key : vKeys)
+    const auto itDB = dbs.find(_TicketType::GetID());
+    if (itDB == dbs.cend())
+        return;
+    if (m_pHeightIndexDB && isIndexBuilt(TICKET_HEIGHTIDX_DB_SUBFOLDER))
+    {
+        listTicketsByHeight<_TicketType>(f, *itDB->second, nMinHeight);
+        return;
+    }
+    unique_ptr<CDBIterator> pcursor(itDB->second->NewIterator());
+    string sKey;
+    for (pcursor->SeekToFirst(); pcursor->Valid(); pcursor->Next())
     {
-        if (key.front() == '@')
+        sKey.clear();
+        // skip secondary keys (@2@) and mv keys (@M@)
+        if (!pcursor->GetKey(sKey) || sKey.empty() || (sKey.front() == '@'))
             continue;
         _TicketType ticket;
-        ticket.SetKeyOne(std::move(key));
-        if (!FindTicket(ticket))
+        ticket.SetKeyOne(std::move(sKey));
+        if (!pcursor->GetValue(ticket))
             continue;
-        if (ticket.GetBlock() < nMinHeight)
+        if ((ticket.GetBlock() < nMinHeight) || ticket.IsBlockNewerThan(gl_nChainHeight))
             continue;
         if (!f(ticket))
             break;
     }
 }
 
-template <class _TicketType>
-string CPastelTicketProcessor::ListTickets(const uint32_t nMinHeight) const
+/**
+ * Apply functor F for all tickets with type _TicketType registered at nMinHeight or above.
+ * Uses height index to find tickets, tickets are enumerated in block height order,
+ * tickets registered at the same height - in primary key order.
+ * 
+ * \param f - functor to apply
+ *      if functor returns false - enumerations will be stopped
+ * \param db - ticket DB for the _TicketType
+ * \param nMinHeight - minimal block height of the tickets to enumerate
+ */
+template <class _TicketType, typename F>
+void CPastelTicketProcessor::listTicketsByHeight(F f, CDBWrapper& db, const uint32_t nMinHeight) const
 {
-    json jArray = json::array();
-    listTickets<_TicketType>([&](const _TicketType& ticket) -> bool
+    const auto id = _TicketType::GetID();
+    unique_ptr<CDBIterator> pcursor(m_pHeightIndexDB->NewIterator());
+    ticket_height_index_key_t key(id, nMinHeight, "");
+    for (pcursor->Seek(key); pcursor->Valid(); pcursor->Next())
     {
-        jArray.push_back(json::parse(ticket.ToJSON()));
-        return true;
-    }, nMinHeight);
-    return jArray.dump();
-}
-template string CPastelTicketProcessor::ListTickets<CPastelIDRegTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CNFTRegTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CollectionRegTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CollectionActivateTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CNFTActivateTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<COfferTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CAcceptTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CTransferTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CNFTRoyaltyTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CChangeUsernameTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CChangeEthereumAddressTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CActionRegTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CActionActivateTicket>(const uint32_t nMinHeight) const;
-template string CPastelTicketProcessor::ListTickets<CContractTicket>(const uint32_t nMinHeight) const;
+        if (!pcursor->GetKey(key) || (key.ticket_id != id))
+            break;
+        // all the next tickets are not in the active chain yet
+        if (key.nHeight > gl_nChainHeight)
+            break;
+        _TicketType ticket;
+        ticket.SetKeyOne(string(key.sKeyOne));
+        if (!readTicketFromDB(db, key.sKeyOne, ticket))
+            continue;
+        // skip stale index record - ticket was overwritten at the other height
+        if (ticket.GetBlock() != key.nHeight)
+            continue;
+        if (!f(ticket))
+            break;
+    }
+}
+
+/**
+ * List all tickets with type _TicketType.
+ * 
+ * \param nMinHeight - minimal block height of the tickets to list
+ * \param page - paging parameters
+ * \return json array with tickets
+ */
+template <class _TicketType>
+string CPastelTicketProcessor::ListTickets(const uint32_t nMinHeight, const ticket_list_page_t &page) const
+{
+    return filterTickets<_TicketType>([](const _TicketType&, const unsigned int) -> bool
+        {
+            return false;
+        }, nMinHeight, false, page);
+}
+template string CPastelTicketProcessor::ListTickets<CPastelIDRegTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CNFTRegTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CollectionRegTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CollectionActivateTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CNFTActivateTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<COfferTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CAcceptTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CTransferTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CNFTRoyaltyTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CChangeUsernameTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CChangeEthereumAddressTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CActionRegTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CActionActivateTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
+template string CPastelTicketProcessor::ListTickets<CContractTicket>(const uint32_t nMinHeight, const ticket_list_page_t &page) const;
 
+/**
+ * Filter tickets with type _TicketType and write them to json array.
+ * Ticket json is appended to the output string as is, without parsing.
+ * 
+ * \param f - functor to apply, if functor returns true - ticket is skipped
+ * \param nMinHeight - minimal block height of the tickets to list
+ * \param bCheckConfirmation - if true - skip tickets that are not confirmed yet
+ * \param page - paging parameters
+ * \return json array with filtered tickets
+ */
 template <class _TicketType, typename F>
-string CPastelTicketProcessor::filterTickets(F f, const uint32_t nMinHeight, const bool bCheckConfirmation) const
+string CPastelTicketProcessor::filterTickets(F f, const uint32_t nMinHeight, const bool bCheckConfirmation,
+    const ticket_list_page_t &page) const
 {
-    json jArray = json::array();
+    string sJSON("[");
+    size_t nMatched = 0;
+    size_t nWritten = 0;
     const auto nActiveChainHeight = gl_nChainHeight + 1;
     // list tickets with the specific type (_TicketType) and add to json array if functor f applies
     listTickets<_TicketType>([&](const _TicketType& ticket) -> bool
@@ -1411,10 +2575,16 @@ string CPastelTicketProcessor::filterTickets(F f, const uint32_t nMinHeight, con
         // apply functor to the current ticket
         if (f(ticket, nActiveChainHeight))
             return true;
-        jArray.push_back(json::parse(ticket.ToJSON()));
-        return true;
+        if (nMatched++ < page.nStart)
+            return true;
+        if (nWritten++)
+            sJSON += ',';
+        sJSON += ticket.ToJSON();
+        // stop enumeration when the page is full
+        return !page.nCount || (nWritten < page.nCount);
     }, nMinHeight);
-    return jArray.dump(4);
+    sJSON += ']';
+    return sJSON;
 }
 
 /**
@@ -1481,7 +2651,8 @@ template tuple<size_t, size_t, size_t, size_t> CPastelTicketProcessor::calculate
  * \param pmapIDs - map of locally stored Pastel IDs -> LegRoast public key
  * \return json with filtered tickets
  */
-string CPastelTicketProcessor::ListFilterPastelIDTickets(const uint32_t nMinHeight, const short filter, const pastelid_store_t* pmapIDs) const
+string CPastelTicketProcessor::ListFilterPastelIDTickets(const uint32_t nMinHeight, const short filter, const pastelid_store_t* pmapIDs,
+    const ticket_list_page_t &page) const
 {
     return filterTickets<CPastelIDRegTicket>(
         [&](const CPastelIDRegTicket& t, const unsigned int chainHeight) -> bool
@@ -1495,11 +2666,11 @@ string CPastelTicketProcessor::ListFilterPastelIDTickets(const uint32_t nMinHeig
                     pmapIDs && pmapIDs->find(t.getPastelID()) != pmapIDs->cend()))
                 return false;
             return true;
-        }, nMinHeight);
+        }, nMinHeight, true, page);
 }
 
 // 1 - active;    2 - inactive;     3 - transferred
-string CPastelTicketProcessor::ListFilterNFTTickets(const uint32_t nMinHeight, const short filter) const
+string CPastelTicketProcessor::ListFilterNFTTickets(const uint32_t nMinHeight, const short filter, const ticket_list_page_t &page) const
 {
     return filterTickets<CNFTRegTicket>(
         [&](const CNFTRegTicket& t, const unsigned int nChainHeight) -> bool
@@ -1525,11 +2696,11 @@ string CPastelTicketProcessor::ListFilterNFTTickets(const uint32_t nMinHeight, c
             } else if (filter == 2)
                 return false; //don't skip inactive
             return true;
-        }, nMinHeight);
+        }, nMinHeight, true, page);
 }
 
 // 1 - active;    2 - inactive;
-string CPastelTicketProcessor::ListFilterCollectionTickets(const uint32_t nMinHeight, const short filter) const
+string CPastelTicketProcessor::ListFilterCollectionTickets(const uint32_t nMinHeight, const short filter, const ticket_list_page_t &page) const
 {
     return filterTickets<CollectionRegTicket>(
         [&](const CollectionRegTicket& t, const unsigned int nChainHeight) -> bool
@@ -1543,11 +2714,11 @@ string CPastelTicketProcessor::ListFilterCollectionTickets(const uint32_t nMinHe
             if (filter == 2)
                 return false; //don't skip inactive
             return true;
-        }, nMinHeight);
+        }, nMinHeight, true, page);
 }
 
 // 1 - active; 2 - inactive; 3 - transferred
-string CPastelTicketProcessor::ListFilterActionTickets(const uint32_t nMinHeight, const short filter) const
+string CPastelTicketProcessor::ListFilterActionTickets(const uint32_t nMinHeight, const short filter, const ticket_list_page_t &page) const
 {
     return filterTickets<CActionRegTicket>(
         [&](const CActionRegTicket& t, const unsigned int nChainHeight) -> bool
@@ -1572,32 +2743,34 @@ string CPastelTicketProcessor::ListFilterActionTickets(const uint32_t nMinHeight
             } else if (filter == 2)
                 return false; //don't skip inactive
             return true;
-        }, nMinHeight);
+        }, nMinHeight, true, page);
 }
 
-string CPastelTicketProcessor::ListFilterContractTickets(const uint32_t nMinHeight, const string& subtype) const
+string CPastelTicketProcessor::ListFilterContractTickets(const uint32_t nMinHeight, const string& subtype,
+    const ticket_list_page_t &page) const
 {
-    ContractTickets_t vTickets;
+    string sJSON("[");
+    size_t nMatched = 0;
+    size_t nWritten = 0;
     ProcessTicketsByMVKey<CContractTicket>(subtype, nullptr,
         [&](const CContractTicket& ticket) -> bool
         {
-            if ((ticket.getSubType() == subtype) &&
-                ticket.IsBlockEqualOrNewerThan(nMinHeight))
-				vTickets.emplace_back(ticket);
-            return true;
+            if ((ticket.getSubType() != subtype) ||
+                !ticket.IsBlockEqualOrNewerThan(nMinHeight))
+                return true;
+            if (nMatched++ < page.nStart)
+                return true;
+            if (nWritten++)
+                sJSON += ',';
+            sJSON += ticket.ToJSON(true);
+            return !page.nCount || (nWritten < page.nCount);
         });
-
-    json jArray = json::array();
-    jArray.get_ptr<json::array_t*>()->reserve(vTickets.size());
-
-    for (const auto& ticket : vTickets)
-		jArray.emplace_back(ticket.getJSON(true));
-
-	return jArray.dump(4);
+    sJSON += ']';
+    return sJSON;
 }
 
 // 1 - available;      2 - transferred|sold
-string CPastelTicketProcessor::ListFilterActTickets(const uint32_t nMinHeight, const short filter) const
+string CPastelTicketProcessor::ListFilterActTickets(const uint32_t nMinHeight, const short filter, const ticket_list_page_t &page) const
 {
     return filterTickets<CNFTActivateTicket>(
         [&](const CNFTActivateTicket& t, const unsigned int chainHeight) -> bool
@@ -1615,15 +2788,16 @@ string CPastelTicketProcessor::ListFilterActTickets(const uint32_t nMinHeight, c
             } else if (filter == 2)
                 return false; //don't skip transferred|sold
             return true;
-        }, nMinHeight);
+        }, nMinHeight, true, page);
 }
 
 // 0 - all, 1 - available; 2 - unavailable; 3 - expired; 4 - transferred|sold
-string CPastelTicketProcessor::ListFilterOfferTickets(const uint32_t nMinHeight, const short filter, const string& pastelID) const
+string CPastelTicketProcessor::ListFilterOfferTickets(const uint32_t nMinHeight, const short filter, const string& pastelID,
+    const ticket_list_page_t &page) const
 {
     const bool checkConfirmation{filter > 0};
     if (filter == 0 && pastelID.empty()) {
-            return ListTickets<COfferTicket>(nMinHeight); // get all
+            return ListTickets<COfferTicket>(nMinHeight, page); // get all
     }
     return filterTickets<COfferTicket>(
         [&](const COfferTicket& t, const unsigned int chainHeight) -> bool
@@ -1662,15 +2836,16 @@ string CPastelTicketProcessor::ListFilterOfferTickets(const uint32_t nMinHeight,
                     return true;
             }
             return false;
-        }, checkConfirmation);
+        }, nMinHeight, checkConfirmation, page);
 }
 
 // 0 - all, 1 - expired;    2 - transferred|sold
-string CPastelTicketProcessor::ListFilterAcceptTickets(const uint32_t nMinHeight, const short filter, const string& pastelID) const
+string CPastelTicketProcessor::ListFilterAcceptTickets(const uint32_t nMinHeight, const short filter, const string& pastelID,
+    const ticket_list_page_t &page) const
 {
     const bool checkConfirmation{filter > 0};
     if (filter == 0 && pastelID.empty()) {
-            return ListTickets<CAcceptTicket>(nMinHeight); // get all
+            return ListTickets<CAcceptTicket>(nMinHeight, page); // get all
     }
     return filterTickets<CAcceptTicket>(
         [&](const CAcceptTicket& t, const unsigned int chainHeight) -> bool
@@ -1685,15 +2860,16 @@ string CPastelTicketProcessor::ListFilterAcceptTickets(const uint32_t nMinHeight
             } else if (filter == 1 && t.GetBlock() + masterNodeCtrl.nMaxAcceptTicketAge < chainHeight)
                 return false; //don't skip non transferred|sold, and expired
             return true;
-        }, checkConfirmation);
+        }, nMinHeight, checkConfirmation, page);
 }
 
 // 0 - all, 1 - available; 2 - transferred|sold
-string CPastelTicketProcessor::ListFilterTransferTickets(const uint32_t nMinHeight, const short filter, const string& pastelID) const
+string CPastelTicketProcessor::ListFilterTransferTickets(const uint32_t nMinHeight, const short filter, const string& pastelID,
+    const ticket_list_page_t &page) const
 {
     const bool checkConfirmation{filter > 0};
     if (filter == 0 && pastelID.empty())
-        return ListTickets<CTransferTicket>(nMinHeight); // get all
+        return ListTickets<CTransferTicket>(nMinHeight, page); // get all
     return filterTickets<CTransferTicket>(
         [&](const CTransferTicket& t, const unsigned int chainHeight) -> bool
         {
@@ -1710,7 +2886,7 @@ string CPastelTicketProcessor::ListFilterTransferTickets(const uint32_t nMinHeig
             } else if (filter == 2)
                 return false; //don't skip transferred|sold
             return true;
-        }, checkConfirmation);
+        }, nMinHeight, checkConfirmation, page);
 }
 
 bool CPastelTicketProcessor::WalkBackTradingChain(
@@ -1918,6 +3094,228 @@ tuple<string, string> CPastelTicketProcessor::SendTicket(const CPastelTicket& ti
     return make_tuple(tx.GetHash().GetHex(), ticket.KeyOne());
 }
 
+/**
+ * Create NFT search attributes for the NFT registration ticket.
+ * 
+ * \param ticket - NFT registration ticket
+ * \param attr - returns NFT search attributes
+ * \param jApp - returns parsed NFT app ticket json
+ * \return true if NFT search attributes were successfully created
+ */
+bool CPastelTicketProcessor::createNFTSearchAttributes(const CPastelTicket& ticket, nft_search_attr_t &attr, json &jApp)
+{
+    const auto pNftTicket = dynamic_cast<const CNFTRegTicket*>(&ticket);
+    if (!pNftTicket)
+        return false;
+    string error;
+    if (!ParseNFTAppTicket(pNftTicket->ToStr(), jApp, error) ||
+        !BuildNFTSearchAttributes(pNftTicket->getTotalCopies(), jApp, attr, error))
+    {
+        LogFnPrintf("ERROR: NFT ticket (%s) - %s", pNftTicket->GetTxId(), error);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Create NFT search attributes for the NFT registration ticket and store them in the NFT search DB.
+ * Called when NFT registration ticket is connected to the active chain or NFT search DBs are built.
+ * 
+ * \param ticket - NFT registration ticket
+ * \param attr - returns NFT search attributes
+ * \param jApp - returns parsed NFT app ticket json
+ * \return true if NFT search attributes were successfully created
+ */
+bool CPastelTicketProcessor::updateNFTSearchAttributes(const CPastelTicket& ticket, nft_search_attr_t &attr, json &jApp) const
+{
+    if (!createNFTSearchAttributes(ticket, attr, jApp))
+        return false;
+    if (m_pNftSearchDB)
+        m_pNftSearchDB->Write(ticket.GetTxId(), attr);
+    updateNFTKeywordIndex(ticket.GetTxId(), attr, false);
+    return true;
+}
+
+/**
+ * Remove NFT registration ticket from the NFT search attributes DB and NFT keyword index.
+ * Called when NFT registration ticket is disconnected from the active chain.
+ * 
+ * \param ticket - NFT registration ticket
+ */
+void CPastelTicketProcessor::eraseNFTSearchAttributes(const CPastelTicket& ticket) const
+{
+    const string sRegTxId = ticket.GetTxId();
+    nft_search_attr_t attr;
+    bool bHasAttr = m_pNftSearchDB && m_pNftSearchDB->Read(sRegTxId, attr);
+    if (!bHasAttr)
+    {
+        // index records are created from the app ticket, rebuild attributes to find them
+        json jApp;
+        bHasAttr = createNFTSearchAttributes(ticket, attr, jApp);
+    }
+    if (bHasAttr)
+        updateNFTKeywordIndex(sRegTxId, attr, true);
+    if (m_pNftSearchDB)
+        m_pNftSearchDB->Erase(sRegTxId);
+}
+
+/**
+ * Add or remove NFT keyword index records for the NFT registration ticket.
+ * 
+ * \param sRegTxId - NFT registration ticket txid
+ * \param attr - NFT search attributes
+ * \param bErase - if true - remove index records, otherwise - add them
+ */
+void CPastelTicketProcessor::updateNFTKeywordIndex(const string& sRegTxId, const nft_search_attr_t &attr, const bool bErase) const
+{
+    if (!m_pNftKeywordDB)
+        return;
+    map<string, s_strings> mapTokens;
+    GetNFTKeywordIndexTokens(attr, mapTokens);
+    CDBBatch batch(*m_pNftKeywordDB);
+    for (const auto& [sPropName, tokens] : mapTokens)
+    {
+        for (const auto& sToken : tokens)
+        {
+            const nft_keyword_index_key_t key(sPropName, sToken, sRegTxId);
+            if (bErase)
+                batch.Erase(key);
+            else
+                batch.Write(key, uint8_t(0));
+        }
+    }
+    m_pNftKeywordDB->WriteBatch(batch);
+}
+
+/**
+ * Read NFT keyword index records for the property token.
+ * Index records are intersected with the filter set while iterating: the cursor is
+ * moved by seeks to the next txid from the filter set, so the number of index
+ * records visited is limited by the size of the smaller of the two sets.
+ * 
+ * \param sPropName - app ticket property name
+ * \param sToken - index token
+ * \param filterSet - only NFT reg txids from this set are added to the result
+ * \param result - NFT reg txids found in the index are added to this set
+ */
+void CPastelTicketProcessor::readNFTKeywordIndex(const string& sPropName, const string& sToken,
+    const su_strings &filterSet, su_strings &result) const
+{
+    if (filterSet.empty())
+        return;
+    // sort filter set in the index key order (txids are serialized with the length prefix)
+    v_strings vFilter(filterSet.cbegin(), filterSet.cend());
+    const auto keyLess = [](const string& a, const string& b) -> bool
+    {
+        return (a.size() < b.size()) || ((a.size() == b.size()) && (a < b));
+    };
+    sort(vFilter.begin(), vFilter.end(), keyLess);
+
+    unique_ptr<CDBIterator> pcursor(m_pNftKeywordDB->NewIterator());
+    nft_keyword_index_key_t key(sPropName, sToken, vFilter.front());
+    auto it = vFilter.cbegin();
+    for (pcursor->Seek(key); pcursor->Valid(); pcursor->Seek(key))
+    {
+        if (!pcursor->GetKey(key) || (key.sPropName != sPropName) || (key.sToken != sToken))
+            break;
+        // skip filter txids that are not in the index
+        it = lower_bound(it, vFilter.cend(), key.sRegTxId, keyLess);
+        if (it == vFilter.cend())
+            break;
+        if (*it == key.sRegTxId)
+        {
+            result.insert(*it);
+            if (++it == vFilter.cend())
+                break;
+        }
+        key.sRegTxId = *it;
+    }
+}
+
+/**
+ * Apply fuzzy filter to the set of NFT registration ticket txids using NFT keyword index.
+ * Filter value can match string property (substring search), number or bool property.
+ * NFTs without the property pass the filter. Resulting candidates still have to be checked
+ * with the actual filter - n-gram match does not guarantee substring match.
+ * 
+ * \param sPropName - app ticket property name
+ * \param sLowercasedFilterValue - lowercased filter value
+ * \param candidates - set of NFT registration ticket txids to filter
+ * \return false if filter value cannot be searched using the index (too short)
+ */
+bool CPastelTicketProcessor::filterByNFTKeywordIndex(const string& sPropName, const string& sLowercasedFilterValue,
+    su_strings &candidates) const
+{
+    if (!m_pNftKeywordDB)
+        return false;
+    const s_strings ngrams = GetNFTKeywordNGramTokens(sLowercasedFilterValue);
+    if (ngrams.empty())
+        return false;
+
+    su_strings result;
+    // string properties - all n-grams of the filter value should be found
+    su_strings ngramCandidates = candidates;
+    for (const auto& sToken : ngrams)
+    {
+        su_strings tokenCandidates;
+        readNFTKeywordIndex(sPropName, sToken, ngramCandidates, tokenCandidates);
+        ngramCandidates = std::move(tokenCandidates);
+        if (ngramCandidates.empty())
+            break;
+    }
+    result = std::move(ngramCandidates);
+    // number properties
+    readNFTKeywordIndex(sPropName, NFT_KEYWORD_TOKEN_NUMBER + sLowercasedFilterValue, candidates, result);
+    // bool properties
+    bool bValue = false;
+    if (str_tobool(sLowercasedFilterValue, bValue))
+        readNFTKeywordIndex(sPropName, string(1, NFT_KEYWORD_TOKEN_BOOL) + (bValue ? "1" : "0"), candidates, result);
+    // NFTs without this property
+    readNFTKeywordIndex(sPropName, string(1, NFT_KEYWORD_TOKEN_MISSING), candidates, result);
+    candidates = std::move(result);
+    return true;
+}
+
+/**
+ * Get NFT search attributes by NFT registration ticket txid.
+ * If search attributes are not found in the NFT search DB - NFT registration ticket
+ * is parsed, NFT search DBs are not modified.
+ * 
+ * \param sRegTxId - NFT registration ticket txid
+ * \param attr - returns NFT search attributes
+ * \param pjApp - if not nullptr - returns parsed NFT app ticket json (always parses NFT ticket)
+ * \return true if NFT search attributes were found
+ */
+bool CPastelTicketProcessor::getNFTSearchAttributes(const string& sRegTxId, nft_search_attr_t &attr, json *pjApp) const
+{
+    const bool bHasAttr = m_pNftSearchDB && m_pNftSearchDB->Read(sRegTxId, attr) &&
+        (attr.nVersion == nft_search_attr_t::CURRENT_VERSION);
+    if (bHasAttr && !pjApp)
+        return true;
+    try
+    {
+        const auto pNftTicket = GetTicket(sRegTxId, TicketID::NFT);
+        json jApp;
+        if (bHasAttr)
+        {
+            string error;
+            if (!ParseNFTAppTicket(pNftTicket->ToStr(), jApp, error))
+            {
+                LogFnPrintf("ERROR: NFT ticket (%s) - %s", sRegTxId, error);
+                return false;
+            }
+        } else if (!createNFTSearchAttributes(*pNftTicket, attr, jApp))
+            return false;
+        if (pjApp)
+            *pjApp = std::move(jApp);
+    } catch (const exception& ex)
+    {
+        LogFnPrintf("ERROR: failed to get NFT registration ticket (%s). %s", sRegTxId, ex.what());
+        return false;
+    }
+    return true;
+}
+
 #ifdef ENABLE_WALLET
 bool CPastelTicketProcessor::CreateP2FMSTransaction(const string& input_string, CMutableTransaction& tx_out, 
     const CAmount nPricePSL, const opt_string_t& sFundingAddress, string& error_ret)
@@ -1980,13 +3378,45 @@ bool isValuePassFuzzyFilter(const json &jProp, const string &sPropFilterValue) n
     return bPassedFilter;
 }
 
+/**
+ * Check if NFT passes fuzzy search filters.
+ * Filters for the properties not defined in the NFT are skipped,
+ * NFT should pass all other filters.
+ * 
+ * \param vFilters - fuzzy search filters
+ * \param attr - NFT search attributes
+ * \param jApp - NFT app ticket json, used for the properties not stored in the search attributes
+ * \return true if NFT passes fuzzy search filters
+ */
+bool isNFTPassFuzzyFilters(const vector<nft_fuzzy_filter_t>& vFilters, const nft_search_attr_t& attr,
+    const json& jApp) noexcept
+{
+    for (const auto &filter : vFilters)
+    {
+        if (filter.bHasSearchAttr)
+        {
+            const auto it = attr.mapProps.find(filter.sPropName);
+            if (it == attr.mapProps.cend())
+                continue; // just skip unknown properties
+            if (!IsNFTSearchPropPassFuzzyFilter(it->second, filter.sLowercasedFilterValue))
+                return false;
+            continue;
+        }
+        if (!jApp.contains(filter.sPropName))
+            continue; // just skip unknown properties
+        if (!isValuePassFuzzyFilter(jApp[filter.sPropName], filter.sFilterValue))
+            return false;
+    }
+    return true;
+}
+
 /**
  * Search for NFT tickets using multiple criterias (defined in 'tickets tools searchthumbids').
  * 
  * \param p - structure with search criterias
  * \param fnMatchFound - functor to apply when NFT registration ticket found that matches all search criterias
  */
-void CPastelTicketProcessor::SearchForNFTs(const search_thumbids_t& p, function<size_t(const CPastelTicket*, const json&)> &fnMatchFound) const
+void CPastelTicketProcessor::SearchForNFTs(const search_thumbids_t& p, const nft_search_match_func_t &fnMatchFound) const
 {
     v_strings vPastelIDs;
     // Creator Pastel ID can have special 'mine' value
@@ -2001,116 +3431,144 @@ void CPastelTicketProcessor::SearchForNFTs(const search_thumbids_t& p, function<
         }
     } else
         vPastelIDs.push_back(p.sCreatorPastelId);
-    size_t nResultCount = 0;
-    string sAppTicket, sData;
+
+    // NFT registration ticket txids from NFT activation tickets that pass block range filter
+    v_strings vRegTxIds;
     // process NFT activation tickets by PastelID (mvkey #1)
     for (const auto &sPastelID : vPastelIDs)
     {
         ProcessTicketsByMVKey<CNFTActivateTicket>(sPastelID, nullptr,
             [&](const CNFTActivateTicket& actTicket) -> bool
         {
-            // check if we exceeded max results
-            if (p.nMaxResultCount.has_value() && (nResultCount >= p.nMaxResultCount.value()))
-                return false; // stop enumeration
+            // filter NFT activation tickets by block height range
+            if (!p.blockRange.has_value() || p.blockRange.value().contains(actTicket.GetBlock()))
+                vRegTxIds.push_back(actTicket.getRegTxId());
+            return true;
+        });
+    }
+    if (vRegTxIds.empty() || (p.nMaxResultCount.has_value() && (p.nMaxResultCount.value() == 0)))
+        return;
 
-            do
-            {
-                // filter NFT activation tickets by block height range
-                if (p.blockRange.has_value() && !p.blockRange.value().contains(actTicket.GetBlock()))
-                    break;
+    vector<nft_fuzzy_filter_t> vFuzzyFilters;
+    bool bNeedAppTicket = false;
+    // fuzzy search (key is lowercased in the fuzzySearchMap)
+    for (const auto &[sSearchProp, sPropFilterValue] : p.fuzzySearchMap)
+    {
+        nft_fuzzy_filter_t filter;
+        // first let's check if we have any fuzzy search mappings (search keyword->nft ticket property name)
+        const auto itMapping = p.fuzzyMappings.find(sSearchProp);
+        if (itMapping != p.fuzzyMappings.cend())
+            filter.sPropName = itMapping->second; // found property name in the map -> use it
+        else
+            filter.sPropName = sSearchProp; // try to use search property and nft ticket property name as is
+        filter.sFilterValue = sPropFilterValue;
+        filter.sLowercasedFilterValue = sPropFilterValue;
+        lowercase(filter.sLowercasedFilterValue);
+        filter.bHasSearchAttr = IsNFTSearchAttrProperty(filter.sPropName);
+        if (!filter.bHasSearchAttr)
+            bNeedAppTicket = true;
+        vFuzzyFilters.push_back(std::move(filter));
+    }
 
-                const auto& regTxId = actTicket.getRegTxId();
-                // find NFT registration ticket by txid
-                auto pNftTicketPtr = CPastelTicketProcessor::GetTicket(regTxId, TicketID::NFT);
-                if (!pNftTicketPtr)
-                    break;
-                auto pNftTicket = dynamic_cast<const CNFTRegTicket*>(pNftTicketPtr.get());
-                if (!pNftTicket)
-                    break;
-                // filter by number of copies
-                if (p.copyCount.has_value() && !p.copyCount.value().contains(pNftTicket->getTotalCopies()))
-                    break;
-                // NFT ticket data are base64 encoded
-                bool bInvalid = false;
-                sData = DecodeBase64(pNftTicket->ToStr(), &bInvalid);
-                if (bInvalid)
-                {
-                    LogPrintf("ERROR: failed to decode base64 encoded NFT ticket (%s)", regTxId);
-                    break;
-                }
-                json j;
-                try
-                {
-                    // parse NFT ticket json
-                    j = json::parse(sData);
-                } catch (const json::exception& ex)
-                {
-                    LogPrintf("ERROR: failed to parse NFT ticket json (%s). %s", regTxId, SAFE_SZ(ex.what()));
+    // narrow down the list of NFT registration tickets using NFT keyword index,
+    // filters with short values or for the properties not in the index are applied by the full check only
+    if (m_pNftKeywordDB && !vFuzzyFilters.empty())
+    {
+        su_strings candidates(vRegTxIds.cbegin(), vRegTxIds.cend());
+        bool bIndexUsed = false;
+        for (const auto &filter : vFuzzyFilters)
+        {
+            if (!filter.bHasSearchAttr)
+                continue;
+            if (filterByNFTKeywordIndex(filter.sPropName, filter.sLowercasedFilterValue, candidates))
+                bIndexUsed = true;
+            if (candidates.empty())
+                return;
+        }
+        if (bIndexUsed)
+            vRegTxIds.erase(remove_if(vRegTxIds.begin(), vRegTxIds.end(),
+                [&](const string& sRegTxId) { return candidates.count(sRegTxId) == 0; }), vRegTxIds.end());
+    }
+
+    // check if NFT registration ticket passes all search filters
+    auto isMatchingNFT = [&](const string &sRegTxId, nft_search_attr_t &attr) -> bool
+    {
+        json jApp;
+        // app ticket json is needed only for the properties not stored in the search attributes
+        if (!getNFTSearchAttributes(sRegTxId, attr, bNeedAppTicket ? &jApp : nullptr))
+            return false;
+        // filter by number of copies
+        if (p.copyCount.has_value() && !p.copyCount.value().contains(attr.nTotalCopies))
+            return false;
+        // filter by rareness score
+        if (p.rarenessScore.has_value() && attr.bHasRarenessScore && !p.rarenessScore.value().contains(attr.nRarenessScore))
+            return false;
+        // filter by nsfw score
+        if (p.nsfwScore.has_value() && attr.bHasNsfwScore && !p.nsfwScore.value().contains(attr.nNsfwScore))
+            return false;
+        return isNFTPassFuzzyFilters(vFuzzyFilters, attr, jApp);
+    };
+
+    unsigned int nNumThreads = thread::hardware_concurrency();
+    if (nNumThreads == 0)
+        nNumThreads = 1;
+    nNumThreads = static_cast<unsigned int>(min<size_t>(nNumThreads, NFT_SEARCH_MAX_THREADS));
+
+    // process NFT activation tickets in batches, each batch is processed in parallel,
+    // results are reported in the original order of NFT activation tickets
+    vector<nft_search_attr_t> vAttrs;
+    vector<uint8_t> vMatched;
+    size_t nResultCount = 0;
+    size_t nBatchStart = 0;
+    while (nBatchStart < vRegTxIds.size())
+    {
+        const size_t nBatchSize = min(NFT_SEARCH_BATCH_SIZE, vRegTxIds.size() - nBatchStart);
+        // number of matches required to reach max results
+        const size_t nMatchesRequired = p.nMaxResultCount.has_value() ? 
+            p.nMaxResultCount.value() - nResultCount : numeric_limits<size_t>::max();
+        vAttrs.assign(nBatchSize, nft_search_attr_t());
+        vMatched.assign(nBatchSize, 0);
+        atomic<size_t> nNextIndex(0);
+        atomic<size_t> nMatchCount(0);
+        // tickets are claimed by workers in order, so when workers stop early
+        // all tickets before the last claimed one are processed
+        auto worker = [&]()
+        {
+            while (nMatchCount < nMatchesRequired)
+            {
+                const size_t i = nNextIndex++;
+                if (i >= nBatchSize)
                     break;
-                }
-                json jApp; // app ticket json
-                if (j.contains(NFT_TICKET_APP_OBJ))
-                {
-                    const json& jAppTicketBase85 = j[NFT_TICKET_APP_OBJ];
-                    if (jAppTicketBase85.is_string())
-                    {
-                        bInvalid = false;
-                        sData = DecodeAscii85(jAppTicketBase85, &bInvalid);
-                        if (bInvalid)
-                        {
-                            LogPrintf("ERROR: failed to decode ascii85 encoded NFT app ticket (%s)", regTxId);
-                            break;
-                        }
-                        try
-                        {
-                            // parse app ticket json
-                            jApp = json::parse(sData);
-                        } catch (const json::exception& ex)
-                        {
-                            LogPrintf("ERROR: failed to parse NFT app ticket json (%s). %s", regTxId, SAFE_SZ(ex.what()));
-                            break;
-                        }
-                    }
-                }
-                uint32_t nScore;
-                // filter by rareness score
-                if (p.rarenessScore.has_value() && jApp.contains("rareness_score"))
+                if (isMatchingNFT(vRegTxIds[nBatchStart + i], vAttrs[i]))
                 {
-                    jApp["rareness_score"].get_to(nScore);
-                    if (!p.rarenessScore.value().contains(nScore))
-                        break;
-                }
-                // filter by nsfw score
-                if (p.nsfwScore.has_value() && jApp.contains("nsfw_score"))
-                {
-                    jApp["nsfw_score"].get_to(nScore);
-                    if (!p.nsfwScore.value().contains(nScore))
-                        break;
+                    vMatched[i] = 1;
+                    ++nMatchCount;
                 }
-                // nft reg app ticket properties (name: value)
-                string sPropName, sPropValue;
-                // fuzzy search (key is lowercased in the fuzzySearchMap)
-                bool bPassedFilter = true;
-                for (const auto &[sSearchProp, sPropFilterValue] : p.fuzzySearchMap)
-                {
-                    // first let's check if we have any fuzzy search mappings (search keyword->nft ticket property name)
-                    const auto itMapping = p.fuzzyMappings.find(sSearchProp);
-                    if (itMapping != p.fuzzyMappings.cend())
-                        sPropName = itMapping->second; // found property name in the map -> use it
-                    else
-                        sPropName = sSearchProp; // try to use search property and nft ticket property name as is
-                    if (!jApp.contains(sPropName))
-                        continue; // just skip unknown properties
-                    bPassedFilter = isValuePassFuzzyFilter(jApp[sPropName], sPropFilterValue);
-                }
-                if (!bPassedFilter)
-                    break;
-                // add NFT reg ticket info to the json array
-                nResultCount = fnMatchFound(pNftTicket, jApp);
-            } while (false);
-            return true;
-        });
-    } // for
+            }
+        };
+        const size_t nBatchThreads = min<size_t>(nNumThreads, 
+            (nBatchSize + NFT_SEARCH_MIN_TICKETS_PER_THREAD - 1) / NFT_SEARCH_MIN_TICKETS_PER_THREAD);
+        vector<future<void>> futures;
+        futures.reserve(nBatchThreads);
+        for (size_t t = 1; t < nBatchThreads; ++t)
+            futures.push_back(async(launch::async, worker));
+        worker();
+        for (auto& f : futures)
+            f.get();
+
+        const size_t nProcessed = min(nNextIndex.load(), nBatchSize);
+        for (size_t i = 0; i < nProcessed; ++i)
+        {
+            if (!vMatched[i])
+                continue;
+            // add NFT reg ticket info to the results
+            nResultCount = fnMatchFound(vRegTxIds[nBatchStart + i], vAttrs[i]);
+            // check if we exceeded max results
+            if (p.nMaxResultCount.has_value() && (nResultCount >= p.nMaxResultCount.value()))
+                return;
+        }
+        nBatchStart += nProcessed;
+    }
 }
 #endif // ENABLE_WALLET
 
@@ -6,6 +6,8 @@
 #include <tuple>
 #include <optional>
 #include <atomic>
+#include <mutex>
+#include <map>
 
 #include <extlibs/json.hpp>
 
@@ -21,6 +23,8 @@
 #include <consensus/validation.h>
 #include <pastelid/pastel_key.h>
 #include <mnode/mnode-consts.h>
+#include <mnode/ticket-cache.h>
+#include <mnode/nft-search.h>
 #include <mnode/tickets/ticket-types.h>
 #include <mnode/tickets/ticket.h>
 
@@ -28,6 +32,18 @@ constexpr uint8_t TICKET_COMPRESS_ENABLE_MASK  = (1<<7); // using bit 7 to mark
 constexpr uint8_t TICKET_COMPRESS_DISABLE_MASK = 0x7F;
 constexpr auto TICKET_KEYTWO_PREFIX = "@2@";  // Ticket DB secondary key prefix (unique)
 constexpr auto TICKET_MVKEY_PREFIX = "@M@";   // Ticket DB auxiliary key prefix (non-unique)
+constexpr auto TICKET_DB_VERSION_KEY = "@V@"; // Ticket DB format version key
+constexpr auto TICKET_DB_REPAIR_KEY = "@R@";  // Ticket DB repair checkpoint key (stored in PastelID ticket DB)
+constexpr auto TICKET_INDEX_BUILT_KEY_PREFIX = "@I@"; // Ticket index build completion marker: @I@<index DB subfolder> (stored in PastelID ticket DB)
+// ticket DB format version:
+//   1 - mv key record: @M@<mvKey> -> vector of primary keys
+//   2 - mv key record per ticket: <@M@<mvKey>><primary key> -> 0
+//   3 - mv key record per ticket: <@M@<mvKey>><block height><primary key> -> 0
+constexpr uint32_t TICKET_DB_VERSION = 4;
+constexpr auto TICKET_HEIGHTIDX_DB_SUBFOLDER = "heightidx"; // Ticket height index DB subfolder
+constexpr auto TICKET_NFTKEYWORD_DB_SUBFOLDER = "nftkeywords"; // NFT keyword index DB subfolder
+constexpr auto TICKET_NFTSEARCH_DB_SUBFOLDER = "nftsearch"; // NFT search attributes DB subfolder
+constexpr auto TICKET_TXIDX_DB_SUBFOLDER = "txidx"; // Ticket txid index DB subfolder
 
 // tuple <item id, item registration txid, transfer ticket txid>
 using reg_transfer_txid_t = std::tuple<TicketID, std::string, std::string>;
@@ -69,10 +85,135 @@ typedef struct _search_thumbids_t
     mu_strings fuzzySearchMap;
 } search_thumbids_t;
 
+// max number of threads used by NFT search
+constexpr size_t NFT_SEARCH_MAX_THREADS = 8;
+// number of NFT activation tickets processed by NFT search in one parallel batch
+constexpr size_t NFT_SEARCH_BATCH_SIZE = 1024;
+// min number of NFT activation tickets processed by one NFT search thread
+constexpr size_t NFT_SEARCH_MIN_TICKETS_PER_THREAD = 64;
+
+// functor called for each NFT registration ticket that matches search criteria,
+// returns number of results found so far
+using nft_search_match_func_t = std::function<size_t(const std::string &sRegTxId, const nft_search_attr_t &attr)>;
+
 using process_ticket_data_func_t = std::function<bool(std::string &&sKey, const PastelTicketPtr&)>;
 
 // Check if json value passes fuzzy search filter
 bool isValuePassFuzzyFilter(const nlohmann::json& jProp, const std::string& sPropFilterValue) noexcept;
+// Check if NFT passes fuzzy search filters, jApp is used for the properties not stored in the search attributes
+bool isNFTPassFuzzyFilters(const std::vector<nft_fuzzy_filter_t>& vFilters, const nft_search_attr_t& attr,
+    const nlohmann::json& jApp) noexcept;
+
+/**
+ * Ticket txid index record: txid -> ticket location in the ticket DB.
+ * Also keeps ticket transaction info that is not stored in the ticket DB.
+ */
+typedef struct _ticket_txid_index_t
+{
+    TicketID ticket_id = TicketID::InvalidID;
+    std::string sKeyOne;        // ticket primary key
+    uint32_t nHeight = 0;       // ticket block height
+    uint256 hashBlock;          // ticket block hash
+    uint32_t nSerializedSize = 0;
+    uint32_t nCompressedSize = 0;
+    uint32_t nMultiSigOutputsCount = 0;
+    CAmount nMultiSigTxTotalFee = 0;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        uint8_t nTicketID = to_integral_type(ticket_id);
+        READWRITE(nTicketID);
+        if (ser_action == SERIALIZE_ACTION::Read)
+            ticket_id = static_cast<TicketID>(nTicketID);
+        READWRITE(sKeyOne);
+        READWRITE(nHeight);
+        READWRITE(hashBlock);
+        READWRITE(nSerializedSize);
+        READWRITE(nCompressedSize);
+        READWRITE(nMultiSigOutputsCount);
+        READWRITE(nMultiSigTxTotalFee);
+    }
+} ticket_txid_index_t;
+
+/**
+ * Ticket height index key: <ticket type><block height><primary key>.
+ * Height is stored in big-endian format to keep index records
+ * of the same ticket type ordered by block height.
+ */
+typedef struct _ticket_height_index_key_t
+{
+    TicketID ticket_id = TicketID::InvalidID;
+    uint32_t nHeight = 0;
+    std::string sKeyOne; // ticket primary key
+
+    _ticket_height_index_key_t() noexcept = default;
+    _ticket_height_index_key_t(const TicketID id, const uint32_t nBlockHeight, const std::string &sKey) :
+        ticket_id(id),
+        nHeight(nBlockHeight),
+        sKeyOne(sKey)
+    {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, to_integral_type(ticket_id));
+        ser_writedata32be(s, nHeight);
+        s << sKeyOne;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        ticket_id = static_cast<TicketID>(ser_readdata8(s));
+        nHeight = ser_readdata32be(s);
+        s >> sKeyOne;
+    }
+} ticket_height_index_key_t;
+
+/**
+ * Ticket DB mv key record key: <@M@mvKey><block height><tx index><primary key>.
+ * All records for the same mv key share the same serialized "@M@mvKey" prefix
+ * and can be read with one DB seek. Height and transaction index in the block are
+ * stored in big-endian format, so tickets are read in the order they were added
+ * to the blockchain.
+ */
+typedef struct _ticket_mvkey_t
+{
+    std::string sRealMVKey; // real mv key: @M@<mvKey>
+    uint32_t nHeight = 0;   // ticket block height
+    uint32_t nTxIndex = 0;  // ticket transaction index in the block
+    std::string sKeyOne;    // ticket primary key
+
+    _ticket_mvkey_t() noexcept = default;
+    _ticket_mvkey_t(const std::string &sRealKey, const uint32_t nBlockHeight, const uint32_t nBlockTxIndex,
+        const std::string &sKey) :
+        sRealMVKey(sRealKey),
+        nHeight(nBlockHeight),
+        nTxIndex(nBlockTxIndex),
+        sKeyOne(sKey)
+    {}
+
+    template<typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << sRealMVKey;
+        ser_writedata32be(s, nHeight);
+        ser_writedata32be(s, nTxIndex);
+        s << sKeyOne;
+    }
+
+    template<typename Stream>
+    void Unserialize(Stream& s)
+    {
+        s >> sRealMVKey;
+        nHeight = ser_readdata32be(s);
+        nTxIndex = ser_readdata32be(s);
+        s >> sKeyOne;
+    }
+} ticket_mvkey_t;
 
 typedef struct _ticket_parse_data_t
 {
@@ -90,18 +231,108 @@ typedef struct _ticket_parse_data_t
     {}
 } ticket_parse_data_t;
 
+// paging parameters for the ticket lists
+typedef struct _ticket_list_page_t
+{
+    size_t nStart = 0; // number of matching tickets to skip
+    size_t nCount = 0; // max number of tickets to return, 0 - no limit
+} ticket_list_page_t;
+
+// max number of connected blocks with ticket transactions kept in memory until UpdatedBlockTip
+constexpr size_t MAX_PENDING_TICKET_BLOCKS = 500;
+// number of blocks applied to the ticket DB by RepairTicketDB between checkpoints
+constexpr uint32_t TICKET_DB_REPAIR_CHECKPOINT_BLOCKS = 1000;
+// max number of blocks RepairTicketDB block scanner can read ahead of the applied block height
+constexpr uint32_t TICKET_DB_REPAIR_MAX_READY_BLOCKS = 2000;
+
+// ticket parsed from the P2FMS transaction
+typedef struct _parsed_ticket_t
+{
+    PastelTicketPtr ticket;
+    uint256 hashTx;
+    uint32_t nTxIndex = 0; // ticket transaction index in the block
+    uint32_t nMultiSigOutputsCount = 0;
+    CAmount nMultiSigTxTotalFee = 0;
+} parsed_ticket_t;
+
+/**
+ * Ticket DB repair checkpoint.
+ * All tickets up to the block nHeight have been applied to the ticket DB,
+ * RepairTicketDB resumes from the next block if this block is still in the active chain.
+ * Checkpoint with null block hash schedules full ticket DB repair.
+ */
+typedef struct _ticket_db_repair_checkpoint_t
+{
+    uint32_t nHeight = 0;
+    uint256 hashBlock;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        READWRITE(nHeight);
+        READWRITE(hashBlock);
+    }
+} ticket_db_repair_checkpoint_t;
+
+/**
+ * Ticket DB changes accumulated for one connected block.
+ * Writes are collected in one batch per DB and committed at once
+ * by CPastelTicketProcessor::commitDBBatch (index DBs first, ticket DBs last),
+ * ticket cache entries are invalidated after the commit.
+ */
+class CTicketDBBatch
+{
+public:
+    CTicketDBBatch() noexcept = default;
+
+    // get batch for the DB, created on first use
+    CDBBatch& Get(CDBWrapper& db)
+    {
+        auto &pBatch = m_mapBatches[&db];
+        if (!pBatch)
+            pBatch = std::make_unique<CDBBatch>(db);
+        return *pBatch;
+    }
+    // ticket cache entry to invalidate after the commit
+    void Invalidate(const TicketID id, const std::string& sRealKey)
+    {
+        m_vInvalidatedKeys.emplace_back(id, sRealKey);
+    }
+    bool IsEmpty() const noexcept { return m_mapBatches.empty(); }
+
+protected:
+    friend class CPastelTicketProcessor;
+
+    std::unordered_map<CDBWrapper*, std::unique_ptr<CDBBatch>> m_mapBatches;
+    std::vector<std::pair<TicketID, std::string>> m_vInvalidatedKeys;
+};
+
 // Ticket  Processor ////////////////////////////////////////////////////////////////////////////////////////////////////
 class CPastelTicketProcessor
 {
     using db_map_t = std::unordered_map<TicketID, std::unique_ptr<CDBWrapper>>;
     db_map_t dbs; // ticket db storage
+    std::unique_ptr<CDBWrapper> m_pTxIdIndexDB; // ticket txid index: txid -> ticket_txid_index_t
+    std::unique_ptr<CDBWrapper> m_pHeightIndexDB; // ticket height index: ticket_height_index_key_t -> 0
+    std::unique_ptr<CDBWrapper> m_pNftSearchDB; // NFT search attributes: NFT reg ticket txid -> nft_search_attr_t
+    std::unique_ptr<CDBWrapper> m_pNftKeywordDB; // NFT keyword index: nft_keyword_index_key_t -> 0
+
+    void buildTicketHeightIndex();
+    bool migrateTicketDB(const TicketID id, CDBWrapper& db, const uint32_t nDBVersion);
+    void clearNFTSearchDBs();
+    void buildNFTKeywordIndex();
 
     template <class _TicketType, typename F>
     void listTickets(F f, const uint32_t nMinHeight) const;
+    template <class _TicketType, typename F>
+    void listTicketsByHeight(F f, CDBWrapper& db, const uint32_t nMinHeight) const;
 
     // filter tickets of the specific type using functor f
     template <class _TicketType, typename F>
-    std::string filterTickets(F f, const uint32_t nMinHeight, const bool bCheckConfirmation = true) const;
+    std::string filterTickets(F f, const uint32_t nMinHeight, const bool bCheckConfirmation = true,
+        const ticket_list_page_t &page = {}) const;
 
 public:
     CPastelTicketProcessor() noexcept = default;
@@ -110,14 +341,19 @@ public:
     static PastelTicketPtr CreateTicket(const TicketID ticketId);
 
     void InitTicketDB();
+    // build txid index for the tickets added by the previous versions (requires block index)
+    void BuildTicketTxIdIndex();
+    void ChainTip(const CBlockIndex* pBlockIndex, const CBlock* pBlock, const bool bAdded);
     void UpdatedBlockTip(const CBlockIndex* cBlockIndex, bool fInitialDownload);
-    bool ParseTicketAndUpdateDB(CMutableTransaction& tx, const unsigned int nBlockHeight);
+    bool ParseTicketAndUpdateDB(CMutableTransaction& tx, const unsigned int nBlockHeight, const uint256 &hashBlock = uint256(),
+        CTicketDBBatch *pBatch = nullptr, const uint32_t nTxIndex = 0);
 
     static std::string RealKeyTwo(const std::string& key) noexcept { return TICKET_KEYTWO_PREFIX + key; }
     static std::string RealMVKey(const std::string& key) noexcept { return TICKET_MVKEY_PREFIX + key; }
 
-    bool UpdateDB(CPastelTicket& ticket, std::string& txid, const unsigned int nBlockHeight);
-    void UpdateDB_MVK(const CPastelTicket& ticket, const std::string& mvKey);
+    bool UpdateDB(CPastelTicket& ticket, std::string& txid, const unsigned int nBlockHeight, CTicketDBBatch *pBatch = nullptr,
+        const uint32_t nTxIndex = 0);
+    void UpdateDB_MVK(const CPastelTicket& ticket, const std::string& mvKey, const uint32_t nTxIndex, CTicketDBBatch &batch);
 
     // check whether ticket exists (use keyOne as a key)
     bool CheckTicketExist(const CPastelTicket& ticket, const CBlockIndex* pindexPrev = nullptr) const;
@@ -126,6 +362,8 @@ public:
     EraseTicketResult EraseIfTicketTransaction(const uint256& txid, std::string &error);
     size_t EraseTicketsFromDbByList(const block_index_cvector_t& vBlockIndex);
     void RepairTicketDB(const bool bUpdateUI);
+    // check whether ticket DB repair was interrupted or scheduled after the ticket DB write failure
+    bool IsRepairPending() const;
 
     // Check whether ticket exists (use keyTwo as a key).
     bool CheckTicketExistBySecondaryKey(const CPastelTicket& ticket, const CBlockIndex *pindexPrev = nullptr) const;
@@ -143,20 +381,18 @@ public:
     void ProcessTicketsByMVKey(const std::string& mvKey, const CBlockIndex *pindexPrev, _TicketFunctor f) const
     {
         v_strings vMainKeys;
-        // get real MV key: "@M@" + key
-        const auto realMVKey = RealMVKey(mvKey);
         // get DB for the given ticket type
         const auto itDB = dbs.find(_TicketType::GetID());
         if (itDB == dbs.cend())
             return;
-        // read primary keys for the given MV key
-        itDB->second->Read(realMVKey, vMainKeys);
+        // read primary keys for the given MV key ("@M@" + key)
+        readKeysFromDB(_TicketType::GetID(), *itDB->second, RealMVKey(mvKey), vMainKeys);
         const uint32_t nCurrentChainHeight = gl_nChainHeight;
         for (const auto& key : vMainKeys)
         {
             // read ticket & call the functor
             _TicketType ticket;
-            if (itDB->second->Read(key, ticket) && !ticket.IsBlockNewerThan(nCurrentChainHeight))
+            if (readTicketFromDB(*itDB->second, key, ticket) && !ticket.IsBlockNewerThan(nCurrentChainHeight))
             {
                 // check if this ticket is in the same chain as pindexPrev
                 if (pindexPrev)
@@ -192,22 +428,22 @@ public:
     std::string getValueBySecondaryKey(const CPastelTicket& ticket) const;
 
     template <class _TicketType>
-    std::string ListTickets(const uint32_t nMinHeight) const;
+    std::string ListTickets(const uint32_t nMinHeight, const ticket_list_page_t &page = {}) const;
 
     // list NFT registration tickets using filter
     std::string ListFilterPastelIDTickets(const uint32_t nMinHeight, const short filter = 0, // 1 - mn;        2 - personal;     3 - mine
-                                          const pastelid_store_t* pmapIDs = nullptr) const;
-    std::string ListFilterNFTTickets(const uint32_t nMinHeight, const short filter = 0) const;   // 1 - active;    2 - inactive;     3 - transferred
-    std::string ListFilterCollectionTickets(const uint32_t nMinHeight, const short filter = 0) const;   // 1 - active;    2 - inactive;
-    std::string ListFilterActTickets(const uint32_t nMinHeight, const short filter = 0) const;   // 1 - available; 2 - transferred
-    std::string ListFilterOfferTickets(const uint32_t nMinHeight, const short filter = 0, const std::string& pastelID = "") const;  // 0 - all, 1 - available; 2 - unavailable;  3 - expired; 4 - transferred
-    std::string ListFilterAcceptTickets(const uint32_t nMinHeight, const short filter = 0, const std::string& pastelID = "") const;   // 0 - all, 1 - transferred; 2 - expired
-    std::string ListFilterTransferTickets(const uint32_t nMinHeight, const short filter = 0, const std::string& pastelID = "") const; // 0 - all, 1 - available; 2 - transferred
-    std::string ListFilterActionTickets(const uint32_t nMinHeight, const short filter = 0) const; // 1 - active;    2 - inactive
-    std::string ListFilterContractTickets(const uint32_t nMinHeight, const std::string& subtype) const;
+                                          const pastelid_store_t* pmapIDs = nullptr, const ticket_list_page_t &page = {}) const;
+    std::string ListFilterNFTTickets(const uint32_t nMinHeight, const short filter = 0, const ticket_list_page_t &page = {}) const;   // 1 - active;    2 - inactive;     3 - transferred
+    std::string ListFilterCollectionTickets(const uint32_t nMinHeight, const short filter = 0, const ticket_list_page_t &page = {}) const;   // 1 - active;    2 - inactive;
+    std::string ListFilterActTickets(const uint32_t nMinHeight, const short filter = 0, const ticket_list_page_t &page = {}) const;   // 1 - available; 2 - transferred
+    std::string ListFilterOfferTickets(const uint32_t nMinHeight, const short filter = 0, const std::string& pastelID = "", const ticket_list_page_t &page = {}) const;  // 0 - all, 1 - available; 2 - unavailable;  3 - expired; 4 - transferred
+    std::string ListFilterAcceptTickets(const uint32_t nMinHeight, const short filter = 0, const std::string& pastelID = "", const ticket_list_page_t &page = {}) const;   // 0 - all, 1 - transferred; 2 - expired
+    std::string ListFilterTransferTickets(const uint32_t nMinHeight, const short filter = 0, const std::string& pastelID = "", const ticket_list_page_t &page = {}) const; // 0 - all, 1 - available; 2 - transferred
+    std::string ListFilterActionTickets(const uint32_t nMinHeight, const short filter = 0, const ticket_list_page_t &page = {}) const; // 1 - active;    2 - inactive
+    std::string ListFilterContractTickets(const uint32_t nMinHeight, const std::string& subtype, const ticket_list_page_t &page = {}) const;
 
     // search for NFT registration tickets, calls functor for each matching ticket
-    void SearchForNFTs(const search_thumbids_t &p, std::function<size_t(const CPastelTicket *, const nlohmann::json &)> &fnMatchFound) const;
+    void SearchForNFTs(const search_thumbids_t &p, const nft_search_match_func_t &fnMatchFound) const;
 
     static bool FindAndValidateTicketTransaction(const CPastelTicket& ticket,
         const std::string& new_txid, const uint32_t nNewHeight, const bool bPreReg,
@@ -260,14 +496,74 @@ public:
     static bool preParseTicket(const CMutableTransaction& tx, CCompressedDataStream& data_stream,
         TicketID& ticket_id, std::string& error, uint32_t &nMultiSigOutputsCount, CAmount &nMultiSigTxTotalFee,
         const bool bLog = true, const bool bUncompressData = true);
+    // parse ticket from the P2FMS transaction
+    static bool parseTicketTransaction(const CMutableTransaction& tx, parsed_ticket_t &parsedTicket, std::string &error);
+    // create txid index record for the parsed ticket
+    static ticket_txid_index_t createTxIdIndex(const parsed_ticket_t &parsedTicket, const uint32_t nBlockHeight,
+        const uint256 &hashBlock);
 
     // Get mempool tracker for ticket transactions
     static tx_mempool_tracker_t GetTxMemPoolTracker();
 
     static uint32_t GetTicketBlockHeightInActiveChain(const uint256& txid);
 
+    // get ticket cache statistics for the given ticket type
+    ticket_cache_stats_t GetTicketCacheStats(const TicketID id) const { return m_TicketCache.GetStats(id); }
+    size_t GetTicketCacheMaxSize() const noexcept { return m_TicketCache.GetMaxSize(); }
+
 protected:
     bool m_bTicketDBInitialized = false;
+    // LRU cache of the decoded tickets read from the ticket DB
+    mutable CTicketCache m_TicketCache;
+
+    // ticket transactions of the connected blocks waiting for UpdatedBlockTip notification
+    typedef struct _pending_block_txs_t
+    {
+        uint32_t nHeight = 0;
+        std::vector<CTransaction> vTx; // transactions with multisig outputs
+    } pending_block_txs_t;
+    std::mutex m_PendingBlocksLock;
+    std::map<uint256, pending_block_txs_t> m_mapPendingBlocks; // block hash -> ticket transactions
+
+    // write all accumulated DB changes and invalidate ticket cache
+    bool commitDBBatch(CTicketDBBatch &batch, const bool bSync);
+    // parse tickets from the block transactions and update ticket DB
+    void processBlockTickets(const std::vector<CTransaction>& vTx, const CBlockIndex* pBlockIndex, const bool bSync);
+    // add parsed ticket to the ticket DB
+    bool addTicketToDB(parsed_ticket_t &parsedTicket, const unsigned int nBlockHeight, const uint256 &hashBlock,
+        CTicketDBBatch *pBatch);
+    // check or set ticket index build completion marker
+    bool isIndexBuilt(const char *szIndexName) const;
+    void setIndexBuilt(const char *szIndexName, const bool bBuilt);
+    // write or erase ticket DB repair checkpoint
+    bool readRepairCheckpoint(ticket_db_repair_checkpoint_t &checkpoint) const;
+    void writeRepairCheckpoint(const ticket_db_repair_checkpoint_t *pCheckpoint);
+    // get block height to start (or resume) ticket DB repair from
+    uint32_t getRepairStartHeight(const uint32_t nTipHeight) const;
+
+    // read ticket by primary key using ticket cache
+    bool readTicketFromDB(CDBWrapper& db, const std::string& sKey, CPastelTicket& ticket) const;
+    // read primary keys by real secondary key or real mv key using ticket cache
+    bool readKeysFromDB(const TicketID id, CDBWrapper& db, const std::string& sRealKey, v_strings& vKeys) const;
+    // find mv key records of the ticket added at the given block height
+    static void findMVKeyRecords(CDBWrapper& db, const std::string& sRealMVKey, const uint32_t nHeight,
+        const std::string& sKeyOne, std::vector<ticket_mvkey_t>& vKeys);
+    // read ticket using txid index
+    bool readTicketByTxId(const uint256& txid, PastelTicketPtr& ticket, ticket_txid_index_t& txIndex) const;
+    // create NFT search attributes for the NFT registration ticket, DBs are not changed
+    static bool createNFTSearchAttributes(const CPastelTicket& ticket, nft_search_attr_t &attr, nlohmann::json &jApp);
+    // create and store NFT search attributes for the NFT registration ticket
+    bool updateNFTSearchAttributes(const CPastelTicket& ticket, nft_search_attr_t &attr, nlohmann::json &jApp) const;
+    // read NFT search attributes by NFT registration ticket txid
+    bool getNFTSearchAttributes(const std::string& sRegTxId, nft_search_attr_t &attr, nlohmann::json *pjApp = nullptr) const;
+    // add or remove NFT keyword index records for the NFT registration ticket
+    void updateNFTKeywordIndex(const std::string& sRegTxId, const nft_search_attr_t &attr, const bool bErase) const;
+    // remove NFT registration ticket from the NFT search DBs
+    void eraseNFTSearchAttributes(const CPastelTicket& ticket) const;
+    // read NFT keyword index records for the property token, keep only txids from the filter set
+    void readNFTKeywordIndex(const std::string& sPropName, const std::string& sToken, const su_strings &filterSet, su_strings &result) const;
+    // apply fuzzy filter to the candidate set of NFT reg txids using NFT keyword index
+    bool filterByNFTKeywordIndex(const std::string& sPropName, const std::string& sLowercasedFilterValue, su_strings &candidates) const;
 
     static ticket_validation_t ValidateTicketFees(const uint32_t nHeight, const CTransaction& tx, PastelTicketPtr&& ticket) noexcept;
 };
@@ -9,24 +9,32 @@ using namespace std;
 /**
  * Handle notification: transaction was added to the local memory pool.
  * Add txid to a local map if it is recognized as a ticket P2FMS transaction.
+ * Ticket is parsed and added to the ticket key indexes.
  * 
  * \param entry - transaction memory pool entry
  */
 void CTicketTxMemPoolTracker::processTransaction(const CTxMemPoolEntry& entry, [[maybe_unused]] const bool fCurrentEstimate)
 {
-    CCompressedDataStream data_stream(SER_NETWORK, DATASTREAM_VERSION);
-    TicketID ticket_id;
-    uint32_t nMultiSigOutputsCount;
-    CAmount nMultiSigTxTotalFee;
-    string error;
     const auto& tx = entry.GetTx();
-    if (!CPastelTicketProcessor::preParseTicket(tx, data_stream, ticket_id, error, 
-        nMultiSigOutputsCount, nMultiSigTxTotalFee))
+    parsed_ticket_t parsedTicket;
+    string error;
+    if (!CPastelTicketProcessor::parseTicketTransaction(CMutableTransaction(tx), parsedTicket, error))
+    {
+        if (!error.empty())
+            LogPrint("mempool", "Failed to parse P2FMS transaction '%s'. %s\n", tx.GetHash().ToString(), error);
         return;
+    }
+    auto &ticket = parsedTicket.ticket;
+    // set additional ticket transaction data
+    ticket->SetTxId(tx.GetHash().ToString());
+    ticket->SetBlock(entry.GetHeight());
+    const auto ticket_id = ticket->ID();
     {
         EXCLUSIVE_LOCK(m_rwMemPoolLock);
+        if (!m_mapTxid.emplace(tx.GetHash(), ticket_id).second)
+            return;
         m_mapTicket.emplace(ticket_id, tx.GetHash());
-        m_mapTxid.emplace(tx.GetHash(), ticket_id);
+        addTicketToIndex(tx.GetHash(), MemPoolTicketPtr(std::move(ticket)));
     }
 }
 
@@ -46,12 +54,67 @@ void CTicketTxMemPoolTracker::removeTx(const uint256& txid)
         // search in the range only for transaction with txid
         auto toEraseIt = find_if(it.first, it.second, [&](const auto item) -> bool { return item.second == txid; });
         // erase it
-        if (toEraseIt != m_mapTicket.end())
+        if (toEraseIt != it.second)
             m_mapTicket.erase(toEraseIt);
         m_mapTxid.erase(itTx);
+        removeTicketFromIndex(txid);
     }
 }
 
+/**
+ * Add parsed ticket to the primary & secondary key indexes.
+ * Should be called under exclusive lock.
+ * 
+ * \param txid - ticket transaction hash
+ * \param ticket - parsed ticket
+ */
+void CTicketTxMemPoolTracker::addTicketToIndex(const uint256 &txid, MemPoolTicketPtr &&ticket)
+{
+    const auto nIndex = to_integral_type(ticket->ID());
+    if (nIndex >= m_TicketIndex.size())
+        return;
+    auto &index = m_TicketIndex[nIndex];
+    index.mapKeyOne.emplace(ticket->KeyOne(), txid);
+    if (ticket->HasKeyTwo())
+        index.mapKeyTwo.emplace(ticket->KeyTwo(), txid);
+    m_mapTxTicket.emplace(txid, std::move(ticket));
+}
+
+/**
+ * Remove ticket from the primary & secondary key indexes.
+ * Should be called under exclusive lock.
+ * 
+ * \param txid - ticket transaction hash
+ */
+void CTicketTxMemPoolTracker::removeTicketFromIndex(const uint256 &txid)
+{
+    const auto itTicket = m_mapTxTicket.find(txid);
+    if (itTicket == m_mapTxTicket.end())
+        return;
+    const auto &ticket = itTicket->second;
+    const auto nIndex = to_integral_type(ticket->ID());
+    if (nIndex < m_TicketIndex.size())
+    {
+        auto eraseKey = [&](mempool_keymap_t &mapKey, const string &sKey)
+        {
+            const auto range = mapKey.equal_range(sKey);
+            for (auto it = range.first; it != range.second; ++it)
+            {
+                if (it->second == txid)
+                {
+                    mapKey.erase(it);
+                    break;
+                }
+            }
+        };
+        auto &index = m_TicketIndex[nIndex];
+        eraseKey(index.mapKeyOne, ticket->KeyOne());
+        if (ticket->HasKeyTwo())
+            eraseKey(index.mapKeyTwo, ticket->KeyTwo());
+    }
+    m_mapTxTicket.erase(itTicket);
+}
+
 /**
  * Get list of ticket transactions in mempool by ticket id.
  * Returned vector is just current snapshot of the ticket transactions in the mempool.
@@ -84,3 +147,103 @@ size_t CTicketTxMemPoolTracker::count(const TicketID ticket_id) const noexcept
     SHARED_LOCK(m_rwMemPoolLock);
     return m_mapTicket.count(ticket_id);
 }
+
+/**
+ * Find first ticket with the given key in the key index.
+ * Should be called under shared lock.
+ * 
+ * \param mapKey - key index (primary or secondary)
+ * \param sKey - key to search for
+ * \return ticket or nullptr if not found
+ */
+MemPoolTicketPtr CTicketTxMemPoolTracker::findByKey(const mempool_keymap_t &mapKey, const string &sKey) const noexcept
+{
+    const auto itKey = mapKey.find(sKey);
+    if (itKey == mapKey.cend())
+        return nullptr;
+    const auto itTicket = m_mapTxTicket.find(itKey->second);
+    if (itTicket == m_mapTxTicket.cend())
+        return nullptr;
+    return itTicket->second;
+}
+
+/**
+ * Find ticket in mempool by primary key.
+ * 
+ * \param ticket_id - ticket type
+ * \param sKeyOne - ticket primary key
+ * \return ticket or nullptr if not found
+ */
+MemPoolTicketPtr CTicketTxMemPoolTracker::findTicket(const TicketID ticket_id, const string &sKeyOne) const noexcept
+{
+    const auto nIndex = to_integral_type(ticket_id);
+    if (nIndex >= m_TicketIndex.size())
+        return nullptr;
+    SHARED_LOCK(m_rwMemPoolLock);
+    return findByKey(m_TicketIndex[nIndex].mapKeyOne, sKeyOne);
+}
+
+/**
+ * Find ticket in mempool by secondary key.
+ * 
+ * \param ticket_id - ticket type
+ * \param sKeyTwo - ticket secondary key
+ * \return ticket or nullptr if not found
+ */
+MemPoolTicketPtr CTicketTxMemPoolTracker::findTicketBySecondaryKey(const TicketID ticket_id, const string &sKeyTwo) const noexcept
+{
+    const auto nIndex = to_integral_type(ticket_id);
+    if (nIndex >= m_TicketIndex.size())
+        return nullptr;
+    SHARED_LOCK(m_rwMemPoolLock);
+    return findByKey(m_TicketIndex[nIndex].mapKeyTwo, sKeyTwo);
+}
+
+bool CTicketTxMemPoolTracker::ticketExists(const TicketID ticket_id, const string &sKeyOne) const noexcept
+{
+    const auto nIndex = to_integral_type(ticket_id);
+    if (nIndex >= m_TicketIndex.size())
+        return false;
+    SHARED_LOCK(m_rwMemPoolLock);
+    return m_TicketIndex[nIndex].mapKeyOne.count(sKeyOne) > 0;
+}
+
+bool CTicketTxMemPoolTracker::ticketExistsBySecondaryKey(const TicketID ticket_id, const string &sKeyTwo) const noexcept
+{
+    const auto nIndex = to_integral_type(ticket_id);
+    if (nIndex >= m_TicketIndex.size())
+        return false;
+    SHARED_LOCK(m_rwMemPoolLock);
+    return m_TicketIndex[nIndex].mapKeyTwo.count(sKeyTwo) > 0;
+}
+
+/**
+ * List tickets in mempool by primary key (and optional secondary key).
+ * 
+ * \param ticket_id - ticket type
+ * \param vTicket - tickets found are added to this vector
+ * \param sKeyOne - primary key filter
+ * \param psKeyTwo - optional secondary key filter
+ * \return number of tickets found
+ */
+size_t CTicketTxMemPoolTracker::listTickets(const TicketID ticket_id, MemPoolTickets_t &vTicket,
+    const string &sKeyOne, const string *psKeyTwo) const noexcept
+{
+    const auto nIndex = to_integral_type(ticket_id);
+    if (nIndex >= m_TicketIndex.size())
+        return 0;
+    size_t nCount = 0;
+    SHARED_LOCK(m_rwMemPoolLock);
+    const auto range = m_TicketIndex[nIndex].mapKeyOne.equal_range(sKeyOne);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const auto itTicket = m_mapTxTicket.find(it->second);
+        if (itTicket == m_mapTxTicket.cend())
+            continue;
+        if (psKeyTwo && (*psKeyTwo != itTicket->second->KeyTwo()))
+            continue;
+        vTicket.push_back(itTicket->second);
+        ++nCount;
+    }
+    return nCount;
+}
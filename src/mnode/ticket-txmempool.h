@@ -2,6 +2,8 @@
 // Copyright (c) 2021-2023 The Pastel Core developers
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <array>
+#include <memory>
 #include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
@@ -11,9 +13,14 @@
 #include <mnode/tickets/ticket.h>
 #include <mnode/tickets/ticket-types.h>
 
+// ticket parsed from the mempool transaction, never modified after it was added to the tracker
+using MemPoolTicketPtr = std::shared_ptr<const CPastelTicket>;
+using MemPoolTickets_t = std::vector<MemPoolTicketPtr>;
+
 /**
  * Track P2FMS transactions with Pastel Tickets accepted to the local memory pool.
- * 
+ * Tickets are parsed once when transaction is added to the mempool and indexed
+ * by primary and secondary keys for each ticket type.
  */
 class CTicketTxMemPoolTracker : public ITxMemPoolTracker
 {
@@ -31,13 +38,44 @@ public:
     // get number of ticket transactions in mempool by ticket id
     virtual size_t count(const TicketID ticket_id) const noexcept;
 
+    // find first ticket in mempool by primary key
+    MemPoolTicketPtr findTicket(const TicketID ticket_id, const std::string &sKeyOne) const noexcept;
+    // find first ticket in mempool by secondary key
+    MemPoolTicketPtr findTicketBySecondaryKey(const TicketID ticket_id, const std::string &sKeyTwo) const noexcept;
+    // check if ticket exists in mempool by primary key
+    bool ticketExists(const TicketID ticket_id, const std::string &sKeyOne) const noexcept;
+    // check if ticket exists in mempool by secondary key
+    bool ticketExistsBySecondaryKey(const TicketID ticket_id, const std::string &sKeyTwo) const noexcept;
+    // list tickets in mempool by primary key (and optional secondary key)
+    size_t listTickets(const TicketID ticket_id, MemPoolTickets_t &vTicket, const std::string &sKeyOne,
+        const std::string *psKeyTwo = nullptr) const noexcept;
+
 protected:
     using mempool_txidmap_t = std::unordered_map<uint256, TicketID>;
     using mempool_ticketidmap_t = std::unordered_multimap<TicketID, uint256>;
+    using mempool_keymap_t = std::unordered_multimap<std::string, uint256>;
+    // mempool ticket index for one ticket type
+    typedef struct _mempool_ticket_index_t
+    {
+        mempool_keymap_t mapKeyOne; // primary key -> txid
+        mempool_keymap_t mapKeyTwo; // secondary key -> txid
+    } mempool_ticket_index_t;
+
     // read-write lock to protect access to maps
     mutable CSharedMutex m_rwMemPoolLock;
     // map of ticket transactions accepted into the local mempool: ticket id -> txid
     mempool_ticketidmap_t m_mapTicket;
     // map of txid -> ticketm_mapTicket id
     mempool_txidmap_t m_mapTxid;
+    // map of txid -> parsed ticket
+    std::unordered_map<uint256, MemPoolTicketPtr> m_mapTxTicket;
+    // ticket key indexes per ticket type
+    std::array<mempool_ticket_index_t, to_integral_type(TicketID::COUNT)> m_TicketIndex;
+
+    // add parsed ticket to the key indexes, should be called under exclusive lock
+    void addTicketToIndex(const uint256 &txid, MemPoolTicketPtr &&ticket);
+    // remove ticket from the key indexes, should be called under exclusive lock
+    void removeTicketFromIndex(const uint256 &txid);
+    // find first ticket with the given key, should be called under shared lock
+    MemPoolTicketPtr findByKey(const mempool_keymap_t &mapKey, const std::string &sKey) const noexcept;
 };
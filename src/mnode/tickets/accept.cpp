@@ -57,7 +57,7 @@ ticket_validation_t CAcceptTicket::IsValid(const TxOrigin txOrigin, const uint32
             // initialize Pastel Ticket mempool processor for accept tickets
             // retrieve mempool transactions with TicketID::Accept tickets
             CPastelTicketMemPoolProcessor TktMemPool(ID());
-            TktMemPool.Initialize(mempool);
+            TktMemPool.Initialize();
             // check if Accept ticket with the same Offer txid is already in the mempool
             if (TktMemPool.TicketExists(KeyOne()))
             {
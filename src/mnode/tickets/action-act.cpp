@@ -123,7 +123,7 @@ ticket_validation_t CActionActivateTicket::IsValid(const TxOrigin txOrigin, cons
             // initialize Pastel Ticket mempool processor for action activate tickets
 			// retrieve mempool transactions with TicketID::ActionAct tickets
 			CPastelTicketMemPoolProcessor TktMemPool(ID());
-			TktMemPool.Initialize(mempool);
+			TktMemPool.Initialize();
             // check if Action Activation ticket with the same Registration txid is already in the mempool
             if (TktMemPool.TicketExists(KeyOne()))
             {
@@ -75,7 +75,7 @@ ticket_validation_t CollectionActivateTicket::IsValid(const TxOrigin txOrigin, c
 			// initialize Pastel Ticket mempool processor for collection activate tickets
 			// retrieve mempool transactions with TicketID::CollectionActivate tickets
 			CPastelTicketMemPoolProcessor TktMemPool(ID());
-			TktMemPool.Initialize(mempool);
+			TktMemPool.Initialize();
 			// check if Collection Activate ticket with the same Registration txid is already in the mempool
             if (TktMemPool.TicketExists(KeyOne()))
             {
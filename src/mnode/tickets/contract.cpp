@@ -62,7 +62,7 @@ ticket_validation_t CContractTicket::IsValid(const TxOrigin txOrigin, const uint
 		// initialize Pastel Ticket mempool processor for contract tickets
 		// retrieve mempool transactions with TicketID::Contract tickets
 		CPastelTicketMemPoolProcessor TktMemPool(ID());
-		TktMemPool.Initialize(mempool);
+		TktMemPool.Initialize();
 
 		if (bPreReg)
 		{
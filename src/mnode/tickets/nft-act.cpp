@@ -72,7 +72,7 @@ ticket_validation_t CNFTActivateTicket::IsValid(const TxOrigin txOrigin, const u
             // initialize Pastel Ticket mempool processor for NFT Activation tickets
 			// retrieve mempool transactions with TicketID::Activate tickets
 			CPastelTicketMemPoolProcessor TktMemPool(ID());
-			TktMemPool.Initialize(mempool);
+			TktMemPool.Initialize();
 			// check if the NFT Activation ticket is already in the mempool
             if (TktMemPool.TicketExists(KeyOne()))
             {
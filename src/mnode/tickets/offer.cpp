@@ -179,7 +179,7 @@ ticket_validation_t COfferTicket::IsValid(const TxOrigin txOrigin, const uint32_
             // initialize Pastel Ticket mempool processor for offer tickets
             // retrieve mempool transactions with TicketID::Offer tickets
             CPastelTicketMemPoolProcessor TktMemPool(ID());
-            TktMemPool.Initialize(mempool);
+            TktMemPool.Initialize();
             // check if Offer ticket with the same Registration txid is already in the mempool
             if (TktMemPool.TicketExists(KeyOne()))
             {
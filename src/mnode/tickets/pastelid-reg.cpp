@@ -141,7 +141,7 @@ ticket_validation_t CPastelIDRegTicket::IsValid(const TxOrigin txOrigin, const u
             // initialize Pastel Ticket mempool processor for pastelid tickets
             // retrieve mempool transactions with TicketID::PastelID tickets
             CPastelTicketMemPoolProcessor TktMemPool(ID());
-            TktMemPool.Initialize(mempool);
+            TktMemPool.Initialize();
             // check if PastelID registration ticket with the same Pastel ID is already in the mempool
             if (TktMemPool.TicketExists(KeyOne()))
             {
@@ -21,3 +21,70 @@
 #include <mnode/tickets/username-change.h>
 #include <mnode/tickets/ethereum-address-change.h>
 #include <mnode/tickets/contract.h>
+
+/**
+ * Map ticket type ID to the ticket class.
+ */
+template <TicketID>
+struct TicketTypeMapper;
+
+template <> struct TicketTypeMapper<TicketID::PastelID>
+{
+	using TicketType = CPastelIDRegTicket;
+};
+template <> struct TicketTypeMapper<TicketID::NFT>
+{
+	using TicketType = CNFTRegTicket;
+};
+template <> struct TicketTypeMapper<TicketID::Activate>
+{
+	using TicketType = CNFTActivateTicket;
+};
+template <> struct TicketTypeMapper<TicketID::Offer>
+{
+	using TicketType = COfferTicket;
+};
+template <> struct TicketTypeMapper<TicketID::Accept>
+{
+	using TicketType = CAcceptTicket;
+};
+template <> struct TicketTypeMapper<TicketID::Transfer>
+{
+	using TicketType = CTransferTicket;
+};
+template <> struct TicketTypeMapper<TicketID::Down>
+{
+	using TicketType = CTakeDownTicket;
+};
+template <> struct TicketTypeMapper<TicketID::Royalty>
+{
+	using TicketType = CNFTRoyaltyTicket;
+};
+template <> struct TicketTypeMapper<TicketID::Username>
+{
+	using TicketType = CChangeUsernameTicket;
+};
+template <> struct TicketTypeMapper<TicketID::EthereumAddress>
+{
+	using TicketType = CChangeEthereumAddressTicket;
+};
+template <> struct TicketTypeMapper<TicketID::ActionReg>
+{
+	using TicketType = CActionRegTicket;
+};
+template <> struct TicketTypeMapper<TicketID::ActionActivate>
+{
+	using TicketType = CActionActivateTicket;
+};
+template <> struct TicketTypeMapper<TicketID::CollectionReg>
+{
+	using TicketType = CollectionRegTicket;
+};
+template <> struct TicketTypeMapper<TicketID::CollectionAct>
+{
+	using TicketType = CollectionActivateTicket;
+};
+template <> struct TicketTypeMapper<TicketID::Contract>
+{
+	using TicketType = CContractTicket;
+};
@@ -261,7 +261,7 @@ ticket_validation_t CTransferTicket::IsValid(const TxOrigin txOrigin, const uint
             // initialize Pastel Ticket mempool processor for transfer tickets
 			// retrieve mempool transactions with TicketID::Transfer tickets
 			CPastelTicketMemPoolProcessor TktMemPool(ID());
-			TktMemPool.Initialize(mempool);
+			TktMemPool.Initialize();
             // check if Transfer ticket with the same Offer txid is already in the mempool
             if (TktMemPool.TicketExists(KeyOne()))
             {
@@ -131,7 +131,7 @@ ticket_validation_t CChangeUsernameTicket::IsValid(const TxOrigin txOrigin, cons
     // initialize Pastel Ticket mempool processor for username-change tickets
     // retrieve mempool transactions with TicketID::Username tickets
     CPastelTicketMemPoolProcessor TktMemPool(ID());
-    TktMemPool.Initialize(mempool);
+    TktMemPool.Initialize();
 
     CChangeUsernameTicket tktDB, tktMP;
     const bool bTicketExistsInDB = FindTicketInDb(m_sUserName, tktDB, pindexPrev);
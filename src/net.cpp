@@ -39,6 +39,7 @@
 #include <netmsg/nodestate.h>
 #include <netmsg/nodemanager.h>
 #include <netmsg/node.h>
+#include <netmsg/socket-poller.h>
 #include <mining/eligibility-mgr.h>
 //MasterNode
 #include <mnode/mnode-controller.h>
@@ -47,6 +48,8 @@ using namespace std;
 
 constexpr int64_t ONE_DAY = 24 * 3600;
 constexpr int64_t ONE_WEEK = 7 * ONE_DAY;
+// frequency to poll pnode->vSend, ms
+constexpr int SOCKET_POLL_TIMEOUT_MS = 50;
 
 // Dump addresses to peers.dat every 15 minutes (900s)
 #define DUMP_ADDRESSES_INTERVAL 900
@@ -131,15 +134,179 @@ void AddressCurrentlyConnected(const CService& addr)
 CWaitableCriticalSection gl_cs_vNodesDisconnected;
 static node_list_t gl_vNodesDisconnected;
 
+/**
+ * Update socket events to watch for the node.
+ *
+ * Implement the following logic:
+ * * If there is data to send, wait for sending data. As this only
+ *   happens when optimistic write failed, we choose to first drain the
+ *   write buffer in this case before receiving more. This avoids
+ *   needlessly queueing received data, if the remote peer is not themselves
+ *   receiving data. This means properly utilizing TCP flow control signaling.
+ * * Otherwise, if there is no (complete) message in the receive buffer,
+ *   or there is space left in the buffer, wait for receiving data.
+ * * (if neither of the above applies, there is certainly one message
+ *   in the receiver buffer ready to be processed).
+ * Together, that means that at least one of the following is always possible,
+ * so we don't deadlock:
+ * * We send some data.
+ * * We wait for data to be received (and disconnect after timeout).
+ * * We process a message in the buffer (message handler thread).
+ * Socket errors are always watched for.
+ * Interest is updated only when the node state changes: data is queued to send or sent,
+ * data is received or receive buffer is processed by the message handler.
+ *
+ * \param poller - socket poller
+ * \param pnode - node to update socket interest for
+ * \return false if the node buffers are locked by another thread, interest should be updated later
+ */
+static bool UpdateSocketInterest(CSocketPoller &poller, const node_t &pnode)
+{
+    const SOCKET hSocket = pnode->hSocket;
+    if (hSocket == INVALID_SOCKET)
+        return true;
+    uint8_t nEvents = SOCKET_EVENT_NONE;
+    {
+        TRY_LOCK(pnode->cs_vSendMsg, lockSend);
+        if (!lockSend)
+            return false;
+        if (!pnode->vSendMsg.empty())
+            nEvents = SOCKET_EVENT_SEND;
+    }
+    {
+        TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
+        if (!lockRecv)
+            return false;
+        if ((nEvents == SOCKET_EVENT_NONE) && pnode->CanReceiveMore())
+            nEvents = SOCKET_EVENT_RECV;
+        // message handler notifies us when it processes the receive buffer
+        pnode->fRecvPaused = !(nEvents & SOCKET_EVENT_RECV);
+    }
+    // poller is updated only if the events to watch for have changed
+    poller.SetInterest(hSocket, pnode->id, nEvents);
+    return true;
+}
+
+/**
+ * Receive data from the node socket.
+ * 
+ * \param pnode - node to receive data from
+ */
+static void ReceiveSocketData(const node_t &pnode)
+{
+    TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
+    if (!lockRecv)
+        return;
+    // typical socket buffer is 8K-64K
+    char pchBuf[0x10000];
+    int nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
+    if (nBytes > 0)
+    {
+        if (!pnode->ReceiveMsgBytes(pchBuf, nBytes))
+            pnode->CloseSocketDisconnect();
+        pnode->nLastRecv = GetTime();
+        pnode->nRecvBytes += nBytes;
+        pnode->RecordBytesRecv(nBytes);
+    }
+    else if (nBytes == 0)
+    {
+        // socket closed gracefully
+        if (!pnode->fDisconnect)
+            LogPrint("net", "peer=%d socket closed gracefully\n", pnode->GetId());
+        pnode->CloseSocketDisconnect();
+    }
+    else if (nBytes < 0)
+    {
+        // error
+        int nErr = WSAGetLastError();
+        if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
+        {
+            if (!pnode->fDisconnect)
+                LogFnPrintf("socket recv error %s", GetErrorString(nErr));
+            pnode->CloseSocketDisconnect();
+        }
+    }
+}
+
+/**
+ * Inactivity checking.
+ * If network disconnected - do not check for inactivity.
+ * If network was connected recently - wait for some time before checking for inactivity.
+ * 
+ * \param pnode - node to check
+ * \param nTime - current time
+ */
+static void CheckNodeInactivity(const node_t &pnode, const int64_t nTime)
+{
+    if (!gl_NetMgr.IsNetworkConnected() || (nTime - pnode->nTimeConnected <= 60))
+        return;
+    if (gl_NetMgr.IsNetworkConnectedRecently())
+    {
+        if (!pnode->fPingQueued)
+        {
+            pnode->fPingQueued = true;
+            LogFnPrintf("Node %d ping queued after %" PRId64 "s of network inactivity", pnode->id, gl_NetMgr.GetNetworkInactivityTime(nTime));
+        }
+        return;
+    }
+    if (pnode->nLastRecv == 0 || pnode->nLastSend == 0)
+    {
+        LogFnPrint("net", "socket no message in first 60 seconds, %d %d from %d", pnode->nLastRecv != 0, pnode->nLastSend != 0, pnode->id);
+        pnode->fDisconnect = true;
+    }
+    else if (nTime - pnode->nLastSend > DISCONNECT_TIMEOUT_INTERVAL_SECS)
+    {
+        LogFnPrintf("socket sending timeout: %" PRId64 "s", nTime - pnode->nLastSend);
+        pnode->fDisconnect = true;
+    }
+    else if (nTime - pnode->nLastRecv > (pnode->nVersion > BIP0031_VERSION ? DISCONNECT_TIMEOUT_INTERVAL_SECS : 90 * 60))
+    {
+        LogFnPrintf("socket receive timeout: %" PRId64 "s", nTime - pnode->nLastRecv);
+        pnode->fDisconnect = true;
+    }
+    else if (pnode->nPingNonceSent && pnode->nPingUsecStart + DISCONNECT_TIMEOUT_INTERVAL_SECS * 1000000 < GetTimeMicros())
+    {
+        LogFnPrintf("ping timeout: %fs", 0.000001 * (GetTimeMicros() - pnode->nPingUsecStart));
+        pnode->fDisconnect = true;
+    }
+}
+
+/**
+ * Socket handler thread.
+ * Only the sockets reported by the poller are serviced on each wakeup.
+ * Socket events to watch for are updated when the node state changes
+ * (see UpdateSocketInterest), other threads notify us via CNodeManager::NotifySocketInterest.
+ * All nodes are checked for disconnect requests and inactivity once per second.
+ */
 void CSocketHandlerThread::execute()
 {
     size_t nPrevNodeCount = 0;
+    auto pPoller = CSocketPoller::Create();
+    LogFnPrintf("using %s socket poller", pPoller->GetName());
+    for (const auto& hListenSocket : vhListenSocket)
+        pPoller->SetInterest(hListenSocket.socket, -1, SOCKET_EVENT_RECV);
+
+    // nodes with sockets registered in the poller
+    typedef struct _poll_node_t
+    {
+        node_t pnode;
+        SOCKET hSocket;
+    } poll_node_t;
+    unordered_map<NodeId, poll_node_t> mapPollNodes;
+    vector<NodeId> vChangedNodeIds;
+    vector<CSocketPoller::socket_event_t> vReadySockets;
+    int64_t nLastCheckTime = 0;
+    // set when the node socket was closed, disconnected nodes are removed without waiting for the periodic check
+    bool bCheckDisconnect = false;
     while (!shouldStop())
     {
-        //
-        // Disconnect nodes
-        //
+        const int64_t nTime = GetTime();
+        // all nodes are checked once per second
+        const bool bCheckAllNodes = nTime != nLastCheckTime;
+        nLastCheckTime = nTime;
+        if (bCheckAllNodes || bCheckDisconnect)
         {
+            bCheckDisconnect = false;
             // Disconnect unused nodes
             node_vector_t vNodesCopy = gl_NodeManager.CopyNodes();
             node_set_t vNodesToRemove;
@@ -154,6 +321,13 @@ void CSocketHandlerThread::execute()
                     pnode->grantOutbound.Release();
                     // close socket and cleanup
                     pnode->CloseSocketDisconnect();
+                    // forget the node socket, its descriptor can be reused by the new connection
+                    const auto it = mapPollNodes.find(pnode->id);
+                    if (it != mapPollNodes.end())
+                    {
+                        pPoller->Remove(it->second.hSocket, pnode->id);
+                        mapPollNodes.erase(it);
+                    }
 
                     vNodesToRemove.emplace(pnode);
                     {
@@ -161,6 +335,8 @@ void CSocketHandlerThread::execute()
                         gl_vNodesDisconnected.push_back(pnode);
                     }
                 }
+                else if (bCheckAllNodes && (pnode->hSocket != INVALID_SOCKET))
+                    CheckNodeInactivity(pnode, nTime);
 
                 if (shouldStop())
                     break;
@@ -221,107 +397,52 @@ void CSocketHandlerThread::execute()
         }
 
         //
-        // Find which sockets have data to receive
+        // Update socket events to watch for the new nodes and nodes changed by other threads
         //
-        struct timeval timeout;
-        timeout.tv_sec  = 0;
-        timeout.tv_usec = 50000; // frequency to poll pnode->vSend
-
-        fd_set fdsetRecv;
-        fd_set fdsetSend;
-        fd_set fdsetError;
-        FD_ZERO(&fdsetRecv);
-        FD_ZERO(&fdsetSend);
-        FD_ZERO(&fdsetError);
-        SOCKET hSocketMax = 0;
-        bool have_fds = false;
-
-        for (const auto& hListenSocket : vhListenSocket)
+        gl_NodeManager.TakeSocketInterestChanges(vChangedNodeIds);
+        for (const NodeId id : vChangedNodeIds)
         {
-            FD_SET(hListenSocket.socket, &fdsetRecv);
-            hSocketMax = max(hSocketMax, hListenSocket.socket);
-            have_fds = true;
-        }
-
-        {
-            node_vector_t vNodesCopy = gl_NodeManager.CopyNodes();
-            for (auto &pnode : vNodesCopy)
+            auto it = mapPollNodes.find(id);
+            node_t pnode = it == mapPollNodes.end() ? gl_NodeManager.FindNode(id) : it->second.pnode;
+            if (!pnode || pnode->fDisconnect)
+                continue;
+            pnode->fSocketInterestChanged = false;
+            if (!UpdateSocketInterest(*pPoller, pnode))
             {
-                if (pnode->hSocket == INVALID_SOCKET)
-                    continue;
-                FD_SET(pnode->hSocket, &fdsetError);
-                hSocketMax = max(hSocketMax, pnode->hSocket);
-                have_fds = true;
-
-                // Implement the following logic:
-                // * If there is data to send, select() for sending data. As this only
-                //   happens when optimistic write failed, we choose to first drain the
-                //   write buffer in this case before receiving more. This avoids
-                //   needlessly queueing received data, if the remote peer is not themselves
-                //   receiving data. This means properly utilizing TCP flow control signaling.
-                // * Otherwise, if there is no (complete) message in the receive buffer,
-                //   or there is space left in the buffer, select() for receiving data.
-                // * (if neither of the above applies, there is certainly one message
-                //   in the receiver buffer ready to be processed).
-                // Together, that means that at least one of the following is always possible,
-                // so we don't deadlock:
-                // * We send some data.
-                // * We wait for data to be received (and disconnect after timeout).
-                // * We process a message in the buffer (message handler thread).
-                {
-                    TRY_LOCK(pnode->cs_vSendMsg, lockSend);
-                    if (lockSend && !pnode->vSendMsg.empty())
-                    {
-                        FD_SET(pnode->hSocket, &fdsetSend);
-                        continue;
-                    }
-                }
-                {
-                    TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
-                    if (lockRecv && (
-                        pnode->vRecvMsg.empty() || !pnode->vRecvMsg.front().complete() ||
-                        pnode->GetTotalRecvSize() <= ReceiveFloodSize()))
-                        FD_SET(pnode->hSocket, &fdsetRecv);
-                }
-                if (shouldStop())
-                    break;
+                // try again on the next wakeup
+                gl_NodeManager.NotifySocketInterest(*pnode);
+                continue;
             }
-            if (shouldStop())
-                break;
+            if ((it == mapPollNodes.end()) && (pnode->hSocket != INVALID_SOCKET))
+                mapPollNodes.emplace(id, poll_node_t{ pnode, pnode->hSocket });
         }
+        if (shouldStop())
+            break;
 
-        int nSelect = select(have_fds ? static_cast<int>(hSocketMax + 1) : 0,
-                             &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
+        const int nReady = pPoller->Wait(SOCKET_POLL_TIMEOUT_MS);
         if (shouldStop())
             break;
 
-        if (nSelect == SOCKET_ERROR)
+        if (nReady == SOCKET_ERROR)
         {
-            if (have_fds)
-            {
-                int nErr = WSAGetLastError();
-                LogFnPrintf("socket select error %s", GetErrorString(nErr));
-                for (unsigned int i = 0; i <= hSocketMax; i++)
-                    FD_SET(i, &fdsetRecv);
-            }
-            FD_ZERO(&fdsetSend);
-            FD_ZERO(&fdsetError);
+            LogFnPrintf("socket %s error %s", pPoller->GetName(), GetErrorString(WSAGetLastError()));
+            unique_lock lck(m_mutex);
+            if (m_condVar.wait_for(lck, chrono::milliseconds(SOCKET_POLL_TIMEOUT_MS)) == cv_status::no_timeout)
             {
-                unique_lock lck(m_mutex);
-                if (m_condVar.wait_for(lck, chrono::milliseconds(timeout.tv_usec / 1000)) == cv_status::no_timeout)
-                {
-                    if (shouldStop())
-                        break;
-                }
+                if (shouldStop())
+                    break;
             }
+            continue;
         }
+        if (nReady == 0)
+            continue;
 
         //
         // Accept new connections
         //
         for (const auto& hListenSocket : vhListenSocket)
         {
-            if (hListenSocket.socket != INVALID_SOCKET && FD_ISSET(hListenSocket.socket, &fdsetRecv))
+            if (hListenSocket.socket != INVALID_SOCKET && (pPoller->GetEvents(hListenSocket.socket) & SOCKET_EVENT_RECV))
             {
                 gl_NodeManager.AcceptConnection(hListenSocket);
             }
@@ -330,112 +451,58 @@ void CSocketHandlerThread::execute()
         }
 
         //
-        // Service each socket
+        // Service only the sockets reported by the poller
         //
-        node_vector_t vNodesCopy = gl_NodeManager.CopyNodes();
-        for (auto& pnode : vNodesCopy)
+        pPoller->GetReadySockets(vReadySockets);
+        for (const auto& socketEvent : vReadySockets)
         {
             if (shouldStop())
                 break;
+            // listening socket
+            if (socketEvent.nOwnerId < 0)
+                continue;
 
-            //
-            // Receive
-            //
-            if (pnode->hSocket == INVALID_SOCKET)
+            const auto it = mapPollNodes.find(socketEvent.nOwnerId);
+            if (it == mapPollNodes.end())
+            {
+                pPoller->Remove(socketEvent.hSocket, socketEvent.nOwnerId);
                 continue;
-            if (FD_ISSET(pnode->hSocket, &fdsetRecv) || FD_ISSET(pnode->hSocket, &fdsetError))
+            }
+            const node_t &pnode = it->second.pnode;
+            // socket was closed by another thread
+            if (pnode->hSocket != socketEvent.hSocket)
             {
-                TRY_LOCK(pnode->cs_vRecvMsg, lockRecv);
-                if (lockRecv)
-                {
-                    {
-                        // typical socket buffer is 8K-64K
-                        char pchBuf[0x10000];
-                        int nBytes = recv(pnode->hSocket, pchBuf, sizeof(pchBuf), MSG_DONTWAIT);
-                        if (nBytes > 0)
-                        {
-                            if (!pnode->ReceiveMsgBytes(pchBuf, nBytes))
-                                pnode->CloseSocketDisconnect();
-                            pnode->nLastRecv = GetTime();
-                            pnode->nRecvBytes += nBytes;
-                            pnode->RecordBytesRecv(nBytes);
-                        }
-                        else if (nBytes == 0)
-                        {
-                            // socket closed gracefully
-                            if (!pnode->fDisconnect)
-                                LogPrint("net", "peer=%d socket closed gracefully\n", pnode->GetId());
-                            pnode->CloseSocketDisconnect();
-                        }
-                        else if (nBytes < 0)
-                        {
-                            // error
-                            int nErr = WSAGetLastError();
-                            if (nErr != WSAEWOULDBLOCK && nErr != WSAEMSGSIZE && nErr != WSAEINTR && nErr != WSAEINPROGRESS)
-                            {
-                                if (!pnode->fDisconnect)
-                                    LogFnPrintf("socket recv error %s", GetErrorString(nErr));
-                                pnode->CloseSocketDisconnect();
-                            }
-                        }
-                    }
-                }
+                pPoller->Remove(socketEvent.hSocket, socketEvent.nOwnerId);
+                bCheckDisconnect = true;
+                continue;
             }
 
+            //
+            // Receive
+            //
+            if (socketEvent.nEvents & (SOCKET_EVENT_RECV | SOCKET_EVENT_ERROR))
+                ReceiveSocketData(pnode);
+
             //
             // Send
             //
-            if (pnode->hSocket == INVALID_SOCKET)
-                continue;
-            if (FD_ISSET(pnode->hSocket, &fdsetSend))
+            if ((pnode->hSocket != INVALID_SOCKET) && (socketEvent.nEvents & SOCKET_EVENT_SEND))
             {
                 TRY_LOCK(pnode->cs_vSendMsg, lockSend);
                 if (lockSend)
                     SocketSendData(*pnode);
             }
 
-            //
-            // Inactivity checking
-            // if network disconnected - do not check for inactivity
-            // if network was connected recently - wait for some time before checking for inactivity
-            //
-            int64_t nTime = GetTime();
-            if (gl_NetMgr.IsNetworkConnected() && (nTime - pnode->nTimeConnected > 60))
-            {   
-                if (gl_NetMgr.IsNetworkConnectedRecently())
-                {
-                    if (!pnode->fPingQueued)
-                    {
-                        pnode->fPingQueued = true;
-                        LogFnPrintf("Node %d ping queued after %" PRId64 "s of network inactivity", pnode->id, gl_NetMgr.GetNetworkInactivityTime(nTime));
-                    }
-                }
-                else
-                {
-                    if (pnode->nLastRecv == 0 || pnode->nLastSend == 0)
-                    {
-                        LogFnPrint("net", "socket no message in first 60 seconds, %d %d from %d", pnode->nLastRecv != 0, pnode->nLastSend != 0, pnode->id);
-                        pnode->fDisconnect = true;
-                    }
-                    else if (nTime - pnode->nLastSend > DISCONNECT_TIMEOUT_INTERVAL_SECS)
-                    {
-                        LogFnPrintf("socket sending timeout: %" PRId64 "s", nTime - pnode->nLastSend);
-                        pnode->fDisconnect = true;
-                    }
-                    else if (nTime - pnode->nLastRecv > (pnode->nVersion > BIP0031_VERSION ? DISCONNECT_TIMEOUT_INTERVAL_SECS : 90 * 60))
-                    {
-                        LogFnPrintf("socket receive timeout: %" PRId64 "s", nTime - pnode->nLastRecv);
-                        pnode->fDisconnect = true;
-                    }
-                    else if (pnode->nPingNonceSent && pnode->nPingUsecStart + DISCONNECT_TIMEOUT_INTERVAL_SECS * 1000000 < GetTimeMicros())
-                    {
-                        LogFnPrintf("ping timeout: %fs", 0.000001 * (GetTimeMicros() - pnode->nPingUsecStart));
-                        pnode->fDisconnect = true;
-                    }
-                }
+            if (pnode->hSocket == INVALID_SOCKET)
+            {
+                pPoller->Remove(socketEvent.hSocket, socketEvent.nOwnerId);
+                bCheckDisconnect = true;
+                continue;
             }
+            // data was received or sent - update socket events to watch for
+            if (!UpdateSocketInterest(*pPoller, pnode))
+                gl_NodeManager.NotifySocketInterest(*pnode);
         }
-        vNodesCopy.clear();
     }
 }
 
@@ -856,11 +923,14 @@ public:
                     {
                         if (!GetNodeSignals().ProcessMessages(chainparams, pnode))
                             pnode->CloseSocketDisconnect();
+                        // receive buffer was processed - socket handler can resume receiving data
+                        if (pnode->fRecvPaused && pnode->CanReceiveMore())
+                            gl_NodeManager.NotifySocketInterest(*pnode);
 
                         if (pnode->nSendSize < SendBufferSize())
                         {
                             if (!pnode->vRecvGetData.empty() ||
-                                (!pnode->vRecvMsg.empty() && pnode->vRecvMsg[0].complete()))
+                                (!pnode->vRecvMsg.empty() && pnode->vRecvMsg[0].complete() && !pnode->fPeerMsgQueueFull))
                                 fSleep = false;
                         }
                     }
@@ -17,6 +17,7 @@
 #include <arpa/inet.h>
 #endif
 #include <fcntl.h>
+#include <poll.h>
 #endif
 #include <unistd.h>
 
@@ -263,6 +264,32 @@ struct timeval MillisToTimeval(int64_t nTimeout)
     return timeout;
 }
 
+/**
+ * Wait until the socket is ready for reading or writing.
+ * Uses poll() on POSIX systems, so socket descriptor is not limited by FD_SETSIZE.
+ *
+ * \param hSocket - socket to wait for
+ * \param bWrite - wait for writing if true, for reading otherwise
+ * \param nTimeout - timeout in milliseconds
+ * \return number of ready sockets, 0 on timeout or SOCKET_ERROR
+ */
+static int WaitForSocket(const SOCKET hSocket, const bool bWrite, const int64_t nTimeout)
+{
+#ifdef WIN32
+    struct timeval timeout = MillisToTimeval(nTimeout);
+    fd_set fdset;
+    FD_ZERO(&fdset);
+    FD_SET(hSocket, &fdset);
+    return select(static_cast<int>(hSocket + 1), bWrite ? nullptr : &fdset, bWrite ? &fdset : nullptr, nullptr, &timeout);
+#else
+    struct pollfd pfd;
+    pfd.fd = hSocket;
+    pfd.events = bWrite ? POLLOUT : POLLIN;
+    pfd.revents = 0;
+    return poll(&pfd, 1, static_cast<int>(nTimeout));
+#endif
+}
+
 /**
  * Read bytes from socket. This will either read the full number of bytes requested
  * or return False on error or timeout.
@@ -295,11 +322,7 @@ bool static InterruptibleRecv(char* data, size_t len, int timeout, SOCKET& hSock
                 if (!IsSelectableSocket(hSocket)) {
                     return false;
                 }
-                struct timeval tval = MillisToTimeval(min(endTime - curTime, maxWait));
-                fd_set fdset;
-                FD_ZERO(&fdset);
-                FD_SET(hSocket, &fdset);
-                int nRet = select(static_cast<int>(hSocket + 1), &fdset, nullptr, nullptr, &tval);
+                const int nRet = WaitForSocket(hSocket, false, min(endTime - curTime, maxWait));
                 if (nRet == SOCKET_ERROR) {
                     return false;
                 }
@@ -495,11 +518,7 @@ bool static ConnectSocketDirectly(const CService &addrConnect, SOCKET& hSocketRe
         // WSAEINVAL is here because some legacy version of winsock uses it
         if (nErr == WSAEINPROGRESS || nErr == WSAEWOULDBLOCK || nErr == WSAEINVAL)
         {
-            struct timeval timeout = MillisToTimeval(nTimeout);
-            fd_set fdset;
-            FD_ZERO(&fdset);
-            FD_SET(hSocket, &fdset);
-            int nRet = select(static_cast<int>(hSocket + 1), nullptr, &fdset, nullptr, &timeout);
+            int nRet = WaitForSocket(hSocket, true, nTimeout);
             if (nRet == 0)
             {
                 LogFnPrint("net", "connection to %s timeout", addrConnect.ToString());
@@ -508,7 +527,7 @@ bool static ConnectSocketDirectly(const CService &addrConnect, SOCKET& hSocketRe
             }
             if (nRet == SOCKET_ERROR)
             {
-                LogFnPrintf("select() for %s failed: %s", addrConnect.ToString(), GetErrorString(WSAGetLastError()));
+                LogFnPrintf("socket wait for %s failed: %s", addrConnect.ToString(), GetErrorString(WSAGetLastError()));
                 CloseSocket(hSocket);
                 return false;
             }
@@ -525,7 +544,7 @@ bool static ConnectSocketDirectly(const CService &addrConnect, SOCKET& hSocketRe
             }
             if (nRet != 0)
             {
-                LogFnPrintf("connect() to %s failed after select(): %s", addrConnect.ToString(), GetErrorString(nRet));
+                LogFnPrintf("connect() to %s failed after socket wait: %s", addrConnect.ToString(), GetErrorString(nRet));
                 CloseSocket(hSocket);
                 return false;
             }
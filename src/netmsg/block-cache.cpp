@@ -2,6 +2,8 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 #include <cinttypes>
+#include <future>
+#include <algorithm>
 
 #include <consensus/validation.h>
 #include <extlibs/scope_guard.hpp>
@@ -11,6 +13,7 @@
 #include <netmsg/block-cache.h>
 #include <netmsg/nodemanager.h>
 #include <accept_to_mempool.h>
+#include <clientversion.h>
 
 using namespace std;
 
@@ -24,15 +27,48 @@ constexpr time_t DELTA_BLOCK_REVALIDATION_WAIT_TIME_SECS = 3;
 constexpr time_t DEFAULT_REVALIDATION_MONITOR_INTERVAL = 30;
 // block in cache expiration time in secs
 constexpr time_t BLOCK_IN_CACHE_EXPIRATION_TIME_IN_SECS = 60 * 60; // 1 hour
+// max number of threads to run context-free checks of the cached blocks
+constexpr size_t MAX_BLOCK_CHECK_THREADS = 4;
 
 CBlockCache::CBlockCache() noexcept : 
     m_bProcessing(false),
+    m_bValidForkDetected(false),
+    m_nReadyCount(0),
+    m_nMemUsage(0),
+    m_nMaxMemUsage(0),
     m_nBlockRevalidationWaitTime(MIN_BLOCK_REVALIDATION_WAIT_TIME_SECS),
     m_nRevalidationMonitorInterval(DEFAULT_REVALIDATION_MONITOR_INTERVAL),
     m_nLastCheckedCacheSize(0),
     m_nLastCacheAdjustmentTime(0)
 {}
 
+/**
+ * Set memory budget for the cached blocks.
+ * Blocks over the budget are spilled to the files in spillDir.
+ * Spilled blocks left from the previous run are removed.
+ * 
+ * \param nMaxMemUsage - max memory in bytes used by the cached blocks (0 - no limit)
+ * \param spillDir - directory to spill cached blocks to
+ */
+void CBlockCache::set_max_mem_usage(const size_t nMaxMemUsage, const fs::path& spillDir)
+{
+    unique_lock lck(m_CacheMapLock);
+    m_nMaxMemUsage = nMaxMemUsage;
+    m_SpillDir = spillDir;
+    try
+    {
+        if (fs::exists(m_SpillDir))
+            fs::remove_all(m_SpillDir);
+        if (m_nMaxMemUsage)
+            fs::create_directories(m_SpillDir);
+    } catch (const fs::filesystem_error& e)
+    {
+        LogFnPrintf("failed to prepare block cache directory '%s', blocks will be kept in memory: %s", 
+            m_SpillDir.string(), e.what());
+        m_nMaxMemUsage = 0;
+    }
+}
+
 /**
  * Add block to the cache.
  * Monitor cache size and adjust revalidation wait time if needed.
@@ -44,17 +80,10 @@ CBlockCache::CBlockCache() noexcept :
   */
 void CBlockCache::add_block(const uint256& hash, const NodeId& nodeId, const TxOrigin txOrigin, CBlock&& block) noexcept
 {
-    unique_lock lck(m_CacheMapLock);
-    auto it = m_BlockCacheMap.find(hash);
-    if (it != m_BlockCacheMap.end())
-    {
-        // we have already this block in a cache
-        it->second.Added();
-        LogFnPrint("net", "block %s already exists in a revalidation cache, peer=%d", hash.ToString(), nodeId);
-        return;
-    }
     uint32_t nBlockHeight = 0;
+    bool bPrevBlockConnected = false;
     {
+        // the correct lock order is: cs_main -> m_CacheMapLock
         LOCK(cs_main);
         const auto itBlock = mapBlockIndex.find(hash);
         if (itBlock != mapBlockIndex.cend())
@@ -66,8 +95,25 @@ void CBlockCache::add_block(const uint256& hash, const NodeId& nodeId, const TxO
                     nBlockHeight = static_cast<uint32_t>(pindex->nHeight);
             }
         }
+        const auto itPrev = mapBlockIndex.find(block.hashPrevBlock);
+        bPrevBlockConnected = (itPrev != mapBlockIndex.cend()) && chainActive.Contains(itPrev->second);
+    }
+    const size_t nBlockSize = ::GetSerializeSize(block, SER_NETWORK, PROTOCOL_VERSION);
+
+    unique_lock lck(m_CacheMapLock);
+    auto it = m_BlockCacheMap.find(hash);
+    if (it != m_BlockCacheMap.end())
+    {
+        // we have already this block in a cache
+        it->second.Added();
+        LogFnPrint("net", "block %s already exists in a revalidation cache, peer=%d", hash.ToString(), nodeId);
+        return;
     }
-    m_BlockCacheMap.emplace(hash, BLOCK_CACHE_ITEM(nodeId, nBlockHeight, txOrigin, std::move(block)));
+    it = m_BlockCacheMap.emplace(hash, BLOCK_CACHE_ITEM(nodeId, nBlockHeight, txOrigin, std::move(block), nBlockSize)).first;
+    m_nMemUsage += nBlockSize;
+    // block with missing inputs can be revalidated only after its previous block is connected
+    if (!bPrevBlockConnected)
+        AddWaitingBlock(hash, it->second);
 
     // monitor cache size and adjust revalidation wait time if needed
     time_t nCurrentTime = time(nullptr);
@@ -80,6 +126,200 @@ void CBlockCache::add_block(const uint256& hash, const NodeId& nodeId, const TxO
     }
                 
     LogFnPrintf("block %s cached for revalidation, peer=%d", hash.ToString(), nodeId);
+    if (m_nMaxMemUsage && (m_nMemUsage > m_nMaxMemUsage))
+        SpillBlocks(lck);
+}
+
+/**
+ * Register cached block in a waiting map - the block waits for its previous block to be connected.
+ * Should be called under m_CacheMapLock.
+ * 
+ * \param hash - hash of the cached block
+ * \param item - cached block item
+ */
+void CBlockCache::AddWaitingBlock(const uint256& hash, BLOCK_CACHE_ITEM& item)
+{
+    if (item.bWaiting)
+        return;
+    m_WaitingMap.emplace(item.hashPrevBlock, hash);
+    item.bWaiting = true;
+}
+
+/**
+ * Remove cached block from a waiting map.
+ * Should be called under m_CacheMapLock.
+ * 
+ * \param hash - hash of the cached block
+ * \param item - cached block item
+ */
+void CBlockCache::RemoveWaitingBlock(const uint256& hash, BLOCK_CACHE_ITEM& item)
+{
+    if (item.bReady)
+    {
+        item.bReady = false;
+        --m_nReadyCount;
+    }
+    if (!item.bWaiting)
+        return;
+    auto range = m_WaitingMap.equal_range(item.hashPrevBlock);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (it->second == hash)
+        {
+            m_WaitingMap.erase(it);
+            break;
+        }
+    }
+    item.bWaiting = false;
+}
+
+/**
+ * Wake up cached blocks waiting for the given block - they will be revalidated
+ * on the next revalidate_blocks call without waiting for the revalidation timer.
+ * Should be called under m_CacheMapLock.
+ * 
+ * \param hashPrev - hash of the connected (or removed from cache) block
+ */
+void CBlockCache::WakeWaitingBlocks(const uint256& hashPrev)
+{
+    auto range = m_WaitingMap.equal_range(hashPrev);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        auto itItem = m_BlockCacheMap.find(it->second);
+        if (itItem == m_BlockCacheMap.end())
+            continue;
+        auto& item = itItem->second;
+        item.bWaiting = false;
+        if (!item.bReady)
+        {
+            item.bReady = true;
+            ++m_nReadyCount;
+        }
+        LogFnPrint("net", "cached block %s woken up by block %s", it->second.ToString(), hashPrev.ToString());
+    }
+    m_WaitingMap.erase(range.first, range.second);
+}
+
+/**
+ * Called when the block is connected to the active chain.
+ * Wakes up cached blocks waiting for this block.
+ * Can be called under cs_main.
+ * 
+ * \param hash - hash of the connected block
+ */
+void CBlockCache::block_connected(const uint256& hash)
+{
+    unique_lock lck(m_CacheMapLock);
+    if (!m_WaitingMap.empty())
+        WakeWaitingBlocks(hash);
+}
+
+fs::path CBlockCache::GetSpillFilePath(const uint256& hash) const
+{
+    return m_SpillDir / (hash.ToString() + ".dat");
+}
+
+/**
+ * Spill cached blocks to disk while memory used by the cached blocks is over the budget.
+ * Blocks with the highest height are spilled first - they are needed last.
+ * Should be called under m_CacheMapLock, the lock is released during disk writes.
+ * 
+ * \param lck - unique lock to protect access to m_BlockCacheMap
+ */
+void CBlockCache::SpillBlocks(unique_lock<mutex>& lck)
+{
+    vector<pair<uint256, BLOCK_CACHE_ITEM*>> vToSpill;
+    for (auto& [hash, item] : m_BlockCacheMap)
+    {
+        // woken up blocks are about to be revalidated
+        if (!item.bSpilled && !item.bRevalidating && !item.bReady)
+            vToSpill.emplace_back(hash, &item);
+    }
+    sort(vToSpill.begin(), vToSpill.end(), [](const auto& a, const auto& b)
+        {
+            return a.second->nBlockHeight > b.second->nBlockHeight;
+        });
+    size_t nMemUsage = m_nMemUsage;
+    size_t nCount = 0;
+    for (; (nCount < vToSpill.size()) && (nMemUsage > m_nMaxMemUsage); ++nCount)
+    {
+        auto pItem = vToSpill[nCount].second;
+        // item can't be revalidated or deleted while it's being spilled
+        pItem->bRevalidating = true;
+        nMemUsage -= pItem->nBlockSize;
+    }
+    vToSpill.resize(nCount);
+    if (vToSpill.empty())
+        return;
+
+    v_uint256 vSpilled;
+    {
+        reverse_lock rlock(lck);
+        for (const auto& [hash, pItem] : vToSpill)
+        {
+            const auto path = GetSpillFilePath(hash);
+            CAutoFile fileout(fopen(path.string().c_str(), "wb"), SER_DISK, CLIENT_VERSION);
+            if (fileout.IsNull())
+            {
+                LogFnPrintf("failed to create file '%s' for cached block %s (errno=%d)", path.string(), hash.ToString(), errno);
+                continue;
+            }
+            try
+            {
+                fileout << pItem->block;
+            } catch (const exception& e)
+            {
+                LogFnPrintf("failed to spill cached block %s to disk: %s", hash.ToString(), e.what());
+                fileout.fclose();
+                fss::error_code ec;
+                fs::remove(path, ec);
+                continue;
+            }
+            vSpilled.push_back(hash);
+        }
+    }
+    for (const auto& [hash, pItem] : vToSpill)
+    {
+        pItem->bRevalidating = false;
+        if (find(vSpilled.cbegin(), vSpilled.cend(), hash) == vSpilled.cend())
+            continue;
+        pItem->block = CBlock();
+        pItem->bSpilled = true;
+        m_nMemUsage -= pItem->nBlockSize;
+    }
+    LogFnPrint("net", "%zu cached blocks spilled to disk, memory used by cached blocks: %zu bytes", vSpilled.size(), m_nMemUsage);
+}
+
+/**
+ * Load spilled block from disk.
+ * Cached item should be locked by bRevalidating flag, m_CacheMapLock is not required.
+ * 
+ * \param hash - hash of the cached block
+ * \param item - cached block item
+ * 
+ * \return true if the block was loaded
+ */
+bool CBlockCache::LoadSpilledBlock(const uint256& hash, BLOCK_CACHE_ITEM& item) const
+{
+    const auto path = GetSpillFilePath(hash);
+    CAutoFile filein(fopen(path.string().c_str(), "rb"), SER_DISK, CLIENT_VERSION);
+    if (filein.IsNull())
+    {
+        LogFnPrintf("failed to open file '%s' for cached block %s (errno=%d)", path.string(), hash.ToString(), errno);
+        return false;
+    }
+    try
+    {
+        filein >> item.block;
+    } catch (const exception& e)
+    {
+        LogFnPrintf("failed to load cached block %s from disk: %s", hash.ToString(), e.what());
+        return false;
+    }
+    filein.fclose();
+    fss::error_code ec;
+    fs::remove(path, ec);
+    return item.block.GetHash() == hash;
 }
 
 /**
@@ -228,8 +468,23 @@ void CBlockCache::DeleteCacheItems(const char* szFuncName, const v_uint256& vToD
 {
     for (const auto& hash : vToDelete)
     {
-		m_BlockCacheMap.erase(hash);
+        auto it = m_BlockCacheMap.find(hash);
+        if (it != m_BlockCacheMap.end())
+        {
+            auto& item = it->second;
+            RemoveWaitingBlock(hash, item);
+            if (item.bSpilled)
+            {
+                fss::error_code ec;
+                fs::remove(GetSpillFilePath(hash), ec);
+            }
+            else
+                m_nMemUsage -= item.nBlockSize;
+            m_BlockCacheMap.erase(it);
+        }
 		CleanupUnlinkedMap(hash);
+        // blocks waiting for the removed block should be revalidated (or rejected) as well
+        WakeWaitingBlocks(hash);
 		if (LogAcceptCategory("net"))
 			LogPrintf("[%s] %sblock %s removed from revalidation cache\n", SAFE_SZ(szFuncName), SAFE_SZ(szDesc), hash.ToString());
 	}
@@ -253,11 +508,17 @@ CBlockCache::revalidate_blocks_t CBlockCache::CollectCachedBlocksToRevalidate(co
         // skip items that being processed
         if (item.bRevalidating)
             continue;
-        // block should be revalidated only after m_nBlockRevalidationWaitTime secs
-        // from either last revalidation attempt or time the block was cached
-        // this wait time is adjusted dynamically based on the cache size change rate
-        if (!bForce && (difftime(nNow, item.GetLastUpdateTime()) < m_nBlockRevalidationWaitTime))
-            continue;
+        if (!bForce && !item.bReady)
+        {
+            // block waiting for the cached previous block is woken up when that block is connected
+            if (item.bWaiting && m_BlockCacheMap.count(item.hashPrevBlock))
+                continue;
+            // block should be revalidated only after m_nBlockRevalidationWaitTime secs
+            // from either last revalidation attempt or time the block was cached
+            // this wait time is adjusted dynamically based on the cache size change rate
+            if (difftime(nNow, item.GetLastUpdateTime()) < m_nBlockRevalidationWaitTime)
+                continue;
+        }
 
         // get the node from which the cached block was downloaded
         const node_t pfrom = gl_NodeManager.FindNode(item.nodeId);
@@ -285,9 +546,70 @@ CBlockCache::revalidate_blocks_t CBlockCache::CollectCachedBlocksToRevalidate(co
     return vToRevalidate;
 }
 
+/**
+ * Load spilled blocks from disk and run context-free checks (CheckBlockContextFree) of the blocks to revalidate.
+ * Checks are executed in parallel, m_CacheMapLock should not be locked.
+ * Checks that depend on the chain state or tickets (mnid registration ticket) are not executed here -
+ * the previous block can be connected in the same revalidation pass, so these are done by ProcessCheckedBlock.
+ * All blocks should be locked by bRevalidating flag.
+ * 
+ * \param chainparams - chain parameters
+ * \param vBlocks - blocks to check
+ * \return check results in the same order as vBlocks
+ */
+vector<CBlockCache::BLOCK_CHECK_RESULT> CBlockCache::CheckBlocks(const CChainParams& chainparams, const revalidate_blocks_t& vBlocks)
+{
+    vector<BLOCK_CHECK_RESULT> vResults;
+    vResults.reserve(vBlocks.size());
+    for (const auto& [hash, pfrom, pItem] : vBlocks)
+        vResults.emplace_back(pItem->txOrigin);
+    // proof-of-work checks depend on the chain height (ingested blocks)
+    vector<BlockPoWCheck> vPoWChecks;
+    vPoWChecks.reserve(vBlocks.size());
+    {
+        LOCK(cs_main);
+        for (const auto& [hash, pfrom, pItem] : vBlocks)
+            vPoWChecks.push_back(GetBlockPoWCheck(chainparams, hash));
+    }
+
+    atomic_size_t nNextIndex(0);
+    auto worker = [&]()
+    {
+        size_t i;
+        while ((i = nNextIndex++) < vBlocks.size())
+        {
+            const auto& [hash, pfrom, pItem] = vBlocks[i];
+            auto& result = vResults[i];
+            if (pItem->bSpilled)
+            {
+                if (!LoadSpilledBlock(hash, *pItem))
+                {
+                    result.state.Error("cached-block-load-failed");
+                    continue;
+                }
+                result.bLoaded = true;
+            }
+            auto verifier = libzcash::ProofVerifier::Disabled();
+            uint256 hashBlock = hash;
+            result.bChecked = CheckBlockContextFree(pItem->block, hashBlock, result.state, chainparams, verifier, vPoWChecks[i], true);
+        }
+    };
+    const size_t nThreads = min<size_t>({ GetNumCores(), MAX_BLOCK_CHECK_THREADS, vBlocks.size() });
+    vector<future<void>> futures;
+    futures.reserve(nThreads);
+    for (size_t t = 1; t < nThreads; ++t)
+        futures.push_back(async(launch::async, worker));
+    worker();
+    for (auto& f : futures)
+        f.get();
+    return vResults;
+}
+
 /**
  * Try to revalidate cached blocks from m_BlockCacheMap.
- * Blocks are revalidated only after waiting m_nBlockRevalidationWaitTime secs in a cache.
+ * Blocks are revalidated only after waiting m_nBlockRevalidationWaitTime secs in a cache
+ * or after the previous block is connected.
+ * Revalidation is repeated while connected blocks wake up other cached blocks.
  * 
  * \param chainparams - chain parameters
  * \param bForce - if true - force revalidation of all cached blocks, default is false
@@ -313,6 +635,34 @@ size_t CBlockCache::revalidate_blocks(const CChainParams& chainparams, const boo
     {
         m_bProcessing = false;
     });
+    size_t nCount = RevalidateBlocksPass(chainparams, bForce, bIsInitialBlockDownload, lck);
+    // revalidate blocks woken up by the connected blocks
+    while (m_nReadyCount)
+    {
+        const size_t nReadyCount = m_nReadyCount;
+        nCount += RevalidateBlocksPass(chainparams, false, bIsInitialBlockDownload, lck);
+        // the rest will be processed on the next call
+        if (m_nReadyCount >= nReadyCount)
+            break;
+    }
+    if (m_nMaxMemUsage && (m_nMemUsage > m_nMaxMemUsage))
+        SpillBlocks(lck);
+    return nCount;
+}
+
+/**
+ * One revalidation pass over the cached blocks.
+ * Should be called under m_CacheMapLock.
+ * 
+ * \param chainparams - chain parameters
+ * \param bForce - if true - force revalidation of all cached blocks
+ * \param bIsInitialBlockDownload - true if we're in initial blockchain download mode
+ * \param lck - unique lock to protect access to m_BlockCacheMap
+ * \return number of blocks successfully revalidated
+ */
+size_t CBlockCache::RevalidateBlocksPass(const CChainParams& chainparams, const bool bForce, const bool bIsInitialBlockDownload,
+    unique_lock<mutex>& lck)
+{
     // blocks successfully revalidated that should be removed from the cache map
     // also added blocks without defined node.
     v_uint256 vToDelete;
@@ -330,13 +680,51 @@ size_t CBlockCache::revalidate_blocks(const CChainParams& chainparams, const boo
     uint32_t nCurrentHeight = gl_nChainHeight;
     if (!vToRevalidate.empty() && get<2>(vToRevalidate.front())->nBlockHeight > nCurrentHeight + 1)
     {
+        // woken up blocks will be retried on timer
+        for (auto& [hash, pfrom, pItem] : vToRevalidate)
+        {
+            if (pItem->bReady)
+            {
+                pItem->bReady = false;
+                --m_nReadyCount;
+            }
+        }
         DeleteCacheItems(__METHOD_NAME__, vToDelete, "orphan ");
         return 0;
     }
 
-    // try to revalidate blocks
+    // lock blocks for revalidation
     for (auto& [hash, pfrom, pItem] : vToRevalidate)
     {
+        pItem->bRevalidating = true;
+        RemoveWaitingBlock(hash, *pItem);
+    }
+    // run context-free checks in parallel
+    vector<BLOCK_CHECK_RESULT> vCheckResults;
+    {
+        reverse_lock rlock(lck);
+        vCheckResults = CheckBlocks(chainparams, vToRevalidate);
+    }
+    for (size_t i = 0; i < vToRevalidate.size(); ++i)
+    {
+        if (!vCheckResults[i].bLoaded)
+            continue;
+        auto pItem = get<2>(vToRevalidate[i]);
+        pItem->bSpilled = false;
+        m_nMemUsage += pItem->nBlockSize;
+    }
+
+    // try to revalidate blocks
+    for (size_t i = 0; i < vToRevalidate.size(); ++i)
+    {
+        auto& [hash, pfrom, pItem] = vToRevalidate[i];
+        const auto& checkResult = vCheckResults[i];
+        if (pItem->bSpilled)
+        {
+            // failed to load spilled block
+            vToDelete.push_back(hash);
+            continue;
+        }
         sHash = hash.ToString();
         CValidationState state(pItem->txOrigin);
         uint32_t nBlockHeight = pItem->nBlockHeight;
@@ -463,37 +851,46 @@ size_t CBlockCache::revalidate_blocks(const CChainParams& chainparams, const boo
 			continue;
         }
 
-        pItem->bRevalidating = true;
+        if (checkResult.bChecked)
         {
             reverse_lock rlock(lck);
             // try to reprocess the block
             //   - try to revalidate block and update blockchain tip (connect newly accepted block)
             //   - calls ActivateBestChain in case block is validated
-            ProcessNewBlock(state, chainparams, pfrom, &pItem->block, true);
-        }
+            ProcessCheckedBlock(state, chainparams, pfrom, &pItem->block, hash, true);
+        } else
+            state = checkResult.state;
         int nDoS = 0; // denial-of-service code
         bool bReject = false;
         const bool bIsMissingInputs = state.IsRejectCode(REJECT_MISSING_INPUTS);
         if (bIsMissingInputs) // block failed revalidation
         {
-            // block failed revalidation due to missing inputs
-            // but if the block is in a forked chain, we should call ReconsiderBlock
-            // to unblock chain download (otherwise the peer will stall download)
-            if (pItem->bIsInForkedChain)
+            bool bPrevBlockConnected = false;
             {
                 reverse_lock rlock(lck);
                 LOCK(cs_main);
-                // reconsider this block
-                // cs_main should be locked to access to mapBlockIndex
-                auto itBlock = mapBlockIndex.find(hash);
-                if (itBlock != mapBlockIndex.end())
+                // block failed revalidation due to missing inputs
+                // but if the block is in a forked chain, we should call ReconsiderBlock
+                // to unblock chain download (otherwise the peer will stall download)
+                if (pItem->bIsInForkedChain)
                 {
-                    CBlockIndex* pindex = itBlock->second;
-                    // remove invalidity status from a block and its descendants
-                    if (pindex)
-                        ReconsiderBlock(state, pindex);
+                    // reconsider this block
+                    // cs_main should be locked to access to mapBlockIndex
+                    auto itBlock = mapBlockIndex.find(hash);
+                    if (itBlock != mapBlockIndex.end())
+                    {
+                        CBlockIndex* pindex = itBlock->second;
+                        // remove invalidity status from a block and its descendants
+                        if (pindex)
+                            ReconsiderBlock(state, pindex);
+                    }
                 }
+                const auto itPrev = mapBlockIndex.find(pItem->hashPrevBlock);
+                bPrevBlockConnected = (itPrev != mapBlockIndex.cend()) && chainActive.Contains(itPrev->second);
             }
+            // wait for the previous block to be connected
+            if (!bPrevBlockConnected)
+                AddWaitingBlock(hash, *pItem);
             // update time of the last revalidation attempt
             pItem->nTimeValidated = time(nullptr);
             // clear revalidating flag for this item to be processed again
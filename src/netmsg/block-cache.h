@@ -5,11 +5,15 @@
 #include <map>
 #include <ctime>
 
+#include <utils/fs.h>
 #include <primitives/block.h>
 #include <consensus/validation.h>
 #include <chainparams.h>
 #include <net.h>
 
+/** Default for -blockcachemaxmem, max memory in MiB used by the blocks in a revalidation cache (0 - no limit) */
+constexpr size_t DEFAULT_BLOCK_CACHE_MAX_MEM_MB = 0;
+
 /**
  * Class to use for temporary block cache.
  * Blocks received from the nodes concurrently.
@@ -19,12 +23,25 @@
  * We don't want to reject blocks that failed validation (transactions failed validation) because of 
  * missing transactions (in blocks that are not downloaded yet).
  * We will save those blocks into this cache and try to revalidate them every time we finish a batch.
+ * 
+ * Cached block waits for its previous block to be connected:
+ *   - if the previous block is in the cache as well - the block is not retried on timer, 
+ *     it is woken up only when the previous block is connected to the active chain (or removed from the cache);
+ *   - otherwise the block is retried on timer and woken up as soon as the previous block is connected.
+ * Context-free checks (CheckBlockContextFree) of the blocks to revalidate are executed in parallel,
+ * mnid ticket and chain state checks are done by ProcessCheckedBlock in block height order.
+ * If the memory budget is set (-blockcachemaxmem), cached blocks over the budget are spilled to disk.
  */
 class CBlockCache
 {
 public:
     CBlockCache() noexcept;
 
+    // set memory budget for the cached blocks, blocks over the budget are spilled to disk
+    void set_max_mem_usage(const size_t nMaxMemUsage, const fs::path &spillDir);
+    // wake up cached blocks waiting for the block to be connected
+    void block_connected(const uint256& hash);
+
     // add block to cache for revalidation
     void add_block(const uint256& hash, const NodeId& nodeId, const TxOrigin txOrigin, CBlock && block) noexcept;
     // try to revalidate cached blocks
@@ -34,6 +51,8 @@ public:
     bool find_next_block(const v_uint256 &vHashes, uint256 &hashNextBlock) const noexcept;
     // get number of blocks in a cache
     size_t size() const noexcept;
+    // get memory used by the cached blocks kept in memory
+    size_t mem_usage() const noexcept;
     // check whether block with the given hash exists in the cache
     bool exists(const uint256& hash) const noexcept;
     // check where prev block exists in the cache - if yes, add to unlinked map
@@ -50,18 +69,29 @@ protected:
         uint32_t nValidationCounter; // number of revalidation attempts
         time_t nTimeAdded;           // time in secs when the block was cached
         time_t nTimeValidated;       // time in secs of the last revalidation attempt
-        bool bRevalidating;          // true if block is being revalidated
+        bool bRevalidating;          // true if block is being revalidated or spilled to disk
         uint32_t nBlockHeight;	     // block height (0 - not defined)
         TxOrigin txOrigin;           // block origin
         bool bIsInForkedChain;       // true if block is in forked chain
+        uint256 hashPrevBlock;       // hash of the previous block
+        bool bWaiting;               // true if block waits in m_WaitingMap for the previous block to be connected
+        bool bReady;                 // true if the previous block was connected since the last revalidation attempt
+        size_t nBlockSize;           // serialized block size
+        bool bSpilled;               // true if block data is spilled to disk
 
-        _BLOCK_CACHE_ITEM(const NodeId id, uint32_t nHeight, TxOrigin txOrigin, CBlock &&block_in) noexcept : 
+        _BLOCK_CACHE_ITEM(const NodeId id, uint32_t nHeight, TxOrigin txOrigin, CBlock &&block_in, const size_t nSize) noexcept : 
             nodeId(id),
+            block(std::move(block_in)),
+            bRevalidating(false),
             nBlockHeight(nHeight),
             txOrigin(txOrigin),
-            block(std::move(block_in)),
-            bIsInForkedChain(false)
+            bIsInForkedChain(false),
+            bWaiting(false),
+            bReady(false),
+            nBlockSize(nSize),
+            bSpilled(false)
         {
+            hashPrevBlock = block.hashPrevBlock;
             Added();
         }
 
@@ -84,12 +114,25 @@ protected:
             nTimeAdded = time(nullptr);
             nTimeValidated = 0;
             nValidationCounter = 0;
-            bRevalidating = false;
         }
     } BLOCK_CACHE_ITEM;
 
     using revalidate_blocks_t = std::vector<std::tuple<uint256, node_t, BLOCK_CACHE_ITEM*>>;
 
+    // result of the context-free block checks
+    typedef struct _BLOCK_CHECK_RESULT
+    {
+        bool bLoaded;   // true if block was loaded from disk
+        bool bChecked;  // true if block passed context-free checks
+        CValidationState state;
+
+        _BLOCK_CHECK_RESULT(const TxOrigin txOrigin) noexcept : 
+            bLoaded(false),
+            bChecked(false),
+            state(txOrigin)
+        {}
+    } BLOCK_CHECK_RESULT;
+
      /**
      * if true - processing cached blocks.
      * block cache revalidation can be called concurrently from multiple threads,
@@ -104,6 +147,16 @@ protected:
 	std::unordered_map<uint256, BLOCK_CACHE_ITEM> m_BlockCacheMap;
     // blocks to add to unlinked map <cached_block_hash> -> <next block hash>
     std::unordered_multimap<uint256, uint256> m_UnlinkedMap;
+    // cached blocks waiting for the previous block to be connected <prev_block_hash> -> <cached block hash>
+    std::unordered_multimap<uint256, uint256> m_WaitingMap;
+    // number of cached blocks woken up and not revalidated yet
+    size_t m_nReadyCount;
+    // memory used by the cached blocks kept in memory
+    size_t m_nMemUsage;
+    // max memory to use for the cached blocks (0 - no limit)
+    size_t m_nMaxMemUsage;
+    // directory to spill cached blocks to
+    fs::path m_SpillDir;
     // time in secs cached block has to wait in the cache for the next revalidation attempt
     // default min startup value is 3 secs (MIN_BLOCK_REVALIDATION_WAIT_TIME_SECS)
     time_t m_nBlockRevalidationWaitTime;
@@ -126,4 +179,23 @@ protected:
     void DeleteCacheItems(const char* szFuncName, const v_uint256& vToDelete, const char* szDesc = nullptr);
     // collect cached blocks to revalidate
     revalidate_blocks_t CollectCachedBlocksToRevalidate(const bool bForce, v_uint256 &vToDelete);
+    // one revalidation pass over the cached blocks
+    size_t RevalidateBlocksPass(const CChainParams& chainparams, const bool bForce, const bool bIsInitialBlockDownload,
+        std::unique_lock<std::mutex>& lck);
+    // load spilled blocks and run context-free checks in parallel
+    std::vector<BLOCK_CHECK_RESULT> CheckBlocks(const CChainParams& chainparams, const revalidate_blocks_t& vBlocks);
+
+    // register cached block in a waiting map
+    void AddWaitingBlock(const uint256& hash, BLOCK_CACHE_ITEM& item);
+    // remove cached block from a waiting map
+    void RemoveWaitingBlock(const uint256& hash, BLOCK_CACHE_ITEM& item);
+    // wake up cached blocks waiting for the given block
+    void WakeWaitingBlocks(const uint256& hashPrev);
+
+    // spill cached blocks to disk while memory usage is over the budget
+    void SpillBlocks(std::unique_lock<std::mutex>& lck);
+    fs::path GetSpillFilePath(const uint256& hash) const;
+    bool LoadSpilledBlock(const uint256& hash, BLOCK_CACHE_ITEM& item) const;
 };
+
+extern CBlockCache gl_BlockCache;
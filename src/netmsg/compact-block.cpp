@@ -0,0 +1,191 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <unordered_map>
+
+#include <sodium.h>
+
+#include <utils/random.h>
+#include <utils/streams.h>
+#include <crypto/sha256.h>
+#include <consensus/consensus.h>
+#include <txmempool.h>
+#include <version.h>
+#include <netmsg/compact-block.h>
+
+using namespace std;
+
+// min size of the serialized transaction
+constexpr size_t MIN_TRANSACTION_SIZE = 60;
+
+CBlockHeaderAndShortTxIDs::CBlockHeaderAndShortTxIDs(const CBlock& block) :
+    header(block.GetBlockHeader()),
+    nonce(GetRand(numeric_limits<uint64_t>::max()))
+{
+    FillShortTxIDSelector();
+    // coinbase transaction is always prefilled, peers never have it
+    if (!block.vtx.empty())
+        prefilledtxn.push_back(CPrefilledTransaction{ 0, block.vtx[0] });
+    if (block.vtx.size() > 1)
+    {
+        shorttxids.reserve(block.vtx.size() - 1);
+        for (size_t i = 1; i < block.vtx.size(); ++i)
+            shorttxids.push_back(GetShortID(block.vtx[i].GetHash()));
+    }
+}
+
+/**
+ * Derive SipHash key for the short transaction ids: first 16 bytes of SHA256(header || nonce).
+ */
+void CBlockHeaderAndShortTxIDs::FillShortTxIDSelector()
+{
+    CDataStream stream(SER_NETWORK, PROTOCOL_VERSION);
+    stream << header << nonce;
+    unsigned char hash[CSHA256::OUTPUT_SIZE];
+    CSHA256().Write(reinterpret_cast<const unsigned char*>(&stream[0]), stream.size()).Finalize(hash);
+    static_assert(sizeof(m_shortTxIdKey) == crypto_shorthash_siphash24_KEYBYTES, "invalid SipHash key size");
+    memcpy(m_shortTxIdKey, hash, sizeof(m_shortTxIdKey));
+}
+
+/**
+ * Calculate short transaction id - lower 6 bytes of SipHash-2-4 of the transaction hash.
+ *
+ * \param txhash - transaction hash
+ * \return short transaction id
+ */
+uint64_t CBlockHeaderAndShortTxIDs::GetShortID(const uint256& txhash) const noexcept
+{
+    static_assert(SHORTTXIDS_LENGTH == 6, "shorttxids calculation assumes 6-byte shorttxids");
+    unsigned char out[crypto_shorthash_siphash24_BYTES];
+    crypto_shorthash_siphash24(out, txhash.begin(), txhash.size(), m_shortTxIdKey);
+    uint64_t nShortId = 0;
+    for (size_t i = 0; i < SHORTTXIDS_LENGTH; ++i)
+        nShortId |= static_cast<uint64_t>(out[i]) << (8 * i);
+    return nShortId;
+}
+
+/**
+ * Initialize block from the compact block.
+ * Transactions are taken from the prefilled transactions and from the mempool.
+ *
+ * \param cmpctblock - compact block
+ * \param pool - transaction memory pool
+ * \return INVALID if compact block is malformed,
+ *         FAILED if block can't be reconstructed (short txid collision),
+ *         OK otherwise (some transactions may be still missing)
+ */
+CompactBlockStatus CPartialCompactBlock::InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const CTxMemPool& pool)
+{
+    if (cmpctblock.header.IsNull() || (cmpctblock.shorttxids.empty() && cmpctblock.prefilledtxn.empty()))
+        return CompactBlockStatus::INVALID;
+    const size_t nTxCount = cmpctblock.BlockTxCount();
+    if (nTxCount > MAX_BLOCK_SIZE / MIN_TRANSACTION_SIZE)
+        return CompactBlockStatus::INVALID;
+
+    m_header = cmpctblock.header;
+    m_vTx.assign(nTxCount, CTransaction());
+    m_vTxAvailable.assign(nTxCount, false);
+    m_nPrefilledCount = 0;
+    m_nMempoolCount = 0;
+
+    for (const auto& prefilled : cmpctblock.prefilledtxn)
+    {
+        if (prefilled.index >= nTxCount || m_vTxAvailable[prefilled.index] || prefilled.tx.IsNull())
+            return CompactBlockStatus::INVALID;
+        m_vTx[prefilled.index] = prefilled.tx;
+        m_vTxAvailable[prefilled.index] = true;
+        ++m_nPrefilledCount;
+    }
+
+    // map short txid -> index of the transaction in the block
+    unordered_map<uint64_t, uint16_t> mapShortIds;
+    mapShortIds.reserve(cmpctblock.shorttxids.size());
+    size_t nShortIdIndex = 0;
+    for (uint16_t i = 0; i < nTxCount; ++i)
+    {
+        if (m_vTxAvailable[i])
+            continue;
+        // duplicate short ids - can't reconstruct the block
+        if (!mapShortIds.emplace(cmpctblock.shorttxids[nShortIdIndex++], i).second)
+            return CompactBlockStatus::FAILED;
+    }
+
+    {
+        LOCK(pool.cs);
+        // transactions with short id collision in the mempool are requested from the peer
+        vector<bool> vCollision(nTxCount, false);
+        for (const auto& entry : pool.mapTx)
+        {
+            const auto& tx = entry.GetTx();
+            const auto it = mapShortIds.find(cmpctblock.GetShortID(tx.GetHash()));
+            if (it == mapShortIds.cend())
+                continue;
+            const uint16_t nIndex = it->second;
+            if (vCollision[nIndex])
+                continue;
+            if (m_vTxAvailable[nIndex])
+            {
+                m_vTx[nIndex] = CTransaction();
+                m_vTxAvailable[nIndex] = false;
+                vCollision[nIndex] = true;
+                --m_nMempoolCount;
+                continue;
+            }
+            m_vTx[nIndex] = tx;
+            m_vTxAvailable[nIndex] = true;
+            ++m_nMempoolCount;
+        }
+    }
+    return CompactBlockStatus::OK;
+}
+
+bool CPartialCompactBlock::IsTxAvailable(const size_t nIndex) const noexcept
+{
+    return (nIndex < m_vTxAvailable.size()) && m_vTxAvailable[nIndex];
+}
+
+vector<uint16_t> CPartialCompactBlock::GetMissingTxIndexes() const noexcept
+{
+    vector<uint16_t> vIndexes;
+    for (size_t i = 0; i < m_vTxAvailable.size(); ++i)
+    {
+        if (!m_vTxAvailable[i])
+            vIndexes.push_back(static_cast<uint16_t>(i));
+    }
+    return vIndexes;
+}
+
+/**
+ * Fill the block with the transactions.
+ *
+ * \param block - block to fill
+ * \param vMissingTx - transactions missing after InitData (in the order of GetMissingTxIndexes)
+ * \return INVALID if number of the missing transactions does not match,
+ *         FAILED if merkle root of the reconstructed block does not match (short txid collision),
+ *         OK if the block was reconstructed
+ */
+CompactBlockStatus CPartialCompactBlock::FillBlock(CBlock& block, const vector<CTransaction>& vMissingTx) const
+{
+    block.Clear();
+    *static_cast<CBlockHeader*>(&block) = m_header;
+    block.vtx.reserve(m_vTx.size());
+    size_t nMissingIndex = 0;
+    for (size_t i = 0; i < m_vTx.size(); ++i)
+    {
+        if (m_vTxAvailable[i])
+            block.vtx.push_back(m_vTx[i]);
+        else
+        {
+            if (nMissingIndex >= vMissingTx.size())
+                return CompactBlockStatus::INVALID;
+            block.vtx.push_back(vMissingTx[nMissingIndex++]);
+        }
+    }
+    if (nMissingIndex != vMissingTx.size())
+        return CompactBlockStatus::INVALID;
+
+    bool bMutated = false;
+    if (block.BuildMerkleTree(&bMutated) != block.hashMerkleRoot || bMutated)
+        return CompactBlockStatus::FAILED;
+    return CompactBlockStatus::OK;
+}
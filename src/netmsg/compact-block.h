@@ -0,0 +1,249 @@
+#pragma once
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <cstdint>
+#include <vector>
+#include <ios>
+#include <limits>
+
+#include <utils/serialize.h>
+#include <utils/uint256.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+
+class CTxMemPool;
+
+/** Compact block relay (BIP152-style).
+ * Compact block contains block header and 6-byte short ids of the block transactions,
+ * the receiver reconstructs the block using transactions from its mempool and
+ * requests only missing transactions (getblocktxn/blocktxn).
+ */
+
+/** Default for -compactblocks, whether to use compact block relay */
+constexpr bool DEFAULT_COMPACT_BLOCKS = true;
+/** Compact blocks are sent only for the blocks at most that deep in the active chain,
+ *  older blocks are served as full blocks */
+constexpr int MAX_CMPCTBLOCK_DEPTH = 5;
+/** Max depth of the block to respond to getblocktxn request */
+constexpr int MAX_BLOCKTXN_DEPTH = 10;
+
+/** Transaction sent in the compact block as is (coinbase or transaction peer may not have) */
+class CPrefilledTransaction
+{
+public:
+    // index of the transaction in the block,
+    // differentially encoded in the compact block (difference from the previous index - 1)
+    uint16_t index;
+    CTransaction tx;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        uint64_t nIndex = index;
+        READWRITE(COMPACTSIZE(nIndex));
+        if (nIndex > std::numeric_limits<uint16_t>::max())
+            throw std::ios_base::failure("index overflowed 16 bits");
+        index = static_cast<uint16_t>(nIndex);
+        READWRITE(tx);
+    }
+};
+
+/** "cmpctblock" message - block header, short transaction ids and prefilled transactions */
+class CBlockHeaderAndShortTxIDs
+{
+public:
+    static constexpr size_t SHORTTXIDS_LENGTH = 6;
+
+    CBlockHeader header;
+    uint64_t nonce;
+    std::vector<uint64_t> shorttxids;
+    std::vector<CPrefilledTransaction> prefilledtxn;
+
+    CBlockHeaderAndShortTxIDs() noexcept :
+        nonce(0)
+    {}
+    CBlockHeaderAndShortTxIDs(const CBlock& block);
+
+    // calculate short id of the transaction
+    uint64_t GetShortID(const uint256& txhash) const noexcept;
+    // number of transactions in the block
+    size_t BlockTxCount() const noexcept { return shorttxids.size() + prefilledtxn.size(); }
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        const bool bRead = ser_action == SERIALIZE_ACTION::Read;
+        READWRITE(header);
+        READWRITE(nonce);
+
+        uint64_t nShortTxIDs = shorttxids.size();
+        READWRITE(COMPACTSIZE(nShortTxIDs));
+        if (bRead)
+        {
+            if (nShortTxIDs > std::numeric_limits<uint16_t>::max())
+                throw std::ios_base::failure("too many short txids");
+            shorttxids.resize(nShortTxIDs);
+        }
+        for (auto& shortid : shorttxids)
+        {
+            uint32_t nLow = static_cast<uint32_t>(shortid & 0xffffffff);
+            uint16_t nHigh = static_cast<uint16_t>((shortid >> 32) & 0xffff);
+            READWRITE(nLow);
+            READWRITE(nHigh);
+            if (bRead)
+                shortid = (static_cast<uint64_t>(nHigh) << 32) | nLow;
+        }
+
+        // prefilled transaction indexes are differentially encoded
+        uint64_t nPrefilled = prefilledtxn.size();
+        READWRITE(COMPACTSIZE(nPrefilled));
+        if (bRead)
+        {
+            if (nPrefilled > std::numeric_limits<uint16_t>::max())
+                throw std::ios_base::failure("too many prefilled transactions");
+            prefilledtxn.resize(nPrefilled);
+        }
+        uint32_t nPrevIndex = 0;
+        for (size_t i = 0; i < prefilledtxn.size(); ++i)
+        {
+            auto& prefilled = prefilledtxn[i];
+            // differential index is kept in a local variable, prefilled transaction is not modified on write
+            uint64_t nIndexDiff = 0;
+            if (!bRead)
+            {
+                if (i && (prefilled.index <= nPrevIndex))
+                    throw std::ios_base::failure("prefilled transaction indexes are not sorted");
+                nIndexDiff = i ? prefilled.index - nPrevIndex - 1 : prefilled.index;
+            }
+            READWRITE(COMPACTSIZE(nIndexDiff));
+            READWRITE(prefilled.tx);
+            if (bRead)
+            {
+                const uint64_t nDecoded = nIndexDiff + (i ? nPrevIndex + 1 : 0);
+                if (nDecoded > std::numeric_limits<uint16_t>::max())
+                    throw std::ios_base::failure("prefilled transaction index overflowed 16 bits");
+                prefilled.index = static_cast<uint16_t>(nDecoded);
+            }
+            nPrevIndex = prefilled.index;
+        }
+        if (bRead)
+            FillShortTxIDSelector();
+    }
+
+protected:
+    // SipHash-2-4 key derived from the block header and nonce
+    unsigned char m_shortTxIdKey[16];
+
+    void FillShortTxIDSelector();
+};
+
+/** "getblocktxn" message - request for the block transactions by indexes */
+class CBlockTransactionsRequest
+{
+public:
+    uint256 blockhash;
+    std::vector<uint16_t> indexes;
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        const bool bRead = ser_action == SERIALIZE_ACTION::Read;
+        READWRITE(blockhash);
+        uint64_t nIndexes = indexes.size();
+        READWRITE(COMPACTSIZE(nIndexes));
+        if (bRead)
+        {
+            if (nIndexes > std::numeric_limits<uint16_t>::max())
+                throw std::ios_base::failure("too many indexes");
+            indexes.resize(nIndexes);
+        }
+        // indexes are differentially encoded
+        uint32_t nPrevIndex = 0;
+        for (size_t i = 0; i < indexes.size(); ++i)
+        {
+            uint64_t nIndex = indexes[i];
+            if (!bRead && i)
+                nIndex -= nPrevIndex + 1;
+            READWRITE(COMPACTSIZE(nIndex));
+            if (bRead)
+            {
+                if (i)
+                    nIndex += nPrevIndex + 1;
+                if (nIndex > std::numeric_limits<uint16_t>::max())
+                    throw std::ios_base::failure("index overflowed 16 bits");
+                indexes[i] = static_cast<uint16_t>(nIndex);
+            }
+            nPrevIndex = indexes[i];
+        }
+    }
+};
+
+/** "blocktxn" message - block transactions requested by getblocktxn */
+class CBlockTransactions
+{
+public:
+    uint256 blockhash;
+    std::vector<CTransaction> txn;
+
+    CBlockTransactions() noexcept = default;
+    CBlockTransactions(const CBlockTransactionsRequest& req) :
+        blockhash(req.blockhash),
+        txn(req.indexes.size())
+    {}
+
+    ADD_SERIALIZE_METHODS;
+
+    template <typename Stream>
+    inline void SerializationOp(Stream& s, const SERIALIZE_ACTION ser_action)
+    {
+        READWRITE(blockhash);
+        READWRITE(txn);
+    }
+};
+
+enum class CompactBlockStatus
+{
+    OK,
+    INVALID,  // compact block is malformed
+    FAILED    // block can't be reconstructed, full block should be requested
+};
+
+/**
+ * Block being reconstructed from the compact block.
+ */
+class CPartialCompactBlock
+{
+public:
+    CPartialCompactBlock() noexcept :
+        m_nPrefilledCount(0),
+        m_nMempoolCount(0)
+    {}
+
+    // initialize block from the compact block and the mempool transactions
+    CompactBlockStatus InitData(const CBlockHeaderAndShortTxIDs& cmpctblock, const CTxMemPool& pool);
+    bool IsTxAvailable(const size_t nIndex) const noexcept;
+    // get indexes of the transactions to request from the peer
+    std::vector<uint16_t> GetMissingTxIndexes() const noexcept;
+    // fill the block with the available and the missing transactions
+    CompactBlockStatus FillBlock(CBlock& block, const std::vector<CTransaction>& vMissingTx) const;
+
+    const CBlockHeader& GetHeader() const noexcept { return m_header; }
+    uint256 GetBlockHash() const noexcept { return m_header.GetHash(); }
+    size_t GetPrefilledCount() const noexcept { return m_nPrefilledCount; }
+    size_t GetMempoolCount() const noexcept { return m_nMempoolCount; }
+
+protected:
+    CBlockHeader m_header;
+    // block transactions, valid only if available
+    std::vector<CTransaction> m_vTx;
+    std::vector<bool> m_vTxAvailable;
+    size_t m_nPrefilledCount;
+    size_t m_nMempoolCount;
+};
@@ -1,9 +1,97 @@
-// Copyright (c) 2018-2023 The Pastel Core developers
+// Copyright (c) 2018-2024 The Pastel Core developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 #include <netmsg/netmessage.h>
 
-CNetMessage::CNetMessage(const CMessageHeader::MessageStartChars& pchMessageStartIn, const int nTypeIn, const int nVersionIn) : 
+using namespace std;
+
+CNetMessageBufferPool gl_NetMsgBufferPool;
+
+CNetMessageBufferPool::CNetMessageBufferPool(const size_t nMaxClassSize)
+{
+    for (size_t i = 0; i < NET_MSG_BUFFER_SIZE_CLASSES.size(); ++i)
+    {
+        m_vMaxFreeCount[i] = nMaxClassSize / NET_MSG_BUFFER_SIZE_CLASSES[i];
+        // Release() never reallocates the free list
+        m_vFreeBuffers[i].reserve(m_vMaxFreeCount[i]);
+    }
+}
+
+/**
+ * Get receive buffer with the capacity of at least nSize bytes.
+ *
+ * \param nSize - required buffer capacity
+ * \param bReused - returns true if the free buffer was taken from the pool
+ * \return empty buffer
+ */
+CSerializeData CNetMessageBufferPool::Acquire(const size_t nSize, bool &bReused)
+{
+    CSerializeData vch;
+    bReused = false;
+    const auto it = lower_bound(NET_MSG_BUFFER_SIZE_CLASSES.cbegin(), NET_MSG_BUFFER_SIZE_CLASSES.cend(), nSize);
+    if (it == NET_MSG_BUFFER_SIZE_CLASSES.cend())
+    {
+        // too big to be pooled
+        vch.reserve(nSize);
+        return vch;
+    }
+    const size_t nClass = distance(NET_MSG_BUFFER_SIZE_CLASSES.cbegin(), it);
+    {
+        unique_lock lock(m_Mutex);
+        auto &vFree = m_vFreeBuffers[nClass];
+        if (!vFree.empty())
+        {
+            vch = std::move(vFree.back());
+            vFree.pop_back();
+            bReused = true;
+            return vch;
+        }
+    }
+    vch.reserve(*it);
+    return vch;
+}
+
+/**
+ * Return receive buffer to the pool.
+ * Buffer is freed if it does not fit any size class or the size class is full.
+ *
+ * \param vch - buffer to return
+ */
+void CNetMessageBufferPool::Release(CSerializeData &&vch) noexcept
+{
+    const size_t nCapacity = vch.capacity();
+    // find the largest size class that fits into the buffer
+    const auto it = upper_bound(NET_MSG_BUFFER_SIZE_CLASSES.cbegin(), NET_MSG_BUFFER_SIZE_CLASSES.cend(), nCapacity);
+    if (it == NET_MSG_BUFFER_SIZE_CLASSES.cbegin())
+        return;
+    const size_t nClass = distance(NET_MSG_BUFFER_SIZE_CLASSES.cbegin(), it) - 1;
+    // do not waste memory on buffers much larger than the size class
+    if (nCapacity >= 2 * NET_MSG_BUFFER_SIZE_CLASSES[nClass])
+        return;
+    vch.clear();
+    unique_lock lock(m_Mutex);
+    auto &vFree = m_vFreeBuffers[nClass];
+    if (vFree.size() < m_vMaxFreeCount[nClass])
+        vFree.push_back(std::move(vch));
+}
+
+size_t CNetMessageBufferPool::size() const noexcept
+{
+    unique_lock lock(m_Mutex);
+    size_t nCount = 0;
+    for (const auto &vFree : m_vFreeBuffers)
+        nCount += vFree.size();
+    return nCount;
+}
+
+void CNetMessageBufferPool::clear() noexcept
+{
+    unique_lock lock(m_Mutex);
+    for (auto &vFree : m_vFreeBuffers)
+        vFree.clear();
+}
+
+CNetMessage::CNetMessage(const CMessageHeader::MessageStartChars& pchMessageStartIn, const int nTypeIn, const int nVersionIn) :
     hdrbuf(nTypeIn, nVersionIn),
     hdr(pchMessageStartIn),
     vRecv(nTypeIn, nVersionIn)
@@ -12,9 +100,16 @@ CNetMessage::CNetMessage(const CMessageHeader::MessageStartChars& pchMessageStar
     in_data = false;
     nHdrPos = 0;
     nDataPos = 0;
+    bBufferReused = false;
+    nBufferGrows = 0;
     nTime = 0;
 }
 
+CNetMessage::~CNetMessage()
+{
+    gl_NetMsgBufferPool.Release(vRecv.release_buffer());
+}
+
 int CNetMessage::readHeader(const char *pch, unsigned int nBytes)
 {
     // copy data to temporary parsing buffer
@@ -40,6 +135,12 @@ int CNetMessage::readHeader(const char *pch, unsigned int nBytes)
     if (hdr.nMessageSize > MAX_DATA_SIZE)
             return -1;
 
+    // allocate receive buffer for the message, the header is not trusted -
+    // buffer for the large message is grown only when its data is received
+    if (hdr.nMessageSize > 0)
+        vRecv = CDataStream(gl_NetMsgBufferPool.Acquire(std::min<size_t>(hdr.nMessageSize, NET_MSG_MAX_PREALLOC_SIZE), bBufferReused),
+            vRecv.GetType(), vRecv.GetVersion());
+
     // switch state to reading message data
     in_data = true;
 
@@ -51,13 +152,11 @@ int CNetMessage::readData(const char *pch, unsigned int nBytes)
     unsigned int nRemaining = hdr.nMessageSize - nDataPos;
     unsigned int nCopy = std::min(nRemaining, nBytes);
 
-    if (vRecv.size() < nDataPos + nCopy)
-    {
-        // Allocate up to 256 KiB ahead, but never more than the total message size.
-        vRecv.resize(std::min(hdr.nMessageSize, nDataPos + nCopy + 256 * 1024));
-    }
-
-    memcpy(&vRecv[nDataPos], pch, nCopy);
+    // receive buffer is preallocated by readHeader up to NET_MSG_MAX_PREALLOC_SIZE
+    const size_t nCapacity = vRecv.capacity();
+    vRecv.write(pch, nCopy);
+    if (vRecv.capacity() != nCapacity)
+        ++nBufferGrows;
     nDataPos += nCopy;
 
     return nCopy;
@@ -1,11 +1,50 @@
 #pragma once
-// Copyright (c) 2018-2023 The Pastel Core developers
+// Copyright (c) 2018-2024 The Pastel Core developers
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 #include <cstdint>
+#include <array>
+#include <mutex>
+#include <vector>
 
 #include <utils/streams.h>
 #include <protocol.h>
+#include <netmsg/netconsts.h>
+
+/** Size classes of the pooled network message receive buffers */
+constexpr std::array<size_t, 4> NET_MSG_BUFFER_SIZE_CLASSES = { 4 * 1024, 64 * 1024, 256 * 1024, MAX_PROTOCOL_MESSAGE_LENGTH };
+/** Max receive buffer preallocated from the message header, larger messages grow the buffer as the data arrives */
+constexpr size_t NET_MSG_MAX_PREALLOC_SIZE = NET_MSG_BUFFER_SIZE_CLASSES[2];
+/** Max memory kept in the free buffers of one size class */
+constexpr size_t NET_MSG_BUFFER_POOL_MAX_CLASS_SIZE = 8 * 1024 * 1024;
+
+/**
+ * Pool of the network message receive buffers.
+ * Receive buffer is allocated once using the message size from the header
+ * and returned to the pool when the message is destroyed (processed or dropped).
+ * Free buffers are grouped by the size classes, each size class keeps
+ * up to nMaxClassSize bytes of free buffers.
+ */
+class CNetMessageBufferPool
+{
+public:
+    CNetMessageBufferPool(const size_t nMaxClassSize = NET_MSG_BUFFER_POOL_MAX_CLASS_SIZE);
+
+    CSerializeData Acquire(const size_t nSize, bool &bReused);
+    void Release(CSerializeData &&vch) noexcept;
+
+    // number of free buffers in the pool
+    size_t size() const noexcept;
+    void clear() noexcept;
+
+private:
+    mutable std::mutex m_Mutex;
+    // max number of free buffers per size class
+    std::array<size_t, NET_MSG_BUFFER_SIZE_CLASSES.size()> m_vMaxFreeCount;
+    std::array<std::vector<CSerializeData>, NET_MSG_BUFFER_SIZE_CLASSES.size()> m_vFreeBuffers;
+};
+
+extern CNetMessageBufferPool gl_NetMsgBufferPool;
 
 class CNetMessage
 {
@@ -18,10 +57,15 @@ public:
 
     CDataStream vRecv;              // received message data
     unsigned int nDataPos;
+    bool bBufferReused;             // receive buffer was taken from the pool
+    uint32_t nBufferGrows;          // number of receive buffer reallocations
 
     int64_t nTime;                  // time (in microseconds) of message receipt.
 
     CNetMessage(const CMessageHeader::MessageStartChars& pchMessageStartIn, const int nTypeIn, const int nVersionIn);
+    CNetMessage(CNetMessage&&) = default;
+    CNetMessage& operator=(CNetMessage&&) = default;
+    ~CNetMessage();
 
     bool complete() const noexcept;
     void SetVersion(int nVersionIn) noexcept;
@@ -98,6 +98,11 @@ CNode::CNode(SOCKET hSocketIn, const CAddress& addrIn, const string& addrNameIn,
     nLastRecv = 0;
     nSendBytes = 0;
     nRecvBytes = 0;
+    nRecvBufAllocs = 0;
+    nRecvBufReuses = 0;
+    nRecvBufGrows = 0;
+    nCmpctBlocksReceived = 0;
+    nCmpctBlockTxRequests = 0;
     nTimeConnected = GetTime();
     nTimeOffset = 0;
     addr = addrIn;
@@ -111,6 +116,9 @@ CNode::CNode(SOCKET hSocketIn, const CAddress& addrIn, const string& addrNameIn,
     fNetworkNode = fNetworkNodeIn;
     fSuccessfullyConnected = false;
     fDisconnect = false;
+    fPeerMsgQueueFull = false;
+    fSocketInterestChanged = false;
+    fRecvPaused = false;
     nSendSize = 0;
     nSendOffset = 0;
     hashContinue = uint256();
@@ -153,6 +161,7 @@ CNode::~CNode()
 
 void CNode::AskFor(const CInv& inv)
 {
+    LOCK(cs_askFor);
     if (mapAskFor.size() > MAPASKFOR_MAX_SZ || setAskFor.size() > SETASKFOR_MAX_SZ)
         return;
     // a peer may not have multiple non-responded queue positions for a single inv item
@@ -185,6 +194,12 @@ void CNode::AskFor(const CInv& inv)
     mapAskFor.insert(make_pair(nRequestTime, inv));
 }
 
+void CNode::RemoveAskFor(const uint256& hash)
+{
+    LOCK(cs_askFor);
+    setAskFor.erase(hash);
+}
+
 void CNode::BeginMessage(const char* pszCommand) EXCLUSIVE_LOCK_FUNCTION(cs_vSendMsg)
 {
     ENTER_CRITICAL_SECTION(cs_vSendMsg);
@@ -241,8 +256,13 @@ void CNode::EndMessage() UNLOCK_FUNCTION(cs_vSendMsg)
     // If write queue empty, attempt "optimistic write"
     if (msgData == vSendMsg.front())
         SocketSendData(*this);
+    const bool bSendPending = !vSendMsg.empty();
 
     LEAVE_CRITICAL_SECTION(cs_vSendMsg);
+
+    // socket handler should wait for the socket to be writable to send the rest of the data
+    if (bSendPending)
+        gl_NodeManager.NotifySocketInterest(*this);
 }
 
 void CNode::PushAddress(const CAddress& addr)
@@ -395,6 +415,11 @@ void CNode::copyStats(CNodeStats &stats)
     stats.nStartingHeight = nStartingHeight;
     stats.nSendBytes = nSendBytes;
     stats.nRecvBytes = nRecvBytes;
+    stats.nRecvBufAllocs = nRecvBufAllocs;
+    stats.nRecvBufReuses = nRecvBufReuses;
+    stats.nRecvBufGrows = nRecvBufGrows;
+    stats.nCmpctBlocksReceived = nCmpctBlocksReceived;
+    stats.nCmpctBlockTxRequests = nCmpctBlockTxRequests;
     stats.fWhitelisted = fWhitelisted;
 
     // It is common for nodes with good ping times to suddenly become lagged,
@@ -431,7 +456,17 @@ bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes)
         // absorb network data
         int handled;
         if (!msg.in_data)
+        {
             handled = msg.readHeader(pch, nBytes);
+            // receive buffer is allocated when the header is complete
+            if (msg.in_data && msg.hdr.nMessageSize)
+            {
+                if (msg.bBufferReused)
+                    ++nRecvBufReuses;
+                else
+                    ++nRecvBufAllocs;
+            }
+        }
         else
             handled = msg.readData(pch, nBytes);
 
@@ -449,6 +484,7 @@ bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes)
 
         if (msg.complete())
         {
+            nRecvBufGrows += msg.nBufferGrows;
             msg.nTime = GetTimeMicros();
             gl_NodeManager.MessageHandlerNotifyOne();
         }
@@ -457,6 +493,18 @@ bool CNode::ReceiveMsgBytes(const char *pch, unsigned int nBytes)
     return true;
 }
 
+/**
+ * Check receive flood control - if there is no (complete) message in the receive buffer,
+ * or there is space left in the buffer, more data can be received from the peer.
+ * Requires LOCK(cs_vRecvMsg).
+ *
+ * \return true if data can be received from the peer
+ */
+bool CNode::CanReceiveMore() const noexcept
+{
+    return vRecvMsg.empty() || !vRecvMsg.front().complete() || (GetTotalRecvSize() <= ReceiveFloodSize());
+}
+
 bool CNode::IsNotUsed()
 {
     TRY_LOCK(cs_vRecvMsg, lockRecv);
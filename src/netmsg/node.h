@@ -42,6 +42,11 @@ public:
     int32_t nStartingHeight;
     uint64_t nSendBytes;
     uint64_t nRecvBytes;
+    uint64_t nRecvBufAllocs;
+    uint64_t nRecvBufReuses;
+    uint64_t nRecvBufGrows;
+    uint64_t nCmpctBlocksReceived;
+    uint64_t nCmpctBlockTxRequests;
     bool fWhitelisted;
     double dPingTime;
     double dPingWait;
@@ -73,6 +78,13 @@ public:
     CCriticalSection cs_vRecvMsg; // protects vRecvMsg
     std::deque<CNetMessage> vRecvMsg;
     std::atomic_uint64_t nRecvBytes;
+    // receive buffer allocation churn
+    std::atomic_uint64_t nRecvBufAllocs; // buffers allocated for the received messages
+    std::atomic_uint64_t nRecvBufReuses; // buffers reused from the pool
+    std::atomic_uint64_t nRecvBufGrows;  // buffer reallocations while receiving the message
+    // compact block relay
+    std::atomic_uint64_t nCmpctBlocksReceived;  // compact blocks received from the peer
+    std::atomic_uint64_t nCmpctBlockTxRequests; // missing transactions requests sent for the compact blocks
     int nRecvVersion;
 
     std::atomic_int64_t nLastSend;
@@ -95,6 +107,12 @@ public:
     std::atomic_bool fNetworkNode;
     std::atomic_bool fSuccessfullyConnected;
     std::atomic_bool fDisconnect;
+    // peer message queue is full, messages are not processed until some space is freed
+    std::atomic_bool fPeerMsgQueueFull;
+    // socket events to watch for should be updated by the socket handler thread
+    std::atomic_bool fSocketInterestChanged;
+    // socket handler does not receive data from the peer until the receive buffer is processed
+    std::atomic_bool fRecvPaused;
     // We use fRelayTxes for two purposes -
     // a) it allows us to not relay tx invs before receiving the peer's version message
     // b) the peer may tell us in its version message that we should not relay tx invs
@@ -123,6 +141,7 @@ public:
     mruset<CInv> setInventoryKnown;
     std::vector<CInv> vInventoryToSend;
     CCriticalSection cs_inventory;
+    CCriticalSection cs_askFor; // protects setAskFor & mapAskFor
     std::set<uint256> setAskFor;
     std::multimap<int64_t, CInv> mapAskFor;
 
@@ -156,6 +175,8 @@ public:
 
     // requires LOCK(cs_vRecvMsg)
     bool ReceiveMsgBytes(const char *pch, unsigned int nBytes);
+    // requires LOCK(cs_vRecvMsg)
+    bool CanReceiveMore() const noexcept;
 
     bool IsNotUsed();
 
@@ -188,6 +209,7 @@ public:
     }
 
     void AskFor(const CInv& inv);
+    void RemoveAskFor(const uint256& hash);
 
     // TODO: Document the postcondition of this function.  Is cs_vSendMsg locked?
     void BeginMessage(const char* pszCommand) EXCLUSIVE_LOCK_FUNCTION(cs_vSendMsg);
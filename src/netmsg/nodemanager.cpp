@@ -316,6 +316,32 @@ node_t CNodeManager::FindNode(const NodeId id)
     return nullptr;
 }
 
+/**
+ * Notify socket handler thread that socket events to watch for the node should be updated:
+ *   - new node is added;
+ *   - data is queued to send and could not be sent at once;
+ *   - message handler processed received messages of the node with paused receiving.
+ * Node is queued only once until the socket handler takes the changes.
+ *
+ * \param node - node with changed socket interest
+ * \param bForce - queue the node even if it is already queued (new node could be queued
+ *                 before it was added to the node list and skipped by the socket handler)
+ */
+void CNodeManager::NotifySocketInterest(CNode &node, const bool bForce)
+{
+    if (node.fSocketInterestChanged.exchange(true) && !bForce)
+        return;
+    unique_lock lock(m_mtxSocketInterest);
+    m_vSocketInterestChanged.push_back(node.id);
+}
+
+void CNodeManager::TakeSocketInterestChanges(vector<NodeId> &vNodeIds)
+{
+    vNodeIds.clear();
+    unique_lock lock(m_mtxSocketInterest);
+    vNodeIds.swap(m_vSocketInterestChanged);
+}
+
 const CNodeManager::CAllNodes CNodeManager::AllNodes{};
 const CNodeManager::CFullyConnectedOnly CNodeManager::FullyConnectedOnly{};
 
@@ -398,6 +424,8 @@ node_t CNodeManager::ConnectNode(const CAddress &addrConnect, const char *pszDes
             EXCLUSIVE_LOCK(mtx_vNodes);
             m_vNodes.emplace_back(pnode);
         }
+        // register the new socket in the socket handler
+        NotifySocketInterest(*pnode, true);
         return pnode;
     }
     if (!proxyConnectionFailed)
@@ -666,6 +694,8 @@ void CNodeManager::AcceptConnection(const ListenSocket& hListenSocket)
         EXCLUSIVE_LOCK(mtx_vNodes);
         m_vNodes.emplace_back(pnode);
     }
+    // register the new socket in the socket handler
+    NotifySocketInterest(*pnode, true);
 }
 
 CNodeManager gl_NodeManager;
\ No newline at end of file
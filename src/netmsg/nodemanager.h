@@ -5,6 +5,7 @@
 #include <chrono>
 #include <set>
 #include <condition_variable>
+#include <mutex>
 
 #include <utils/vector_types.h>
 #include <utils/svc_thread.h>
@@ -39,6 +40,11 @@ public:
 		m_messageHandlerCondition.notify_one();
 	}
 
+    // socket events to watch for the node should be updated by the socket handler thread
+    void NotifySocketInterest(CNode &node, const bool bForce = false);
+    // get ids of the nodes with changed socket interest, called by the socket handler thread
+    void TakeSocketInterestChanges(std::vector<NodeId> &vNodeIds);
+
 	node_t FindNode(const CNetAddr& ip);
 	node_t FindNode(const CSubNet& subNet);
 	node_t FindNode(const std::string& addrName);
@@ -150,6 +156,10 @@ private:
 	mutable CSharedMutex mtx_vNodes;
 
 	std::condition_variable m_messageHandlerCondition;
+
+    std::mutex m_mtxSocketInterest;
+    // nodes with changed socket interest
+    std::vector<NodeId> m_vSocketInterestChanged;
 };
 
 bool IsPeerAddrLocalGood(const node_t& pnode);
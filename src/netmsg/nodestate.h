@@ -4,6 +4,7 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or https://www.opensource.org/licenses/mit-license.php.
 #include <unordered_map>
+#include <map>
 #include <list>
 
 #include <utils/uint256.h>
@@ -11,6 +12,8 @@
 #include <chain.h>
 #include <net.h>
 
+class CPartialCompactBlock;
+
 struct CBlockReject
 {
     unsigned char chRejectCode;
@@ -70,6 +73,9 @@ struct CNodeState
     bool fHasLessChainWork = false;
     //! Whether we consider this a preferred download peer.
     std::atomic_bool fPreferredDownload = false;
+    //! Blocks being reconstructed from the compact blocks, waiting for the missing transactions ("blocktxn").
+    //! Entries are removed when the block is received (MarkBlockAsReceived), protected by cs_main.
+    std::map<uint256, std::shared_ptr<CPartialCompactBlock>> mapPartialBlocks;
 
     CNodeState(const NodeId id) noexcept
     {
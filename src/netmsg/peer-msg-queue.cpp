@@ -0,0 +1,262 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <utils/util.h>
+#include <utils/utilstrencodings.h>
+#include <consensus/validation.h>
+#include <netmsg/nodemanager.h>
+#include <netmsg/peer-msg-queue.h>
+
+using namespace std;
+
+CPeerMessageQueue::CPeerMessageQueue(const char *szName, const size_t nMaxPeerQueueSize) noexcept :
+    m_sName(szName),
+    m_nMaxPeerQueueSize(nMaxPeerQueueSize),
+    m_nMaxPeerQueueBytes(0),
+    m_nThreadCount(0),
+    m_nWorkers(0),
+    m_nQueued(0),
+    m_nInProcess(0),
+    m_bGateClosed(false),
+    m_bStopRequested(false)
+{}
+
+void CPeerMessageQueue::SetThreadCount(const int64_t nThreadCount, const size_t nMaxThreadCount)
+{
+    if (nThreadCount <= 0)
+        m_nThreadCount = 0;
+    else
+        m_nThreadCount = min(static_cast<size_t>(nThreadCount), nMaxThreadCount);
+}
+
+/**
+ * Create message queue workers.
+ *
+ * \param threadGroup - add workers to this thread group
+ */
+void CPeerMessageQueue::create_workers(CServiceThreadGroup &threadGroup)
+{
+    if (!m_nThreadCount || !m_fnHandler)
+    {
+        LogPrintf("%s message queue is disabled, messages are processed by the message handler thread\n", m_sName);
+        return;
+    }
+    LogPrintf("Using %zu threads for %s message queue\n", m_nThreadCount, m_sName);
+    string sThreadName, error;
+    for (size_t i = 0; i < m_nThreadCount; ++i)
+    {
+        sThreadName = strprintf("%s-msg%d", m_sName, i + 1);
+        threadGroup.add_thread(error, make_shared<CPeerMessageQueueWorker>(this, sThreadName.c_str()), true);
+    }
+}
+
+/**
+ * Set the gate for the messages taken by the workers.
+ * Gate is acquired under the queue lock, so it should not call back to the queue.
+ *
+ * \param fnAcquire - reserve capacity for one message, returns false if the next stage is full
+ * \param fnRelease - release reserved capacity, called after the message is processed
+ */
+void CPeerMessageQueue::SetGate(peer_msg_gate_acquire_t &&fnAcquire, peer_msg_gate_release_t &&fnRelease)
+{
+    unique_lock lock(m_Mutex);
+    m_fnGateAcquire = std::move(fnAcquire);
+    m_fnGateRelease = std::move(fnRelease);
+}
+
+void CPeerMessageQueue::Resume()
+{
+    unique_lock lock(m_Mutex);
+    m_bGateClosed = false;
+    m_condWorker.notify_all();
+}
+
+size_t CPeerMessageQueue::GetWorkerCount() const
+{
+    unique_lock lock(m_Mutex);
+    return m_nWorkers;
+}
+
+bool CPeerMessageQueue::IsEnabled() const
+{
+    unique_lock lock(m_Mutex);
+    return m_nWorkers && !m_bStopRequested;
+}
+
+/**
+ * Submit message to the peer message queue.
+ * Message data is moved to the queue only if the message was accepted.
+ * Moved data is not counted by the receive flood control anymore, so the size of the peer queue
+ * together with the peer receive buffer is limited by m_nMaxPeerQueueBytes.
+ *
+ * \param pfrom - node that sent the message
+ * \param strCommand - message command
+ * \param vRecv - message data
+ * \param nRecvBufferSize - size of the messages in the peer receive buffer
+ * \return false if there are no workers or the peer queue is full
+ */
+bool CPeerMessageQueue::Submit(const node_t &pfrom, const string &strCommand, CDataStream &vRecv, const size_t nRecvBufferSize)
+{
+    unique_lock lock(m_Mutex);
+    if (!m_nWorkers || m_bStopRequested)
+        return false;
+    auto it = m_mapPeerQueues.find(pfrom->id);
+    if (it == m_mapPeerQueues.end())
+    {
+        it = m_mapPeerQueues.emplace(pfrom->id, peer_queue_t{ pfrom, {}, 0 }).first;
+        m_ReadyPeers.push_back(pfrom->id);
+        m_condWorker.notify_one();
+    } else if (it->second.messages.size() >= m_nMaxPeerQueueSize)
+        return false;
+    // message is always accepted to the empty queue, otherwise the peer would not be resumed by the workers
+    else if (m_nMaxPeerQueueBytes && !it->second.messages.empty() &&
+        (it->second.nQueuedBytes + nRecvBufferSize > m_nMaxPeerQueueBytes))
+        return false;
+    it->second.nQueuedBytes += vRecv.size();
+    it->second.messages.push_back(peer_msg_t{ strCommand, std::move(vRecv) });
+    ++m_nQueued;
+    return true;
+}
+
+void CPeerMessageQueue::WaitForEmpty()
+{
+    unique_lock lock(m_Mutex);
+    m_condEmpty.wait(lock, [this]() { return !m_nWorkers || (!m_nQueued && !m_nInProcess); });
+}
+
+size_t CPeerMessageQueue::size() const
+{
+    unique_lock lock(m_Mutex);
+    return m_nQueued;
+}
+
+size_t CPeerMessageQueue::GetPeerQueueSize(const NodeId id) const
+{
+    unique_lock lock(m_Mutex);
+    const auto it = m_mapPeerQueues.find(id);
+    return it == m_mapPeerQueues.cend() ? 0 : it->second.messages.size();
+}
+
+size_t CPeerMessageQueue::GetPeerQueueBytes(const NodeId id) const
+{
+    unique_lock lock(m_Mutex);
+    const auto it = m_mapPeerQueues.find(id);
+    return it == m_mapPeerQueues.cend() ? 0 : it->second.nQueuedBytes;
+}
+
+void CPeerMessageQueue::ProcessMessage(node_t &pfrom, peer_msg_t &msg)
+{
+    // skip messages from disconnected peers
+    if (pfrom->fDisconnect)
+        return;
+    const size_t nMessageSize = msg.vRecv.size();
+    try
+    {
+        m_fnHandler(pfrom, msg.strCommand, msg.vRecv);
+    } catch (const ios_base::failure& e) {
+        pfrom->PushMessage("reject", msg.strCommand, REJECT_MALFORMED, string("error parsing message"));
+        LogFnPrintf("(%s, %zu bytes): exception '%s' caught, peer=%d", SanitizeString(msg.strCommand), nMessageSize, e.what(), pfrom->id);
+    } catch (const exception& e) {
+        PrintExceptionContinue(&e, m_sName.c_str());
+    } catch (...) {
+        PrintExceptionContinue(nullptr, m_sName.c_str());
+    }
+}
+
+void CPeerMessageQueue::Worker(const CServiceThread *pThread)
+{
+    unique_lock lock(m_Mutex);
+    ++m_nWorkers;
+    while (true)
+    {
+        m_condWorker.wait(lock, [&]()
+            {
+                return m_bStopRequested || pThread->shouldStop() || (!m_ReadyPeers.empty() && !m_bGateClosed);
+            });
+        if (m_bStopRequested || pThread->shouldStop())
+            break;
+
+        // take the next message of the peer, peer is not served by other workers until it is processed
+        const NodeId id = m_ReadyPeers.front();
+        auto it = m_mapPeerQueues.find(id);
+        if (it == m_mapPeerQueues.end())
+        {
+            m_ReadyPeers.pop_front();
+            continue;
+        }
+        if (m_fnGateAcquire && !m_fnGateAcquire())
+        {
+            // next stage is full - messages stay in the peer queues until Resume() is called
+            m_bGateClosed = true;
+            continue;
+        }
+        m_ReadyPeers.pop_front();
+        node_t pfrom = it->second.pfrom;
+        peer_msg_t msg = std::move(it->second.messages.front());
+        it->second.messages.pop_front();
+        it->second.nQueuedBytes -= msg.vRecv.size();
+        --m_nQueued;
+        ++m_nInProcess;
+        const bool bResumePeer = (it->second.messages.size() < m_nMaxPeerQueueSize / 2) &&
+            (!m_nMaxPeerQueueBytes || (it->second.nQueuedBytes <= m_nMaxPeerQueueBytes / 2));
+        lock.unlock();
+
+        // message handler thread skips the peer while its queue is full
+        if (bResumePeer && pfrom->fPeerMsgQueueFull)
+        {
+            pfrom->fPeerMsgQueueFull = false;
+            gl_NodeManager.MessageHandlerNotifyOne();
+        }
+        ProcessMessage(pfrom, msg);
+        pfrom.reset();
+        if (m_fnGateRelease)
+            m_fnGateRelease();
+
+        lock.lock();
+        --m_nInProcess;
+        it = m_mapPeerQueues.find(id);
+        if (it != m_mapPeerQueues.end())
+        {
+            if (it->second.messages.empty())
+                m_mapPeerQueues.erase(it);
+            else
+            {
+                // round-robin - the peer goes to the end of the line
+                m_ReadyPeers.push_back(id);
+                m_condWorker.notify_one();
+            }
+        }
+        m_condEmpty.notify_all();
+    }
+    if (--m_nWorkers == 0)
+    {
+        // messages not processed yet are dropped on shutdown
+        if (m_nQueued)
+            LogFnPrintf("%zu %s messages were not processed", m_nQueued, m_sName);
+        m_mapPeerQueues.clear();
+        m_ReadyPeers.clear();
+        m_nQueued = 0;
+    }
+    m_condEmpty.notify_all();
+}
+
+void CPeerMessageQueue::stop()
+{
+    unique_lock lock(m_Mutex);
+    m_bStopRequested = true;
+    m_condWorker.notify_all();
+    m_condEmpty.notify_all();
+}
+
+void CPeerMessageQueueWorker::execute()
+{
+    if (m_pQueue)
+        m_pQueue->Worker(this);
+}
+
+void CPeerMessageQueueWorker::stop() noexcept
+{
+    CServiceThread::stop();
+    if (m_pQueue)
+        m_pQueue->stop();
+}
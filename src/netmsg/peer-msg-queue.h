@@ -0,0 +1,128 @@
+#pragma once
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <deque>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+
+#include <utils/streams.h>
+#include <utils/svc_thread.h>
+#include <netmsg/node.h>
+
+/** Max number of messages waiting in the message queue for one peer */
+constexpr size_t PEER_MSG_QUEUE_MAX_PEER_SIZE = 1'000;
+
+using peer_msg_handler_t = std::function<void(node_t&, std::string&, CDataStream&)>;
+// reserve the capacity of the next processing stage for one message
+using peer_msg_gate_acquire_t = std::function<bool()>;
+// release the capacity reserved by peer_msg_gate_acquire_t after the message is processed
+using peer_msg_gate_release_t = std::function<void()>;
+
+/**
+ * Network message queue processed by the pool of worker threads (message lane).
+ * Used to process a class of the network messages separately from the message handler thread.
+ * Messages of one peer are processed strictly in the order of arrival by one worker at a time,
+ * peers with pending messages are served round-robin - one message per turn,
+ * so the message flood from one peer does not delay messages from other peers.
+ * If the peer queue is full or the peer queued and received messages exceed the byte limit,
+ * Submit() fails and the message stays in the peer receive buffer,
+ * that throttles the peer via the receive flood control.
+ * Optional gate reserves the capacity of the next processing stage before the message is taken
+ * from the peer queue. While the gate is closed, messages stay in the peer queues until Resume() is called.
+ */
+class CPeerMessageQueue
+{
+public:
+    CPeerMessageQueue(const char *szName, const size_t nMaxPeerQueueSize = PEER_MSG_QUEUE_MAX_PEER_SIZE) noexcept;
+
+    void SetHandler(peer_msg_handler_t &&fnHandler) { m_fnHandler = std::move(fnHandler); }
+    void SetGate(peer_msg_gate_acquire_t &&fnAcquire, peer_msg_gate_release_t &&fnRelease);
+    // notify workers that the gate can be acquired again
+    void Resume();
+    void SetThreadCount(const int64_t nThreadCount, const size_t nMaxThreadCount);
+    // set max size in bytes of the peer queued messages together with its receive buffer, 0 - no limit
+    void SetMaxPeerQueueBytes(const size_t nMaxPeerQueueBytes) noexcept { m_nMaxPeerQueueBytes = nMaxPeerQueueBytes; }
+    size_t GetThreadCount() const noexcept { return m_nThreadCount; }
+    // number of running workers
+    size_t GetWorkerCount() const;
+    // returns true if the messages can be submitted to the queue
+    bool IsEnabled() const;
+
+    // create message queue workers
+    void create_workers(CServiceThreadGroup &threadGroup);
+
+    bool Submit(const node_t &pfrom, const std::string &strCommand, CDataStream &vRecv, const size_t nRecvBufferSize = 0);
+    // wait until all submitted messages are processed
+    void WaitForEmpty();
+    // number of messages waiting in the queue
+    size_t size() const;
+    size_t GetPeerQueueSize(const NodeId id) const;
+    // size in bytes of the messages waiting in the peer queue
+    size_t GetPeerQueueBytes(const NodeId id) const;
+
+    // worker thread loop
+    void Worker(const CServiceThread *pThread);
+    void stop();
+
+protected:
+    typedef struct _peer_msg_t
+    {
+        std::string strCommand;
+        CDataStream vRecv;
+    } peer_msg_t;
+
+    typedef struct _peer_queue_t
+    {
+        node_t pfrom;
+        std::deque<peer_msg_t> messages;
+        // size in bytes of the messages waiting in the queue
+        size_t nQueuedBytes;
+    } peer_queue_t;
+
+    std::string m_sName;
+    mutable std::mutex m_Mutex;
+    // workers wait for peers with pending messages
+    std::condition_variable m_condWorker;
+    // WaitForEmpty() waits for all messages to be processed
+    std::condition_variable m_condEmpty;
+    // message queues of the peers, peer queue exists while it has messages or one of them is processed
+    std::unordered_map<NodeId, peer_queue_t> m_mapPeerQueues;
+    // peers with pending messages that are not processed by any worker
+    std::deque<NodeId> m_ReadyPeers;
+    peer_msg_handler_t m_fnHandler;
+    peer_msg_gate_acquire_t m_fnGateAcquire;
+    peer_msg_gate_release_t m_fnGateRelease;
+    // true if the gate could not be acquired, workers wait for Resume()
+    bool m_bGateClosed;
+    size_t m_nMaxPeerQueueSize;
+    size_t m_nMaxPeerQueueBytes;
+    size_t m_nThreadCount;
+    // number of running workers
+    size_t m_nWorkers;
+    // number of messages waiting in the queue
+    size_t m_nQueued;
+    // number of messages being processed
+    size_t m_nInProcess;
+    bool m_bStopRequested;
+
+    void ProcessMessage(node_t &pfrom, peer_msg_t &msg);
+};
+
+class CPeerMessageQueueWorker : public CServiceThread
+{
+public:
+    CPeerMessageQueueWorker(CPeerMessageQueue *pQueue, const char *szThreadName) :
+        CServiceThread(szThreadName),
+        m_pQueue(pQueue)
+    {}
+
+    void execute() override;
+    void stop() noexcept override;
+
+private:
+    CPeerMessageQueue *m_pQueue;
+};
@@ -0,0 +1,323 @@
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <cerrno>
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+#include <utils/util.h>
+#include <netmsg/socket-poller.h>
+
+using namespace std;
+
+unique_ptr<CSocketPoller> CSocketPoller::Create(const bool bPreferEpoll)
+{
+#ifdef USE_EPOLL_SOCKET_POLLER
+    if (bPreferEpoll)
+    {
+        auto pPoller = make_unique<CEpollSocketPoller>();
+        if (pPoller->IsValid())
+            return pPoller;
+        LogFnPrintf("epoll is not available (%s), falling back to poll()", GetErrorString(errno));
+    }
+#endif
+#ifdef WIN32
+    return make_unique<CSelectSocketPoller>();
+#else
+    return make_unique<CPollSocketPoller>();
+#endif
+}
+
+/**
+ * Register socket in the poller or update events to watch for.
+ * Poller backend is called only if the socket is new or its events have changed.
+ *
+ * \param hSocket - socket to watch
+ * \param nOwnerId - id of the socket owner (node id, -1 for listening sockets)
+ * \param nEvents - events to watch for (SOCKET_EVENT_RECV, SOCKET_EVENT_SEND),
+ *                  errors are always reported
+ * \return true if the socket is registered in the poller
+ */
+bool CSocketPoller::SetInterest(const SOCKET hSocket, const int64_t nOwnerId, const uint8_t nEvents)
+{
+    const uint8_t nWatchEvents = nEvents & (SOCKET_EVENT_RECV | SOCKET_EVENT_SEND);
+    auto it = m_mapRegistered.find(hSocket);
+    if (it != m_mapRegistered.end())
+    {
+        if (it->second.nOwnerId == nOwnerId)
+        {
+            if (it->second.nEvents == nWatchEvents)
+                return true;
+            if (Modify(hSocket, nWatchEvents))
+            {
+                it->second.nEvents = nWatchEvents;
+                return true;
+            }
+        }
+        // socket descriptor was closed and reused by another connection, or modify failed
+        Unregister(hSocket);
+        m_mapRegistered.erase(it);
+    }
+    if (!Register(hSocket, nWatchEvents))
+        return false;
+    m_mapRegistered.emplace(hSocket, socket_registration_t{ nOwnerId, nWatchEvents });
+    return true;
+}
+
+void CSocketPoller::Remove(const SOCKET hSocket)
+{
+    auto it = m_mapRegistered.find(hSocket);
+    if (it == m_mapRegistered.end())
+        return;
+    Unregister(hSocket);
+    m_mapRegistered.erase(it);
+    m_mapReady.erase(hSocket);
+}
+
+void CSocketPoller::Remove(const SOCKET hSocket, const int64_t nOwnerId)
+{
+    const auto it = m_mapRegistered.find(hSocket);
+    if (it == m_mapRegistered.cend() || it->second.nOwnerId != nOwnerId)
+        return;
+    Remove(hSocket);
+}
+
+void CSocketPoller::RemoveStale(const unordered_set<SOCKET> &setActiveSockets)
+{
+    for (auto it = m_mapRegistered.begin(); it != m_mapRegistered.end();)
+    {
+        if (setActiveSockets.count(it->first))
+        {
+            ++it;
+            continue;
+        }
+        Unregister(it->first);
+        m_mapReady.erase(it->first);
+        it = m_mapRegistered.erase(it);
+    }
+}
+
+int CSocketPoller::Wait(const int nTimeoutMs)
+{
+    m_mapReady.clear();
+    return WaitEvents(nTimeoutMs);
+}
+
+uint8_t CSocketPoller::GetEvents(const SOCKET hSocket) const noexcept
+{
+    const auto it = m_mapReady.find(hSocket);
+    return it == m_mapReady.cend() ? SOCKET_EVENT_NONE : it->second;
+}
+
+/**
+ * Get all registered sockets with events reported by the last Wait().
+ * Only ready sockets are returned, so the caller does not have to check all registered sockets.
+ *
+ * \param vReady - returns ready sockets with their owner ids and events
+ */
+void CSocketPoller::GetReadySockets(vector<socket_event_t> &vReady) const
+{
+    vReady.clear();
+    vReady.reserve(m_mapReady.size());
+    for (const auto& [hSocket, nEvents] : m_mapReady)
+    {
+        const auto it = m_mapRegistered.find(hSocket);
+        if (it == m_mapRegistered.cend())
+            continue;
+        vReady.push_back(socket_event_t{ hSocket, it->second.nOwnerId, nEvents });
+    }
+}
+
+#ifndef WIN32
+static short ToPollEvents(const uint8_t nEvents) noexcept
+{
+    short nPollEvents = 0;
+    if (nEvents & SOCKET_EVENT_RECV)
+        nPollEvents |= POLLIN;
+    if (nEvents & SOCKET_EVENT_SEND)
+        nPollEvents |= POLLOUT;
+    return nPollEvents;
+}
+
+bool CPollSocketPoller::Register(const SOCKET hSocket, const uint8_t nEvents)
+{
+    struct pollfd pfd;
+    pfd.fd = hSocket;
+    pfd.events = ToPollEvents(nEvents);
+    pfd.revents = 0;
+    m_mapPollIndex[hSocket] = m_vPollFds.size();
+    m_vPollFds.push_back(pfd);
+    return true;
+}
+
+bool CPollSocketPoller::Modify(const SOCKET hSocket, const uint8_t nEvents)
+{
+    const auto it = m_mapPollIndex.find(hSocket);
+    if (it == m_mapPollIndex.cend())
+        return false;
+    m_vPollFds[it->second].events = ToPollEvents(nEvents);
+    return true;
+}
+
+void CPollSocketPoller::Unregister(const SOCKET hSocket) noexcept
+{
+    const auto it = m_mapPollIndex.find(hSocket);
+    if (it == m_mapPollIndex.cend())
+        return;
+    // move the last pollfd into the freed slot
+    const size_t nIndex = it->second;
+    m_mapPollIndex.erase(it);
+    if (nIndex + 1 != m_vPollFds.size())
+    {
+        m_vPollFds[nIndex] = m_vPollFds.back();
+        m_mapPollIndex[m_vPollFds[nIndex].fd] = nIndex;
+    }
+    m_vPollFds.pop_back();
+}
+
+int CPollSocketPoller::WaitEvents(const int nTimeoutMs)
+{
+    int nRet = 0;
+    // retry if interrupted by a signal
+    do
+    {
+        nRet = poll(m_vPollFds.data(), static_cast<nfds_t>(m_vPollFds.size()), nTimeoutMs);
+    } while ((nRet < 0) && (errno == EINTR));
+    if (nRet <= 0)
+        return nRet;
+    for (const auto& pfd : m_vPollFds)
+    {
+        if (!pfd.revents)
+            continue;
+        uint8_t nEvents = SOCKET_EVENT_NONE;
+        if (pfd.revents & POLLIN)
+            nEvents |= SOCKET_EVENT_RECV;
+        if (pfd.revents & POLLOUT)
+            nEvents |= SOCKET_EVENT_SEND;
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
+            nEvents |= SOCKET_EVENT_ERROR;
+        m_mapReady[pfd.fd] = nEvents;
+    }
+    return nRet;
+}
+#endif // !WIN32
+
+#ifdef USE_EPOLL_SOCKET_POLLER
+CEpollSocketPoller::CEpollSocketPoller() noexcept :
+    m_hEpoll(epoll_create1(EPOLL_CLOEXEC))
+{}
+
+CEpollSocketPoller::~CEpollSocketPoller()
+{
+    if (m_hEpoll >= 0)
+        close(m_hEpoll);
+}
+
+static uint32_t ToEpollEvents(const uint8_t nEvents) noexcept
+{
+    uint32_t nEpollEvents = 0;
+    if (nEvents & SOCKET_EVENT_RECV)
+        nEpollEvents |= EPOLLIN;
+    if (nEvents & SOCKET_EVENT_SEND)
+        nEpollEvents |= EPOLLOUT;
+    return nEpollEvents;
+}
+
+bool CEpollSocketPoller::Register(const SOCKET hSocket, const uint8_t nEvents)
+{
+    struct epoll_event ev = {};
+    ev.events = ToEpollEvents(nEvents);
+    ev.data.fd = hSocket;
+    if (epoll_ctl(m_hEpoll, EPOLL_CTL_ADD, hSocket, &ev) == 0)
+        return true;
+    // stale registration of the reused descriptor
+    if ((errno == EEXIST) && (epoll_ctl(m_hEpoll, EPOLL_CTL_MOD, hSocket, &ev) == 0))
+        return true;
+    LogFnPrint("net", "epoll_ctl(ADD) failed for socket %d: %s", hSocket, GetErrorString(errno));
+    return false;
+}
+
+bool CEpollSocketPoller::Modify(const SOCKET hSocket, const uint8_t nEvents)
+{
+    struct epoll_event ev = {};
+    ev.events = ToEpollEvents(nEvents);
+    ev.data.fd = hSocket;
+    return epoll_ctl(m_hEpoll, EPOLL_CTL_MOD, hSocket, &ev) == 0;
+}
+
+void CEpollSocketPoller::Unregister(const SOCKET hSocket) noexcept
+{
+    // fails with EBADF or ENOENT if the socket was already closed - closed sockets are removed by the kernel
+    epoll_ctl(m_hEpoll, EPOLL_CTL_DEL, hSocket, nullptr);
+}
+
+int CEpollSocketPoller::WaitEvents(const int nTimeoutMs)
+{
+    m_vEvents.resize(max<size_t>(m_mapRegistered.size(), 16));
+    int nRet = 0;
+    // retry if interrupted by a signal
+    do
+    {
+        nRet = epoll_wait(m_hEpoll, m_vEvents.data(), static_cast<int>(m_vEvents.size()), nTimeoutMs);
+    } while ((nRet < 0) && (errno == EINTR));
+    if (nRet <= 0)
+        return nRet;
+    for (int i = 0; i < nRet; ++i)
+    {
+        const auto& ev = m_vEvents[i];
+        uint8_t nEvents = SOCKET_EVENT_NONE;
+        if (ev.events & EPOLLIN)
+            nEvents |= SOCKET_EVENT_RECV;
+        if (ev.events & EPOLLOUT)
+            nEvents |= SOCKET_EVENT_SEND;
+        if (ev.events & (EPOLLERR | EPOLLHUP))
+            nEvents |= SOCKET_EVENT_ERROR;
+        m_mapReady[ev.data.fd] = nEvents;
+    }
+    return nRet;
+}
+#endif // USE_EPOLL_SOCKET_POLLER
+
+#ifdef WIN32
+int CSelectSocketPoller::WaitEvents(const int nTimeoutMs)
+{
+    struct timeval timeout;
+    timeout.tv_sec = nTimeoutMs / 1000;
+    timeout.tv_usec = (nTimeoutMs % 1000) * 1000;
+
+    fd_set fdsetRecv;
+    fd_set fdsetSend;
+    fd_set fdsetError;
+    FD_ZERO(&fdsetRecv);
+    FD_ZERO(&fdsetSend);
+    FD_ZERO(&fdsetError);
+    SOCKET hSocketMax = 0;
+    for (const auto& [hSocket, reg] : m_mapRegistered)
+    {
+        FD_SET(hSocket, &fdsetError);
+        if (reg.nEvents & SOCKET_EVENT_RECV)
+            FD_SET(hSocket, &fdsetRecv);
+        if (reg.nEvents & SOCKET_EVENT_SEND)
+            FD_SET(hSocket, &fdsetSend);
+        hSocketMax = max(hSocketMax, hSocket);
+    }
+    const int nRet = select(m_mapRegistered.empty() ? 0 : static_cast<int>(hSocketMax + 1),
+                            &fdsetRecv, &fdsetSend, &fdsetError, &timeout);
+    if (nRet <= 0)
+        return nRet;
+    for (const auto& [hSocket, reg] : m_mapRegistered)
+    {
+        uint8_t nEvents = SOCKET_EVENT_NONE;
+        if (FD_ISSET(hSocket, &fdsetRecv))
+            nEvents |= SOCKET_EVENT_RECV;
+        if (FD_ISSET(hSocket, &fdsetSend))
+            nEvents |= SOCKET_EVENT_SEND;
+        if (FD_ISSET(hSocket, &fdsetError))
+            nEvents |= SOCKET_EVENT_ERROR;
+        if (nEvents)
+            m_mapReady[hSocket] = nEvents;
+    }
+    return nRet;
+}
+#endif // WIN32
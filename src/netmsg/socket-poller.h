@@ -0,0 +1,146 @@
+#pragma once
+// Copyright (c) 2024 The Pastel Core developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <compat.h>
+
+#if defined(__linux__)
+#define USE_EPOLL_SOCKET_POLLER
+#include <sys/epoll.h>
+#endif
+#ifndef WIN32
+#include <poll.h>
+#endif
+
+// socket events watched by the poller
+constexpr uint8_t SOCKET_EVENT_NONE = 0x00;
+constexpr uint8_t SOCKET_EVENT_RECV = 0x01;
+constexpr uint8_t SOCKET_EVENT_SEND = 0x02;
+// error or hangup, always reported for the registered socket
+constexpr uint8_t SOCKET_EVENT_ERROR = 0x04;
+
+/**
+ * Socket readiness poller used by the socket handler thread.
+ * Sockets are registered once, interest in read/write readiness is updated
+ * only when it changes (for example, when the node send buffer fills or drains).
+ * Each registration has an owner id (node id), so the socket descriptor reused
+ * by the new connection after close is registered again.
+ * Backends: epoll on Linux, poll() on other POSIX systems, select() on Windows.
+ */
+class CSocketPoller
+{
+public:
+    typedef struct _socket_event_t
+    {
+        SOCKET hSocket;
+        int64_t nOwnerId;
+        uint8_t nEvents;
+    } socket_event_t;
+
+    virtual ~CSocketPoller() = default;
+
+    // create the best poller available on this platform
+    static std::unique_ptr<CSocketPoller> Create(const bool bPreferEpoll = true);
+
+    bool SetInterest(const SOCKET hSocket, const int64_t nOwnerId, const uint8_t nEvents);
+    void Remove(const SOCKET hSocket);
+    // remove socket only if it is registered by the given owner
+    void Remove(const SOCKET hSocket, const int64_t nOwnerId);
+    // remove all sockets not found in setActiveSockets (closed sockets)
+    void RemoveStale(const std::unordered_set<SOCKET> &setActiveSockets);
+
+    // wait for socket events, returns number of ready sockets, 0 on timeout or SOCKET_ERROR
+    int Wait(const int nTimeoutMs);
+    // get events reported for the socket by the last Wait()
+    uint8_t GetEvents(const SOCKET hSocket) const noexcept;
+    // get all registered sockets with events reported by the last Wait()
+    void GetReadySockets(std::vector<socket_event_t> &vReady) const;
+
+    size_t size() const noexcept { return m_mapRegistered.size(); }
+    virtual const char* GetName() const noexcept = 0;
+
+protected:
+    typedef struct _socket_registration_t
+    {
+        int64_t nOwnerId;
+        uint8_t nEvents;
+    } socket_registration_t;
+
+    // registered sockets
+    std::unordered_map<SOCKET, socket_registration_t> m_mapRegistered;
+    // events reported by the last Wait()
+    std::unordered_map<SOCKET, uint8_t> m_mapReady;
+
+    virtual bool Register(const SOCKET hSocket, const uint8_t nEvents) = 0;
+    virtual bool Modify(const SOCKET hSocket, const uint8_t nEvents) = 0;
+    virtual void Unregister(const SOCKET hSocket) noexcept = 0;
+    virtual int WaitEvents(const int nTimeoutMs) = 0;
+};
+
+#ifndef WIN32
+/**
+ * poll() based socket poller.
+ */
+class CPollSocketPoller : public CSocketPoller
+{
+public:
+    const char* GetName() const noexcept override { return "poll"; }
+
+protected:
+    std::vector<struct pollfd> m_vPollFds;
+    // position of the socket in m_vPollFds
+    std::unordered_map<SOCKET, size_t> m_mapPollIndex;
+
+    bool Register(const SOCKET hSocket, const uint8_t nEvents) override;
+    bool Modify(const SOCKET hSocket, const uint8_t nEvents) override;
+    void Unregister(const SOCKET hSocket) noexcept override;
+    int WaitEvents(const int nTimeoutMs) override;
+};
+#endif // !WIN32
+
+#ifdef USE_EPOLL_SOCKET_POLLER
+/**
+ * epoll based socket poller (level-triggered).
+ */
+class CEpollSocketPoller : public CSocketPoller
+{
+public:
+    CEpollSocketPoller() noexcept;
+    ~CEpollSocketPoller() override;
+
+    bool IsValid() const noexcept { return m_hEpoll >= 0; }
+    const char* GetName() const noexcept override { return "epoll"; }
+
+protected:
+    int m_hEpoll;
+    std::vector<struct epoll_event> m_vEvents;
+
+    bool Register(const SOCKET hSocket, const uint8_t nEvents) override;
+    bool Modify(const SOCKET hSocket, const uint8_t nEvents) override;
+    void Unregister(const SOCKET hSocket) noexcept override;
+    int WaitEvents(const int nTimeoutMs) override;
+};
+#endif // USE_EPOLL_SOCKET_POLLER
+
+#ifdef WIN32
+/**
+ * select() based socket poller.
+ */
+class CSelectSocketPoller : public CSocketPoller
+{
+public:
+    const char* GetName() const noexcept override { return "select"; }
+
+protected:
+    bool Register(const SOCKET hSocket, const uint8_t nEvents) override { return true; }
+    bool Modify(const SOCKET hSocket, const uint8_t nEvents) override { return true; }
+    void Unregister(const SOCKET hSocket) noexcept override {}
+    int WaitEvents(const int nTimeoutMs) override;
+};
+#endif // WIN32
@@ -14,7 +14,7 @@
 
 using namespace std;
 
-constexpr array<const char *, 13> NET_MSG_TYPE =
+constexpr array<const char *, 14> NET_MSG_TYPE =
 {
     "ERROR",
     "tx",
@@ -30,9 +30,39 @@ constexpr array<const char *, 13> NET_MSG_TYPE =
     NetMsgType::MNPING,
     NetMsgType::DSTX,
     NetMsgType::MNVERIFY,
+    NetMsgType::MASTERNODEMESSAGE,
+
+    "cmpctblock"
+};
+
+// messages processed by the masternode layer
+constexpr array<const char *, 13> MASTERNODE_NET_MSG_TYPES =
+{
+    NetMsgType::MNANNOUNCE,
+    NetMsgType::MNPING,
+    NetMsgType::MNVERIFY,
+    NetMsgType::DSEG,
+    NetMsgType::DSEGCOMPACT,
+    NetMsgType::SYNCSTATUSCOUNT,
+    NetMsgType::MASTERNODEPAYMENTVOTE,
+    NetMsgType::MASTERNODEPAYMENTBLOCK,
+    NetMsgType::MASTERNODEPAYMENTSYNC,
+    NetMsgType::GOVERNANCESYNC,
+    NetMsgType::GOVERNANCE,
+    NetMsgType::GOVERNANCEVOTE,
     NetMsgType::MASTERNODEMESSAGE
 };
 
+bool IsMasternodeMessageType(const string &strCommand) noexcept
+{
+    for (const auto szMsgType : MASTERNODE_NET_MSG_TYPES)
+    {
+        if (strCommand == szMsgType)
+            return true;
+    }
+    return false;
+}
+
 CMessageHeader::CMessageHeader(const MessageStartChars& pchMessageStartIn)
 {
     memcpy(pchMessageStart, pchMessageStartIn, MESSAGE_START_SIZE);
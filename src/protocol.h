@@ -74,6 +74,9 @@ enum {
     // Zcash nodes used to support this by default, without advertising this bit,
     // but no longer do as of protocol version 170004 (= NO_BLOOM_VERSION)
     NODE_BLOOM = (1 << 2),
+    // NODE_COMPACT_BLOCKS means the node supports compact block relay
+    // ("cmpctblock", "getblocktxn" and "blocktxn" messages), see COMPACT_BLOCKS_VERSION
+    NODE_COMPACT_BLOCKS = (1 << 3),
 
     // Bits 24-31 are reserved for temporary experiments. Just pick a bit that
     // isn't getting used, or one not being used much, and notify the
@@ -163,7 +166,9 @@ enum {
     MSG_MASTERNODE_PING,
     MSG_DSTX,
     MSG_MASTERNODE_VERIFY,
-    MSG_MASTERNODE_MESSAGE
+    MSG_MASTERNODE_MESSAGE,
+    // MSG_CMPCT_BLOCK is used only in getdata to request a compact block
+    MSG_CMPCT_BLOCK
 };
 
 namespace NetMsgType
@@ -172,6 +177,7 @@ namespace NetMsgType
     constexpr auto MNPING                   = "mnp";    // MasterNode Ping
     constexpr auto MNVERIFY                 = "mnv";    // MasterNode Verify
     constexpr auto DSEG                     = "dseg";   // MasterNode Sync request (Masternode list or specific entry)
+    constexpr auto DSEGCOMPACT              = "dsegc";  // MasterNode Sync request (only missing or changed Masternode list entries)
     constexpr auto SYNCSTATUSCOUNT          = "ssc";    // MasterNode Sync status
 
     // const char *TXLOCKREQUEST="ix";
@@ -185,3 +191,6 @@ namespace NetMsgType
     constexpr auto DSTX                     = "dstx";    
     constexpr auto MASTERNODEMESSAGE        = "mnmsg";  // MasterNode message
 };
+
+// returns true if the message is processed by the masternode layer
+bool IsMasternodeMessageType(const std::string &strCommand) noexcept;
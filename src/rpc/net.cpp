@@ -96,6 +96,11 @@ Result:
     "lastrecv": ttt,                    (numeric) The time in seconds since epoch (Jan 1 1970 GMT) of the last receive
     "bytessent": n,                     (numeric) The total bytes sent
     "bytesrecv": n,                     (numeric) The total bytes received
+    "recvbufallocs": n,                 (numeric) The number of receive buffers allocated for the peer messages
+    "recvbufreuses": n,                 (numeric) The number of receive buffers reused from the pool
+    "recvbufgrows": n,                  (numeric) The number of receive buffer reallocations
+    "cmpctblocks": n,                   (numeric) The number of compact blocks received from the peer
+    "cmpctblocktxnreqs": n,             (numeric) The number of missing transactions requests sent for the compact blocks
     "conntime": ttt,                    (numeric) The connection time in seconds since epoch (Jan 1 1970 GMT)
     "timeoffset": ttt,                  (numeric) The time offset in seconds
     "pingtime": n,                      (numeric) ping time
@@ -143,6 +148,11 @@ Examples:
         obj.pushKV("lastrecv", stats.nLastRecv);
         obj.pushKV("bytessent", stats.nSendBytes);
         obj.pushKV("bytesrecv", stats.nRecvBytes);
+        obj.pushKV("recvbufallocs", stats.nRecvBufAllocs);
+        obj.pushKV("recvbufreuses", stats.nRecvBufReuses);
+        obj.pushKV("recvbufgrows", stats.nRecvBufGrows);
+        obj.pushKV("cmpctblocks", stats.nCmpctBlocksReceived);
+        obj.pushKV("cmpctblocktxnreqs", stats.nCmpctBlockTxRequests);
         obj.pushKV("conntime", stats.nTimeConnected);
         obj.pushKV("timeoffset", stats.nTimeOffset);
         obj.pushKV("pingtime", stats.dPingTime);
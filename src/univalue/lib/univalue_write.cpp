@@ -58,6 +58,10 @@ void UniValue::write(unsigned int prettyIndent,
     case VBOOL:
         s += (val == "1" ? "true" : "false");
         break;
+    case VRAW:
+        // already serialized json
+        s += val;
+        break;
     }
 }
 
@@ -222,12 +222,21 @@ public:
     bool empty() const noexcept                      { return vch.empty() ? true : (nReadPos >= vch.size()); }
     void resize(size_type n, value_type c = 0)         { vch.resize(n + nReadPos, c); }
     void reserve(size_type n)                        { vch.reserve(n + nReadPos); }
+    size_type capacity() const noexcept              { return vch.capacity(); }
     const_reference operator[](size_type pos) const  { return vch[pos + nReadPos]; }
     reference operator[](size_type pos)              { return vch[pos + nReadPos]; }
     void clear() noexcept                            { vch.clear(); nReadPos = 0; }
     iterator insert(iterator it, const char& x=char()) { return vch.insert(it, x); }
     void insert(iterator it, size_type n, const char& x) { vch.insert(it, n, x); }
     size_t getReadPos() const noexcept               { return nReadPos; }
+    // move out the underlying buffer, stream is left empty
+    vector_type release_buffer() noexcept
+    {
+        vector_type v(std::move(vch));
+        vch.clear();
+        nReadPos = 0;
+        return v;
+    }
 
     void insert(iterator it, std::vector<char>::const_iterator first, std::vector<char>::const_iterator last)
     {
@@ -461,6 +470,10 @@ public:
         CBaseDataStream(vchIn, nType, nVersion)
     {}
 
+    CDataStream(vector_type&& vchIn, const int nType, const int nVersion) :
+        CBaseDataStream(std::move(vchIn), nType, nVersion)
+    {}
+
     CDataStream(const std::vector<char>& vchIn, const int nType, const int nVersion) :
         CBaseDataStream(vchIn, nType, nVersion)
     {}
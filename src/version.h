@@ -8,7 +8,7 @@
  * network protocol versioning
  */
 
-inline constexpr int PROTOCOL_VERSION = 170012;
+inline constexpr int PROTOCOL_VERSION = 170014;
 
 // min MasterNodes protocol version
 inline constexpr int MN_MIN_PROTOCOL_VERSION = 170010;
@@ -34,3 +34,9 @@ inline constexpr int MEMPOOL_GD_VERSION = 60002;
 
 //! "filter*" commands are disabled without NODE_BLOOM after and including this version
 inline constexpr int NO_BLOOM_VERSION = 170004;
+
+//! compact masternode list sync request "dsegc" is supported starting with this version
+inline constexpr int MN_DSEG_COMPACT_VERSION = 170013;
+
+//! compact block relay "cmpctblock", "getblocktxn" and "blocktxn" messages are supported starting with this version
+inline constexpr int COMPACT_BLOCKS_VERSION = 170014;